@@ -0,0 +1,552 @@
+#include "Gemm.hpp"
+#include "LU.hpp"
+#include "Matrix.hpp"
+#include "MixedPrecision.hpp"
+#include "QR.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+#include "Trsm.hpp"
+#include "Vector.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Benchmark driver for the MWP kernels
+ *
+ * Sweeps matrix orders for each kernel and reports the best time of several
+ * repetitions with the derived GFLOP/s, GB/s and percentage of the machine
+ * peak. The level-1 kernels (norm and dot) run on n * n elements so that
+ * every kernel of a sweep touches the same amount of memory.
+ *
+ * Usage: mwp_bench [--sizes 64,128,...] [--kernels gemm,lu,...]
+ *                  [--threads N] [--min-time seconds] [--json file]
+ *                  [--baseline file] [--tolerance fraction]
+ *                  [--peak-gflops value] [--peak-gbps value]
+ *
+ * --json writes the results for regression tracking. --baseline compares
+ * them to a file written by --json and the process exits with status 1 when
+ * a kernel is slower than the baseline by more than the tolerance.
+ */
+
+namespace {
+
+/**
+ * @brief Work done by one run of a kernel at a given size
+ *
+ * Bytes count the compulsory traffic: every operand read and every result
+ * written once.
+ */
+struct Cost {
+  double _flops;
+  double _bytes;
+};
+
+/**
+ * @brief Benchmarked kernel
+ *
+ * prepare() allocates the operands of order n and returns the function timed
+ * by the driver, which must leave the operands ready for the next run.
+ */
+struct Kernel {
+  std::string _name;
+  std::function<Cost(std::size_t)> _cost;
+  std::function<std::function<void()>(std::size_t)> _prepare;
+};
+
+struct Measurement {
+  std::string _kernel;
+  std::size_t _size;
+  double _seconds;
+  double _gflops;
+  double _gbps;
+  double _peakPercent;
+};
+
+struct Settings {
+  std::vector<std::size_t> _sizes = {64, 128, 256, 512, 1024};
+  std::vector<std::string> _kernels;
+  unsigned int _threads = 0;
+  double _minTime = 0.2;
+  std::string _jsonPath;
+  std::string _baselinePath;
+  double _tolerance = 0.1;
+  double _peakGflops = 0.0;
+  double _peakGbps = 0.0;
+};
+
+volatile double sink = 0.0;
+
+MWP::MatrixD randomMatrix(std::size_t rows, std::size_t columns,
+                          unsigned int seed) {
+  MWP::MatrixD matrix((MWP::Index)rows, (MWP::Index)columns);
+  for (std::size_t i = 0; i < matrix._elements.size(); i++) {
+    matrix._elements[i] = std::sin((double)(i * 7 + seed)) + 0.1;
+  }
+  return matrix;
+}
+
+std::shared_ptr<MWP::MatrixF> randomMatrixF(std::size_t n, unsigned int seed) {
+  const MWP::MatrixD matrix = randomMatrix(n, n, seed);
+  auto rounded = std::make_shared<MWP::MatrixF>((MWP::Index)n, (MWP::Index)n);
+  for (std::size_t i = 0; i < matrix._elements.size(); i++) {
+    rounded->_elements[i] = (float)matrix._elements[i];
+  }
+  return rounded;
+}
+
+// Diagonally dominant, so LU and the triangular solves stay well scaled.
+MWP::MatrixD dominantMatrix(std::size_t n, unsigned int seed) {
+  MWP::MatrixD matrix = randomMatrix(n, n, seed);
+  for (std::size_t i = 0; i < n; i++) {
+    matrix._elements[i * n + i] += (double)n;
+  }
+  return matrix;
+}
+
+std::shared_ptr<MWP::MatrixD> share(MWP::MatrixD matrix) {
+  return std::make_shared<MWP::MatrixD>(std::move(matrix));
+}
+
+std::vector<Kernel> kernels() {
+  std::vector<Kernel> list;
+  list.push_back({"gemm",
+                  [](std::size_t n) {
+                    double n2 = (double)n * n;
+                    return Cost{2.0 * n2 * n, 3.0 * 8.0 * n2};
+                  },
+                  [](std::size_t n) -> std::function<void()> {
+                    auto A = share(randomMatrix(n, n, 1));
+                    auto B = share(randomMatrix(n, n, 2));
+                    auto C = share(randomMatrix(n, n, 3));
+                    return [=]() {
+                      MWP::gemm<double>(false, false, n, n, n, 1.0,
+                                        A->_elements.data(), n,
+                                        B->_elements.data(), n, 0.0,
+                                        C->_elements.data(), n);
+                    };
+                  }});
+  // Single precision runs at twice the double rate, so its percentage of the
+  // double peak can exceed 100%.
+  list.push_back({"sgemm",
+                  [](std::size_t n) {
+                    double n2 = (double)n * n;
+                    return Cost{2.0 * n2 * n, 3.0 * 4.0 * n2};
+                  },
+                  [](std::size_t n) -> std::function<void()> {
+                    auto A = randomMatrixF(n, 1);
+                    auto B = randomMatrixF(n, 2);
+                    auto C = randomMatrixF(n, 3);
+                    return [=]() {
+                      MWP::gemm<float>(false, false, n, n, n, 1.0f,
+                                       A->_elements.data(), n,
+                                       B->_elements.data(), n, 0.0f,
+                                       C->_elements.data(), n);
+                    };
+                  }});
+  list.push_back({"gemv",
+                  [](std::size_t n) {
+                    double n2 = (double)n * n;
+                    return Cost{2.0 * n2, 8.0 * (n2 + 2.0 * n)};
+                  },
+                  [](std::size_t n) -> std::function<void()> {
+                    auto A = share(randomMatrix(n, n, 1));
+                    auto x = std::make_shared<std::vector<double>>(n, 1.0);
+                    auto y = std::make_shared<std::vector<double>>(n, 0.0);
+                    return [=]() {
+                      MWP::gemv<double>(false, n, n, 1.0, A->_elements.data(),
+                                        n, x->data(), 0.0, y->data());
+                    };
+                  }});
+  list.push_back({"lu",
+                  [](std::size_t n) {
+                    double n2 = (double)n * n;
+                    return Cost{2.0 / 3.0 * n2 * n, 2.0 * 8.0 * n2};
+                  },
+                  [](std::size_t n) -> std::function<void()> {
+                    auto A = share(dominantMatrix(n, 1));
+                    return [=]() {
+                      MWP::LUD lu(*A);
+                      sink = sink + (double)lu.isNonsingular();
+                    };
+                  }});
+  // Same flop count as lu so the two rates compare directly; the factorization
+  // runs in single precision and rounds a copy of A first.
+  list.push_back({"mixedlu",
+                  [](std::size_t n) {
+                    double n2 = (double)n * n;
+                    return Cost{2.0 / 3.0 * n2 * n, 2.0 * 8.0 * n2};
+                  },
+                  [](std::size_t n) -> std::function<void()> {
+                    auto A = share(dominantMatrix(n, 1));
+                    return [=]() {
+                      MWP::MixedPrecisionLU<double> lu(*A);
+                      sink = sink + (double)lu.usedFallback();
+                    };
+                  }});
+  list.push_back({"qr",
+                  [](std::size_t n) {
+                    double n2 = (double)n * n;
+                    return Cost{4.0 / 3.0 * n2 * n, 2.0 * 8.0 * n2};
+                  },
+                  [](std::size_t n) -> std::function<void()> {
+                    auto A = share(randomMatrix(n, n, 1));
+                    return [=]() {
+                      MWP::QRD qr(*A);
+                      sink = sink + qr._factors._elements[0];
+                    };
+                  }});
+  list.push_back({"gs",
+                  [](std::size_t n) {
+                    double n2 = (double)n * n;
+                    return Cost{2.0 * n2 * n, 3.0 * 8.0 * n2};
+                  },
+                  [](std::size_t n) -> std::function<void()> {
+                    auto A = share(dominantMatrix(n, 1));
+                    return [=]() {
+                      std::pair<MWP::MatrixD, MWP::MatrixD> QR = GS(*A);
+                      sink = sink + QR.second._elements[0];
+                    };
+                  }});
+  list.push_back({"trsm",
+                  [](std::size_t n) {
+                    double n2 = (double)n * n;
+                    return Cost{n2 * n, 3.0 * 8.0 * n2};
+                  },
+                  [](std::size_t n) -> std::function<void()> {
+                    auto A = share(dominantMatrix(n, 1));
+                    auto B = share(randomMatrix(n, n, 2));
+                    auto X = share(*B);
+                    // Each run solves for the original right-hand sides;
+                    // the O(n^2) copy is negligible next to the solve.
+                    return [=]() {
+                      X->_elements = B->_elements;
+                      MWP::trsm<double>(true, false, false, n, n,
+                                        A->_elements.data(), n,
+                                        X->_elements.data(), n);
+                    };
+                  }});
+  list.push_back({"transpose",
+                  [](std::size_t n) {
+                    return Cost{0.0, 2.0 * 8.0 * (double)n * n};
+                  },
+                  [](std::size_t n) -> std::function<void()> {
+                    auto A = share(randomMatrix(n, n, 1));
+                    return [=]() { A->transpose(); };
+                  }});
+  list.push_back({"norm",
+                  [](std::size_t n) {
+                    double n2 = (double)n * n;
+                    return Cost{2.0 * n2, 8.0 * n2};
+                  },
+                  [](std::size_t n) -> std::function<void()> {
+                    auto x = std::make_shared<MWP::VectorD>(
+                        randomMatrix(n * n, 1, 1)._elements,
+                        (MWP::Index)(n * n), 1);
+                    return [=]() { sink = sink + x->norm2(); };
+                  }});
+  list.push_back({"dot",
+                  [](std::size_t n) {
+                    double n2 = (double)n * n;
+                    return Cost{2.0 * n2, 2.0 * 8.0 * n2};
+                  },
+                  [](std::size_t n) -> std::function<void()> {
+                    auto x = std::make_shared<MWP::VectorD>(
+                        randomMatrix(n * n, 1, 1)._elements,
+                        (MWP::Index)(n * n), 1);
+                    auto y = std::make_shared<MWP::VectorD>(
+                        randomMatrix(n * n, 1, 2)._elements,
+                        (MWP::Index)(n * n), 1);
+                    return [=]() { sink = sink + Dot(*x, *y); };
+                  }});
+  return list;
+}
+
+/**
+ * @brief Best time of a kernel in seconds
+ *
+ * One untimed run warms the caches and the thread pool, then the kernel is
+ * repeated until minTime has elapsed, with at least three runs.
+ */
+double bestTime(const std::function<void()> &run, double minTime) {
+  typedef std::chrono::steady_clock Clock;
+  run();
+  double best = 1e300;
+  double total = 0.0;
+  for (int repetition = 0; repetition < 3 || total < minTime; repetition++) {
+    Clock::time_point start = Clock::now();
+    run();
+    double elapsed =
+        std::chrono::duration<double>(Clock::now() - start).count();
+    best = std::min(best, elapsed);
+    total += elapsed;
+  }
+  return best;
+}
+
+std::size_t simdLanes() {
+  switch (MWP::simd::activeLevel()) {
+  case MWP::simd::Level::AVX512:
+    return 8;
+  case MWP::simd::Level::AVX2:
+    return 4;
+  case MWP::simd::Level::SSE2:
+    return 2;
+  default:
+    return 1;
+  }
+}
+
+/**
+ * @brief Estimated peak in double precision GFLOP/s
+ *
+ * Two FMA units per core at the clock reported by /proc/cpuinfo. It is only
+ * an estimate, --peak-gflops overrides it.
+ */
+double estimatePeakGflops(unsigned int threads) {
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  double megahertz = 0.0;
+  while (std::getline(cpuinfo, line)) {
+    if (line.compare(0, 7, "cpu MHz") == 0) {
+      std::size_t colon = line.find(':');
+      if (colon != std::string::npos) {
+        megahertz = std::max(megahertz, std::atof(line.c_str() + colon + 1));
+      }
+    }
+  }
+  if (megahertz <= 0.0) {
+    return 0.0;
+  }
+  return megahertz * 1e-3 * (double)(simdLanes() * 2 * 2) * (double)threads;
+}
+
+/**
+ * @brief Measured memory bandwidth in GB/s
+ *
+ * A STREAM-like triad with axpy on arrays much larger than the caches.
+ */
+double measurePeakGbps() {
+  const std::size_t n = 1 << 23;
+  std::vector<double> x(n, 1.0);
+  std::vector<double> y(n, 2.0);
+  double seconds = bestTime(
+      [&]() { MWP::simd::axpy<double>(n, 1e-9, x.data(), y.data()); }, 0.2);
+  return 3.0 * 8.0 * (double)n / seconds * 1e-9;
+}
+
+std::vector<std::string> split(const std::string &text) {
+  std::vector<std::string> parts;
+  std::stringstream stream(text);
+  std::string part;
+  while (std::getline(stream, part, ',')) {
+    if (!part.empty()) {
+      parts.push_back(part);
+    }
+  }
+  return parts;
+}
+
+Settings parseArguments(int argc, char **argv) {
+  Settings settings;
+  for (int i = 1; i < argc; i++) {
+    std::string option = argv[i];
+    if (option == "--help") {
+      std::cout << "Usage: mwp_bench [--sizes 64,128,...] [--kernels "
+                   "gemm,sgemm,gemv,lu,mixedlu,qr,gs,trsm,\n"
+                   "                 transpose,norm,dot]\n"
+                   "                 [--threads N] [--min-time seconds] "
+                   "[--json file]\n"
+                   "                 [--baseline file] [--tolerance "
+                   "fraction]\n"
+                   "                 [--peak-gflops value] [--peak-gbps "
+                   "value]\n";
+      std::exit(0);
+    }
+    if (i + 1 >= argc) {
+      throw std::runtime_error("Missing value for option " + option);
+    }
+    std::string value = argv[++i];
+    if (option == "--sizes") {
+      settings._sizes.clear();
+      for (const std::string &size : split(value)) {
+        settings._sizes.push_back((std::size_t)std::stoul(size));
+      }
+    } else if (option == "--kernels") {
+      settings._kernels = split(value);
+    } else if (option == "--threads") {
+      settings._threads = (unsigned int)std::stoul(value);
+    } else if (option == "--min-time") {
+      settings._minTime = std::stod(value);
+    } else if (option == "--json") {
+      settings._jsonPath = value;
+    } else if (option == "--baseline") {
+      settings._baselinePath = value;
+    } else if (option == "--tolerance") {
+      settings._tolerance = std::stod(value);
+    } else if (option == "--peak-gflops") {
+      settings._peakGflops = std::stod(value);
+    } else if (option == "--peak-gbps") {
+      settings._peakGbps = std::stod(value);
+    } else {
+      throw std::runtime_error("Unknown option " + option);
+    }
+  }
+  return settings;
+}
+
+void writeJson(const std::string &path, const Settings &settings,
+               const std::vector<Measurement> &measurements) {
+  std::ofstream file(path);
+  if (!file) {
+    throw std::runtime_error("Could not open " + path);
+  }
+  file << "{\n"
+       << "  \"simd\": \""
+       << MWP::simd::levelName(MWP::simd::activeLevel()) << "\",\n"
+       << "  \"threads\": " << MWP::getNumThreads() << ",\n"
+       << "  \"peak_gflops\": " << settings._peakGflops << ",\n"
+       << "  \"peak_gbps\": " << settings._peakGbps << ",\n"
+       << "  \"results\": [\n";
+  // One result per line, which is what readBaseline() expects.
+  for (std::size_t i = 0; i < measurements.size(); i++) {
+    const Measurement &m = measurements[i];
+    file << "    {\"kernel\": \"" << m._kernel << "\", \"n\": " << m._size
+         << ", \"seconds\": " << m._seconds << ", \"gflops\": " << m._gflops
+         << ", \"gbps\": " << m._gbps
+         << ", \"peak_percent\": " << m._peakPercent << "}"
+         << (i + 1 < measurements.size() ? "," : "") << "\n";
+  }
+  file << "  ]\n}\n";
+}
+
+std::string jsonField(const std::string &line, const std::string &key) {
+  std::string pattern = "\"" + key + "\":";
+  std::size_t start = line.find(pattern);
+  if (start == std::string::npos) {
+    return "";
+  }
+  start += pattern.size();
+  while (start < line.size() && (line[start] == ' ' || line[start] == '"')) {
+    start++;
+  }
+  std::size_t end = line.find_first_of("\",}", start);
+  return line.substr(start, end - start);
+}
+
+/**
+ * @brief Reads the seconds of each kernel and size from a --json file
+ */
+std::map<std::pair<std::string, std::size_t>, double>
+readBaseline(const std::string &path) {
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error("Could not open " + path);
+  }
+  std::map<std::pair<std::string, std::size_t>, double> baseline;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::string kernel = jsonField(line, "kernel");
+    std::string size = jsonField(line, "n");
+    std::string seconds = jsonField(line, "seconds");
+    if (!kernel.empty() && !size.empty() && !seconds.empty()) {
+      baseline[{kernel, (std::size_t)std::stoul(size)}] = std::stod(seconds);
+    }
+  }
+  return baseline;
+}
+
+bool compareBaseline(const std::string &path, double tolerance,
+                     const std::vector<Measurement> &measurements) {
+  std::map<std::pair<std::string, std::size_t>, double> baseline =
+      readBaseline(path);
+  bool regressed = false;
+  std::printf("\n%-10s %6s %12s %12s %8s\n", "kernel", "n", "baseline s",
+              "current s", "speedup");
+  for (const Measurement &m : measurements) {
+    auto entry = baseline.find({m._kernel, m._size});
+    if (entry == baseline.end()) {
+      continue;
+    }
+    double speedup = entry->second / m._seconds;
+    bool slower = m._seconds > entry->second * (1.0 + tolerance);
+    regressed = regressed || slower;
+    std::printf("%-10s %6zu %12.6f %12.6f %7.2fx%s\n", m._kernel.c_str(),
+                m._size, entry->second, m._seconds, speedup,
+                slower ? "  REGRESSION" : "");
+  }
+  return regressed;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  try {
+    Settings settings = parseArguments(argc, argv);
+    if (settings._threads > 0) {
+      MWP::setNumThreads(settings._threads);
+    }
+    if (settings._peakGflops <= 0.0) {
+      settings._peakGflops = estimatePeakGflops(MWP::getNumThreads());
+    }
+    if (settings._peakGbps <= 0.0) {
+      settings._peakGbps = measurePeakGbps();
+    }
+    std::printf("simd %s, %u threads, peak %.1f GFLOP/s, %.1f GB/s\n\n",
+                MWP::simd::levelName(MWP::simd::activeLevel()),
+                MWP::getNumThreads(), settings._peakGflops,
+                settings._peakGbps);
+    std::printf("%-10s %6s %12s %10s %10s %8s\n", "kernel", "n", "seconds",
+                "GFLOP/s", "GB/s", "% peak");
+
+    std::vector<Measurement> measurements;
+    for (const Kernel &kernel : kernels()) {
+      if (!settings._kernels.empty() &&
+          std::find(settings._kernels.begin(), settings._kernels.end(),
+                    kernel._name) == settings._kernels.end()) {
+        continue;
+      }
+      for (std::size_t n : settings._sizes) {
+        Cost cost = kernel._cost(n);
+        double seconds = bestTime(kernel._prepare(n), settings._minTime);
+        Measurement m{kernel._name, n, seconds, cost._flops / seconds * 1e-9,
+                      cost._bytes / seconds * 1e-9, 0.0};
+        // Kernels without arithmetic are bound by memory bandwidth.
+        if (cost._flops > 0.0 && settings._peakGflops > 0.0) {
+          m._peakPercent = 100.0 * m._gflops / settings._peakGflops;
+        } else if (cost._flops == 0.0 && settings._peakGbps > 0.0) {
+          m._peakPercent = 100.0 * m._gbps / settings._peakGbps;
+        }
+        std::printf("%-10s %6zu %12.6f %10.2f %10.2f %7.1f%%\n",
+                    m._kernel.c_str(), n, m._seconds, m._gflops, m._gbps,
+                    m._peakPercent);
+        measurements.push_back(m);
+      }
+    }
+
+    if (!settings._jsonPath.empty()) {
+      writeJson(settings._jsonPath, settings, measurements);
+    }
+    if (!settings._baselinePath.empty() &&
+        compareBaseline(settings._baselinePath, settings._tolerance,
+                        measurements)) {
+      return 1;
+    }
+  } catch (const std::exception &error) {
+    std::fprintf(stderr, "mwp_bench: %s\n", error.what());
+    return 2;
+  }
+  return 0;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace MWP {
+
+/**
+ * @brief Alignment in bytes of the matrix and vector storage
+ *
+ * One cache line, which is also the width of an AVX-512 register: rows of
+ * SIMD loads starting at the first element never straddle two lines.
+ */
+constexpr std::size_t StorageAlignment = 64;
+
+/**
+ * @brief Allocator returning StorageAlignment aligned blocks
+ *
+ * Elements inserted without a value, as by resize(), are default-initialized
+ * rather than value-initialized, so arithmetic types are left uninitialized.
+ * Code that needs zeros must ask for them, as with assign(n, (T)0).
+ *
+ * @tparam T The type of the elements.
+ */
+template <typename T> class AlignedAllocator {
+public:
+  typedef T value_type;
+
+  AlignedAllocator() noexcept {}
+  template <typename U> AlignedAllocator(const AlignedAllocator<U> &) noexcept {}
+
+  T *allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t(StorageAlignment)));
+  }
+
+  void deallocate(T *pointer, std::size_t) noexcept {
+    ::operator delete(pointer, std::align_val_t(StorageAlignment));
+  }
+
+  template <typename U> void construct(U *pointer) {
+    ::new (static_cast<void *>(pointer)) U;
+  }
+
+  template <typename U, typename... Args>
+  void construct(U *pointer, Args &&...args) {
+    ::new (static_cast<void *>(pointer)) U(std::forward<Args>(args)...);
+  }
+};
+
+template <typename T, typename U>
+bool operator==(const AlignedAllocator<T> &, const AlignedAllocator<U> &) {
+  return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const AlignedAllocator<T> &, const AlignedAllocator<U> &) {
+  return false;
+}
+
+/**
+ * @brief Storage type of the Matrix and Vector elements
+ *
+ * A std::vector with the aligned allocator. Since the allocators differ it
+ * is a different type from std::vector<T>, so it converts both ways and
+ * compares with it to keep code written against the former std::vector
+ * storage working. Each conversion copies the elements: a std::vector cannot
+ * hand its buffer over to aligned storage.
+ *
+ * @tparam T The type of the elements.
+ */
+template <typename T>
+class AlignedVector : public std::vector<T, AlignedAllocator<T>> {
+  typedef std::vector<T, AlignedAllocator<T>> Base;
+
+public:
+  using Base::Base;
+  using Base::operator=;
+
+  AlignedVector() = default;
+
+  AlignedVector(const std::vector<T> &elements)
+      : Base(elements.begin(), elements.end()) {}
+
+  AlignedVector &operator=(const std::vector<T> &elements) {
+    this->assign(elements.begin(), elements.end());
+    return *this;
+  }
+
+  operator std::vector<T>() const {
+    return std::vector<T>(this->begin(), this->end());
+  }
+};
+
+template <typename T>
+bool operator==(const AlignedVector<T> &left, const std::vector<T> &right) {
+  return left.size() == right.size() &&
+         std::equal(left.begin(), left.end(), right.begin());
+}
+
+template <typename T>
+bool operator==(const std::vector<T> &left, const AlignedVector<T> &right) {
+  return right == left;
+}
+
+template <typename T>
+bool operator!=(const AlignedVector<T> &left, const std::vector<T> &right) {
+  return !(left == right);
+}
+
+template <typename T>
+bool operator!=(const std::vector<T> &left, const AlignedVector<T> &right) {
+  return !(right == left);
+}
+
+/**
+ * @brief Tag selecting the constructors that leave the elements uninitialized
+ *
+ * Meant for results that are entirely overwritten before being read, which
+ * saves the pass that would zero them.
+ */
+struct UninitializedTag {};
+constexpr UninitializedTag Uninitialized{};
+
+} // namespace MWP
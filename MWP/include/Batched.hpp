@@ -0,0 +1,189 @@
+#pragma once
+
+#include "Matrix.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace MWP {
+
+/**
+ * @brief Number of batch members handled per task by the batched kernels
+ */
+constexpr std::size_t BatchChunkSize = 256;
+
+/**
+ * @brief A batch of matrices of the same dimensions stored interleaved
+ *
+ * Element (i, j) of every member is stored contiguously, member after
+ * member: the batch index is the fastest-moving one. Every batched kernel
+ * then runs its scalar algorithm once, with each arithmetic step applied
+ * across the whole batch as a SIMD operation, so each lane works on a
+ * different matrix. The whole batch is a single allocation.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> class BatchedMatrix {
+public:
+  std::size_t _batch;
+  std::size_t _rows;
+  std::size_t _columns;
+  std::vector<T> _elements;
+
+public:
+  /**
+   * @brief Default constructor for an empty batch
+   */
+  BatchedMatrix();
+
+  /**
+   * @brief Constructor for a batch of zero matrices
+   *
+   * @param batch The number of matrices.
+   * @param rows The number of rows of every matrix.
+   * @param columns The number of columns of every matrix.
+   */
+  BatchedMatrix(std::size_t batch, std::size_t rows, std::size_t columns);
+
+public:
+  /**
+   * @brief Element (row, column) of member b, without bounds checking
+   */
+  T &operator()(std::size_t b, std::size_t row, std::size_t column) {
+    return _elements[(row * _columns + column) * _batch + b];
+  }
+  const T &operator()(std::size_t b, std::size_t row,
+                      std::size_t column) const {
+    return _elements[(row * _columns + column) * _batch + b];
+  }
+
+  /**
+   * @brief Overwrites member b with the given matrix
+   *
+   * @param b The index of the member.
+   * @param matrix A matrix of the batch dimensions.
+   * @throws std::runtime_error If the dimensions differ.
+   * @throws std::out_of_range If b is outside the batch.
+   */
+  void set(std::size_t b, const Matrix<T> &matrix);
+
+  /**
+   * @brief Copies member b out of the batch
+   *
+   * @param b The index of the member.
+   * @return Matrix<T> The member as a dynamic matrix.
+   * @throws std::out_of_range If b is outside the batch.
+   */
+  Matrix<T> get(std::size_t b) const;
+};
+
+/**
+ * @brief Batched general matrix multiplication, C = alpha * A * B + beta * C
+ *
+ * @tparam T The type of the matrix elements.
+ * @throws std::runtime_error If the batch sizes or dimensions do not match.
+ */
+template <typename T>
+void batchedGemm(T alpha, const BatchedMatrix<T> &A, const BatchedMatrix<T> &B,
+                 T beta, BatchedMatrix<T> &C);
+
+/**
+ * @brief Batched triangular solve, op(A) * X = B, overwriting B with X
+ *
+ * @tparam T The type of the matrix elements.
+ * @param lower A is lower triangular instead of upper triangular.
+ * @param transA Use the transpose of A.
+ * @param unitDiagonal Assume a unit diagonal instead of reading it.
+ * @param A The square triangular matrices.
+ * @param B The right-hand sides, overwritten by the solutions.
+ * @throws std::runtime_error If the batch sizes or dimensions do not match.
+ */
+template <typename T>
+void batchedTrsm(bool lower, bool transA, bool unitDiagonal,
+                 const BatchedMatrix<T> &A, BatchedMatrix<T> &B);
+
+/**
+ * @brief LU factorization with partial pivoting of every member of a batch
+ *
+ * Each member picks its own pivots; the row interchanges are applied lane
+ * by lane while all arithmetic runs across the batch.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> class BatchedLU {
+public:
+  BatchedMatrix<T> _factors;
+  std::vector<std::size_t> _pivots;
+  std::vector<unsigned char> _nonsingular;
+
+public:
+  /**
+   * @brief Factors every member of the batch
+   *
+   * @param matrices The batch of square matrices.
+   * @throws std::runtime_error If the matrices are not square.
+   */
+  explicit BatchedLU(BatchedMatrix<T> matrices);
+
+public:
+  /**
+   * @brief Check if member b had no zero pivot
+   */
+  bool isNonsingular(std::size_t b) const;
+
+  /**
+   * @brief Solves A * X = B for every member, in place
+   *
+   * Singular members produce non-finite solutions; check isNonsingular().
+   *
+   * @param B The right-hand sides, overwritten by the solutions.
+   * @throws std::runtime_error If the batch sizes or dimensions do not match.
+   */
+  void solveInPlace(BatchedMatrix<T> &B) const;
+};
+
+/**
+ * @brief Cholesky factorization of every member of a batch
+ *
+ * Only the lower triangles are read and written.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> class BatchedCholesky {
+public:
+  BatchedMatrix<T> _factors;
+  std::vector<unsigned char> _positiveDefinite;
+
+public:
+  /**
+   * @brief Factors every member of the batch
+   *
+   * @param matrices The batch of symmetric matrices.
+   * @throws std::runtime_error If the matrices are not square.
+   */
+  explicit BatchedCholesky(BatchedMatrix<T> matrices);
+
+public:
+  /**
+   * @brief Check if member b was positive definite
+   */
+  bool isPositiveDefinite(std::size_t b) const;
+
+  /**
+   * @brief Solves A * X = B for every member, in place
+   *
+   * Members that are not positive definite produce meaningless solutions;
+   * check isPositiveDefinite().
+   *
+   * @param B The right-hand sides, overwritten by the solutions.
+   * @throws std::runtime_error If the batch sizes or dimensions do not match.
+   */
+  void solveInPlace(BatchedMatrix<T> &B) const;
+};
+
+typedef BatchedMatrix<double> BatchedMatrixD;
+typedef BatchedMatrix<float> BatchedMatrixF;
+typedef BatchedLU<double> BatchedLUD;
+typedef BatchedLU<float> BatchedLUF;
+typedef BatchedCholesky<double> BatchedCholeskyD;
+typedef BatchedCholesky<float> BatchedCholeskyF;
+} // namespace MWP
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "Matrix.hpp"
+#include "MatrixView.hpp"
+#include "Vector.hpp"
+#include <cstddef>
+
+namespace MWP {
+
+/**
+ * @brief Number of columns factored per block column by the blocked Cholesky
+ */
+constexpr std::size_t CholeskyBlockSize = 64;
+
+/**
+ * @brief Factors a symmetric positive definite block in place as A = L * L^T
+ *
+ * Left-looking blocked factorization: the bulk of the work is one GEMM per
+ * block column. Only the lower triangle of A is read and written; on return
+ * it holds L. The upper triangle is left untouched.
+ *
+ * @tparam T The type of the matrix elements, which must not be integral: the
+ * square roots and divisions would truncate.
+ * @param A View of the square block to factor.
+ * @return true The matrix is positive definite.
+ * @return false A non-positive pivot was found; the factor is incomplete.
+ * @throws std::runtime_error If the block is not square.
+ */
+template <typename T> bool choleskyFactorInPlace(MatrixView<T> A);
+
+/**
+ * @brief Cholesky factorization of a symmetric positive definite matrix
+ *
+ * The factor L is stored in the lower triangle of the factored matrix, so
+ * factoring allocates nothing beyond the matrix itself.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> class Cholesky {
+public:
+  Matrix<T> _factors;
+  bool _positiveDefinite;
+
+public:
+  /**
+   * @brief Default constructor for an empty factorization
+   */
+  Cholesky() : _positiveDefinite(false) {}
+
+  /**
+   * @brief Factors the given matrix
+   *
+   * The matrix is taken by value and factored in its own storage; pass it
+   * with std::move to avoid the copy.
+   *
+   * @param matrix The symmetric matrix to factor.
+   * @throws std::runtime_error If the matrix is not square.
+   */
+  explicit Cholesky(Matrix<T> matrix);
+
+public:
+  /**
+   * @brief Check if the factored matrix was positive definite
+   *
+   * @return true The factorization is complete
+   * @return false The matrix is not positive definite
+   */
+  bool isPositiveDefinite() const;
+
+  /**
+   * @brief Unpacks the lower triangular factor
+   *
+   * @return Matrix<T> The L matrix.
+   */
+  Matrix<T> lower() const;
+
+  /**
+   * @brief Solves A * x = b in place
+   *
+   * @param b Contiguous right-hand side of size n, overwritten by x.
+   */
+  void solveInPlace(T *b) const;
+
+  /**
+   * @brief Solves A * x = b
+   *
+   * @param constants The column vector b.
+   * @return Vector<T> The solution x.
+   * @throws std::runtime_error If the dimensions do not match or the matrix
+   * is not positive definite.
+   */
+  Vector<T> solve(const Vector<T> &constants) const;
+
+  /**
+   * @brief Solves A * x = b into an existing vector
+   *
+   * The storage of variables is reused when it already has the size of b,
+   * so repeated solves do not allocate.
+   *
+   * @param constants The column vector b.
+   * @param variables Receives the solution x.
+   * @throws std::runtime_error If the dimensions do not match or the matrix
+   * is not positive definite.
+   */
+  void solve(const Vector<T> &constants, Vector<T> &variables) const;
+
+  /**
+   * @brief Solves A * X = B for every column of B in place
+   *
+   * @param B View of the n x nrhs right-hand sides, overwritten by X.
+   * @throws std::runtime_error If B does not have n rows.
+   */
+  void solveInPlace(MatrixView<T> B) const;
+
+  /**
+   * @brief Solves A * X = B for every column of B
+   *
+   * @param constants The n x nrhs matrix B.
+   * @return Matrix<T> The solutions X.
+   * @throws std::runtime_error If the dimensions do not match or the matrix
+   * is not positive definite.
+   */
+  Matrix<T> solve(const Matrix<T> &constants) const;
+};
+typedef Cholesky<double> CholeskyD;
+typedef Cholesky<float> CholeskyF;
+} // namespace MWP
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @brief Header-only build
+ *
+ * By default the library is compiled once and its templates are explicitly
+ * instantiated for float, double, int and, where it applies, std::complex.
+ * Defining MWP_HEADER_ONLY before including MWP.hpp compiles the whole
+ * library into the including translation unit instead: the kernels can then
+ * be inlined across what used to be library boundaries and the templates
+ * accept custom element types. The CMake target MWP::HeaderOnly sets it.
+ *
+ * MWP_INLINE marks the non-template functions, which must be inline to be
+ * defined in several translation units.
+ */
+#ifdef MWP_HEADER_ONLY
+#define MWP_INLINE inline
+#else
+#define MWP_INLINE
+#endif
+
+/**
+ * @brief Index type of the dense matrices and vectors
+ *
+ * Dimensions, element counts and element indices are all of this type. It
+ * defaults to std::size_t, so a matrix can hold more than 2^32 elements on
+ * 64-bit targets; defining MWP_INDEX_TYPE to a narrower unsigned type, the
+ * same way everywhere, halves the size of the index arithmetic on 32-bit
+ * targets. Sizes that do not fit are rejected by the constructors.
+ */
+#ifndef MWP_INDEX_TYPE
+#define MWP_INDEX_TYPE std::size_t
+#endif
+
+namespace MWP {
+typedef MWP_INDEX_TYPE Index;
+static_assert(std::is_unsigned<Index>::value,
+              "MWP_INDEX_TYPE must be an unsigned integer type");
+} // namespace MWP
@@ -0,0 +1,869 @@
+#pragma once
+
+#include "Allocator.hpp"
+#include "Gemm.hpp"
+#include "Simd.hpp"
+#include "Transpose.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+namespace MWP {
+
+template <typename T> class Matrix;
+template <typename T> class Vector;
+
+/**
+ * @brief Base class of every lazy matrix expression
+ *
+ * Arithmetic on matrices builds a tree of expression nodes instead of
+ * allocating a result per operator. The tree is evaluated in a single pass
+ * when it is assigned to a Matrix, and products inside it are mapped onto
+ * GEMM, GEMV or rank-1 updates. Nodes also answer operator(), operator[]
+ * and norm2() like a Matrix; anything else, such as _elements, needs the
+ * expression assigned to a Matrix first.
+ *
+ * Nodes reference matrices instead of copying them, so an expression must
+ * not outlive its operands: keep it in a Matrix rather than in an auto
+ * variable when an operand is a temporary.
+ *
+ * @tparam E The concrete expression type.
+ */
+template <typename E> struct MatrixExpression {
+  const E &derived() const { return static_cast<const E &>(*this); }
+
+  /**
+   * @brief Element at a row-major linear index
+   *
+   * Gives expressions the read-only access of a Matrix, computing the one
+   * element without evaluating the rest.
+   *
+   * @param index The linear index.
+   * @return The element value.
+   */
+  auto operator[](std::size_t index) const {
+    const E &expression = derived();
+    if (index >= expression.rows() * expression.columns()) {
+      throw std::runtime_error("Index out of bounds");
+    }
+    return expression.at(index / expression.columns(),
+                         index % expression.columns());
+  }
+
+  /**
+   * @brief Frobenius norm of the expression
+   *
+   * The expression is evaluated into a temporary Matrix first.
+   */
+  auto norm2() const { return Matrix<typename E::value_type>(*this).norm2(); }
+};
+
+/**
+ * @brief Base class of every lazy vector expression
+ *
+ * @tparam E The concrete expression type.
+ */
+template <typename E> struct VectorExpression {
+  const E &derived() const { return static_cast<const E &>(*this); }
+
+  /**
+   * @brief Euclidean norm of the expression
+   *
+   * The expression is evaluated into a temporary Vector first.
+   */
+  auto norm2() const { return Vector<typename E::value_type>(*this).norm2(); }
+};
+
+struct AddOperation {
+  static constexpr int sign = 1;
+  static const char *name() { return "addition"; }
+  template <typename T> static T apply(T left, T right) { return left + right; }
+};
+
+struct SubtractOperation {
+  static constexpr int sign = -1;
+  static const char *name() { return "subtraction"; }
+  template <typename T> static T apply(T left, T right) { return left - right; }
+};
+
+/**
+ * @brief Read-only strided view of a row-major block of matrix elements
+ *
+ * The view references elements owned by a Matrix (or any other buffer)
+ * through a pointer, its dimensions and a leading dimension, so sub-blocks
+ * are taken without copying. It is also how matrices are stored inside
+ * expression trees, so building an expression never copies elements.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T>
+class ConstMatrixView : public MatrixExpression<ConstMatrixView<T>> {
+public:
+  typedef T value_type;
+  static constexpr bool elementwise = true;
+  static constexpr bool linear = true;
+
+  const T *_data;
+  std::size_t _rows;
+  std::size_t _columns;
+  std::size_t _ld;
+
+public:
+  ConstMatrixView(const Matrix<T> &matrix)
+      : _data(matrix._elements.data()), _rows(matrix._rows),
+        _columns(matrix._columns), _ld(matrix._columns) {}
+
+  ConstMatrixView(const T *data, std::size_t rows, std::size_t columns,
+             std::size_t ld)
+      : _data(data), _rows(rows), _columns(columns), _ld(ld) {}
+
+  std::size_t rows() const { return _rows; }
+  std::size_t columns() const { return _columns; }
+  T at(std::size_t i, std::size_t j) const { return _data[i * _ld + j]; }
+  T atLinear(std::size_t index) const { return _data[index]; }
+  T operator()(std::size_t i, std::size_t j) const { return at(i, j); }
+  bool contiguous() const { return _ld == _columns; }
+
+  bool overlaps(const T *begin, const T *end) const {
+    return _rows != 0 && _data < end &&
+           begin < _data + (_rows - 1) * _ld + _columns;
+  }
+
+  bool conflicts(const T *out, std::size_t ld, const T *end) const {
+    return overlaps(out, end) && !isStorage(out, ld);
+  }
+
+  bool isStorage(const T *out, std::size_t ld) const {
+    return _data == out && _ld == ld;
+  }
+
+  void assignTo(T *out, std::size_t ld, T alpha, bool accumulate) const {
+    if (contiguous() && ld == _columns) {
+      assignRow(out, _data, _rows * _columns, alpha, accumulate);
+      return;
+    }
+    for (std::size_t i = 0; i < _rows; i++) {
+      assignRow(out + i * ld, _data + i * _ld, _columns, alpha, accumulate);
+    }
+  }
+
+private:
+  static void assignRow(T *out, const T *in, std::size_t n, T alpha,
+                        bool accumulate) {
+    if (accumulate) {
+      simd::axpy<T>(n, alpha, in, out);
+    } else if (alpha != (T)1) {
+      simd::scale<T>(n, alpha, in, out);
+    } else if (in != out) {
+      std::copy(in, in + n, out);
+    }
+  }
+};
+
+/**
+ * @brief Read-only strided view of vector elements
+ *
+ * Element i lives at data[i * stride], so a view can reference a Vector, a
+ * row of a matrix (stride 1) or a column of a matrix (stride equal to its
+ * leading dimension) without copying.
+ *
+ * @tparam T The type of the vector elements.
+ */
+template <typename T>
+class ConstVectorView : public VectorExpression<ConstVectorView<T>> {
+public:
+  typedef T value_type;
+
+  const T *_data;
+  std::size_t _rows;
+  std::size_t _columns;
+  std::size_t _stride;
+
+public:
+  ConstVectorView(const Vector<T> &vector)
+      : _data(vector._elements.data()), _rows(vector._rows),
+        _columns(vector._columns), _stride(1) {}
+
+  ConstVectorView(const T *data, std::size_t rows, std::size_t columns,
+                  std::size_t stride = 1)
+      : _data(data), _rows(rows), _columns(columns), _stride(stride) {}
+
+  std::size_t rows() const { return _rows; }
+  std::size_t columns() const { return _columns; }
+  std::size_t size() const { return _rows * _columns; }
+  T at(std::size_t index) const { return _data[index * _stride]; }
+  T operator[](std::size_t index) const { return at(index); }
+
+  bool conflicts(const T *out, std::size_t stride, std::size_t size) const {
+    if (isStorage(out, stride) || size == 0 || this->size() == 0) {
+      return false;
+    }
+    return _data < out + (size - 1) * stride + 1 &&
+           out < _data + (this->size() - 1) * _stride + 1;
+  }
+
+  bool isStorage(const T *out, std::size_t stride) const {
+    return _data == out && _stride == stride;
+  }
+
+  void assignTo(T *out, std::size_t stride, T alpha, bool accumulate) const {
+    const std::size_t size = this->size();
+    if (_stride == 1 && stride == 1) {
+      if (accumulate) {
+        simd::axpy<T>(size, alpha, _data, out);
+      } else if (alpha != (T)1) {
+        simd::scale<T>(size, alpha, _data, out);
+      } else if (_data != out) {
+        std::copy(_data, _data + size, out);
+      }
+      return;
+    }
+    for (std::size_t i = 0; i < size; i++) {
+      const T value = alpha * _data[i * _stride];
+      out[i * stride] = accumulate ? out[i * stride] + value : value;
+    }
+  }
+};
+
+/**
+ * @brief Maps an operand type to the type stored inside expression nodes
+ *
+ * Matrices and vectors are held through leaves, nodes are held by value.
+ */
+template <typename E> struct ExpressionStorage {
+  typedef E type;
+};
+
+template <typename T> struct ExpressionStorage<Matrix<T>> {
+  typedef ConstMatrixView<T> type;
+};
+
+template <typename T> struct ExpressionStorage<Vector<T>> {
+  typedef ConstVectorView<T> type;
+};
+
+template <typename L, typename R, typename Op> class MatrixBinary;
+template <typename E> class MatrixScaled;
+template <typename E> class MatrixTransposed;
+template <typename L, typename R> class MatrixProduct;
+
+template <typename E> struct IsConstMatrixView : std::false_type {};
+template <typename T> struct IsConstMatrixView<ConstMatrixView<T>> : std::true_type {};
+
+template <typename E> struct IsMatrixProduct : std::false_type {};
+template <typename L, typename R>
+struct IsMatrixProduct<MatrixProduct<L, R>> : std::true_type {};
+
+namespace detail {
+
+template <typename E>
+Matrix<typename E::value_type> evaluate(const E &expression) {
+  typedef typename E::value_type T;
+  Matrix<T> result(expression.rows(), expression.columns(), Uninitialized);
+  expression.assignTo(result._elements.data(), result._columns, (T)1, false);
+  return result;
+}
+
+template <typename E>
+const typename E::value_type *endOf(const E &expression,
+                                    typename E::value_type *out,
+                                    std::size_t ld) {
+  return out + (expression.rows() - 1) * ld + expression.columns();
+}
+
+// Evaluates an expression into a temporary first; used when the destination
+// is read by the expression in a way a single pass cannot handle.
+template <typename E>
+void assignThroughTemporary(const E &expression, typename E::value_type *out,
+                            std::size_t ld, typename E::value_type alpha,
+                            bool accumulate) {
+  typedef typename E::value_type T;
+  Matrix<T> temporary = evaluate(expression);
+  ConstMatrixView<T>(temporary).assignTo(out, ld, alpha, accumulate);
+}
+
+// Single fused pass over an element-wise expression.
+template <typename E>
+void assignElementwise(const E &expression, typename E::value_type *out,
+                       std::size_t ld, typename E::value_type alpha,
+                       bool accumulate) {
+  typedef typename E::value_type T;
+  const std::size_t rows = expression.rows();
+  const std::size_t columns = expression.columns();
+  if constexpr (E::linear) {
+    if (ld == columns && expression.contiguous()) {
+      const std::size_t size = rows * columns;
+      if (accumulate) {
+        for (std::size_t i = 0; i < size; i++) {
+          out[i] += alpha * expression.atLinear(i);
+        }
+      } else if (alpha == (T)1) {
+        for (std::size_t i = 0; i < size; i++) {
+          out[i] = expression.atLinear(i);
+        }
+      } else {
+        for (std::size_t i = 0; i < size; i++) {
+          out[i] = alpha * expression.atLinear(i);
+        }
+      }
+      return;
+    }
+  }
+  for (std::size_t i = 0; i < rows; i++) {
+    T *row = out + i * ld;
+    for (std::size_t j = 0; j < columns; j++) {
+      const T value = alpha * expression.at(i, j);
+      row[j] = accumulate ? row[j] + value : value;
+    }
+  }
+}
+
+/**
+ * @brief A matrix operand ready to be handed to gemm/gemv
+ *
+ * Scalars and transposes are folded into the operand; any other expression
+ * is evaluated into the owned storage.
+ */
+template <typename T> struct GemmOperand {
+  const T *data;
+  std::size_t ld;
+  bool trans;
+  T scale;
+  Matrix<T> storage;
+};
+
+template <typename T>
+GemmOperand<T> materialize(Matrix<T> &&storage) {
+  GemmOperand<T> operand;
+  operand.storage = std::move(storage);
+  operand.data = operand.storage._elements.data();
+  operand.ld = operand.storage._columns;
+  operand.trans = false;
+  operand.scale = (T)1;
+  return operand;
+}
+
+template <typename E>
+GemmOperand<typename E::value_type>
+gemmOperand(const E &expression, const typename E::value_type *begin,
+            const typename E::value_type *end) {
+  return materialize(evaluate(expression));
+}
+
+template <typename T>
+GemmOperand<T> gemmOperand(const ConstMatrixView<T> &leaf, const T *begin,
+                           const T *end) {
+  if (leaf.overlaps(begin, end)) {
+    return materialize(evaluate(leaf));
+  }
+  GemmOperand<T> operand;
+  operand.data = leaf._data;
+  operand.ld = leaf._ld;
+  operand.trans = false;
+  operand.scale = (T)1;
+  return operand;
+}
+
+template <typename E>
+GemmOperand<typename E::value_type>
+gemmOperand(const MatrixScaled<E> &scaled, const typename E::value_type *begin,
+            const typename E::value_type *end) {
+  GemmOperand<typename E::value_type> operand =
+      gemmOperand(scaled._inner, begin, end);
+  operand.scale *= scaled._scalar;
+  return operand;
+}
+
+template <typename E>
+GemmOperand<typename E::value_type>
+gemmOperand(const MatrixTransposed<E> &transposed,
+            const typename E::value_type *begin,
+            const typename E::value_type *end) {
+  GemmOperand<typename E::value_type> operand =
+      gemmOperand(transposed._inner, begin, end);
+  operand.trans = !operand.trans;
+  return operand;
+}
+
+} // namespace detail
+
+/**
+ * @brief Lazy element-wise sum or difference of two matrix expressions
+ */
+template <typename L, typename R, typename Op>
+class MatrixBinary : public MatrixExpression<MatrixBinary<L, R, Op>> {
+public:
+  typedef typename L::value_type value_type;
+  typedef value_type T;
+  static constexpr bool elementwise = L::elementwise && R::elementwise;
+  static constexpr bool linear = L::linear && R::linear;
+
+  L _left;
+  R _right;
+
+public:
+  MatrixBinary(const L &left, const R &right) : _left(left), _right(right) {
+    if (left.rows() != right.rows() || left.columns() != right.columns()) {
+      throw std::runtime_error(std::string("Invalid matrices dimensions for ") +
+                               Op::name() + " operation");
+    }
+  }
+
+  std::size_t rows() const { return _left.rows(); }
+  std::size_t columns() const { return _left.columns(); }
+  T at(std::size_t i, std::size_t j) const {
+    return Op::apply(_left.at(i, j), _right.at(i, j));
+  }
+  T atLinear(std::size_t index) const {
+    return Op::apply(_left.atLinear(index), _right.atLinear(index));
+  }
+  T operator()(std::size_t i, std::size_t j) const { return at(i, j); }
+  bool contiguous() const { return _left.contiguous() && _right.contiguous(); }
+
+  bool overlaps(const T *begin, const T *end) const {
+    return _left.overlaps(begin, end) || _right.overlaps(begin, end);
+  }
+
+  bool conflicts(const T *out, std::size_t ld, const T *end) const {
+    return _left.conflicts(out, ld, end) || _right.conflicts(out, ld, end);
+  }
+
+  bool isStorage(const T *, std::size_t) const { return false; }
+
+  void assignTo(T *out, std::size_t ld, T alpha, bool accumulate) const {
+    const T *end = detail::endOf(*this, out, ld);
+    if constexpr (elementwise) {
+      if (conflicts(out, ld, end)) {
+        detail::assignThroughTemporary(*this, out, ld, alpha, accumulate);
+        return;
+      }
+      if constexpr (IsConstMatrixView<L>::value && IsConstMatrixView<R>::value) {
+        if (!accumulate && alpha == (T)1 && ld == columns() && contiguous()) {
+          if (Op::sign > 0) {
+            simd::add<T>(rows() * columns(), _left._data, _right._data, out);
+          } else {
+            simd::sub<T>(rows() * columns(), _left._data, _right._data, out);
+          }
+          return;
+        }
+      }
+      detail::assignElementwise(*this, out, ld, alpha, accumulate);
+    } else {
+      // Products cannot be fused into the element-wise pass, so each side
+      // is accumulated into the destination in turn.
+      if (!accumulate && alpha == (T)1 && _left.isStorage(out, ld)) {
+        _right.assignTo(out, ld, (T)Op::sign, true);
+        return;
+      }
+      if (_right.overlaps(out, end)) {
+        detail::assignThroughTemporary(*this, out, ld, alpha, accumulate);
+        return;
+      }
+      _left.assignTo(out, ld, alpha, accumulate);
+      _right.assignTo(out, ld, (T)Op::sign * alpha, true);
+    }
+  }
+};
+
+/**
+ * @brief Lazy product of a matrix expression by a scalar
+ */
+template <typename E>
+class MatrixScaled : public MatrixExpression<MatrixScaled<E>> {
+public:
+  typedef typename E::value_type value_type;
+  typedef value_type T;
+  static constexpr bool elementwise = E::elementwise;
+  static constexpr bool linear = E::linear;
+
+  E _inner;
+  T _scalar;
+
+public:
+  MatrixScaled(const E &inner, T scalar) : _inner(inner), _scalar(scalar) {}
+
+  std::size_t rows() const { return _inner.rows(); }
+  std::size_t columns() const { return _inner.columns(); }
+  T at(std::size_t i, std::size_t j) const { return _inner.at(i, j) * _scalar; }
+  T atLinear(std::size_t index) const {
+    return _inner.atLinear(index) * _scalar;
+  }
+  T operator()(std::size_t i, std::size_t j) const { return at(i, j); }
+  bool contiguous() const { return _inner.contiguous(); }
+
+  bool overlaps(const T *begin, const T *end) const {
+    return _inner.overlaps(begin, end);
+  }
+
+  bool conflicts(const T *out, std::size_t ld, const T *end) const {
+    return _inner.conflicts(out, ld, end);
+  }
+
+  bool isStorage(const T *, std::size_t) const { return false; }
+
+  void assignTo(T *out, std::size_t ld, T alpha, bool accumulate) const {
+    _inner.assignTo(out, ld, alpha * _scalar, accumulate);
+  }
+};
+
+/**
+ * @brief Lazy transpose of a matrix expression
+ *
+ * Products consume the transpose as a flag without moving any data.
+ */
+template <typename E>
+class MatrixTransposed : public MatrixExpression<MatrixTransposed<E>> {
+public:
+  typedef typename E::value_type value_type;
+  typedef value_type T;
+  static constexpr bool elementwise = E::elementwise;
+  static constexpr bool linear = false;
+
+  E _inner;
+
+public:
+  explicit MatrixTransposed(const E &inner) : _inner(inner) {}
+
+  std::size_t rows() const { return _inner.columns(); }
+  std::size_t columns() const { return _inner.rows(); }
+  T at(std::size_t i, std::size_t j) const { return _inner.at(j, i); }
+  T operator()(std::size_t i, std::size_t j) const { return at(i, j); }
+  bool contiguous() const { return false; }
+
+  bool overlaps(const T *begin, const T *end) const {
+    return _inner.overlaps(begin, end);
+  }
+
+  bool conflicts(const T *out, std::size_t, const T *end) const {
+    return _inner.overlaps(out, end);
+  }
+
+  bool isStorage(const T *, std::size_t) const { return false; }
+
+  void assignTo(T *out, std::size_t ld, T alpha, bool accumulate) const {
+    if (_inner.overlaps(out, detail::endOf(*this, out, ld))) {
+      detail::assignThroughTemporary(*this, out, ld, alpha, accumulate);
+      return;
+    }
+    if constexpr (IsConstMatrixView<E>::value) {
+      if (!accumulate && alpha == (T)1) {
+        MWP::transpose<T>(_inner._rows, _inner._columns, _inner._data,
+                          _inner._ld, out, ld);
+        return;
+      }
+    }
+    if constexpr (elementwise) {
+      // Tiles keep both the reads and the writes inside a few cache lines.
+      constexpr std::size_t tile = 32;
+      const std::size_t rows = this->rows();
+      const std::size_t columns = this->columns();
+      for (std::size_t ib = 0; ib < rows; ib += tile) {
+        const std::size_t iEnd = std::min(rows, ib + tile);
+        for (std::size_t jb = 0; jb < columns; jb += tile) {
+          const std::size_t jEnd = std::min(columns, jb + tile);
+          for (std::size_t i = ib; i < iEnd; i++) {
+            T *row = out + i * ld;
+            for (std::size_t j = jb; j < jEnd; j++) {
+              const T value = alpha * _inner.at(j, i);
+              row[j] = accumulate ? row[j] + value : value;
+            }
+          }
+        }
+      }
+    } else {
+      Matrix<T> inner = detail::evaluate(_inner);
+      MatrixTransposed<ConstMatrixView<T>>(ConstMatrixView<T>(inner))
+          .assignTo(out, ld, alpha, accumulate);
+    }
+  }
+};
+
+/**
+ * @brief Lazy product of two matrix expressions
+ *
+ * On assignment the product is computed with a rank-1 update when the inner
+ * dimension is one, with GEMV when either side is a vector and with GEMM
+ * otherwise. Chains A * (B * C) are reassociated when (A * B) * C needs fewer
+ * multiply-adds.
+ */
+template <typename L, typename R>
+class MatrixProduct : public MatrixExpression<MatrixProduct<L, R>> {
+public:
+  typedef typename L::value_type value_type;
+  typedef value_type T;
+  static constexpr bool elementwise = false;
+  static constexpr bool linear = false;
+
+  L _left;
+  R _right;
+
+public:
+  MatrixProduct(const L &left, const R &right) : _left(left), _right(right) {
+    if (left.columns() != right.rows()) {
+      throw std::runtime_error(
+          "Invalid matrices dimensions for multiplication operation");
+    }
+  }
+
+  std::size_t rows() const { return _left.rows(); }
+  std::size_t columns() const { return _right.columns(); }
+
+  T at(std::size_t i, std::size_t j) const {
+    T sum = (T)0;
+    for (std::size_t p = 0; p < _left.columns(); p++) {
+      sum += _left.at(i, p) * _right.at(p, j);
+    }
+    return sum;
+  }
+
+  T operator()(std::size_t i, std::size_t j) const { return at(i, j); }
+  bool contiguous() const { return false; }
+
+  bool overlaps(const T *begin, const T *end) const {
+    return _left.overlaps(begin, end) || _right.overlaps(begin, end);
+  }
+
+  bool conflicts(const T *out, std::size_t, const T *end) const {
+    return overlaps(out, end);
+  }
+
+  bool isStorage(const T *, std::size_t) const { return false; }
+
+  void assignTo(T *out, std::size_t ld, T alpha, bool accumulate) const {
+    const std::size_t m = rows();
+    const std::size_t n = columns();
+    const std::size_t k = _left.columns();
+
+    if constexpr (IsMatrixProduct<R>::value) {
+      const std::size_t q = _right._left.columns();
+      if (m * k * q + m * q * n < k * q * n + m * k * n) {
+        Matrix<T> leftProduct =
+            detail::evaluate(MatrixProduct<L, decltype(_right._left)>(
+                _left, _right._left));
+        MatrixProduct<ConstMatrixView<T>, decltype(_right._right)>(
+            ConstMatrixView<T>(leftProduct), _right._right)
+            .assignTo(out, ld, alpha, accumulate);
+        return;
+      }
+    }
+
+    const T *end = detail::endOf(*this, out, ld);
+    const detail::GemmOperand<T> a = detail::gemmOperand(_left, out, end);
+    const detail::GemmOperand<T> b = detail::gemmOperand(_right, out, end);
+    const T scale = alpha * a.scale * b.scale;
+    const T beta = accumulate ? (T)1 : (T)0;
+
+    if (k == 1 && (!b.trans || b.ld == 1)) {
+      // Rank-1 update: every row of the result is a multiple of op(B).
+      for (std::size_t i = 0; i < m; i++) {
+        const T u = a.trans ? a.data[i] : a.data[i * a.ld];
+        if (accumulate) {
+          simd::axpy<T>(n, scale * u, b.data, out + i * ld);
+        } else {
+          simd::scale<T>(n, scale * u, b.data, out + i * ld);
+        }
+      }
+      return;
+    }
+    if (n == 1 && (m == 1 || ld == 1) && (b.trans || b.ld == 1)) {
+      gemv<T>(a.trans, a.trans ? k : m, a.trans ? m : k, scale, a.data, a.ld,
+              b.data, beta, out);
+      return;
+    }
+    if (m == 1 && (!a.trans || a.ld == 1)) {
+      gemv<T>(!b.trans, b.trans ? n : k, b.trans ? k : n, scale, b.data, b.ld,
+              a.data, beta, out);
+      return;
+    }
+    gemm<T>(a.trans, b.trans, m, n, k, scale, a.data, a.ld, b.data, b.ld, beta,
+            out, ld);
+  }
+};
+
+/**
+ * @brief Lazy element-wise sum or difference of two vector expressions
+ */
+template <typename L, typename R, typename Op>
+class VectorBinary : public VectorExpression<VectorBinary<L, R, Op>> {
+public:
+  typedef typename L::value_type value_type;
+  typedef value_type T;
+
+  L _left;
+  R _right;
+
+public:
+  VectorBinary(const L &left, const R &right) : _left(left), _right(right) {
+    if (left.rows() != right.rows() || left.columns() != right.columns()) {
+      throw std::runtime_error(std::string("Invalid vectors dimensions for ") +
+                               Op::name() + " operation");
+    }
+  }
+
+  std::size_t rows() const { return _left.rows(); }
+  std::size_t columns() const { return _left.columns(); }
+  std::size_t size() const { return _left.size(); }
+  T at(std::size_t index) const {
+    return Op::apply(_left.at(index), _right.at(index));
+  }
+  T operator[](std::size_t index) const {
+    if (index >= size()) {
+      throw std::runtime_error("Index out of bounds");
+    }
+    return at(index);
+  }
+
+  bool conflicts(const T *out, std::size_t stride, std::size_t size) const {
+    return _left.conflicts(out, stride, size) ||
+           _right.conflicts(out, stride, size);
+  }
+
+  bool isStorage(const T *, std::size_t) const { return false; }
+
+  void assignTo(T *out, std::size_t stride, T alpha, bool accumulate) const {
+    const std::size_t size = this->size();
+    if (conflicts(out, stride, size)) {
+      Vector<T> temporary(*this);
+      ConstVectorView<T>(temporary).assignTo(out, stride, alpha, accumulate);
+      return;
+    }
+    if (!accumulate && alpha == (T)1 && _left.isStorage(out, stride)) {
+      _right.assignTo(out, stride, (T)Op::sign, true);
+      return;
+    }
+    if constexpr (std::is_same<L, ConstVectorView<T>>::value &&
+                  std::is_same<R, ConstVectorView<T>>::value) {
+      if (!accumulate && alpha == (T)1 && stride == 1 &&
+          _left._stride == 1 && _right._stride == 1) {
+        if (Op::sign > 0) {
+          simd::add<T>(size, _left._data, _right._data, out);
+        } else {
+          simd::sub<T>(size, _left._data, _right._data, out);
+        }
+        return;
+      }
+    }
+    for (std::size_t i = 0; i < size; i++) {
+      const T value = alpha * at(i);
+      out[i * stride] = accumulate ? out[i * stride] + value : value;
+    }
+  }
+};
+
+/**
+ * @brief Lazy product of a vector expression by a scalar
+ */
+template <typename E>
+class VectorScaled : public VectorExpression<VectorScaled<E>> {
+public:
+  typedef typename E::value_type value_type;
+  typedef value_type T;
+
+  E _inner;
+  T _scalar;
+
+public:
+  VectorScaled(const E &inner, T scalar) : _inner(inner), _scalar(scalar) {}
+
+  std::size_t rows() const { return _inner.rows(); }
+  std::size_t columns() const { return _inner.columns(); }
+  std::size_t size() const { return _inner.size(); }
+  T at(std::size_t index) const { return _inner.at(index) * _scalar; }
+  T operator[](std::size_t index) const {
+    if (index >= size()) {
+      throw std::runtime_error("Index out of bounds");
+    }
+    return at(index);
+  }
+
+  bool conflicts(const T *out, std::size_t stride, std::size_t size) const {
+    return _inner.conflicts(out, stride, size);
+  }
+
+  bool isStorage(const T *, std::size_t) const { return false; }
+
+  void assignTo(T *out, std::size_t stride, T alpha, bool accumulate) const {
+    _inner.assignTo(out, stride, alpha * _scalar, accumulate);
+  }
+};
+
+template <typename L, typename R>
+MatrixBinary<typename ExpressionStorage<L>::type,
+             typename ExpressionStorage<R>::type, AddOperation>
+operator+(const MatrixExpression<L> &left, const MatrixExpression<R> &right) {
+  return {left.derived(), right.derived()};
+}
+
+template <typename L, typename R>
+MatrixBinary<typename ExpressionStorage<L>::type,
+             typename ExpressionStorage<R>::type, SubtractOperation>
+operator-(const MatrixExpression<L> &left, const MatrixExpression<R> &right) {
+  return {left.derived(), right.derived()};
+}
+
+template <typename E>
+MatrixScaled<typename ExpressionStorage<E>::type>
+operator*(const MatrixExpression<E> &expression,
+          typename E::value_type scalar) {
+  return {expression.derived(), scalar};
+}
+
+template <typename E>
+MatrixScaled<typename ExpressionStorage<E>::type>
+operator*(typename E::value_type scalar,
+          const MatrixExpression<E> &expression) {
+  return {expression.derived(), scalar};
+}
+
+template <typename L, typename R>
+MatrixProduct<typename ExpressionStorage<L>::type,
+              typename ExpressionStorage<R>::type>
+operator*(const MatrixExpression<L> &left, const MatrixExpression<R> &right) {
+  return {left.derived(), right.derived()};
+}
+
+/**
+ * @brief Lazy transpose of any matrix expression
+ *
+ * @tparam E The expression type.
+ * @param expression The expression to transpose.
+ * @return A transpose node referencing the expression.
+ */
+template <typename E>
+MatrixTransposed<typename ExpressionStorage<E>::type>
+transposed(const MatrixExpression<E> &expression) {
+  return MatrixTransposed<typename ExpressionStorage<E>::type>(
+      expression.derived());
+}
+
+template <typename L, typename R>
+VectorBinary<typename ExpressionStorage<L>::type,
+             typename ExpressionStorage<R>::type, AddOperation>
+operator+(const VectorExpression<L> &left, const VectorExpression<R> &right) {
+  return {left.derived(), right.derived()};
+}
+
+template <typename L, typename R>
+VectorBinary<typename ExpressionStorage<L>::type,
+             typename ExpressionStorage<R>::type, SubtractOperation>
+operator-(const VectorExpression<L> &left, const VectorExpression<R> &right) {
+  return {left.derived(), right.derived()};
+}
+
+template <typename E>
+VectorScaled<typename ExpressionStorage<E>::type>
+operator*(const VectorExpression<E> &expression,
+          typename E::value_type scalar) {
+  return {expression.derived(), scalar};
+}
+
+template <typename E>
+VectorScaled<typename ExpressionStorage<E>::type>
+operator*(typename E::value_type scalar,
+          const VectorExpression<E> &expression) {
+  return {expression.derived(), scalar};
+}
+
+} // namespace MWP
@@ -0,0 +1,377 @@
+#pragma once
+
+#include "Matrix.hpp"
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace MWP {
+
+namespace detail {
+
+template <typename F, std::size_t... I>
+constexpr void unrollImpl(F &&f, std::index_sequence<I...>) {
+  (f(std::integral_constant<std::size_t, I>{}), ...);
+}
+
+/**
+ * @brief Calls f(0) ... f(N - 1) as straight-line code
+ *
+ * The index is passed as a std::integral_constant, so loops over fixed
+ * dimensions are unrolled regardless of the optimizer's heuristics.
+ */
+template <std::size_t N, typename F> constexpr void unroll(F &&f) {
+  unrollImpl(f, std::make_index_sequence<N>{});
+}
+
+/**
+ * @brief Closed-form determinant of a row-major N x N block, N <= 4
+ */
+template <std::size_t N, typename T> constexpr T smallDeterminant(const T *a) {
+  static_assert(N >= 1 && N <= 4, "Closed forms are limited to 4x4 blocks");
+  if constexpr (N == 1) {
+    return a[0];
+  } else if constexpr (N == 2) {
+    return a[0] * a[3] - a[1] * a[2];
+  } else if constexpr (N == 3) {
+    return a[0] * (a[4] * a[8] - a[5] * a[7]) -
+           a[1] * (a[3] * a[8] - a[5] * a[6]) +
+           a[2] * (a[3] * a[7] - a[4] * a[6]);
+  } else {
+    // 2x2 minors of the top two rows (s) and of the bottom two rows (c).
+    const T s0 = a[0] * a[5] - a[4] * a[1];
+    const T s1 = a[0] * a[6] - a[4] * a[2];
+    const T s2 = a[0] * a[7] - a[4] * a[3];
+    const T s3 = a[1] * a[6] - a[5] * a[2];
+    const T s4 = a[1] * a[7] - a[5] * a[3];
+    const T s5 = a[2] * a[7] - a[6] * a[3];
+    const T c5 = a[10] * a[15] - a[14] * a[11];
+    const T c4 = a[9] * a[15] - a[13] * a[11];
+    const T c3 = a[9] * a[14] - a[13] * a[10];
+    const T c2 = a[8] * a[15] - a[12] * a[11];
+    const T c1 = a[8] * a[14] - a[12] * a[10];
+    const T c0 = a[8] * a[13] - a[12] * a[9];
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  }
+}
+
+/**
+ * @brief Closed-form inverse of a row-major N x N block, N <= 4
+ *
+ * Computed through the adjugate. Returns false, leaving out untouched, if
+ * the block is singular.
+ */
+template <std::size_t N, typename T>
+constexpr bool smallInverse(const T *a, T *out) {
+  static_assert(N >= 1 && N <= 4, "Closed forms are limited to 4x4 blocks");
+  if constexpr (N == 1) {
+    if (a[0] == (T)0) {
+      return false;
+    }
+    out[0] = (T)1 / a[0];
+  } else if constexpr (N == 2) {
+    const T det = a[0] * a[3] - a[1] * a[2];
+    if (det == (T)0) {
+      return false;
+    }
+    out[0] = a[3] / det;
+    out[1] = -a[1] / det;
+    out[2] = -a[2] / det;
+    out[3] = a[0] / det;
+  } else if constexpr (N == 3) {
+    const T c00 = a[4] * a[8] - a[5] * a[7];
+    const T c01 = a[5] * a[6] - a[3] * a[8];
+    const T c02 = a[3] * a[7] - a[4] * a[6];
+    const T det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+    if (det == (T)0) {
+      return false;
+    }
+    const T b1 = a[2] * a[7] - a[1] * a[8];
+    const T b2 = a[1] * a[5] - a[2] * a[4];
+    const T b4 = a[0] * a[8] - a[2] * a[6];
+    const T b5 = a[2] * a[3] - a[0] * a[5];
+    const T b7 = a[1] * a[6] - a[0] * a[7];
+    const T b8 = a[0] * a[4] - a[1] * a[3];
+    out[0] = c00 / det;
+    out[1] = b1 / det;
+    out[2] = b2 / det;
+    out[3] = c01 / det;
+    out[4] = b4 / det;
+    out[5] = b5 / det;
+    out[6] = c02 / det;
+    out[7] = b7 / det;
+    out[8] = b8 / det;
+  } else {
+    const T s0 = a[0] * a[5] - a[4] * a[1];
+    const T s1 = a[0] * a[6] - a[4] * a[2];
+    const T s2 = a[0] * a[7] - a[4] * a[3];
+    const T s3 = a[1] * a[6] - a[5] * a[2];
+    const T s4 = a[1] * a[7] - a[5] * a[3];
+    const T s5 = a[2] * a[7] - a[6] * a[3];
+    const T c5 = a[10] * a[15] - a[14] * a[11];
+    const T c4 = a[9] * a[15] - a[13] * a[11];
+    const T c3 = a[9] * a[14] - a[13] * a[10];
+    const T c2 = a[8] * a[15] - a[12] * a[11];
+    const T c1 = a[8] * a[14] - a[12] * a[10];
+    const T c0 = a[8] * a[13] - a[12] * a[9];
+    const T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (det == (T)0) {
+      return false;
+    }
+    const T b[16] = {a[5] * c5 - a[6] * c4 + a[7] * c3,
+                     -a[1] * c5 + a[2] * c4 - a[3] * c3,
+                     a[13] * s5 - a[14] * s4 + a[15] * s3,
+                     -a[9] * s5 + a[10] * s4 - a[11] * s3,
+                     -a[4] * c5 + a[6] * c2 - a[7] * c1,
+                     a[0] * c5 - a[2] * c2 + a[3] * c1,
+                     -a[12] * s5 + a[14] * s2 - a[15] * s1,
+                     a[8] * s5 - a[10] * s2 + a[11] * s1,
+                     a[4] * c4 - a[5] * c2 + a[7] * c0,
+                     -a[0] * c4 + a[1] * c2 - a[3] * c0,
+                     a[12] * s4 - a[13] * s2 + a[15] * s0,
+                     -a[8] * s4 + a[9] * s2 - a[11] * s0,
+                     -a[4] * c3 + a[5] * c1 - a[6] * c0,
+                     a[0] * c3 - a[1] * c1 + a[2] * c0,
+                     -a[12] * s3 + a[13] * s1 - a[14] * s0,
+                     a[8] * s3 - a[9] * s1 + a[10] * s0};
+    for (std::size_t i = 0; i < 16; i++) {
+      out[i] = b[i] / det;
+    }
+  }
+  return true;
+}
+
+} // namespace detail
+
+/**
+ * @brief Matrix whose dimensions are template parameters
+ *
+ * The elements live in a std::array, so a FixedMatrix never allocates and
+ * can be built and computed on at compile time. Dimension mismatches in
+ * arithmetic are compile errors, and every kernel is unrolled into
+ * straight-line code that the compiler can vectorize. Use it for the small
+ * transforms that Matrix<T> would heap-allocate; it converts to and from
+ * Matrix<T> for everything else.
+ *
+ * @tparam T The type of the matrix elements.
+ * @tparam R The number of rows.
+ * @tparam C The number of columns.
+ */
+template <typename T, std::size_t R, std::size_t C> class FixedMatrix {
+  static_assert(R > 0 && C > 0, "FixedMatrix dimensions must be positive");
+
+public:
+  std::array<T, R * C> _elements{};
+
+public:
+  /**
+   * @brief Constructor for a matrix with all elements set to zero
+   */
+  constexpr FixedMatrix() = default;
+
+  /**
+   * @brief Constructor from the elements in row-major order
+   *
+   * @param values Exactly R * C elements.
+   */
+  template <typename... Values,
+            typename = std::enable_if_t<sizeof...(Values) == R * C &&
+                                        (sizeof...(Values) > 1 || R * C == 1)>>
+  constexpr FixedMatrix(Values... values) : _elements{{(T)values...}} {}
+
+  /**
+   * @brief Constructor from a dynamic matrix of the same dimensions
+   *
+   * @param matrix The matrix to copy.
+   * @throws std::runtime_error If the dimensions differ.
+   */
+  explicit FixedMatrix(const Matrix<T> &matrix) {
+    if (matrix._rows != R || matrix._columns != C) {
+      throw std::runtime_error("Invalid matrix dimensions for conversion");
+    }
+    std::copy(matrix._elements.begin(), matrix._elements.end(),
+              _elements.begin());
+  }
+
+  /**
+   * @brief Converts to a dynamic matrix
+   *
+   * @return Matrix<T> A heap-allocated copy.
+   */
+  explicit operator Matrix<T>() const {
+    return Matrix<T>(AlignedVector<T>(_elements.begin(), _elements.end()),
+                     (Index)R, (Index)C);
+  }
+
+public:
+  /**
+   * @brief The identity matrix
+   */
+  static constexpr FixedMatrix identity() {
+    static_assert(R == C, "The identity matrix is square");
+    FixedMatrix result;
+    detail::unroll<R>([&](auto i) { result._elements[i * C + i] = (T)1; });
+    return result;
+  }
+
+  static constexpr std::size_t rows() { return R; }
+  static constexpr std::size_t columns() { return C; }
+
+  /**
+   * @brief Element access without bounds checking
+   *
+   * @param row The row index.
+   * @param column The column index.
+   */
+  constexpr T &operator()(std::size_t row, std::size_t column) {
+    return _elements[row * C + column];
+  }
+  constexpr const T &operator()(std::size_t row, std::size_t column) const {
+    return _elements[row * C + column];
+  }
+
+  constexpr T &operator[](std::size_t index) { return _elements[index]; }
+  constexpr const T &operator[](std::size_t index) const {
+    return _elements[index];
+  }
+
+  constexpr FixedMatrix operator+(const FixedMatrix &other) const {
+    FixedMatrix result;
+    detail::unroll<R * C>([&](auto i) {
+      result._elements[i] = _elements[i] + other._elements[i];
+    });
+    return result;
+  }
+
+  constexpr FixedMatrix operator-(const FixedMatrix &other) const {
+    FixedMatrix result;
+    detail::unroll<R * C>([&](auto i) {
+      result._elements[i] = _elements[i] - other._elements[i];
+    });
+    return result;
+  }
+
+  constexpr FixedMatrix operator*(T scalar) const {
+    FixedMatrix result;
+    detail::unroll<R * C>(
+        [&](auto i) { result._elements[i] = _elements[i] * scalar; });
+    return result;
+  }
+
+  constexpr FixedMatrix &operator+=(const FixedMatrix &other) {
+    detail::unroll<R * C>([&](auto i) { _elements[i] += other._elements[i]; });
+    return *this;
+  }
+
+  constexpr FixedMatrix &operator-=(const FixedMatrix &other) {
+    detail::unroll<R * C>([&](auto i) { _elements[i] -= other._elements[i]; });
+    return *this;
+  }
+
+  constexpr FixedMatrix &operator*=(T scalar) {
+    detail::unroll<R * C>([&](auto i) { _elements[i] *= scalar; });
+    return *this;
+  }
+
+  /**
+   * @brief Matrix product; the inner dimensions are checked at compile time
+   */
+  template <std::size_t K>
+  constexpr FixedMatrix<T, R, K>
+  operator*(const FixedMatrix<T, C, K> &other) const {
+    FixedMatrix<T, R, K> result;
+    // Row i of the result accumulates row p of other scaled by A(i, p), the
+    // same order as the dynamic GEMM, so each step is a SIMD-friendly axpy.
+    detail::unroll<R>([&](auto i) {
+      detail::unroll<C>([&](auto p) {
+        const T scale = _elements[i * C + p];
+        detail::unroll<K>([&](auto j) {
+          result._elements[i * K + j] += scale * other._elements[p * K + j];
+        });
+      });
+    });
+    return result;
+  }
+
+  constexpr bool operator==(const FixedMatrix &other) const {
+    for (std::size_t i = 0; i < R * C; i++) {
+      if (_elements[i] != other._elements[i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  constexpr bool operator!=(const FixedMatrix &other) const {
+    return !(*this == other);
+  }
+
+  constexpr FixedMatrix<T, C, R> transposed() const {
+    FixedMatrix<T, C, R> result;
+    detail::unroll<R>([&](auto i) {
+      detail::unroll<C>([&](auto j) {
+        result._elements[j * R + i] = _elements[i * C + j];
+      });
+    });
+    return result;
+  }
+
+  /**
+   * @brief Computes the determinant
+   *
+   * Closed form up to 4x4; larger matrices go through the dynamic pivoted
+   * LU and are not constexpr.
+   */
+  constexpr T det() const {
+    static_assert(R == C, "The matrix should be square to compute its "
+                          "determinant!");
+    if constexpr (R <= 4) {
+      return detail::smallDeterminant<R>(_elements.data());
+    } else {
+      return (T)static_cast<Matrix<T>>(*this).det();
+    }
+  }
+
+  /**
+   * @brief Computes the inverse
+   *
+   * Closed form up to 4x4; larger matrices go through the dynamic pivoted
+   * LU and are not constexpr.
+   *
+   * @throws std::runtime_error If the matrix is singular.
+   */
+  constexpr FixedMatrix inverse() const {
+    static_assert(R == C,
+                  "The matrix should be square to compute its inverse!");
+    static_assert(!std::is_integral<T>::value,
+                  "The inverse is only available for floating-point matrices");
+    if constexpr (R <= 4) {
+      FixedMatrix result;
+      if (!detail::smallInverse<R>(_elements.data(),
+                                   result._elements.data())) {
+        throw std::runtime_error("The matrix is singular");
+      }
+      return result;
+    } else {
+      return FixedMatrix(static_cast<Matrix<T>>(*this).inverse());
+    }
+  }
+};
+
+template <typename T, std::size_t R, std::size_t C>
+constexpr FixedMatrix<T, R, C> operator*(T scalar,
+                                         const FixedMatrix<T, R, C> &matrix) {
+  return matrix * scalar;
+}
+
+template <typename T, std::size_t N> using FixedVector = FixedMatrix<T, N, 1>;
+
+typedef FixedMatrix<double, 2, 2> Matrix2D;
+typedef FixedMatrix<double, 3, 3> Matrix3D;
+typedef FixedMatrix<double, 4, 4> Matrix4D;
+typedef FixedVector<double, 2> Vector2D;
+typedef FixedVector<double, 3> Vector3D;
+typedef FixedVector<double, 4> Vector4D;
+} // namespace MWP
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <cstddef>
+
+namespace MWP {
+
+/**
+ * @brief Cache blocking parameters of the GEMM engine
+ *
+ * The mr x nr register tile comes from simd::gemmMicroKernel and depends on
+ * the instruction set. KC x nr panels of B are sized to stay in L1, MC x KC
+ * blocks of A in L2 and KC x NC panels of B in L3; MC and NC are trimmed to
+ * whole micro-panels.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> struct GemmBlocking {
+  static constexpr std::size_t KC = 256;
+  static constexpr std::size_t MC = 128;
+  static constexpr std::size_t NC = 4096;
+};
+
+/**
+ * @brief Single precision fits, at the same byte footprint, twice as deep a
+ * KC panel
+ */
+template <> struct GemmBlocking<float> {
+  static constexpr std::size_t KC = 512;
+  static constexpr std::size_t MC = 128;
+  static constexpr std::size_t NC = 4096;
+};
+
+/**
+ * @brief Products with fewer multiply-adds than this use the naive loop
+ *
+ * Packing does not pay off for tiny shapes, so they skip the blocked engine.
+ */
+constexpr std::size_t GemmSmallThreshold = 64 * 64 * 64;
+
+/**
+ * @brief Products with at least this many multiply-adds use the thread pool
+ */
+constexpr std::size_t GemmParallelThreshold = 192 * 192 * 192;
+
+/**
+ * @brief Matrix-vector products with at least this many elements in the
+ * matrix use the thread pool
+ */
+constexpr std::size_t GemvParallelThreshold = 256 * 1024;
+
+/**
+ * @brief Operation applied to an operand of GEMM and GEMV
+ *
+ * ConjugateTranspose is the Hermitian adjoint X^H; for real element types it
+ * is the same as Transpose.
+ */
+enum class Operation { None, Transpose, ConjugateTranspose };
+
+/**
+ * @brief General matrix-matrix product on row-major storage
+ *
+ * Computes C = alpha * op(A) * op(B) + beta * C, where op(X) is X, its
+ * transpose or its conjugate transpose. op(A) is m x k, op(B) is k x n and C
+ * is m x n. Large shapes are computed with packed, cache-blocked panels and
+ * a register micro-kernel chosen for the instruction set; tiny shapes fall
+ * back to a naive loop. Conjugation is applied while packing, so it costs no
+ * extra pass.
+ *
+ * @tparam T The type of the matrix elements.
+ * @param opA The operation applied to A.
+ * @param opB The operation applied to B.
+ * @param m Number of rows of op(A) and C.
+ * @param n Number of columns of op(B) and C.
+ * @param k Number of columns of op(A) and rows of op(B).
+ * @param alpha Scalar applied to op(A) * op(B).
+ * @param A Pointer to the first element of A.
+ * @param lda Leading dimension (row stride) of A.
+ * @param B Pointer to the first element of B.
+ * @param ldb Leading dimension (row stride) of B.
+ * @param beta Scalar applied to C. When zero, C is not read.
+ * @param C Pointer to the first element of C.
+ * @param ldc Leading dimension (row stride) of C.
+ */
+template <typename T>
+void gemm(Operation opA, Operation opB, std::size_t m, std::size_t n,
+          std::size_t k, T alpha, const T *A, std::size_t lda, const T *B,
+          std::size_t ldb, T beta, T *C, std::size_t ldc);
+
+/**
+ * @brief General matrix-matrix product with plain transpose flags
+ *
+ * Same as gemm() with Operation::Transpose for each flag that is set.
+ */
+template <typename T>
+inline void gemm(bool transA, bool transB, std::size_t m, std::size_t n,
+                 std::size_t k, T alpha, const T *A, std::size_t lda,
+                 const T *B, std::size_t ldb, T beta, T *C, std::size_t ldc) {
+  gemm<T>(transA ? Operation::Transpose : Operation::None,
+          transB ? Operation::Transpose : Operation::None, m, n, k, alpha, A,
+          lda, B, ldb, beta, C, ldc);
+}
+
+/**
+ * @brief General matrix-vector product on row-major storage
+ *
+ * Computes y = alpha * op(A) * x + beta * y, where A is m x n and op(A) is A,
+ * its transpose or its conjugate transpose. Large products are split into
+ * row chunks across the thread pool.
+ *
+ * @tparam T The type of the matrix elements.
+ * @param opA The operation applied to A.
+ * @param m Number of rows of A.
+ * @param n Number of columns of A.
+ * @param alpha Scalar applied to op(A) * x.
+ * @param A Pointer to the first element of A.
+ * @param lda Leading dimension (row stride) of A.
+ * @param x Contiguous input vector.
+ * @param beta Scalar applied to y. When zero, y is not read.
+ * @param y Contiguous output vector.
+ */
+template <typename T>
+void gemv(Operation opA, std::size_t m, std::size_t n, T alpha, const T *A,
+          std::size_t lda, const T *x, T beta, T *y);
+
+/**
+ * @brief General matrix-vector product with a plain transpose flag
+ *
+ * Same as gemv() with Operation::Transpose when the flag is set.
+ */
+template <typename T>
+inline void gemv(bool transA, std::size_t m, std::size_t n, T alpha,
+                 const T *A, std::size_t lda, const T *x, T beta, T *y) {
+  gemv<T>(transA ? Operation::Transpose : Operation::None, m, n, alpha, A, lda,
+          x, beta, y);
+}
+
+} // namespace MWP
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "Matrix.hpp"
+#include "SparseMatrix.hpp"
+#include "Vector.hpp"
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace MWP {
+
+/**
+ * @brief A square linear map given by its action y = A * x
+ *
+ * Iterative solvers only need products with A, so dense matrices, sparse
+ * matrices and matrix-free callbacks are all wrapped into this one type. The
+ * operator refers to the wrapped matrix, which must outlive it.
+ *
+ * @tparam T The type of the vector elements.
+ */
+template <typename T> class LinearOperator {
+public:
+  std::size_t _size;
+  std::function<void(const T *, T *)> _apply;
+
+public:
+  /**
+   * @brief Wraps a callback computing y = A * x
+   *
+   * @param size The number of rows and columns of A.
+   * @param apply Callback reading x and overwriting y, both of size entries.
+   */
+  LinearOperator(std::size_t size, std::function<void(const T *, T *)> apply);
+
+  /**
+   * @brief Wraps a dense square matrix, applied with GEMV
+   *
+   * @throws std::runtime_error If the matrix is not square.
+   */
+  LinearOperator(const Matrix<T> &matrix);
+
+  /**
+   * @brief Wraps a sparse square matrix, applied with SpMV
+   *
+   * @throws std::runtime_error If the matrix is not square.
+   */
+  LinearOperator(const SparseMatrix<T> &matrix);
+
+public:
+  /**
+   * @brief Computes y = A * x
+   */
+  void apply(const T *x, T *y) const { _apply(x, y); }
+};
+
+/**
+ * @brief Krylov method used by KrylovSolver::solve
+ *
+ * CG needs a symmetric positive definite operator; BiCGSTAB and GMRES(m)
+ * handle general nonsymmetric ones.
+ */
+enum class IterativeMethod { CG, BiCGSTAB, GMRES };
+
+/**
+ * @brief Stopping criteria of the iterative solvers
+ *
+ * The iteration stops once ||b - A * x|| <= max(_tolerance * ||b||,
+ * _absoluteTolerance) or after _maxIterations iterations. GMRES restarts
+ * every _restart iterations.
+ */
+struct IterativeSettings {
+  double _tolerance = 1e-10;
+  double _absoluteTolerance = 0.0;
+  std::size_t _maxIterations = 1000;
+  std::size_t _restart = 30;
+};
+
+/**
+ * @brief Outcome of an iterative solve
+ *
+ * _residualHistory holds the residual norm before the first iteration and
+ * after each one; GMRES reports the norm estimated by its least-squares
+ * problem.
+ */
+struct IterativeResult {
+  bool _converged = false;
+  std::size_t _iterations = 0;
+  double _residualNorm = 0.0;
+  std::vector<double> _residualHistory;
+};
+
+/**
+ * @brief CG, BiCGSTAB and restarted GMRES solvers
+ *
+ * The solver keeps its work vectors between calls, so repeated solves of
+ * systems of the same size allocate nothing. Every method takes x as the
+ * initial guess and overwrites it with the solution.
+ *
+ * An optional preconditioner M ~ A^-1 is applied on the right for BiCGSTAB
+ * and GMRES, so the monitored residual is the true one; CG uses it as the
+ * symmetric preconditioner of PCG, which M must then be.
+ *
+ * @tparam T The type of the vector elements.
+ */
+template <typename T> class KrylovSolver {
+public:
+  std::vector<T> _r;
+  std::vector<T> _p;
+  std::vector<T> _q;
+  std::vector<T> _s;
+  std::vector<T> _t;
+  std::vector<T> _y;
+  std::vector<T> _z;
+  std::vector<T> _basis;
+  std::vector<T> _hessenberg;
+  std::vector<T> _cosines;
+  std::vector<T> _sines;
+  std::vector<T> _g;
+
+public:
+  /**
+   * @brief Conjugate gradients for symmetric positive definite operators
+   */
+  IterativeResult cg(const LinearOperator<T> &A, const T *b, T *x,
+                     const IterativeSettings &settings = IterativeSettings(),
+                     const LinearOperator<T> *preconditioner = nullptr);
+
+  /**
+   * @brief Stabilized biconjugate gradients for general operators
+   */
+  IterativeResult
+  bicgstab(const LinearOperator<T> &A, const T *b, T *x,
+           const IterativeSettings &settings = IterativeSettings(),
+           const LinearOperator<T> *preconditioner = nullptr);
+
+  /**
+   * @brief GMRES restarted every settings._restart iterations
+   *
+   * Orthogonalizes with modified Gram-Schmidt and updates the least-squares
+   * problem with Givens rotations, so the residual norm is known at every
+   * iteration without forming x.
+   */
+  IterativeResult gmres(const LinearOperator<T> &A, const T *b, T *x,
+                        const IterativeSettings &settings = IterativeSettings(),
+                        const LinearOperator<T> *preconditioner = nullptr);
+
+  /**
+   * @brief Runs the given method on raw arrays of size A._size
+   */
+  IterativeResult solve(IterativeMethod method, const LinearOperator<T> &A,
+                        const T *b, T *x,
+                        const IterativeSettings &settings = IterativeSettings(),
+                        const LinearOperator<T> *preconditioner = nullptr);
+
+  /**
+   * @brief Runs the given method on column vectors
+   *
+   * @param method The Krylov method.
+   * @param A The operator.
+   * @param b The right-hand side.
+   * @param x The initial guess, overwritten by the solution.
+   * @param settings The stopping criteria.
+   * @param preconditioner Optional approximation of A^-1.
+   * @return IterativeResult The convergence report.
+   * @throws std::runtime_error If the dimensions do not match.
+   */
+  IterativeResult solve(IterativeMethod method, const LinearOperator<T> &A,
+                        const Vector<T> &b, Vector<T> &x,
+                        const IterativeSettings &settings = IterativeSettings(),
+                        const LinearOperator<T> *preconditioner = nullptr);
+};
+
+typedef LinearOperator<double> LinearOperatorD;
+typedef LinearOperator<float> LinearOperatorF;
+typedef KrylovSolver<double> KrylovSolverD;
+typedef KrylovSolver<float> KrylovSolverF;
+} // namespace MWP
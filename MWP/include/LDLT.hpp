@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Matrix.hpp"
+#include "MatrixView.hpp"
+#include "Vector.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace MWP {
+
+/**
+ * @brief Factors a symmetric block in place as P * A * P^T = L * D * L^T
+ *
+ * Bunch-Kaufman diagonal pivoting: D is block diagonal with 1 x 1 and 2 x 2
+ * blocks, which keeps the factorization stable for indefinite matrices
+ * without giving up symmetry. Only the lower triangle of A is read and
+ * written; on return it holds D on its diagonal blocks and the multipliers of
+ * L (whose unit diagonal is implicit) below them.
+ *
+ * At step k, rows and columns k + blockSizes[k] - 1 and pivots[k] were
+ * interchanged before eliminating the block starting at k. blockSizes[k] is
+ * 1 or 2 at the first index of each block and 0 at the second index of a
+ * 2 x 2 block.
+ *
+ * @tparam T The type of the matrix elements, which must not be integral: the
+ * pivot divisions would truncate.
+ * @param A View of the square block to factor.
+ * @param pivots Receives the interchange chosen for each block.
+ * @param blockSizes Receives the size of each diagonal block of D.
+ * @return true The matrix is nonsingular.
+ * @return false D has a zero block; the factors are still complete.
+ * @throws std::runtime_error If the block is not square.
+ */
+template <typename T>
+bool ldltFactorInPlace(MatrixView<T> A, std::vector<std::size_t> &pivots,
+                       std::vector<std::size_t> &blockSizes);
+
+/**
+ * @brief Symmetric indefinite LDL^T factorization with Bunch-Kaufman pivoting
+ *
+ * The factors share one buffer with the factored matrix, so factoring
+ * allocates nothing beyond the matrix itself and does half the work of LU.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> class LDLT {
+public:
+  Matrix<T> _factors;
+  std::vector<std::size_t> _pivots;
+  std::vector<std::size_t> _blockSizes;
+  bool _nonsingular;
+
+public:
+  /**
+   * @brief Default constructor for an empty factorization
+   */
+  LDLT() : _nonsingular(false) {}
+
+  /**
+   * @brief Factors the given matrix
+   *
+   * The matrix is taken by value and factored in its own storage; pass it
+   * with std::move to avoid the copy.
+   *
+   * @param matrix The symmetric matrix to factor.
+   * @throws std::runtime_error If the matrix is not square.
+   */
+  explicit LDLT(Matrix<T> matrix);
+
+public:
+  /**
+   * @brief Check if D has no zero block
+   *
+   * @return true The factored matrix is nonsingular
+   * @return false The factored matrix is singular
+   */
+  bool isNonsingular() const;
+
+  /**
+   * @brief Solves A * x = b in place
+   *
+   * @param b Contiguous right-hand side of size n, overwritten by x.
+   */
+  void solveInPlace(T *b) const;
+
+  /**
+   * @brief Solves A * x = b
+   *
+   * @param constants The column vector b.
+   * @return Vector<T> The solution x.
+   * @throws std::runtime_error If the dimensions do not match or the matrix
+   * is singular.
+   */
+  Vector<T> solve(const Vector<T> &constants) const;
+
+  /**
+   * @brief Solves A * x = b into an existing vector
+   *
+   * The storage of variables is reused when it already has the size of b,
+   * so repeated solves do not allocate.
+   *
+   * @param constants The column vector b.
+   * @param variables Receives the solution x.
+   * @throws std::runtime_error If the dimensions do not match or the matrix
+   * is singular.
+   */
+  void solve(const Vector<T> &constants, Vector<T> &variables) const;
+
+  /**
+   * @brief Solves A * X = B for every column of B in place
+   *
+   * @param B View of the n x nrhs right-hand sides, overwritten by X.
+   * @throws std::runtime_error If B does not have n rows.
+   */
+  void solveInPlace(MatrixView<T> B) const;
+
+  /**
+   * @brief Solves A * X = B for every column of B
+   *
+   * @param constants The n x nrhs matrix B.
+   * @return Matrix<T> The solutions X.
+   * @throws std::runtime_error If the dimensions do not match or the matrix
+   * is singular.
+   */
+  Matrix<T> solve(const Matrix<T> &constants) const;
+};
+typedef LDLT<double> LDLTD;
+typedef LDLT<float> LDLTF;
+} // namespace MWP
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "Matrix.hpp"
+#include "MatrixView.hpp"
+#include "Vector.hpp"
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace MWP {
+
+/**
+ * @brief Number of columns factored per panel by the blocked LU
+ *
+ * The panel is factored with row operations; everything to its right is
+ * updated by a triangular solve and one GEMM per panel.
+ */
+constexpr std::size_t LUBlockSize = 64;
+
+/**
+ * @brief Factors a square block in place as P * A = L * U
+ *
+ * Right-looking blocked LU with partial row pivoting. On return the strictly
+ * lower part of A holds L (its unit diagonal is implicit) and the upper part
+ * holds U. Row i was swapped with row pivots[i] at step i, in order.
+ *
+ * @tparam T The type of the matrix elements.
+ * @param A View of the square block to factor.
+ * @param pivots Receives the pivot row chosen at each step.
+ * @return true The matrix is nonsingular.
+ * @return false A zero pivot was found; the factors are still complete.
+ * @throws std::runtime_error If the block is not square.
+ */
+template <typename T>
+bool luFactorInPlace(MatrixView<T> A, std::vector<std::size_t> &pivots);
+
+/**
+ * @brief LU factorization with partial pivoting, stored packed
+ *
+ * L and U share one buffer with the factored matrix and the row interchanges
+ * are kept as a pivot vector, so factoring allocates nothing beyond the
+ * matrix itself. Once factored, each solve costs O(n^2).
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> class LU {
+public:
+  Matrix<T> _factors;
+  std::vector<std::size_t> _pivots;
+  bool _nonsingular;
+
+public:
+  /**
+   * @brief Default constructor for an empty factorization
+   */
+  LU() : _nonsingular(false) {}
+
+  /**
+   * @brief Factors the given matrix
+   *
+   * The matrix is taken by value and factored in its own storage; pass it
+   * with std::move to avoid the copy.
+   *
+   * @param matrix The square matrix to factor.
+   * @throws std::runtime_error If the matrix is not square.
+   */
+  explicit LU(Matrix<T> matrix);
+
+public:
+  /**
+   * @brief Check if no zero pivot was found
+   *
+   * @return true The factored matrix is nonsingular
+   * @return false The factored matrix is singular
+   */
+  bool isNonsingular() const;
+
+  /**
+   * @brief Unpacks the unit lower triangular factor
+   *
+   * @return Matrix<T> The L matrix.
+   */
+  Matrix<T> lower() const;
+
+  /**
+   * @brief Unpacks the upper triangular factor
+   *
+   * @return Matrix<T> The U matrix.
+   */
+  Matrix<T> upper() const;
+
+  /**
+   * @brief Row permutation applied by the factorization
+   *
+   * Row i of P * A is row permutation()[i] of A.
+   *
+   * @return std::vector<std::size_t> The row permutation.
+   */
+  std::vector<std::size_t> permutation() const;
+
+  /**
+   * @brief Determinant of the factored matrix
+   *
+   * The product of the diagonal of U, negated once per row interchange. It
+   * overflows easily for large matrices; see logDeterminant().
+   *
+   * @return T The determinant.
+   */
+  T determinant() const;
+
+  /**
+   * @brief Logarithm of the absolute value of the determinant
+   *
+   * @param sign Receives the sign of the determinant: -1, 0 or 1. The phase
+   * of a complex determinant is not tracked: sign is then 0 or 1.
+   * @return double log|det(A)|, or -infinity if the matrix is singular.
+   */
+  double logDeterminant(int &sign) const;
+
+  /**
+   * @brief Inverse of the factored matrix
+   *
+   * U is inverted in place by blocks, then U^-1 * L^-1 is formed by blocks
+   * and the row interchanges are undone on the columns, so almost all of the
+   * work is done by GEMM and TRSM.
+   *
+   * @return Matrix<T> The inverse matrix.
+   * @throws std::runtime_error If the matrix is singular.
+   */
+  Matrix<T> inverse() const;
+
+  /**
+   * @brief Solves A * x = b in place
+   *
+   * @param b Contiguous right-hand side of size n, overwritten by x.
+   */
+  void solveInPlace(T *b) const;
+
+  /**
+   * @brief Solves A * x = b
+   *
+   * @param constants The column vector b.
+   * @return Vector<T> The solution x.
+   * @throws std::runtime_error If the dimensions do not match or the matrix
+   * is singular.
+   */
+  Vector<T> solve(const Vector<T> &constants) const;
+
+  /**
+   * @brief Solves A * x = b into an existing vector
+   *
+   * The storage of variables is reused when it already has the size of b,
+   * so repeated solves do not allocate.
+   *
+   * @param constants The column vector b.
+   * @param variables Receives the solution x.
+   * @throws std::runtime_error If the dimensions do not match or the matrix
+   * is singular.
+   */
+  void solve(const Vector<T> &constants, Vector<T> &variables) const;
+
+  /**
+   * @brief Solves A * X = B for every column of B in place
+   *
+   * @param B View of the n x nrhs right-hand sides, overwritten by X.
+   * @throws std::runtime_error If B does not have n rows.
+   */
+  void solveInPlace(MatrixView<T> B) const;
+
+  /**
+   * @brief Solves A * X = B for every column of B
+   *
+   * All right-hand sides are solved together with blocked triangular solves.
+   *
+   * @param constants The n x nrhs matrix B.
+   * @return Matrix<T> The solutions X.
+   * @throws std::runtime_error If the dimensions do not match or the matrix
+   * is singular.
+   */
+  Matrix<T> solve(const Matrix<T> &constants) const;
+};
+typedef LU<double> LUD;
+typedef LU<float> LUF;
+typedef LU<std::complex<double>> LUCD;
+typedef LU<std::complex<float>> LUCF;
+} // namespace MWP
@@ -1,19 +1,54 @@
+#pragma once
+
+#include "Cholesky.hpp"
+#include "Krylov.hpp"
+#include "LDLT.hpp"
+#include "LU.hpp"
 #include "Matrix.hpp"
+#include "MixedPrecision.hpp"
+#include "QR.hpp"
 #include "Vector.hpp"
 
 namespace MWP {
+
+/**
+ * @brief Method chosen by LinSys::solve for the coefficient matrix
+ */
+enum class SolverMethod {
+  None,
+  LowerTriangular,
+  UpperTriangular,
+  Cholesky,
+  LDLT,
+  LU,
+  MixedPrecisionLU,
+  QR
+};
+
 template <typename T> class LinSys {
 public:
   Matrix<T> coefficients;
   Vector<T> variables;
   Vector<T> constants;
 
+  SolverMethod _method;
+  LU<T> _lu;
+  Cholesky<T> _cholesky;
+  LDLT<T> _ldlt;
+  QR<T> _qr;
+  KrylovSolver<T> _krylov;
+  MixedPrecisionLU<T> _mixed;
+  bool _mixedPrecision;
+  RefinementResult _refinement;
+
 public:
   /**
    * @brief Inits the linear system
    *
    * Inits a linear system with given coefficient matrix and constant matrix.
    * The amount of variables should be equal to the amount of constants.
+   * Both are taken by value and moved into the system; pass them with
+   * std::move to avoid the copies.
    *
    * @param coefficients
    * @param constants
@@ -36,8 +71,104 @@ public:
    * systems.
    */
   void solveBackSubstitution();
+
+  /**
+   * @brief Detects the structure of the coefficient matrix and factors it
+   *
+   * Triangular systems need no factorization. Symmetric matrices with a
+   * positive diagonal are factored with Cholesky, falling back to the
+   * Bunch-Kaufman LDL^T factorization if they turn out not to be positive
+   * definite; other symmetric matrices use LDL^T directly. Other square
+   * matrices use pivoted LU, factored in single precision and refined when
+   * the mixed precision mode is on, and overdetermined systems use QR, giving
+   * the least-squares solution. The factorization is kept until factor() is called again,
+   * which is required after changing the coefficients.
+   *
+   * @throws std::runtime_error If the system is underdetermined or the
+   * matrix is integral, since integer pivots and square roots truncate.
+   */
+  void factor();
+
+  /**
+   * @brief Solves the linear system for the current constants
+   *
+   * Factors the coefficient matrix on first use; later calls reuse the
+   * cached factorization and cost O(n^2).
+   *
+   * @throws std::runtime_error If the coefficient matrix is singular or
+   * integral.
+   */
+  void solve();
+
+  /**
+   * @brief Solves the linear system for new constants
+   *
+   * Replaces the constants, solves with the cached factorization and stores
+   * the result in variables.
+   *
+   * @param constants The new constants vector.
+   * @return Vector<T> The variables solving the system.
+   * @throws std::runtime_error If the constants vector has an incompatible
+   * dimension or the coefficient matrix is singular.
+   */
+  Vector<T> solve(const Vector<T> &constants);
+
+  /**
+   * @brief Solves the linear system for several constants at once
+   *
+   * Each column of the constants matrix is a right-hand side. All columns
+   * are solved together with blocked triangular solves (TRSM) on the cached
+   * factorization, which turns the substitutions into matrix-matrix work.
+   * The variables and constants vectors of the system are left untouched.
+   *
+   * @param constants The matrix of constants, one right-hand side per column.
+   * @return Matrix<T> The variables, one solution per column.
+   * @throws std::runtime_error If the constants matrix has an incompatible
+   * number of rows or the coefficient matrix is singular.
+   */
+  Matrix<T> solve(const Matrix<T> &constants);
+
+  /**
+   * @brief Solves the linear system with a Krylov method
+   *
+   * The coefficient matrix is only used through matrix-vector products and
+   * is never factored. The current variables are the initial guess and
+   * receive the solution; the work vectors are kept for the next call.
+   *
+   * @param method The Krylov method.
+   * @param settings The tolerances and iteration limits.
+   * @param preconditioner Optional approximation of the inverse of the
+   * coefficients, such as a JacobiPreconditioner::linearOperator().
+   * @return IterativeResult The convergence report and residual history.
+   * @throws std::runtime_error If the coefficient matrix is not square.
+   */
+  IterativeResult
+  solveIterative(IterativeMethod method,
+                 const IterativeSettings &settings = IterativeSettings(),
+                 const LinearOperator<T> *preconditioner = nullptr);
+
+  /**
+   * @brief Switches the general square solver to mixed precision
+   *
+   * When enabled, matrices that would use LU are factored in single
+   * precision and each solution is refined with residuals in the working
+   * precision, falling back to a working precision LU if the refinement
+   * stalls. The report of the last solve is kept in _refinement. Changing
+   * the mode discards the cached factorization.
+   *
+   * @param enabled Use the mixed precision LU.
+   */
+  void setMixedPrecision(bool enabled);
+
+  /**
+   * @brief Method selected by the last factorization
+   *
+   * @return SolverMethod None until the system has been factored.
+   */
+  SolverMethod method() const;
 };
 typedef LinSys<double> LinSysD;
+typedef LinSys<float> LinSysF;
 typedef LinSys<int> LinSysI;
 } // namespace MWP
 
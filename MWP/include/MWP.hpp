@@ -0,0 +1,57 @@
+#pragma once
+
+/**
+ * @brief Umbrella header for the whole library
+ *
+ * In the default build this only gathers the public headers. With
+ * MWP_HEADER_ONLY defined it also includes every implementation file, so the
+ * library needs no separate compilation; see Config.hpp.
+ */
+
+#include "Allocator.hpp"
+#include "Batched.hpp"
+#include "Cholesky.hpp"
+#include "Config.hpp"
+#include "Expression.hpp"
+#include "FixedMatrix.hpp"
+#include "Gemm.hpp"
+#include "Krylov.hpp"
+#include "LDLT.hpp"
+#include "LU.hpp"
+#include "LinSys.hpp"
+#include "Matrix.hpp"
+#include "MatrixView.hpp"
+#include "MixedPrecision.hpp"
+#include "Preconditioner.hpp"
+#include "QR.hpp"
+#include "Scalar.hpp"
+#include "Simd.hpp"
+#include "SparseMatrix.hpp"
+#include "TSQR.hpp"
+#include "ThreadPool.hpp"
+#include "Transpose.hpp"
+#include "Trsm.hpp"
+#include "Vector.hpp"
+#include "Workspace.hpp"
+
+#ifdef MWP_HEADER_ONLY
+#include "../src/Batched.cpp"
+#include "../src/Cholesky.cpp"
+#include "../src/Gemm.cpp"
+#include "../src/Krylov.cpp"
+#include "../src/LDLT.cpp"
+#include "../src/LU.cpp"
+#include "../src/LinSys.cpp"
+#include "../src/Matrix.cpp"
+#include "../src/MixedPrecision.cpp"
+#include "../src/Preconditioner.cpp"
+#include "../src/QR.cpp"
+#include "../src/Simd.cpp"
+#include "../src/SparseMatrix.cpp"
+#include "../src/TSQR.cpp"
+#include "../src/ThreadPool.cpp"
+#include "../src/Transpose.cpp"
+#include "../src/Trsm.cpp"
+#include "../src/Vector.cpp"
+#include "../src/Workspace.cpp"
+#endif
@@ -1,7 +1,13 @@
 #pragma once
 
+#include "Allocator.hpp"
+#include "Config.hpp"
+#include "Expression.hpp"
+#include "MatrixView.hpp"
 #include "Vector.hpp"
+#include "Workspace.hpp"
 #include <cmath>
+#include <initializer_list>
 #include <iostream>
 #include <stdexcept>
 #include <utility>
@@ -9,12 +15,14 @@
 #include <limits>
 
 namespace MWP {
-template <typename T> class Matrix {
+template <typename T> class Matrix : public MatrixExpression<Matrix<T>> {
 public:
-  std::vector<T> _elements;
-  unsigned int _rows;
-  unsigned int _columns;
-  unsigned int _size;
+  typedef T value_type;
+
+  AlignedVector<T> _elements;
+  Index _rows;
+  Index _columns;
+  Index _size;
 
 public:
   /**
@@ -35,20 +43,111 @@ public:
    * @param rows The number of rows in the matrix.
    * @param columns The number of columns in the matrix.
    */
-  Matrix<T>(unsigned int rows, unsigned int columns);
+  Matrix<T>(Index rows, Index columns);
 
   /**
    * @brief Constructor for given elements and number of rows and columns
    *
    * Init the matrix with given columns, rows and set the given
-   * elements
+   * elements. The elements are moved into the matrix; pass them with
+   * std::move to avoid the copy.
    *
    * @tparam T The data type of the matrix elements.
    * @param elements The elements of matrix.
    * @param rows The number of rows in the matrix.
    * @param columns The number of columns in the matrix.
    */
-  Matrix<T>(std::vector<T> elements, unsigned int rows, unsigned int columns);
+  Matrix<T>(AlignedVector<T> elements, Index rows, Index columns);
+
+  /**
+   * @brief Constructor copying the given elements
+   *
+   * @param elements The elements of the matrix.
+   * @param rows The number of rows in the matrix.
+   * @param columns The number of columns in the matrix.
+   */
+  Matrix<T>(const std::vector<T> &elements, Index rows, Index columns);
+  Matrix<T>(std::initializer_list<T> elements, Index rows, Index columns);
+
+  /**
+   * @brief Constructor taking over the elements of a std::vector
+   *
+   * A std::vector cannot hand its buffer over to the aligned storage, so the
+   * elements are copied once and the source is released, leaving it empty.
+   * Pass an AlignedVector instead to move the elements without a copy.
+   *
+   * @param elements The elements of the matrix.
+   * @param rows The number of rows in the matrix.
+   * @param columns The number of columns in the matrix.
+   */
+  Matrix<T>(std::vector<T> &&elements, Index rows, Index columns);
+
+  /**
+   * @brief Constructor leaving the elements uninitialized
+   *
+   * For results that are entirely overwritten before being read. The
+   * dimensions are checked as in the zeroing constructor.
+   *
+   * @param rows The number of rows in the matrix.
+   * @param columns The number of columns in the matrix.
+   */
+  Matrix<T>(Index rows, Index columns, UninitializedTag);
+
+  /**
+   * @brief Constructor from a matrix expression
+   *
+   * Evaluates the expression in a single pass into the new matrix, so
+   * intermediate results of the expression are never allocated.
+   *
+   * @tparam E The expression type.
+   * @param expression The expression to evaluate.
+   */
+  template <typename E> Matrix(const MatrixExpression<E> &expression);
+
+  /**
+   * @brief Assigns the result of a matrix expression
+   *
+   * The current storage is reused when the dimensions match. Expressions that
+   * read the matrix itself are handled safely.
+   *
+   * @tparam E The expression type.
+   * @param expression The expression to evaluate.
+   * @return Matrix<T>& The current matrix.
+   */
+  template <typename E> Matrix<T> &operator=(const MatrixExpression<E> &expression);
+
+  /**
+   * @brief Adds a matrix expression to the current matrix in place
+   *
+   * The expression is accumulated into the current storage; products are
+   * computed by GEMM with beta equal to one.
+   *
+   * @tparam E The expression type.
+   * @param expression The expression to add.
+   * @return Matrix<T>& The current matrix.
+   * @throws std::runtime_error If the dimensions do not match.
+   */
+  template <typename E>
+  Matrix<T> &operator+=(const MatrixExpression<E> &expression);
+
+  /**
+   * @brief Subtracts a matrix expression from the current matrix in place
+   *
+   * @tparam E The expression type.
+   * @param expression The expression to subtract.
+   * @return Matrix<T>& The current matrix.
+   * @throws std::runtime_error If the dimensions do not match.
+   */
+  template <typename E>
+  Matrix<T> &operator-=(const MatrixExpression<E> &expression);
+
+  /**
+   * @brief Scales the current matrix in place
+   *
+   * @param scalar The scalar factor.
+   * @return Matrix<T>& The current matrix.
+   */
+  Matrix<T> &operator*=(T scalar);
 
 public:
   /**
@@ -60,7 +159,7 @@ public:
    * @param index The index of the element.
    * @return The value of the element.
    */
-  T operator[](unsigned int index) const;
+  T operator[](Index index) const;
 
   /**
    * @brief Access the matrix element by index.
@@ -71,7 +170,7 @@ public:
    * @param index The index of the element.
    * @return The reference to the element.
    */
-  T &operator[](unsigned int index);
+  T &operator[](Index index);
 
   /**
    * @brief Access the matrix components by row index and column index.
@@ -84,7 +183,7 @@ public:
    * @param columnsIndex The column index of the element position.
    * @return The element in the asked position.
    */
-  T operator()(unsigned int rowIndex, unsigned int columnsIndex) const;
+  T operator()(Index rowIndex, Index columnsIndex) const;
 
   /**
    * @brief Access the matrix components by row index and column index.
@@ -97,80 +196,63 @@ public:
    * @param columnsIndex The column index of the element position.
    * @return The element in the asked position.
    */
-  T &operator()(unsigned int rowIndex, unsigned int columnsIndex);
+  T &operator()(Index rowIndex, Index columnsIndex);
 
   /**
-   * @brief Overloads the addition operator for Matrix objects.
+   * @brief Overloads the multiplication operator for Matrix objects.
    *
-   * This operator allows for the addition of two Matrix objects.
+   * This operator allows for the multiplication of two Matrix objects.
    *
    * @tparam T The type of the matrix elements.
-   * @param matrix The matrix to be added to the current matrix.
+   * @param matrix The matrix to be multiplied by the current matrix.
    * @return A new Matrix object that is the result of the matrix
-   * addition.
+   * multiplication.
    */
-  Matrix<T> operator+(const Matrix<T> &matrix) const;
+  Vector<T> operator*(const Vector<T> &vector) const;
 
   /**
-   * @brief Overloads the subtraction operator for Matrix objects.
+   * @brief Computes the determinant of the matrix
    *
-   * This operator allows for the addition of two Matrix objects.
+   * Matrices up to 4x4 use the closed-form cofactor expansion; larger ones
+   * take the signed product of the diagonal of a pivoted blocked LU. For
+   * large matrices prefer logDet(), which cannot overflow.
    *
-   * @tparam T The type of the matrix elements.
-   * @param matrix The matrix to be subtracted to the current matrix.
-   * @return A new Matrix object that is the result of the matrix
-   * subtraction.
+   * @return double The determinant.
+   * @throws std::runtime_error If the matrix is not square or complex; use
+   * LU::determinant() for complex matrices.
    */
-  Matrix<T> operator-(const Matrix<T> &matrix) const;
-
-  /**
-  * @brief Overloads the multiplication operator for Matrix objects.
-  *
-  * This operator allows for the multiplication of a Matrix object by a
-  scalar.
-  *
-  * @tparam T The type of the matrix elements.
-  * @param scalar The scalar value to multiply the matrix by.
-  * @return A new Matrix object that is the result of the matrix-scalar
-  * multiplication.
-  */
-  Matrix<T> operator*(T scalar) const;
+  double det() const;
 
   /**
-   * @brief Overloads the multiplication operator for Matrix objects.
-   *
-   * This operator allows for the multiplication of two Matrix objects.
+   * @brief Computes the logarithm of the absolute value of the determinant
    *
-   * @tparam T The type of the matrix elements.
-   * @param matrix The matrix to be multiplied by the current matrix.
-   * @return A new Matrix object that is the result of the matrix
-   * multiplication.
+   * @param sign Receives the sign of the determinant: -1, 0 or 1; only 0 or
+   * 1 for complex matrices.
+   * @return double log|det|, or -infinity if the matrix is singular.
+   * @throws std::runtime_error If the matrix is not square.
    */
-  Matrix<T> operator*(const Matrix<T> &matrix) const;
+  double logDet(int &sign) const;
 
   /**
-   * @brief Overloads the multiplication operator for Matrix objects.
+   * @brief Computes the inverse of the matrix
    *
-   * This operator allows for the multiplication of two Matrix objects.
+   * Matrices up to 4x4 use the closed-form adjugate; larger ones are
+   * inverted from a pivoted blocked LU factorization. Integer matrices are
+   * rejected since their inverse is generally not integral; convert them to
+   * a floating-point matrix first.
    *
-   * @tparam T The type of the matrix elements.
-   * @param matrix The matrix to be multiplied by the current matrix.
-   * @return A new Matrix object that is the result of the matrix
-   * multiplication.
+   * @return Matrix<T> The inverse matrix.
+   * @throws std::runtime_error If the matrix is not square, is singular or
+   * has integer elements.
    */
-  Vector<T> operator*(const Vector<T> &vector) const;
-
-  // TODO: Implement
-  double det() const;
-
-  // TODO: Implement
   Matrix<T> inverse() const;
 
   /**
    * @brief Transpose the current matrix
    *
    * Transpose operation, all the row elements turn into column elements and
-   * vice versa
+   * vice versa. Square matrices are transposed in place by swapping tiles;
+   * rectangular ones through a tiled copy into a new buffer.
    *
    * @return Matrix<T> Transposed matrix
    */
@@ -212,10 +294,12 @@ public:
    * @brief Factors the matrix using lower-upper decomposition
    *
    * Factors the matrix as the product of a lower triangular matrix and an upper
-   * triangular matrix.
+   * triangular matrix, without pivoting. For large or general matrices use
+   * MWP::LU, which pivots and factors in place.
    *
    * @return std::pair<Matrix<T>, Matrix<T>> Lower triangular matrix and an
    * upper triangular matrix
+   * @throws std::runtime_error If the matrix is not square or complex.
    */
   std::pair<Matrix<double>, Matrix<double>> LUDecomposition();
 
@@ -231,8 +315,59 @@ public:
    * @param endCol Final col.
    * @return A new Matrix object that is a submatrix of this one.
    */
-  MWP::Matrix<T> subMatrix(unsigned int startRow, unsigned int endRow,
-                           unsigned int startCol, unsigned int endCol) const;
+  MWP::Matrix<T> subMatrix(Index startRow, Index endRow, Index startCol,
+                           Index endCol) const;
+
+  /**
+   * @brief Returns a view of a block of the matrix
+   *
+   * The view references the elements of the matrix, so no element is copied
+   * and expressions assigned to the view update the matrix in place. Ranges
+   * are half-open, as in subMatrix.
+   *
+   * @param startRow Initial row.
+   * @param endRow Final row (excluded).
+   * @param startCol Initial column.
+   * @param endCol Final column (excluded).
+   * @return MatrixView<T> A view of the block.
+   * @throws std::out_of_range If the range does not fit inside the matrix.
+   */
+  MatrixView<T> view(Index startRow, Index endRow, Index startCol,
+                     Index endCol);
+
+  /**
+   * @brief Returns a read-only view of a block of the matrix
+   *
+   * @param startRow Initial row.
+   * @param endRow Final row (excluded).
+   * @param startCol Initial column.
+   * @param endCol Final column (excluded).
+   * @return ConstMatrixView<T> A read-only view of the block.
+   * @throws std::out_of_range If the range does not fit inside the matrix.
+   */
+  ConstMatrixView<T> view(Index startRow, Index endRow, Index startCol,
+                          Index endCol) const;
+
+  /**
+   * @brief Returns a view of a row of the matrix as a row vector
+   *
+   * @param rowIndex The row index.
+   * @return VectorView<T> A contiguous view of the row.
+   * @throws std::out_of_range If the row index is out of bounds.
+   */
+  VectorView<T> row(Index rowIndex);
+  ConstVectorView<T> row(Index rowIndex) const;
+
+  /**
+   * @brief Returns a view of a column of the matrix as a column vector
+   *
+   * @param columnIndex The column index.
+   * @return VectorView<T> A view of the column, strided by the number of
+   * columns of the matrix.
+   * @throws std::out_of_range If the column index is out of bounds.
+   */
+  VectorView<T> column(Index columnIndex);
+  ConstVectorView<T> column(Index columnIndex) const;
 
   /**
    * @brief Replaces a submatrix of the current matrix with another smaller
@@ -247,8 +382,8 @@ public:
    * @throws std::out_of_range If the smaller matrix does not fit within the
    * bounds of the current matrix at the specified starting indices.
    */
-  void replaceSubmatrix(const Matrix<T> &smallerMatrix, unsigned int startRow,
-                        unsigned int startCol);
+  void replaceSubmatrix(const Matrix<T> &smallerMatrix, Index startRow,
+                        Index startCol);
 
   /**
    * @brief Get the largest column number in modulo.
@@ -257,7 +392,7 @@ public:
    * @return Largest number of the column in module.
    * @throws std::out_of_range If the col index is out of bounds.
    */
-  T colMax(unsigned int col) const;
+  T colMax(Index col) const;
 
   /**
    * @brief Norm2 of the matrix.
@@ -270,32 +405,151 @@ public:
    * @brief QR decomposition of a mxn matrix.
    *
    * @return An orthogonal vector Q and an upper triangular vector R.
-   *
+   * @throws std::runtime_error If the matrix is complex or integral.
    */
   std::pair<Matrix<T>, Matrix<T>> QRdecomp() const;
 };
 typedef Matrix<double> MatrixD;
+typedef Matrix<float> MatrixF;
+typedef Matrix<std::complex<double>> MatrixCD;
+typedef Matrix<std::complex<float>> MatrixCF;
 typedef Matrix<int> MatrixI;
+
+template <typename T>
+template <typename E>
+Matrix<T>::Matrix(const MatrixExpression<E> &expression) {
+  const typename ExpressionStorage<E>::type node(expression.derived());
+  _rows = (Index)node.rows();
+  _columns = (Index)node.columns();
+  _size = _rows * _columns;
+  _elements.resize(_size);
+  node.assignTo(_elements.data(), _columns, (T)1, false);
+}
+
+template <typename T>
+template <typename E>
+Matrix<T> &Matrix<T>::operator=(const MatrixExpression<E> &expression) {
+  const typename ExpressionStorage<E>::type node(expression.derived());
+  if (node.rows() != _rows || node.columns() != _columns) {
+    Matrix<T> result(expression);
+    *this = std::move(result);
+    return *this;
+  }
+  node.assignTo(_elements.data(), _columns, (T)1, false);
+  return *this;
+}
+
+template <typename T>
+template <typename E>
+Matrix<T> &Matrix<T>::operator+=(const MatrixExpression<E> &expression) {
+  const typename ExpressionStorage<E>::type node(expression.derived());
+  if (node.rows() != _rows || node.columns() != _columns) {
+    throw std::runtime_error(
+        "Invalid matrices dimensions for addition operation");
+  }
+  node.assignTo(_elements.data(), _columns, (T)1, true);
+  return *this;
+}
+
+template <typename T>
+template <typename E>
+Matrix<T> &Matrix<T>::operator-=(const MatrixExpression<E> &expression) {
+  const typename ExpressionStorage<E>::type node(expression.derived());
+  if (node.rows() != _rows || node.columns() != _columns) {
+    throw std::runtime_error(
+        "Invalid matrices dimensions for subtraction operation");
+  }
+  node.assignTo(_elements.data(), _columns, (T)-1, true);
+  return *this;
+}
+
+/**
+ * @brief Matrix expression times vector product
+ *
+ * Evaluates op(A) * x with GEMV, folding scalars and transposes of the
+ * expression into the call.
+ *
+ * @tparam E The expression type.
+ * @param expression The matrix expression.
+ * @param vector The column vector.
+ * @return Vector<T> The resulting column vector.
+ */
+template <typename E>
+Vector<typename E::value_type>
+operator*(const MatrixExpression<E> &expression,
+          const Vector<typename E::value_type> &vector) {
+  typedef typename E::value_type T;
+  const typename ExpressionStorage<E>::type node(expression.derived());
+  if (node.columns() != vector._rows || vector._columns != 1) {
+    throw std::runtime_error(
+        "Invalid dimensions for matrix-vector multiplication");
+  }
+  const detail::GemmOperand<T> operand =
+      detail::gemmOperand(node, (const T *)nullptr, (const T *)nullptr);
+  Vector<T> result((Index)node.rows(), 1, Uninitialized);
+  gemv<T>(operand.trans, operand.trans ? node.columns() : node.rows(),
+          operand.trans ? node.rows() : node.columns(), operand.scale,
+          operand.data, operand.ld, vector._elements.data(), (T)0,
+          result._elements.data());
+  return result;
+}
+
+/**
+ * @brief Product of two matrices
+ *
+ * Unlike products involving views, scalars or transposes, which stay lazy so
+ * they can be fused into the assignment, the product of two matrices is
+ * evaluated right away with GEMM and returns a Matrix, as it always has.
+ *
+ * @tparam T The type of the matrix elements.
+ * @param left The left matrix.
+ * @param right The right matrix.
+ * @return Matrix<T> The resulting matrix.
+ */
+template <typename T>
+Matrix<T> operator*(const Matrix<T> &left, const Matrix<T> &right) {
+  return detail::evaluate(
+      MatrixProduct<ConstMatrixView<T>, ConstMatrixView<T>>(left, right));
+}
 } // namespace MWP
 
 /**
  * @brief Transpose the current matrix
  *
  * Transpose operation, all the row elements turn into column elements and
- * vice versa
+ * vice versa. The transpose is lazy: it is materialized when assigned to a
+ * Matrix and consumed as a flag by products.
  *
- * @return Matrix<T> Transposed matrix
+ * @return Lazy transposed matrix
  */
 template <typename T>
-inline MWP::Matrix<T> TransposeMatrix(const MWP::Matrix<T> &matrix) {
-  MWP::Matrix<T> transposedMatrix(matrix._columns, matrix._rows);
-  for (int i = 0; i < transposedMatrix._rows; i++) {
-    for (int j = 0; j < transposedMatrix._columns; j++) {
-      transposedMatrix._elements[i * transposedMatrix._columns + j] =
-          matrix._elements[j * transposedMatrix._rows + i];
-    }
-  }
-  return transposedMatrix;
+inline MWP::MatrixTransposed<MWP::ConstMatrixView<T>>
+TransposeMatrix(const MWP::Matrix<T> &matrix) {
+  return MWP::MatrixTransposed<MWP::ConstMatrixView<T>>(matrix);
+}
+
+/**
+ * @brief Transpose a matrix expression
+ *
+ * @return Lazy transposed expression
+ */
+template <typename E>
+inline MWP::MatrixTransposed<typename MWP::ExpressionStorage<E>::type>
+TransposeMatrix(const MWP::MatrixExpression<E> &expression) {
+  return MWP::transposed(expression);
+}
+
+/**
+ * @brief Transpose a temporary matrix
+ *
+ * A lazy transpose would reference the temporary after it is destroyed, so
+ * the transpose is evaluated into a new matrix instead.
+ *
+ * @return MWP::Matrix<T> The transposed matrix
+ */
+template <typename T>
+inline MWP::Matrix<T> TransposeMatrix(MWP::Matrix<T> &&matrix) {
+  return MWP::Matrix<T>(MWP::transposed(matrix));
 }
 
 /**
@@ -309,14 +563,14 @@ inline MWP::Matrix<T> TransposeMatrix(const MWP::Matrix<T> &matrix) {
  * @return MWP::Matrix<T> The identity matrix.
  */
 template <typename T>
-inline MWP::Matrix<T> IdentityMatrix(unsigned int rows, unsigned int columns) {
+inline MWP::Matrix<T> IdentityMatrix(MWP::Index rows, MWP::Index columns) {
   if (rows != columns) {
     throw std::runtime_error("An identity matrix should have number of rows "
                              "equal to the number of columns");
   }
   MWP::Matrix<T> identityMatrix(rows, columns);
-  for (int i = 0; i < identityMatrix._rows; i++) {
-    for (int j = 0; j < identityMatrix._columns; j++) {
+  for (MWP::Index i = 0; i < identityMatrix._rows; i++) {
+    for (MWP::Index j = 0; j < identityMatrix._columns; j++) {
       if (i == j) {
         identityMatrix._elements[i * identityMatrix._columns + j] = (T)1;
       }
@@ -326,26 +580,21 @@ inline MWP::Matrix<T> IdentityMatrix(unsigned int rows, unsigned int columns) {
 }
 
 /**
- * @brief Evaluate the nth householder submatrix
+ * @brief Applies the householder reflector of the first column in place
  *
- * Zeros out all columns below the nth diagonal element
+ * Zeros out the first column of the viewed block below its first element by
+ * updating the block in place.
  *
- * @param A Matrix to be zeroed
- * @return [A,u] Pair.
+ * @param A View of the block to be zeroed
+ * @return The householder vector u.
  */
-
-template <typename T>
-inline std::pair<MWP::Matrix<T>, MWP::Matrix<T>> hh(const MWP::Matrix<T> &A) {
-
-  MWP::Matrix<T> A_star = A;
-  MWP::Matrix<T> x = A_star.subMatrix(0, A_star._rows, 0, 1); // column vector
-  MWP::Matrix<T> hu;
+template <typename T> inline MWP::Matrix<T> hhInPlace(MWP::MatrixView<T> A) {
+  MWP::Matrix<T> hu = A.view(0, A._rows, 0, 1); // column vector
   T beta;
-  T maxVal = x.colMax(0);
-  x = x * ((T)1.0f / maxVal);
+  T maxVal = hu.colMax(0);
+  hu *= (T)1.0f / maxVal;
 
-  T colNorm = x.norm2();
-  hu = x;
+  T colNorm = hu.norm2();
   if (hu[0] >= 0) {
     hu[0] = hu[0] + colNorm;
   } else {
@@ -360,7 +609,34 @@ inline std::pair<MWP::Matrix<T>, MWP::Matrix<T>> hh(const MWP::Matrix<T> &A) {
     beta = (T)0.f;
   }
 
-  A_star = A_star - (hu * beta) * (TransposeMatrix(hu) * A_star);
+  // A -= (beta * hu) * (hu^T * A) by row axpys, the row hu^T * A being kept
+  // in the workspace.
+  MWP::WorkspaceScope scope;
+  T *w = scope.allocate<T>(A._columns, (T)0);
+  const MWP::Index rows = (MWP::Index)A._rows;
+  for (MWP::Index i = 0; i < rows; i++) {
+    MWP::simd::axpy<T>(A._columns, hu._elements[i], A._data + i * A._ld, w);
+  }
+  for (MWP::Index i = 0; i < rows; i++) {
+    MWP::simd::axpy<T>(A._columns, -beta * hu._elements[i], w,
+                       A._data + i * A._ld);
+  }
+  return hu;
+}
+
+/**
+ * @brief Evaluate the nth householder submatrix
+ *
+ * Zeros out all columns below the nth diagonal element
+ *
+ * @param A Matrix to be zeroed
+ * @return [A,u] Pair.
+ */
+template <typename T>
+inline std::pair<MWP::Matrix<T>, MWP::Matrix<T>> hh(const MWP::Matrix<T> &A) {
+  MWP::Matrix<T> A_star = A;
+  MWP::Matrix<T> hu =
+      hhInPlace(A_star.view(0, A_star._rows, 0, A_star._columns));
   return {A_star, hu};
 }
 
@@ -378,23 +654,22 @@ inline std::pair<MWP::MatrixD, MWP::MatrixD> GS(const MWP::MatrixD &Amatrix) {
   if (Amatrix._rows < Amatrix._columns) {
     throw std::invalid_argument("A matriz deve ter mais linhas que colunas.");
   }
-  MWP::MatrixD QMatrix(Amatrix._rows, Amatrix._columns);
+  // Columns of A are orthogonalized as contiguous rows of its transpose, in
+  // place, so every dot product and update runs on unit-stride views.
+  MWP::MatrixD QTransposed = TransposeMatrix(Amatrix);
   MWP::MatrixD RMatrix(Amatrix._columns, Amatrix._columns);
-  MWP::VectorD rowVectorA(Amatrix._rows, 1);
-  MWP::VectorD rowVectorQ(Amatrix._rows, 1);
-  for (int i = 0; i < Amatrix._columns; i++) {
-    rowVectorA = toVector(Amatrix.subMatrix(0, Amatrix._rows, i, i + 1));
-    for (int j = 0; j < i; j++) {
-      rowVectorQ = toVector(QMatrix.subMatrix(0, QMatrix._rows, j, j + 1));
-      double dotProduct =
-          Dot(rowVectorA, rowVectorQ);
+  for (MWP::Index i = 0; i < Amatrix._columns; i++) {
+    MWP::VectorView<double> vectorA = QTransposed.row(i);
+    for (MWP::Index j = 0; j < i; j++) {
+      const MWP::ConstVectorView<double> vectorQ = QTransposed.row(j);
+      double dotProduct = Dot(vectorA, vectorQ);
       RMatrix(j, i) = dotProduct;
-      rowVectorA = rowVectorA - rowVectorQ * dotProduct;
+      vectorA = vectorA - vectorQ * dotProduct;
     }
-    double norm = rowVectorA.norm2();
-    rowVectorQ = rowVectorA * (1.0 / norm);
-    QMatrix.replaceSubmatrix(toMatrix(rowVectorQ), 0, i);
+    double norm = vectorA.norm2();
+    vectorA = vectorA * (1.0 / norm);
     RMatrix(i, i) = norm;
   }
-  return std::pair<MWP::MatrixD, MWP::MatrixD>(QMatrix, RMatrix);
+  return std::pair<MWP::MatrixD, MWP::MatrixD>(TransposeMatrix(QTransposed),
+                                                RMatrix);
 }
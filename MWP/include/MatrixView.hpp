@@ -0,0 +1,253 @@
+#pragma once
+
+#include "Expression.hpp"
+#include "Scalar.hpp"
+#include "Vector.hpp"
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace MWP {
+
+/**
+ * @brief Mutable strided view of a row-major block of matrix elements
+ *
+ * A view is a pointer, its dimensions and a leading dimension into storage
+ * owned by someone else, usually a Matrix. Taking a view never copies, and
+ * assigning an expression to a view writes the result straight into the
+ * viewed block, so decompositions can update trailing blocks in place.
+ *
+ * Views do not own their elements: they must not outlive the matrix they
+ * were taken from, nor survive a resize of it.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> class MatrixView : public MatrixExpression<MatrixView<T>> {
+public:
+  typedef T value_type;
+
+  T *_data;
+  std::size_t _rows;
+  std::size_t _columns;
+  std::size_t _ld;
+
+public:
+  MatrixView(T *data, std::size_t rows, std::size_t columns, std::size_t ld)
+      : _data(data), _rows(rows), _columns(columns), _ld(ld) {}
+
+  MatrixView(const MatrixView<T> &other) = default;
+
+  /**
+   * @brief Copies the elements of another view into the viewed block
+   *
+   * Views have reference semantics for construction and value semantics for
+   * assignment, like a reference to the block.
+   *
+   * @param other The view to copy the elements from.
+   * @return MatrixView<T>& The current view.
+   */
+  MatrixView<T> &operator=(const MatrixView<T> &other) {
+    return *this = static_cast<const MatrixExpression<MatrixView<T>> &>(other);
+  }
+
+  /**
+   * @brief Evaluates a matrix expression into the viewed block
+   *
+   * @tparam E The expression type.
+   * @param expression The expression to evaluate.
+   * @return MatrixView<T>& The current view.
+   * @throws std::runtime_error If the dimensions of the expression differ
+   * from the dimensions of the view.
+   */
+  template <typename E>
+  MatrixView<T> &operator=(const MatrixExpression<E> &expression) {
+    const typename ExpressionStorage<E>::type node(expression.derived());
+    if (node.rows() != _rows || node.columns() != _columns) {
+      throw std::runtime_error("Invalid view dimensions for assignment");
+    }
+    if (_rows == 0 || _columns == 0) {
+      return *this;
+    }
+    typedef typename ExpressionStorage<E>::type Node;
+    if constexpr (IsConstMatrixView<Node>::value) {
+      // A plain copy between partially overlapping blocks needs a temporary.
+      if (node.conflicts(_data, _ld, detail::endOf(node, _data, _ld))) {
+        detail::assignThroughTemporary(node, _data, _ld, (T)1, false);
+        return *this;
+      }
+    }
+    node.assignTo(_data, _ld, (T)1, false);
+    return *this;
+  }
+
+  operator ConstMatrixView<T>() const {
+    return ConstMatrixView<T>(_data, _rows, _columns, _ld);
+  }
+
+  std::size_t rows() const { return _rows; }
+  std::size_t columns() const { return _columns; }
+
+  /**
+   * @brief Access the viewed element by row index and column index
+   *
+   * @param rowIndex The row index inside the view.
+   * @param columnIndex The column index inside the view.
+   * @return T& The reference to the element.
+   * @throws std::runtime_error If the indices are out of bounds.
+   */
+  T &operator()(std::size_t rowIndex, std::size_t columnIndex) const {
+    if (rowIndex >= _rows || columnIndex >= _columns) {
+      throw std::runtime_error("Index out of bounds");
+    }
+    return _data[rowIndex * _ld + columnIndex];
+  }
+
+  /**
+   * @brief Returns a view of a block of the current view
+   *
+   * Ranges are half-open, as in Matrix::subMatrix.
+   *
+   * @param startRow Initial row.
+   * @param endRow Final row (excluded).
+   * @param startCol Initial column.
+   * @param endCol Final column (excluded).
+   * @return MatrixView<T> A view of the block.
+   * @throws std::out_of_range If the range does not fit inside the view.
+   */
+  MatrixView<T> view(std::size_t startRow, std::size_t endRow,
+                     std::size_t startCol, std::size_t endCol) const {
+    if (startRow > endRow || startCol > endCol || endRow > _rows ||
+        endCol > _columns) {
+      throw std::out_of_range("Invalid view range");
+    }
+    return MatrixView<T>(_data + startRow * _ld + startCol, endRow - startRow,
+                         endCol - startCol, _ld);
+  }
+};
+
+/**
+ * @brief Mutable strided view of vector elements
+ *
+ * Element i lives at data[i * stride]. Rows and columns of a matrix are
+ * exposed as vector views, so vector arithmetic can update them in place.
+ *
+ * @tparam T The type of the vector elements.
+ */
+template <typename T> class VectorView : public VectorExpression<VectorView<T>> {
+public:
+  typedef T value_type;
+
+  T *_data;
+  std::size_t _rows;
+  std::size_t _columns;
+  std::size_t _stride;
+
+public:
+  VectorView(T *data, std::size_t rows, std::size_t columns,
+             std::size_t stride = 1)
+      : _data(data), _rows(rows), _columns(columns), _stride(stride) {}
+
+  VectorView(const VectorView<T> &other) = default;
+
+  VectorView<T> &operator=(const VectorView<T> &other) {
+    return *this = static_cast<const VectorExpression<VectorView<T>> &>(other);
+  }
+
+  /**
+   * @brief Evaluates a vector expression into the viewed elements
+   *
+   * @tparam E The expression type.
+   * @param expression The expression to evaluate.
+   * @return VectorView<T>& The current view.
+   * @throws std::runtime_error If the size of the expression differs from the
+   * size of the view.
+   */
+  template <typename E>
+  VectorView<T> &operator=(const VectorExpression<E> &expression) {
+    const typename ExpressionStorage<E>::type node(expression.derived());
+    if (node.size() != size()) {
+      throw std::runtime_error("Invalid view dimensions for assignment");
+    }
+    typedef typename ExpressionStorage<E>::type Node;
+    if constexpr (std::is_same<Node, ConstVectorView<T>>::value) {
+      if (node.conflicts(_data, _stride, size())) {
+        Vector<T> temporary(node);
+        ConstVectorView<T>(temporary).assignTo(_data, _stride, (T)1, false);
+        return *this;
+      }
+    }
+    node.assignTo(_data, _stride, (T)1, false);
+    return *this;
+  }
+
+  operator ConstVectorView<T>() const {
+    return ConstVectorView<T>(_data, _rows, _columns, _stride);
+  }
+
+  std::size_t rows() const { return _rows; }
+  std::size_t columns() const { return _columns; }
+  std::size_t size() const { return _rows * _columns; }
+
+  T &operator[](std::size_t index) const {
+    if (index >= size()) {
+      throw std::runtime_error("Index out of bounds");
+    }
+    return _data[index * _stride];
+  }
+
+  double norm2() const {
+    double sum = 0.0;
+    if (_stride == 1) {
+      sum = (double)simd::sumSquares<T>(size(), _data);
+    } else {
+      for (std::size_t i = 0; i < size(); i++) {
+        sum += squaredMagnitude(_data[i * _stride]);
+      }
+    }
+    return std::sqrt(sum);
+  }
+};
+
+template <typename T> struct ExpressionStorage<MatrixView<T>> {
+  typedef ConstMatrixView<T> type;
+};
+
+template <typename T> struct ExpressionStorage<VectorView<T>> {
+  typedef ConstVectorView<T> type;
+};
+
+} // namespace MWP
+
+/**
+ * @brief Dot product of two vector expressions
+ *
+ * Views (and vectors) are read in place: contiguous ones use the SIMD kernel,
+ * strided ones a scalar loop. Other expressions are evaluated first.
+ */
+template <typename L, typename R>
+inline typename L::value_type Dot(const MWP::VectorExpression<L> &vector1,
+                                  const MWP::VectorExpression<R> &vector2) {
+  typedef typename L::value_type T;
+  typedef MWP::ConstVectorView<T> View;
+  if constexpr (std::is_same<typename MWP::ExpressionStorage<L>::type,
+                             View>::value &&
+                std::is_same<typename MWP::ExpressionStorage<R>::type,
+                             View>::value) {
+    const View left(vector1.derived());
+    const View right(vector2.derived());
+    if (left.size() != right.size()) {
+      throw std::runtime_error("Invalid vectors dimensions for dot product");
+    }
+    if (left._stride == 1 && right._stride == 1) {
+      return MWP::simd::dot<T>(left.size(), left._data, right._data);
+    }
+    T sum = (T)0;
+    for (std::size_t i = 0; i < left.size(); i++) {
+      sum += left._data[i * left._stride] * right._data[i * right._stride];
+    }
+    return sum;
+  } else {
+    return Dot(View(MWP::Vector<T>(vector1)), View(MWP::Vector<T>(vector2)));
+  }
+}
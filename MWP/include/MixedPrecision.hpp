@@ -0,0 +1,140 @@
+#pragma once
+
+#include "LU.hpp"
+#include "Matrix.hpp"
+#include "Vector.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace MWP {
+
+/**
+ * @brief Stopping criteria of the mixed precision refinement
+ *
+ * Refinement stops once ||b - A * x|| <= sqrt(n) * eps * ||A|| * ||x|| in the
+ * infinity norm, eps being the machine epsilon of the working precision. It
+ * is declared stalled, and the solver falls back to a working precision LU,
+ * when a correction shrinks the residual by less than _stallRatio or
+ * _maxIterations corrections were not enough.
+ */
+struct RefinementSettings {
+  std::size_t _maxIterations = 30;
+  double _stallRatio = 0.5;
+};
+
+/**
+ * @brief Outcome of a mixed precision solve
+ *
+ * _residualHistory holds the infinity norm of the residual before each
+ * correction; _iterations counts the single precision solves. _fallback is
+ * set when the solution came from the working precision factorization.
+ */
+struct RefinementResult {
+  bool _converged = false;
+  bool _fallback = false;
+  std::size_t _iterations = 0;
+  double _residualNorm = 0.0;
+  std::vector<double> _residualHistory;
+};
+
+/**
+ * @brief LU factorization in single precision with iterative refinement
+ *
+ * The O(n^3) factorization runs in float, where a SIMD register holds twice
+ * as many elements, and only the O(n^2) residuals b - A * x are computed in
+ * the working precision T. Each correction solves A * d = r with the float
+ * factors, which recovers full accuracy as long as cond(A) is well below
+ * 1 / eps(float). The gain rests on the single precision GEMM of the
+ * trailing updates; the mixedlu and lu kernels of the benchmark driver
+ * compare the two factorizations.
+ *
+ * Harder matrices are detected instead of returning a poor solution: a
+ * singular or overflowing float factorization, or a stalled refinement,
+ * factors A once in the working precision and every later solve uses that
+ * factorization directly.
+ *
+ * @tparam T The working precision.
+ */
+template <typename T> class MixedPrecisionLU {
+public:
+  Matrix<T> _matrix;
+  LU<float> _lowFactors;
+  LU<T> _fallback;
+  bool _fellBack;
+  RefinementSettings _settings;
+  T _matrixNorm;
+  std::vector<T> _residual;
+  std::vector<float> _correction;
+
+public:
+  /**
+   * @brief Default constructor for an empty factorization
+   */
+  MixedPrecisionLU() : _fellBack(false), _matrixNorm((T)0) {}
+
+  /**
+   * @brief Factors a rounded copy of the matrix in single precision
+   *
+   * The matrix is kept in the working precision to compute the residuals.
+   *
+   * @param matrix The square matrix to factor.
+   * @param settings The refinement stopping criteria.
+   * @throws std::runtime_error If the matrix is not square.
+   */
+  explicit MixedPrecisionLU(Matrix<T> matrix,
+                            const RefinementSettings &settings =
+                                RefinementSettings());
+
+public:
+  /**
+   * @brief Check if the matrix can be solved
+   *
+   * @return true The single or the working precision factors are
+   * nonsingular.
+   */
+  bool isNonsingular() const;
+
+  /**
+   * @brief Check if the working precision factorization replaced the single
+   * precision one
+   */
+  bool usedFallback() const;
+
+  /**
+   * @brief Solves A * x = b on raw arrays of size n
+   *
+   * @param b The right-hand side.
+   * @param x Receives the solution.
+   * @return RefinementResult The convergence report.
+   * @throws std::runtime_error If the matrix is singular.
+   */
+  RefinementResult solve(const T *b, T *x);
+
+  /**
+   * @brief Solves A * x = b
+   *
+   * @param constants The column vector b.
+   * @param variables Receives the solution x.
+   * @return RefinementResult The convergence report.
+   * @throws std::runtime_error If the dimensions do not match or the matrix
+   * is singular.
+   */
+  RefinementResult solve(const Vector<T> &constants, Vector<T> &variables);
+
+  /**
+   * @brief Solves A * X = B column by column
+   *
+   * @param constants The n x nrhs matrix B.
+   * @return Matrix<T> The solutions X.
+   * @throws std::runtime_error If the dimensions do not match or the matrix
+   * is singular.
+   */
+  Matrix<T> solve(const Matrix<T> &constants);
+
+private:
+  void fallBack();
+  T residual(const T *b, const T *x);
+};
+
+typedef MixedPrecisionLU<double> MixedPrecisionLUD;
+} // namespace MWP
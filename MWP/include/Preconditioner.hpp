@@ -0,0 +1,203 @@
+#pragma once
+
+#include "Config.hpp"
+#include "Krylov.hpp"
+#include "LU.hpp"
+#include "SparseMatrix.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace MWP {
+
+/**
+ * @brief Rows of a sparse triangular solve grouped into independent levels
+ *
+ * Row i of a lower (upper) triangular solve only waits for the rows j < i
+ * (j > i) it references. Giving each row one level more than the deepest of
+ * those rows makes all rows of a level independent, so a level is solved in
+ * parallel and the levels in order. _rows lists the rows level by level and
+ * level l spans _rows[_levelStarts[l] .. _levelStarts[l + 1]).
+ */
+struct LevelSchedule {
+  std::vector<std::size_t> _levelStarts;
+  std::vector<std::size_t> _rows;
+
+  /**
+   * @brief Builds the schedule of a triangular part of a CSR pattern
+   *
+   * @param offsets The CSR row offsets.
+   * @param indices The sorted column indices.
+   * @param diagonal Position of the diagonal entry in each row.
+   * @param lower Schedule the strictly lower part instead of the strictly
+   * upper part.
+   */
+  MWP_INLINE LevelSchedule(const std::vector<std::size_t> &offsets,
+                           const std::vector<std::size_t> &indices,
+                           const std::vector<std::size_t> &diagonal,
+                           bool lower);
+  LevelSchedule() = default;
+
+  /**
+   * @brief Number of levels, the length of the critical path
+   */
+  std::size_t levels() const { return _levelStarts.size() - 1; }
+};
+
+/**
+ * @brief Diagonal scaling, M = diag(A)^-1
+ *
+ * Like every preconditioner here, M approximates A^-1: apply(r, z) computes
+ * z = M * r and linearOperator() wraps it for the Krylov solvers. The
+ * preconditioner must outlive that operator.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> class JacobiPreconditioner {
+public:
+  std::vector<T> _inverseDiagonal;
+
+public:
+  /**
+   * @brief Inverts the diagonal of the matrix
+   *
+   * @throws std::runtime_error If the matrix is not square or has a zero on
+   * its diagonal.
+   */
+  explicit JacobiPreconditioner(const SparseMatrix<T> &matrix);
+
+public:
+  /**
+   * @brief Computes z = M * r
+   */
+  void apply(const T *r, T *z) const;
+
+  /**
+   * @brief Wraps the preconditioner as an operator for the Krylov solvers
+   */
+  LinearOperator<T> linearOperator() const;
+};
+
+/**
+ * @brief Incomplete LU factorization with no fill-in, M = (L * U)^-1
+ *
+ * L and U keep the sparsity pattern of A and share one CSR buffer, L with an
+ * implicit unit diagonal. Both the factorization and the triangular solves
+ * run level by level across the thread pool.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> class ILU0Preconditioner {
+public:
+  SparseMatrix<T> _factors;
+  std::vector<std::size_t> _diagonal;
+  LevelSchedule _lowerLevels;
+  LevelSchedule _upperLevels;
+
+public:
+  /**
+   * @brief Factors the matrix on its own pattern
+   *
+   * @throws std::runtime_error If the matrix is not square, misses a
+   * diagonal entry or a zero pivot occurs.
+   */
+  explicit ILU0Preconditioner(const SparseMatrix<T> &matrix);
+
+public:
+  /**
+   * @brief Computes z = M * r
+   */
+  void apply(const T *r, T *z) const;
+
+  /**
+   * @brief Wraps the preconditioner as an operator for the Krylov solvers
+   */
+  LinearOperator<T> linearOperator() const;
+};
+
+/**
+ * @brief Incomplete Cholesky factorization with no fill-in,
+ * M = (L * L^T)^-1
+ *
+ * Only the lower triangle of the symmetric matrix is read. L^T is kept as a
+ * second CSR matrix so the backward solve is also row oriented and can be
+ * level scheduled.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> class IC0Preconditioner {
+public:
+  SparseMatrix<T> _lower;
+  SparseMatrix<T> _upper;
+  std::vector<std::size_t> _lowerDiagonal;
+  std::vector<std::size_t> _upperDiagonal;
+  LevelSchedule _lowerLevels;
+  LevelSchedule _upperLevels;
+
+public:
+  /**
+   * @brief Factors the lower triangle of the matrix on its own pattern
+   *
+   * @throws std::runtime_error If the matrix is not square, misses a
+   * diagonal entry or a pivot is not positive.
+   */
+  explicit IC0Preconditioner(const SparseMatrix<T> &matrix);
+
+public:
+  /**
+   * @brief Computes z = M * r
+   */
+  void apply(const T *r, T *z) const;
+
+  /**
+   * @brief Wraps the preconditioner as an operator for the Krylov solvers
+   */
+  LinearOperator<T> linearOperator() const;
+};
+
+/**
+ * @brief Exact inverses of the diagonal blocks of A
+ *
+ * The blocks are extracted as dense matrices and factored with pivoted LU,
+ * in parallel; applying the preconditioner solves every block in parallel.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> class BlockJacobiPreconditioner {
+public:
+  std::size_t _size;
+  std::size_t _blockSize;
+  std::vector<LU<T>> _blocks;
+
+public:
+  /**
+   * @brief Factors the diagonal blocks of the matrix
+   *
+   * @param matrix The square matrix.
+   * @param blockSize The size of the blocks; the last one may be smaller.
+   * @throws std::runtime_error If the matrix is not square or a diagonal
+   * block is singular.
+   */
+  BlockJacobiPreconditioner(const SparseMatrix<T> &matrix,
+                            std::size_t blockSize);
+
+public:
+  /**
+   * @brief Computes z = M * r
+   */
+  void apply(const T *r, T *z) const;
+
+  /**
+   * @brief Wraps the preconditioner as an operator for the Krylov solvers
+   */
+  LinearOperator<T> linearOperator() const;
+};
+
+typedef JacobiPreconditioner<double> JacobiPreconditionerD;
+typedef JacobiPreconditioner<float> JacobiPreconditionerF;
+typedef ILU0Preconditioner<double> ILU0PreconditionerD;
+typedef ILU0Preconditioner<float> ILU0PreconditionerF;
+typedef IC0Preconditioner<double> IC0PreconditionerD;
+typedef IC0Preconditioner<float> IC0PreconditionerF;
+typedef BlockJacobiPreconditioner<double> BlockJacobiPreconditionerD;
+typedef BlockJacobiPreconditioner<float> BlockJacobiPreconditionerF;
+} // namespace MWP
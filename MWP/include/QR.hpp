@@ -0,0 +1,146 @@
+#pragma once
+
+#include "Matrix.hpp"
+#include "MatrixView.hpp"
+#include "Vector.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace MWP {
+
+/**
+ * @brief Number of reflectors aggregated per block by the blocked QR
+ */
+constexpr std::size_t QRBlockSize = 32;
+
+/**
+ * @brief Factors a block in place as A = Q * R with Householder reflectors
+ *
+ * Blocked Householder QR in the compact WY form: each panel of QRBlockSize
+ * columns is factored with level-2 operations, its reflectors are
+ * accumulated into a triangular T so that H_1 ... H_b = I - V * T * V^T, and
+ * the trailing columns are updated with three GEMM calls.
+ *
+ * On return R is stored on and above the diagonal and the essential part of
+ * each reflector v_j (whose leading one is implicit) below it.
+ *
+ * @tparam T The type of the matrix elements.
+ * @param A View of the block to factor.
+ * @param tau Receives the scalar factor of each of the min(m, n) reflectors.
+ */
+template <typename T> void qrFactorInPlace(MatrixView<T> A, std::vector<T> &tau);
+
+/**
+ * @brief Applies the orthogonal factor of a block factored in place
+ *
+ * Computes C = Q * C, or C = Q^T * C when transpose is set, one block of
+ * QRBlockSize reflectors at a time.
+ *
+ * @tparam T The type of the matrix elements.
+ * @param factors The block as left by qrFactorInPlace.
+ * @param tau The scalar factors returned by qrFactorInPlace.
+ * @param transpose Apply Q^T instead of Q.
+ * @param C View of a matrix with as many rows as the factored block.
+ * @throws std::runtime_error If the row counts do not match.
+ */
+template <typename T>
+void applyHouseholder(ConstMatrixView<T> factors, const std::vector<T> &tau,
+                      bool transpose, MatrixView<T> C);
+
+/**
+ * @brief Householder QR factorization stored in place
+ *
+ * The reflectors live in the lower part of the factored matrix, so Q is never
+ * formed unless requested: it is applied to other matrices block by block
+ * through the compact WY representation.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> class QR {
+public:
+  Matrix<T> _factors;
+  std::vector<T> _tau;
+
+public:
+  /**
+   * @brief Default constructor for an empty factorization
+   */
+  QR() {}
+
+  /**
+   * @brief Factors the given matrix
+   *
+   * The matrix is taken by value and factored in its own storage; pass it
+   * with std::move to avoid the copy.
+   *
+   * @param matrix The m x n matrix to factor.
+   */
+  explicit QR(Matrix<T> matrix);
+
+public:
+  /**
+   * @brief Unpacks the upper triangular factor
+   *
+   * @return Matrix<T> The min(m, n) x n matrix R.
+   */
+  Matrix<T> upper() const;
+
+  /**
+   * @brief Forms the orthogonal factor
+   *
+   * @param full Form the full m x m matrix instead of the first min(m, n)
+   * columns.
+   * @return Matrix<T> The matrix Q.
+   */
+  Matrix<T> orthogonal(bool full = false) const;
+
+  /**
+   * @brief Computes C = Q * C in place
+   *
+   * @param C View of a matrix with m rows.
+   * @throws std::runtime_error If C does not have m rows.
+   */
+  void applyQ(MatrixView<T> C) const;
+
+  /**
+   * @brief Computes C = Q^T * C in place
+   *
+   * @param C View of a matrix with m rows.
+   * @throws std::runtime_error If C does not have m rows.
+   */
+  void applyQTransposed(MatrixView<T> C) const;
+
+  /**
+   * @brief Check if R has no negligible entry on its diagonal
+   *
+   * @return true The factored matrix has full column rank
+   * @return false The factored matrix is rank deficient
+   */
+  bool isFullRank() const;
+
+  /**
+   * @brief Least-squares solution of A * x = b
+   *
+   * @param constants The column vector b with m rows.
+   * @return Vector<T> The n components of x.
+   * @throws std::runtime_error If the dimensions do not match, the system is
+   * underdetermined or A is rank deficient.
+   */
+  Vector<T> solve(const Vector<T> &constants) const;
+
+  /**
+   * @brief Least-squares solution of A * X = B for every column of B
+   *
+   * @param constants The m x nrhs matrix B.
+   * @return Matrix<T> The n x nrhs solutions X.
+   * @throws std::runtime_error If the dimensions do not match, the system is
+   * underdetermined or A is rank deficient.
+   */
+  Matrix<T> solve(const Matrix<T> &constants) const;
+
+private:
+  void solve(const T *constants, std::size_t nrhs, T *variables) const;
+};
+typedef QR<double> QRD;
+typedef QR<float> QRF;
+} // namespace MWP
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cmath>
+#include <complex>
+#include <type_traits>
+
+namespace MWP {
+
+/**
+ * @brief Check if a scalar type is a std::complex
+ *
+ * @tparam T The scalar type.
+ */
+template <typename T> struct IsComplex : std::false_type {};
+template <typename R> struct IsComplex<std::complex<R>> : std::true_type {};
+
+/**
+ * @brief Real type underlying a scalar type
+ *
+ * The type itself for real scalars, R for std::complex<R>.
+ *
+ * @tparam T The scalar type.
+ */
+template <typename T> struct RealType {
+  typedef T type;
+};
+template <typename R> struct RealType<std::complex<R>> {
+  typedef R type;
+};
+
+/**
+ * @brief Absolute value of a scalar in double precision
+ *
+ * Pivot searches compare magnitudes, which complex numbers do not order by
+ * themselves.
+ */
+template <typename T> inline double magnitude(T value) {
+  return std::abs((double)value);
+}
+template <typename R> inline double magnitude(std::complex<R> value) {
+  return std::abs(std::complex<double>(value));
+}
+
+/**
+ * @brief Squared absolute value of a scalar in double precision
+ */
+template <typename T> inline double squaredMagnitude(T value) {
+  return (double)value * (double)value;
+}
+template <typename R> inline double squaredMagnitude(std::complex<R> value) {
+  return std::norm(std::complex<double>(value));
+}
+
+/**
+ * @brief Complex conjugate of a scalar, the scalar itself when it is real
+ */
+template <typename T> inline T conjugate(T value) { return value; }
+template <typename R>
+inline std::complex<R> conjugate(std::complex<R> value) {
+  return std::conj(value);
+}
+
+} // namespace MWP
@@ -0,0 +1,326 @@
+#pragma once
+
+#include "Config.hpp"
+#include "Scalar.hpp"
+#include <complex>
+#include <cstddef>
+
+namespace MWP {
+namespace simd {
+
+/**
+ * @brief Instruction set used by the element-wise kernels
+ *
+ * The level is detected once with cpuid the first time a kernel runs. It can
+ * be capped with the MWP_SIMD environment variable (scalar, sse2, avx2 or
+ * avx512), which is useful to compare the variants on a single machine.
+ */
+enum class Level { Scalar, SSE2, AVX2, AVX512 };
+
+/**
+ * @brief Instruction set selected for this process
+ *
+ * @return Level The widest level supported by both the CPU and the OS.
+ */
+MWP_INLINE Level activeLevel();
+
+/**
+ * @brief Name of an instruction set level
+ *
+ * @param level The level.
+ * @return const char* A lower case name such as "avx2".
+ */
+MWP_INLINE const char *levelName(Level level);
+
+/**
+ * @brief Element-wise addition, out = x + y
+ *
+ * @tparam T The type of the elements.
+ * @param n Number of elements.
+ * @param x First operand.
+ * @param y Second operand.
+ * @param out Destination, may alias x or y.
+ */
+template <typename T>
+inline void add(std::size_t n, const T *x, const T *y, T *out) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = x[i] + y[i];
+  }
+}
+
+/**
+ * @brief Element-wise subtraction, out = x - y
+ *
+ * @tparam T The type of the elements.
+ * @param n Number of elements.
+ * @param x First operand.
+ * @param y Second operand.
+ * @param out Destination, may alias x or y.
+ */
+template <typename T>
+inline void sub(std::size_t n, const T *x, const T *y, T *out) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = x[i] - y[i];
+  }
+}
+
+/**
+ * @brief Scaling by a scalar, out = alpha * x
+ *
+ * @tparam T The type of the elements.
+ * @param n Number of elements.
+ * @param alpha The scalar.
+ * @param x Operand.
+ * @param out Destination, may alias x.
+ */
+template <typename T>
+inline void scale(std::size_t n, T alpha, const T *x, T *out) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = x[i] * alpha;
+  }
+}
+
+/**
+ * @brief Scaled accumulation, y = y + alpha * x
+ *
+ * @tparam T The type of the elements.
+ * @param n Number of elements.
+ * @param alpha The scalar.
+ * @param x Operand.
+ * @param y Accumulator.
+ */
+template <typename T>
+inline void axpy(std::size_t n, T alpha, const T *x, T *y) {
+  for (std::size_t i = 0; i < n; i++) {
+    y[i] += alpha * x[i];
+  }
+}
+
+/**
+ * @brief Element-wise multiply-accumulate, z = z + x * y
+ *
+ * @tparam T The type of the elements.
+ * @param n Number of elements.
+ * @param x First factor.
+ * @param y Second factor.
+ * @param z Accumulator.
+ */
+template <typename T>
+inline void multiplyAdd(std::size_t n, const T *x, const T *y, T *z) {
+  for (std::size_t i = 0; i < n; i++) {
+    z[i] += x[i] * y[i];
+  }
+}
+
+/**
+ * @brief Dot product of two arrays
+ *
+ * @tparam T The type of the elements.
+ * @param n Number of elements.
+ * @param x First operand.
+ * @param y Second operand.
+ * @return T The sum of x[i] * y[i].
+ */
+template <typename T> inline T dot(std::size_t n, const T *x, const T *y) {
+  T sum = (T)0;
+  for (std::size_t i = 0; i < n; i++) {
+    sum += x[i] * y[i];
+  }
+  return sum;
+}
+
+/**
+ * @brief Conjugated dot product of two arrays, x^H * y
+ *
+ * Same as dot() for real types.
+ *
+ * @tparam T The type of the elements.
+ * @param n Number of elements.
+ * @param x First operand, conjugated.
+ * @param y Second operand.
+ * @return T The sum of conj(x[i]) * y[i].
+ */
+template <typename T>
+inline T dotConjugate(std::size_t n, const T *x, const T *y) {
+  T sum = (T)0;
+  for (std::size_t i = 0; i < n; i++) {
+    sum += conjugate(x[i]) * y[i];
+  }
+  return sum;
+}
+
+/**
+ * @brief Scaled addition of a conjugated array, y = y + alpha * conj(x)
+ *
+ * Same as axpy() for real types.
+ *
+ * @tparam T The type of the elements.
+ * @param n Number of elements.
+ * @param alpha Scalar factor.
+ * @param x Operand, conjugated.
+ * @param y Accumulator.
+ */
+template <typename T>
+inline void axpyConjugate(std::size_t n, T alpha, const T *x, T *y) {
+  for (std::size_t i = 0; i < n; i++) {
+    y[i] += alpha * conjugate(x[i]);
+  }
+}
+
+/**
+ * @brief Sum of squared magnitudes of an array, accumulated in double
+ * precision
+ *
+ * @tparam T The type of the elements.
+ * @param n Number of elements.
+ * @param x Operand.
+ * @return double The sum of |x[i]|^2.
+ */
+template <typename T> inline double sumSquares(std::size_t n, const T *x) {
+  double sum = 0.0;
+  for (std::size_t i = 0; i < n; i++) {
+    sum += squaredMagnitude(x[i]);
+  }
+  return sum;
+}
+
+/**
+ * @brief Out-of-place transpose of a block, b = a^T
+ *
+ * Meant for cache-sized tiles; MWP::transpose splits larger matrices into
+ * such tiles. Double precision transposes 2 x 2, 4 x 4 or 8 x 8 blocks in
+ * registers, depending on the level.
+ *
+ * @tparam T The type of the elements.
+ * @param rows Number of rows of a.
+ * @param columns Number of columns of a.
+ * @param a Source block, row-major.
+ * @param lda Leading dimension (row stride) of a.
+ * @param b Destination block of columns x rows, must not overlap a.
+ * @param ldb Leading dimension (row stride) of b.
+ */
+template <typename T>
+inline void transpose(std::size_t rows, std::size_t columns, const T *a,
+                      std::size_t lda, T *b, std::size_t ldb) {
+  for (std::size_t i = 0; i < rows; i++) {
+    for (std::size_t j = 0; j < columns; j++) {
+      b[j * ldb + i] = a[i * lda + j];
+    }
+  }
+}
+
+/**
+ * @brief Register-blocked micro-kernel of the packed GEMM engine
+ *
+ * run(kc, alpha, a, b, C, ldc, rows, columns) multiplies an mr x kc panel of
+ * A, packed as kc groups of mr elements, by a kc x nr panel of B, packed as
+ * kc groups of nr elements, and adds alpha times the leading rows x columns
+ * of the mr x nr product to C.
+ *
+ * @tparam T The type of the elements.
+ */
+template <typename T> struct GemmMicroKernel {
+  std::size_t mr;
+  std::size_t nr;
+  void (*run)(std::size_t kc, T alpha, const T *a, const T *b, T *C,
+              std::size_t ldc, std::size_t rows, std::size_t columns);
+};
+
+/**
+ * @brief Portable GEMM micro-kernel accumulating an MR x NR tile
+ *
+ * @tparam T The type of the elements.
+ * @tparam MR Rows of the tile.
+ * @tparam NR Columns of the tile.
+ */
+template <typename T, std::size_t MR, std::size_t NR>
+inline void gemmTile(std::size_t kc, T alpha, const T *a, const T *b, T *C,
+                     std::size_t ldc, std::size_t rows, std::size_t columns) {
+  T acc[MR * NR] = {};
+  for (std::size_t p = 0; p < kc; p++) {
+    for (std::size_t i = 0; i < MR; i++) {
+      const T ai = a[i];
+      for (std::size_t j = 0; j < NR; j++) {
+        acc[i * NR + j] += ai * b[j];
+      }
+    }
+    a += MR;
+    b += NR;
+  }
+  for (std::size_t i = 0; i < rows; i++) {
+    for (std::size_t j = 0; j < columns; j++) {
+      C[i * ldc + j] += alpha * acc[i * NR + j];
+    }
+  }
+}
+
+/**
+ * @brief GEMM micro-kernel of the active level
+ *
+ * Double and single precision broadcast each element of the A panel and
+ * multiply-add it with the B row held in registers, on a tile sized to the
+ * AVX2 or AVX-512 register file; a float tile has twice the columns. Lower
+ * levels and other types use the portable loop.
+ *
+ * @tparam T The type of the elements.
+ * @return GemmMicroKernel<T> The tile size and the kernel computing it.
+ */
+template <typename T> inline GemmMicroKernel<T> gemmMicroKernel() {
+  return {4, 8, gemmTile<T, 4, 8>};
+}
+
+template <>
+MWP_INLINE void add<double>(std::size_t n, const double *x, const double *y,
+                            double *out);
+template <>
+MWP_INLINE void sub<double>(std::size_t n, const double *x, const double *y,
+                            double *out);
+template <>
+MWP_INLINE void scale<double>(std::size_t n, double alpha, const double *x,
+                              double *out);
+template <>
+MWP_INLINE void axpy<double>(std::size_t n, double alpha, const double *x,
+                             double *y);
+template <>
+MWP_INLINE void multiplyAdd<double>(std::size_t n, const double *x,
+                                    const double *y, double *z);
+template <>
+MWP_INLINE double dot<double>(std::size_t n, const double *x, const double *y);
+template <>
+MWP_INLINE double sumSquares<double>(std::size_t n, const double *x);
+template <>
+MWP_INLINE void transpose<double>(std::size_t rows, std::size_t columns,
+                                  const double *a, std::size_t lda, double *b,
+                                  std::size_t ldb);
+template <> MWP_INLINE GemmMicroKernel<double> gemmMicroKernel<double>();
+template <> MWP_INLINE GemmMicroKernel<float> gemmMicroKernel<float>();
+template <>
+MWP_INLINE void axpy<float>(std::size_t n, float alpha, const float *x,
+                            float *y);
+template <>
+MWP_INLINE float dot<float>(std::size_t n, const float *x, const float *y);
+template <>
+MWP_INLINE void axpy<std::complex<double>>(std::size_t n,
+                                           std::complex<double> alpha,
+                                           const std::complex<double> *x,
+                                           std::complex<double> *y);
+template <>
+MWP_INLINE void axpyConjugate<std::complex<double>>(
+    std::size_t n, std::complex<double> alpha, const std::complex<double> *x,
+    std::complex<double> *y);
+template <>
+MWP_INLINE void multiplyAdd<std::complex<double>>(
+    std::size_t n, const std::complex<double> *x,
+    const std::complex<double> *y, std::complex<double> *z);
+template <>
+MWP_INLINE std::complex<double>
+dot<std::complex<double>>(std::size_t n, const std::complex<double> *x,
+                          const std::complex<double> *y);
+template <>
+MWP_INLINE std::complex<double>
+dotConjugate<std::complex<double>>(std::size_t n,
+                                   const std::complex<double> *x,
+                                   const std::complex<double> *y);
+
+} // namespace simd
+} // namespace MWP
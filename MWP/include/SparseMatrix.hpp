@@ -0,0 +1,190 @@
+#pragma once
+
+#include "Matrix.hpp"
+#include "Vector.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace MWP {
+
+/**
+ * @brief Storage layout of a sparse matrix
+ *
+ * CSR compresses the rows: the nonzeros are stored row after row. CSC
+ * compresses the columns: the nonzeros are stored column after column.
+ */
+enum class SparseFormat { CSR, CSC };
+
+/**
+ * @brief A nonzero given by its position, used to assemble sparse matrices
+ */
+template <typename T> struct Triplet {
+  std::size_t _row;
+  std::size_t _column;
+  T _value;
+};
+
+/**
+ * @brief Sparse matrix in compressed-row or compressed-column format
+ *
+ * Only the nonzeros are stored. The major dimension is the rows for CSR and
+ * the columns for CSC: the nonzeros of major line l are
+ * _values[_offsets[l] .. _offsets[l + 1]), with their minor positions in
+ * _indices, sorted increasingly.
+ *
+ * Products walking the major lines (SpMV in CSR, transpose-SpMV in CSC) are
+ * split across the thread pool by nonzero count. Products scattering along
+ * the minor lines accumulate into one buffer per thread which are reduced at
+ * the end, so the transpose is never materialized.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> class SparseMatrix {
+public:
+  std::size_t _rows;
+  std::size_t _columns;
+  SparseFormat _format;
+  std::vector<std::size_t> _offsets;
+  std::vector<std::size_t> _indices;
+  std::vector<T> _values;
+
+public:
+  /**
+   * @brief Default constructor for an empty sparse matrix
+   */
+  SparseMatrix();
+
+  /**
+   * @brief Constructor for a sparse matrix with no nonzeros
+   *
+   * @param rows The number of rows in the matrix.
+   * @param columns The number of columns in the matrix.
+   * @param format The storage layout.
+   */
+  SparseMatrix(std::size_t rows, std::size_t columns,
+               SparseFormat format = SparseFormat::CSR);
+
+  /**
+   * @brief Assembles a sparse matrix from a list of nonzeros
+   *
+   * The triplets may come in any order; duplicates are summed, as is usual
+   * when assembling finite-element matrices.
+   *
+   * @param rows The number of rows in the matrix.
+   * @param columns The number of columns in the matrix.
+   * @param triplets The nonzeros.
+   * @param format The storage layout.
+   * @throws std::runtime_error If a triplet lies outside the matrix.
+   */
+  SparseMatrix(std::size_t rows, std::size_t columns,
+               const std::vector<Triplet<T>> &triplets,
+               SparseFormat format = SparseFormat::CSR);
+
+  /**
+   * @brief Compresses the nonzeros of a dense matrix
+   *
+   * @param matrix The dense matrix.
+   * @param format The storage layout.
+   */
+  explicit SparseMatrix(const Matrix<T> &matrix,
+                        SparseFormat format = SparseFormat::CSR);
+
+public:
+  /**
+   * @brief Number of stored nonzeros
+   */
+  std::size_t nonZeros() const;
+
+  /**
+   * @brief Element (row, column), found by binary search
+   *
+   * @return T The element, or zero if it is not stored.
+   * @throws std::runtime_error If the position lies outside the matrix.
+   */
+  T operator()(std::size_t row, std::size_t column) const;
+
+  /**
+   * @brief Expands the matrix into a dense one
+   */
+  Matrix<T> toDense() const;
+
+  /**
+   * @brief Copy of the matrix in compressed-row format
+   */
+  SparseMatrix<T> toCSR() const;
+
+  /**
+   * @brief Copy of the matrix in compressed-column format
+   */
+  SparseMatrix<T> toCSC() const;
+
+  /**
+   * @brief Transpose of the matrix
+   *
+   * Reinterprets the compressed lines, so no element moves: the transpose
+   * of a CSR matrix is returned in CSC format and the other way around.
+   */
+  SparseMatrix<T> transposed() const;
+
+  /**
+   * @brief Sparse matrix-vector product, A * x
+   *
+   * @param vector The column vector x.
+   * @return Vector<T> The column vector A * x.
+   * @throws std::runtime_error If the dimensions do not match.
+   */
+  Vector<T> operator*(const Vector<T> &vector) const;
+
+  /**
+   * @brief Transposed sparse matrix-vector product, A^T * x
+   *
+   * @param vector The column vector x.
+   * @return Vector<T> The column vector A^T * x.
+   * @throws std::runtime_error If the dimensions do not match.
+   */
+  Vector<T> multiplyTransposed(const Vector<T> &vector) const;
+
+  /**
+   * @brief Sparse times dense matrix product, A * B
+   *
+   * @param matrix The dense matrix B.
+   * @return Matrix<T> The dense matrix A * B.
+   * @throws std::runtime_error If the dimensions do not match.
+   */
+  Matrix<T> operator*(const Matrix<T> &matrix) const;
+
+  /**
+   * @brief Transposed sparse times dense matrix product, A^T * B
+   *
+   * @param matrix The dense matrix B.
+   * @return Matrix<T> The dense matrix A^T * B.
+   * @throws std::runtime_error If the dimensions do not match.
+   */
+  Matrix<T> multiplyTransposed(const Matrix<T> &matrix) const;
+
+  /**
+   * @brief Computes y = A * x on raw arrays
+   *
+   * Lets iterative solvers reuse their buffers between products.
+   *
+   * @param x Input array of size columns.
+   * @param y Output array of size rows, overwritten.
+   */
+  void multiply(const T *x, T *y) const;
+
+  /**
+   * @brief Computes y = A^T * x on raw arrays
+   *
+   * @param x Input array of size rows.
+   * @param y Output array of size columns, overwritten.
+   */
+  void multiplyTransposed(const T *x, T *y) const;
+
+private:
+  std::size_t majorSize() const;
+  void product(bool transpose, const T *B, std::size_t k, T *C) const;
+};
+
+typedef SparseMatrix<double> SparseMatrixD;
+typedef SparseMatrix<float> SparseMatrixF;
+} // namespace MWP
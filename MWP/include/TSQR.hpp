@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Matrix.hpp"
+#include "MatrixView.hpp"
+#include "QR.hpp"
+#include "Vector.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace MWP {
+
+/**
+ * @brief Tall-skinny QR factorization with a parallel reduction tree
+ *
+ * The rows are split into blocks that are factored independently by the
+ * thread pool. Their R factors are then paired level by level, each pair
+ * being stacked and factored again, until a single n x n R remains.
+ *
+ * Q is kept implicit as the reflectors of every leaf, stored in place below
+ * the diagonal of its block, and the small QR of every tree node: the
+ * factorization needs memory linear in the number of rows and Q is only
+ * applied, never formed, by the multiply and solve methods.
+ *
+ * @tparam T The type of the matrix elements.
+ */
+template <typename T> class TSQR {
+public:
+  Matrix<T> _factors;
+  std::vector<std::size_t> _leafStarts;
+  std::vector<std::vector<T>> _leafTau;
+  std::vector<std::vector<QR<T>>> _levels;
+  Matrix<T> _upper;
+
+public:
+  /**
+   * @brief Default constructor for an empty factorization
+   */
+  TSQR() {}
+
+  /**
+   * @brief Factors the given matrix
+   *
+   * The matrix is taken by value and its leaves are factored in its own
+   * storage; pass it with std::move to avoid the copy.
+   *
+   * @param matrix The m x n matrix to factor, with m >= n.
+   * @param blocks Number of row blocks. Zero uses one block per thread of the
+   * pool. Every block keeps at least n rows, so fewer may be used.
+   * @throws std::runtime_error If the matrix has fewer rows than columns.
+   */
+  explicit TSQR(Matrix<T> matrix, unsigned int blocks = 0);
+
+public:
+  /**
+   * @brief The upper triangular factor
+   *
+   * @return const Matrix<T>& The n x n matrix R.
+   */
+  const Matrix<T> &upper() const;
+
+  /**
+   * @brief Number of row blocks factored independently
+   *
+   * @return std::size_t The number of leaves of the reduction tree.
+   */
+  std::size_t blocks() const;
+
+  /**
+   * @brief Computes Q^T * B with the thin m x n factor Q
+   *
+   * @param B The m x k matrix.
+   * @return Matrix<T> The n x k product.
+   * @throws std::runtime_error If B does not have m rows.
+   */
+  Matrix<T> multiplyQTransposed(const Matrix<T> &B) const;
+
+  /**
+   * @brief Computes Q * X with the thin m x n factor Q
+   *
+   * @param X The n x k matrix.
+   * @return Matrix<T> The m x k product.
+   * @throws std::runtime_error If X does not have n rows.
+   */
+  Matrix<T> multiplyQ(const Matrix<T> &X) const;
+
+  /**
+   * @brief Forms the thin orthogonal factor
+   *
+   * @return Matrix<T> The m x n matrix Q.
+   */
+  Matrix<T> orthogonal() const;
+
+  /**
+   * @brief Least-squares solution of A * x = b
+   *
+   * @param constants The column vector b with m rows.
+   * @return Vector<T> The n components of x.
+   * @throws std::runtime_error If the dimensions do not match or A is rank
+   * deficient.
+   */
+  Vector<T> solve(const Vector<T> &constants) const;
+
+  /**
+   * @brief Least-squares solution of A * X = B for every column of B
+   *
+   * @param constants The m x nrhs matrix B.
+   * @return Matrix<T> The n x nrhs solutions X.
+   * @throws std::runtime_error If the dimensions do not match or A is rank
+   * deficient.
+   */
+  Matrix<T> solve(const Matrix<T> &constants) const;
+
+private:
+  std::size_t nodeRow(std::size_t level, std::size_t node) const;
+  void applyNode(const QR<T> &qr, bool transpose, T *work, std::size_t k,
+                 std::size_t topRow, std::size_t bottomRow) const;
+};
+typedef TSQR<double> TSQRD;
+typedef TSQR<float> TSQRF;
+} // namespace MWP
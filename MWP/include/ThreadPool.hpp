@@ -0,0 +1,123 @@
+#pragma once
+
+#include "Config.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace MWP {
+
+/**
+ * @brief Fixed-size pool of worker threads used by the parallel kernels
+ *
+ * The calling thread takes part in every parallel loop, so a pool of size N
+ * owns N - 1 workers. Parallel loops started from inside a task run serially
+ * on the calling worker.
+ */
+class ThreadPool {
+private:
+  std::vector<std::thread> _workers;
+  // Workers plus the caller; readable without the locks guarding _workers.
+  std::atomic<unsigned int> _size;
+  std::mutex _submitMutex;
+  std::mutex _mutex;
+  std::condition_variable _wakeWorkers;
+  std::condition_variable _jobDone;
+  const std::function<void(std::size_t)> *_task;
+  std::size_t _count;
+  std::size_t _next;
+  std::size_t _active;
+  std::size_t _generation;
+  std::exception_ptr _error;
+  bool _stop;
+
+public:
+  /**
+   * @brief Constructor for the ThreadPool class.
+   *
+   * @param threads Total number of threads, including the caller. Zero
+   * selects the number of hardware threads.
+   */
+  MWP_INLINE explicit ThreadPool(unsigned int threads);
+
+  MWP_INLINE ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+public:
+  /**
+   * @brief The pool shared by every MWP kernel
+   *
+   * Its size is read from the MWP_NUM_THREADS environment variable on first
+   * use and defaults to the number of hardware threads.
+   *
+   * @return ThreadPool& The global pool.
+   */
+  MWP_INLINE static ThreadPool &instance();
+
+  /**
+   * @brief Number of threads taking part in a parallel loop
+   *
+   * @return unsigned int Workers plus the calling thread.
+   */
+  MWP_INLINE unsigned int size() const;
+
+  /**
+   * @brief Changes the number of threads of the pool
+   *
+   * @param threads Total number of threads, including the caller. Zero
+   * selects the number of hardware threads.
+   */
+  MWP_INLINE void resize(unsigned int threads);
+
+  /**
+   * @brief Runs task(i) for every i in [0, count) and waits for completion
+   *
+   * Indices are handed out dynamically, so tasks of uneven cost balance
+   * across threads. The first exception thrown by a task is rethrown here.
+   *
+   * @param count Number of tasks.
+   * @param task Callable invoked once per index.
+   */
+  MWP_INLINE void parallelFor(std::size_t count,
+                              const std::function<void(std::size_t)> &task);
+
+private:
+  /**
+   * @brief Whether the calling thread is running tasks of a parallel loop
+   *
+   * Kept in a function rather than a namespace-scope variable so the
+   * header-only build shares a single flag across translation units.
+   */
+  MWP_INLINE static bool &insideParallelRegion();
+
+  MWP_INLINE void start(unsigned int threads);
+  MWP_INLINE void stop();
+  MWP_INLINE void workerLoop(std::size_t seenGeneration);
+  MWP_INLINE void runTasks();
+};
+
+/**
+ * @brief Sets the number of threads used by the parallel kernels
+ *
+ * Pinning the count makes benchmark runs reproducible.
+ *
+ * @param threads Total number of threads. Zero selects the number of
+ * hardware threads.
+ */
+MWP_INLINE void setNumThreads(unsigned int threads);
+
+/**
+ * @brief Number of threads used by the parallel kernels
+ *
+ * @return unsigned int Size of the global thread pool.
+ */
+MWP_INLINE unsigned int getNumThreads();
+
+} // namespace MWP
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+
+namespace MWP {
+
+/**
+ * @brief Order of the square tiles the transposes work on
+ *
+ * A source and a destination tile of doubles fit in L1 together, so the
+ * strided side of the copy stays in cache while a tile is transposed.
+ */
+constexpr std::size_t TransposeBlockSize = 32;
+
+/**
+ * @brief Transposes with at least this many elements use the thread pool
+ */
+constexpr std::size_t TransposeParallelThreshold = 512 * 512;
+
+/**
+ * @brief Out-of-place transpose on row-major storage, B = A^T
+ *
+ * The matrix is walked in TransposeBlockSize tiles, each transposed by
+ * simd::transpose with in-register blocks. Large matrices are split into
+ * bands of tile rows across the thread pool.
+ *
+ * @tparam T The type of the matrix elements.
+ * @param rows Number of rows of A.
+ * @param columns Number of columns of A.
+ * @param A Pointer to the first element of A.
+ * @param lda Leading dimension (row stride) of A.
+ * @param B Pointer to the first element of the columns x rows result, which
+ * must not overlap A.
+ * @param ldb Leading dimension (row stride) of B.
+ */
+template <typename T>
+void transpose(std::size_t rows, std::size_t columns, const T *A,
+               std::size_t lda, T *B, std::size_t ldb);
+
+/**
+ * @brief In-place transpose of a contiguous row-major matrix
+ *
+ * On return the buffer holds the columns x rows transpose. Square matrices
+ * swap mirrored tiles through a tile-sized buffer. Rectangular ones follow
+ * the cycles of the permutation, which only needs a bit per element to mark
+ * the visited positions but accesses memory with a large stride; the
+ * out-of-place transpose is faster when a second buffer is affordable.
+ *
+ * @tparam T The type of the matrix elements.
+ * @param rows Number of rows of A.
+ * @param columns Number of columns of A.
+ * @param A Pointer to the rows * columns elements of A.
+ */
+template <typename T>
+void transposeInPlace(std::size_t rows, std::size_t columns, T *A);
+
+} // namespace MWP
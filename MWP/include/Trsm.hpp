@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+namespace MWP {
+
+/**
+ * @brief Number of rows solved per diagonal block by the blocked TRSM
+ */
+constexpr std::size_t TrsmBlockSize = 64;
+
+/**
+ * @brief Triangular solve with multiple right-hand sides on row-major storage
+ *
+ * Solves op(A) * X = B for X and overwrites B with it, where A is n x n
+ * triangular and op(A) is A or its transpose. The rows of B are processed in
+ * blocks: each diagonal block is solved with row operations across all
+ * right-hand sides at once, and the rest of B is updated with one GEMM per
+ * block, so the bulk of the work runs at GEMM speed.
+ *
+ * @tparam T The type of the matrix elements.
+ * @param lower A is lower triangular; otherwise upper triangular.
+ * @param transA Use the transpose of A.
+ * @param unitDiagonal The diagonal of A is implicitly one and is not read.
+ * @param n Order of A and number of rows of B.
+ * @param nrhs Number of columns of B.
+ * @param A Pointer to the first element of A.
+ * @param lda Leading dimension (row stride) of A.
+ * @param B Pointer to the first element of B.
+ * @param ldb Leading dimension (row stride) of B.
+ */
+template <typename T>
+void trsm(bool lower, bool transA, bool unitDiagonal, std::size_t n,
+          std::size_t nrhs, const T *A, std::size_t lda, T *B, std::size_t ldb);
+
+} // namespace MWP
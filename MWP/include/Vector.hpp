@@ -1,18 +1,27 @@
 #pragma once
 
+#include "Allocator.hpp"
+#include "Config.hpp"
+#include "Expression.hpp"
+#include "Simd.hpp"
 #include <cmath>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 namespace MWP {
 
 template <typename T> class Matrix;
 
-template <typename T> class Vector {
+template <typename T> class Vector : public VectorExpression<Vector<T>> {
 public:
-  std::vector<T> _elements;
-  unsigned int _rows;
-  unsigned int _columns;
-  unsigned int _size;
+  typedef T value_type;
+
+  AlignedVector<T> _elements;
+  Index _rows;
+  Index _columns;
+  Index _size;
 
 public:
   /**
@@ -35,80 +44,127 @@ public:
    * @param rows The number of rows in the vector.
    * @param columns The number of columns in the vector.
    */
-  Vector(unsigned int rows, unsigned int columns);
+  Vector(Index rows, Index columns);
 
   /**
    * @brief Constructor for given elements and number of rows and columns
    *
    * Init the vector with given columns, rows and set the given
-   * elements
+   * elements. The elements are moved into the vector; pass them with
+   * std::move to avoid the copy.
    *
    * @tparam T The data type of the vector elements.
    * @param elements The elements of vector.
    * @param rows The number of rows in the vector.
    * @param columns The number of columns in the vector.
    */
-  Vector(std::vector<T> elements, unsigned int rows, unsigned int columns);
-public:
+  Vector(AlignedVector<T> elements, Index rows, Index columns);
+
   /**
-   * @brief Access the vector components by index
+   * @brief Constructor copying the given elements
    *
-   * This method allows for the access of the vector components by index.
+   * @param elements The elements of the vector.
+   * @param rows The number of rows in the vector.
+   * @param columns The number of columns in the vector.
+   */
+  Vector(const std::vector<T> &elements, Index rows, Index columns);
+  Vector(std::initializer_list<T> elements, Index rows, Index columns);
+
+  /**
+   * @brief Constructor taking over the elements of a std::vector
    *
-   * @param index The index of the component
-   * @return The value of the component
+   * A std::vector cannot hand its buffer over to the aligned storage, so the
+   * elements are copied once and the source is released, leaving it empty.
+   * Pass an AlignedVector instead to move the elements without a copy.
+   *
+   * @param elements The elements of the vector.
+   * @param rows The number of rows in the vector.
+   * @param columns The number of columns in the vector.
    */
-  T operator[](int index) const;
+  Vector(std::vector<T> &&elements, Index rows, Index columns);
 
   /**
-   * @brief Access the vector components by index
+   * @brief Constructor leaving the elements uninitialized
    *
-   * This method allows for the access of the vector components by index.
+   * For results that are entirely overwritten before being read. The
+   * dimensions are checked as in the zeroing constructor.
    *
-   * @param index The index of the component
-   * @return The reference to the component
+   * @param rows The number of rows in the vector.
+   * @param columns The number of columns in the vector.
    */
-  T &operator[](int index);
+  Vector(Index rows, Index columns, UninitializedTag);
 
   /**
-   * @brief Overloads the addition operator for Vector objects.
+   * @brief Constructor from a vector expression
    *
-   * This operator allows for the addition of two Vector objects.
-   * It returns a new Vector object whose components are the sum
-   * of the corresponding components of the two input vectors.
+   * Evaluates the expression in a single pass into the new vector.
    *
-   * @tparam T The type of the vector components.
-   * @param vector The vector to be added to the current vector.
-   * @return A new Vector object that is the result of the vector addition.
+   * @tparam E The expression type.
+   * @param expression The expression to evaluate.
    */
-  Vector<T> operator+(const Vector<T> &vector) const;
+  template <typename E> Vector(const VectorExpression<E> &expression);
 
   /**
-   * @brief Overloads the subtraction operator for Vector objects.
+   * @brief Assigns the result of a vector expression
    *
-   * This operator allows for the subtraction of two Vector objects.
-   * It returns a new Vector object whose components are the difference
-   * of the corresponding components of the two input vectors.
+   * The current storage is reused when the dimensions match.
    *
-   * @tparam T The type of the vector components.
-   * @param vector The vector to be subtracted from the current vector.
-   * @return A new Vector object that is the result of the vector subtraction.
+   * @tparam E The expression type.
+   * @param expression The expression to evaluate.
+   * @return Vector<T>& The current vector.
    */
-  Vector<T> operator-(const Vector<T> &vector) const;
+  template <typename E> Vector<T> &operator=(const VectorExpression<E> &expression);
 
   /**
-   * @brief Overloads the multiplication operator for Vector objects.
+   * @brief Adds a vector expression to the current vector in place
+   *
+   * @tparam E The expression type.
+   * @param expression The expression to add.
+   * @return Vector<T>& The current vector.
+   * @throws std::runtime_error If the dimensions do not match.
+   */
+  template <typename E>
+  Vector<T> &operator+=(const VectorExpression<E> &expression);
+
+  /**
+   * @brief Subtracts a vector expression from the current vector in place
    *
-   * This operator allows for the multiplication of a Vector object by a
-   * scalar. It returns a new Vector object whose components are the product
-   * of the corresponding components of the input vector and the scalar.
+   * @tparam E The expression type.
+   * @param expression The expression to subtract.
+   * @return Vector<T>& The current vector.
+   * @throws std::runtime_error If the dimensions do not match.
+   */
+  template <typename E>
+  Vector<T> &operator-=(const VectorExpression<E> &expression);
+
+  /**
+   * @brief Scales the current vector in place
    *
-   * @tparam T The type of the vector components.
-   * @param scalar The scalar value to multiply the vector by.
-   * @return A new Vector object that is the result of the vector-scalar
-   * multiplication.
+   * @param scalar The scalar factor.
+   * @return Vector<T>& The current vector.
    */
-  Vector<T> operator*(T scalar) const;
+  Vector<T> &operator*=(T scalar);
+
+public:
+  /**
+   * @brief Access the vector components by index
+   *
+   * This method allows for the access of the vector components by index.
+   *
+   * @param index The index of the component
+   * @return The value of the component
+   */
+  T operator[](Index index) const;
+
+  /**
+   * @brief Access the vector components by index
+   *
+   * This method allows for the access of the vector components by index.
+   *
+   * @param index The index of the component
+   * @return The reference to the component
+   */
+  T &operator[](Index index);
 
   /**
    * @brief Overloads the multiplication operator for Vector objects.
@@ -140,7 +196,56 @@ public:
 };
 
 typedef Vector<double> VectorD;
+typedef Vector<float> VectorF;
+typedef Vector<std::complex<double>> VectorCD;
+typedef Vector<std::complex<float>> VectorCF;
 typedef Vector<int> VectorI;
+
+template <typename T>
+template <typename E>
+Vector<T>::Vector(const VectorExpression<E> &expression)
+    : Vector((Index)expression.derived().rows(),
+             (Index)expression.derived().columns(), Uninitialized) {
+  const typename ExpressionStorage<E>::type node(expression.derived());
+  node.assignTo(_elements.data(), 1, (T)1, false);
+}
+
+template <typename T>
+template <typename E>
+Vector<T> &Vector<T>::operator=(const VectorExpression<E> &expression) {
+  const typename ExpressionStorage<E>::type node(expression.derived());
+  if (node.rows() != _rows || node.columns() != _columns) {
+    Vector<T> result(expression);
+    *this = std::move(result);
+    return *this;
+  }
+  node.assignTo(_elements.data(), 1, (T)1, false);
+  return *this;
+}
+
+template <typename T>
+template <typename E>
+Vector<T> &Vector<T>::operator+=(const VectorExpression<E> &expression) {
+  const typename ExpressionStorage<E>::type node(expression.derived());
+  if (node.rows() != _rows || node.columns() != _columns) {
+    throw std::runtime_error(
+        "Invalid vectors dimensions for addition operation");
+  }
+  node.assignTo(_elements.data(), 1, (T)1, true);
+  return *this;
+}
+
+template <typename T>
+template <typename E>
+Vector<T> &Vector<T>::operator-=(const VectorExpression<E> &expression) {
+  const typename ExpressionStorage<E>::type node(expression.derived());
+  if (node.rows() != _rows || node.columns() != _columns) {
+    throw std::runtime_error(
+        "Invalid vectors dimensions for subtraction operation");
+  }
+  node.assignTo(_elements.data(), 1, (T)-1, true);
+  return *this;
+}
 } // namespace MWP
 
 template <typename T>
@@ -153,11 +258,8 @@ inline MWP::Vector<T> transposeVector(const MWP::Vector<T> &vector) {
 template <typename T>
 inline T Dot(const MWP::Vector<T> &vector1, const MWP::Vector<T> &vector2) {
   // TODO: Check compatibility
-  T sum = (T)0;
-  for (int i = 0; i < vector1._size; i++) {
-    sum += vector1._elements[i] * vector2._elements[i];
-  }
-  return sum;
+  return MWP::simd::dot<T>(vector1._size, vector1._elements.data(),
+                           vector2._elements.data());
 }
 
 template <typename T>
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "Allocator.hpp"
+#include "Config.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace MWP {
+
+/**
+ * @brief Bump allocator for the scratch memory of the decompositions
+ *
+ * Every thread owns one workspace, returned by local(). Scratch blocks are
+ * carved out of a few large chunks by moving an offset, and are released all
+ * at once when the WorkspaceScope that allocated them ends, so the memory is
+ * reused by the next call instead of going back to the heap.
+ *
+ * A call needing more than the current capacity appends a chunk. Once every
+ * scope has ended the chunks are merged into one holding the peak usage, so
+ * a repeated call of the same size no longer allocates. reserve() does the
+ * same ahead of time.
+ */
+class Workspace {
+private:
+  struct Chunk {
+    unsigned char *data;
+    std::size_t size;
+  };
+
+  std::vector<Chunk> _chunks;
+  std::size_t _chunk;
+  std::size_t _offset;
+  std::size_t _used;
+  std::size_t _peak;
+
+public:
+  MWP_INLINE Workspace();
+  MWP_INLINE ~Workspace();
+
+  Workspace(const Workspace &) = delete;
+  Workspace &operator=(const Workspace &) = delete;
+
+public:
+  /**
+   * @brief The workspace of the calling thread
+   *
+   * @return Workspace& The thread-local workspace.
+   */
+  MWP_INLINE static Workspace &local();
+
+  /**
+   * @brief Makes sure the given number of bytes can be used without
+   * allocating
+   *
+   * Only takes effect while no scope is active.
+   *
+   * @param bytes The capacity to reserve.
+   */
+  MWP_INLINE void reserve(std::size_t bytes);
+
+  /**
+   * @brief Frees every chunk
+   *
+   * Only takes effect while no scope is active.
+   */
+  MWP_INLINE void release();
+
+  /**
+   * @brief Total size in bytes of the chunks
+   */
+  MWP_INLINE std::size_t capacity() const;
+
+  /**
+   * @brief Bytes handed out to the active scopes
+   */
+  MWP_INLINE std::size_t used() const;
+
+  /**
+   * @brief Largest number of bytes used at once since the last release
+   */
+  MWP_INLINE std::size_t peak() const;
+
+private:
+  friend class WorkspaceScope;
+
+  MWP_INLINE void *allocate(std::size_t bytes);
+  MWP_INLINE void rewind(std::size_t chunk, std::size_t offset,
+                         std::size_t used);
+  MWP_INLINE void resize(std::size_t bytes);
+};
+
+/**
+ * @brief Scratch allocations released together
+ *
+ * Scopes nest and must end in the reverse order of their creation, which
+ * holds as long as they are local variables. Blocks are aligned to
+ * StorageAlignment and left uninitialized.
+ */
+class WorkspaceScope {
+private:
+  Workspace &_workspace;
+  std::size_t _chunk;
+  std::size_t _offset;
+  std::size_t _used;
+
+public:
+  /**
+   * @brief Opens a scope on the given workspace
+   *
+   * @param workspace The workspace to allocate from, by default the one of
+   * the calling thread.
+   */
+  explicit WorkspaceScope(Workspace &workspace = Workspace::local())
+      : _workspace(workspace), _chunk(workspace._chunk),
+        _offset(workspace._offset), _used(workspace._used) {}
+
+  /**
+   * @brief Gives back every block allocated through this scope
+   */
+  ~WorkspaceScope() { _workspace.rewind(_chunk, _offset, _used); }
+
+  WorkspaceScope(const WorkspaceScope &) = delete;
+  WorkspaceScope &operator=(const WorkspaceScope &) = delete;
+
+public:
+  /**
+   * @brief Allocates an uninitialized block of elements
+   *
+   * @tparam T The type of the elements, which must not need destruction.
+   * @param count The number of elements.
+   * @return T* The first element of the block.
+   */
+  template <typename T> T *allocate(std::size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Workspace blocks are never destroyed");
+    return static_cast<T *>(_workspace.allocate(count * sizeof(T)));
+  }
+
+  /**
+   * @brief Allocates a block of elements set to a value
+   *
+   * @tparam T The type of the elements.
+   * @param count The number of elements.
+   * @param value The value of every element.
+   * @return T* The first element of the block.
+   */
+  template <typename T> T *allocate(std::size_t count, T value) {
+    T *block = allocate<T>(count);
+    std::fill(block, block + count, value);
+    return block;
+  }
+};
+
+} // namespace MWP
@@ -0,0 +1,354 @@
+#include "Batched.hpp"
+#include "Scalar.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+#include "Workspace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Runs task(first, count) over consecutive chunks of the batch lanes.
+template <typename Task> void forEachChunk(std::size_t batch, Task task) {
+  const std::size_t chunks =
+      (batch + MWP::BatchChunkSize - 1) / MWP::BatchChunkSize;
+  MWP::ThreadPool::instance().parallelFor(chunks, [&](std::size_t c) {
+    const std::size_t first = c * MWP::BatchChunkSize;
+    task(first, std::min(MWP::BatchChunkSize, batch - first));
+  });
+}
+
+// Divides every lane of x by the matching lane of d, leaving lanes with a
+// zero divisor untouched so integer batches never trap.
+template <typename T>
+void divideLanes(std::size_t count, const T *d, T *x) {
+  for (std::size_t l = 0; l < count; l++) {
+    if (d[l] != (T)0) {
+      x[l] /= d[l];
+    }
+  }
+}
+
+// Solves op(A) * X = B for the lanes [first, first + count). a and b point
+// at lane 0 of A and B; elements are batch lanes apart.
+template <typename T>
+void solveTriangular(bool lower, bool transA, bool unitDiagonal,
+                     std::size_t n, std::size_t nrhs, std::size_t batch,
+                     const T *a, T *b, std::size_t first, std::size_t count,
+                     T *sum) {
+  // op(A)(i, k) of every lane.
+  auto element = [&](std::size_t i, std::size_t k) {
+    return transA ? a + (k * n + i) * batch + first
+                  : a + (i * n + k) * batch + first;
+  };
+  auto rhs = [&](std::size_t i, std::size_t j) {
+    return b + (i * nrhs + j) * batch + first;
+  };
+  const bool forward = lower != transA;
+  for (std::size_t step = 0; step < n; step++) {
+    const std::size_t i = forward ? step : n - 1 - step;
+    const std::size_t k0 = forward ? 0 : i + 1;
+    const std::size_t k1 = forward ? i : n;
+    for (std::size_t j = 0; j < nrhs; j++) {
+      std::fill(sum, sum + count, (T)0);
+      for (std::size_t k = k0; k < k1; k++) {
+        MWP::simd::multiplyAdd<T>(count, element(i, k), rhs(k, j), sum);
+      }
+      MWP::simd::sub<T>(count, rhs(i, j), sum, rhs(i, j));
+      if (!unitDiagonal) {
+        divideLanes(count, element(i, i), rhs(i, j));
+      }
+    }
+  }
+}
+
+template <typename T>
+void checkBatches(const MWP::BatchedMatrix<T> &A,
+                  const MWP::BatchedMatrix<T> &B) {
+  if (A._batch != B._batch) {
+    throw std::runtime_error("Incompatible batch sizes");
+  }
+}
+
+} // namespace
+
+template <typename T>
+MWP::BatchedMatrix<T>::BatchedMatrix() : _batch(0), _rows(0), _columns(0) {}
+
+template <typename T>
+MWP::BatchedMatrix<T>::BatchedMatrix(std::size_t batch, std::size_t rows,
+                                     std::size_t columns)
+    : _batch(batch), _rows(rows), _columns(columns),
+      _elements(batch * rows * columns, (T)0) {}
+
+template <typename T>
+void MWP::BatchedMatrix<T>::set(std::size_t b, const Matrix<T> &matrix) {
+  if (b >= _batch) {
+    throw std::out_of_range("Batch index out of range");
+  }
+  if (matrix._rows != _rows || matrix._columns != _columns) {
+    throw std::runtime_error("Invalid matrix dimensions for the batch");
+  }
+  for (std::size_t e = 0; e < _rows * _columns; e++) {
+    _elements[e * _batch + b] = matrix._elements[e];
+  }
+}
+
+template <typename T>
+MWP::Matrix<T> MWP::BatchedMatrix<T>::get(std::size_t b) const {
+  if (b >= _batch) {
+    throw std::out_of_range("Batch index out of range");
+  }
+  Matrix<T> matrix(_rows, _columns);
+  for (std::size_t e = 0; e < _rows * _columns; e++) {
+    matrix._elements[e] = _elements[e * _batch + b];
+  }
+  return matrix;
+}
+
+template <typename T>
+void MWP::batchedGemm(T alpha, const BatchedMatrix<T> &A,
+                      const BatchedMatrix<T> &B, T beta, BatchedMatrix<T> &C) {
+  checkBatches(A, B);
+  checkBatches(A, C);
+  if (A._columns != B._rows || A._rows != C._rows ||
+      B._columns != C._columns) {
+    throw std::runtime_error(
+        "Invalid matrices dimensions for multiplication operation");
+  }
+  const std::size_t m = A._rows;
+  const std::size_t n = B._columns;
+  const std::size_t k = A._columns;
+  const std::size_t batch = A._batch;
+  forEachChunk(batch, [&](std::size_t first, std::size_t count) {
+    WorkspaceScope scope;
+    T *sum = scope.allocate<T>(count);
+    for (std::size_t i = 0; i < m; i++) {
+      for (std::size_t j = 0; j < n; j++) {
+        std::fill(sum, sum + count, (T)0);
+        for (std::size_t p = 0; p < k; p++) {
+          simd::multiplyAdd<T>(
+              count, A._elements.data() + (i * k + p) * batch + first,
+              B._elements.data() + (p * n + j) * batch + first, sum);
+        }
+        T *c = C._elements.data() + (i * n + j) * batch + first;
+        if (beta == (T)0) {
+          simd::scale<T>(count, alpha, sum, c);
+        } else {
+          simd::scale<T>(count, beta, c, c);
+          simd::axpy<T>(count, alpha, sum, c);
+        }
+      }
+    }
+  });
+}
+
+template <typename T>
+void MWP::batchedTrsm(bool lower, bool transA, bool unitDiagonal,
+                      const BatchedMatrix<T> &A, BatchedMatrix<T> &B) {
+  checkBatches(A, B);
+  if (A._rows != A._columns || A._rows != B._rows) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants matrix");
+  }
+  forEachChunk(A._batch, [&](std::size_t first, std::size_t count) {
+    WorkspaceScope scope;
+    T *sum = scope.allocate<T>(count);
+    solveTriangular(lower, transA, unitDiagonal, A._rows, B._columns,
+                    A._batch, A._elements.data(), B._elements.data(), first,
+                    count, sum);
+  });
+}
+
+template <typename T>
+MWP::BatchedLU<T>::BatchedLU(BatchedMatrix<T> matrices)
+    : _factors(std::move(matrices)) {
+  if (_factors._rows != _factors._columns) {
+    throw std::runtime_error(
+        "The matrix should be square to be decomposed into LU matrices!");
+  }
+  const std::size_t n = _factors._rows;
+  const std::size_t batch = _factors._batch;
+  _pivots.assign(n * batch, 0);
+  _nonsingular.assign(batch, 1);
+  T *a = _factors._elements.data();
+  forEachChunk(batch, [&](std::size_t first, std::size_t count) {
+    auto element = [&](std::size_t i, std::size_t j) {
+      return a + (i * n + j) * batch + first;
+    };
+    // Negated multipliers of the current column, one row of lanes per row.
+    WorkspaceScope scope;
+    T *negated = scope.allocate<T>(n * count);
+    for (std::size_t k = 0; k < n; k++) {
+      // Pivot search and row interchange are the only per-lane steps.
+      for (std::size_t l = 0; l < count; l++) {
+        std::size_t pivot = k;
+        double largest = MWP::magnitude(element(k, k)[l]);
+        for (std::size_t i = k + 1; i < n; i++) {
+          if (MWP::magnitude(element(i, k)[l]) > largest) {
+            largest = MWP::magnitude(element(i, k)[l]);
+            pivot = i;
+          }
+        }
+        _pivots[k * batch + first + l] = pivot;
+        if (pivot != k) {
+          for (std::size_t j = 0; j < n; j++) {
+            std::swap(element(k, j)[l], element(pivot, j)[l]);
+          }
+        }
+        if (largest == 0.0) {
+          _nonsingular[first + l] = 0;
+        }
+      }
+      const T *diagonal = element(k, k);
+      for (std::size_t i = k + 1; i < n; i++) {
+        T *multiplier = element(i, k);
+        divideLanes(count, diagonal, multiplier);
+        // A zero pivot leaves a zero column below it, so its lanes skip the
+        // update through zero multipliers.
+        simd::scale<T>(count, (T)-1, multiplier, negated + i * count);
+      }
+      for (std::size_t i = k + 1; i < n; i++) {
+        for (std::size_t j = k + 1; j < n; j++) {
+          simd::multiplyAdd<T>(count, negated + i * count,
+                               element(k, j), element(i, j));
+        }
+      }
+    }
+  });
+}
+
+template <typename T>
+bool MWP::BatchedLU<T>::isNonsingular(std::size_t b) const {
+  return _nonsingular.at(b) != 0;
+}
+
+template <typename T>
+void MWP::BatchedLU<T>::solveInPlace(BatchedMatrix<T> &B) const {
+  checkBatches(_factors, B);
+  if (B._rows != _factors._rows) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants matrix");
+  }
+  const std::size_t n = _factors._rows;
+  const std::size_t nrhs = B._columns;
+  const std::size_t batch = _factors._batch;
+  T *b = B._elements.data();
+  forEachChunk(batch, [&](std::size_t first, std::size_t count) {
+    for (std::size_t k = 0; k < n; k++) {
+      for (std::size_t l = first; l < first + count; l++) {
+        const std::size_t pivot = _pivots[k * batch + l];
+        if (pivot != k) {
+          for (std::size_t j = 0; j < nrhs; j++) {
+            std::swap(b[(k * nrhs + j) * batch + l],
+                      b[(pivot * nrhs + j) * batch + l]);
+          }
+        }
+      }
+    }
+    WorkspaceScope scope;
+    T *sum = scope.allocate<T>(count);
+    solveTriangular(true, false, true, n, nrhs, batch,
+                    _factors._elements.data(), b, first, count, sum);
+    solveTriangular(false, false, false, n, nrhs, batch,
+                    _factors._elements.data(), b, first, count, sum);
+  });
+}
+
+template <typename T>
+MWP::BatchedCholesky<T>::BatchedCholesky(BatchedMatrix<T> matrices)
+    : _factors(std::move(matrices)) {
+  if (_factors._rows != _factors._columns) {
+    throw std::runtime_error(
+        "The matrix should be square to be decomposed into Cholesky factors!");
+  }
+  const std::size_t n = _factors._rows;
+  const std::size_t batch = _factors._batch;
+  _positiveDefinite.assign(batch, 1);
+  T *a = _factors._elements.data();
+  forEachChunk(batch, [&](std::size_t first, std::size_t count) {
+    auto element = [&](std::size_t i, std::size_t j) {
+      return a + (i * n + j) * batch + first;
+    };
+    WorkspaceScope scope;
+    T *sum = scope.allocate<T>(count);
+    // Row-oriented Crout, as in the unbatched panel kernel.
+    for (std::size_t i = 0; i < n; i++) {
+      for (std::size_t j = 0; j <= i; j++) {
+        std::fill(sum, sum + count, (T)0);
+        for (std::size_t k = 0; k < j; k++) {
+          simd::multiplyAdd<T>(count, element(i, k), element(j, k), sum);
+        }
+        T *entry = element(i, j);
+        simd::sub<T>(count, entry, sum, entry);
+        if (j < i) {
+          divideLanes(count, element(j, j), entry);
+          continue;
+        }
+        for (std::size_t l = 0; l < count; l++) {
+          if (!(entry[l] > (T)0)) {
+            // The lane keeps going on a unit pivot so the others are not
+            // held back; its factors are meaningless.
+            _positiveDefinite[first + l] = 0;
+            entry[l] = (T)1;
+          } else {
+            entry[l] = (T)std::sqrt(entry[l]);
+          }
+        }
+      }
+    }
+  });
+}
+
+template <typename T>
+bool MWP::BatchedCholesky<T>::isPositiveDefinite(std::size_t b) const {
+  return _positiveDefinite.at(b) != 0;
+}
+
+template <typename T>
+void MWP::BatchedCholesky<T>::solveInPlace(BatchedMatrix<T> &B) const {
+  checkBatches(_factors, B);
+  if (B._rows != _factors._rows) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants matrix");
+  }
+  forEachChunk(_factors._batch, [&](std::size_t first, std::size_t count) {
+    WorkspaceScope scope;
+    T *sum = scope.allocate<T>(count);
+    solveTriangular(true, false, false, _factors._rows, B._columns,
+                    _factors._batch, _factors._elements.data(),
+                    B._elements.data(), first, count, sum);
+    solveTriangular(true, true, false, _factors._rows, B._columns,
+                    _factors._batch, _factors._elements.data(),
+                    B._elements.data(), first, count, sum);
+  });
+}
+
+#ifndef MWP_HEADER_ONLY
+template class MWP::BatchedMatrix<double>;
+template class MWP::BatchedMatrix<float>;
+template class MWP::BatchedMatrix<int>;
+template void MWP::batchedGemm<double>(double, const BatchedMatrix<double> &,
+                                       const BatchedMatrix<double> &, double,
+                                       BatchedMatrix<double> &);
+template void MWP::batchedGemm<float>(float, const BatchedMatrix<float> &,
+                                      const BatchedMatrix<float> &, float,
+                                      BatchedMatrix<float> &);
+template void MWP::batchedGemm<int>(int, const BatchedMatrix<int> &,
+                                    const BatchedMatrix<int> &, int,
+                                    BatchedMatrix<int> &);
+template void MWP::batchedTrsm<double>(bool, bool, bool,
+                                       const BatchedMatrix<double> &,
+                                       BatchedMatrix<double> &);
+template void MWP::batchedTrsm<float>(bool, bool, bool,
+                                      const BatchedMatrix<float> &,
+                                      BatchedMatrix<float> &);
+template void MWP::batchedTrsm<int>(bool, bool, bool,
+                                    const BatchedMatrix<int> &,
+                                    BatchedMatrix<int> &);
+template class MWP::BatchedLU<double>;
+template class MWP::BatchedLU<float>;
+template class MWP::BatchedCholesky<double>;
+template class MWP::BatchedCholesky<float>;
+#endif
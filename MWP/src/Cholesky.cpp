@@ -0,0 +1,176 @@
+#include "Cholesky.hpp"
+#include "Gemm.hpp"
+#include "Simd.hpp"
+#include "Trsm.hpp"
+#include "Workspace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+// Row-oriented Cholesky-Crout on columns [j0, j1) of rows [j0, n), the
+// columns left of j0 having already been eliminated: the diagonal block is
+// factored and the rows below it are solved against it. Every update is a
+// dot product of two contiguous row segments of L.
+template <typename T>
+bool factorPanel(T *a, std::size_t ld, std::size_t n, std::size_t j0,
+                 std::size_t j1) {
+  for (std::size_t i = j0; i < n; i++) {
+    T *row = a + i * ld;
+    const std::size_t end = std::min(i, j1);
+    for (std::size_t j = j0; j < end; j++) {
+      const T *pivotRow = a + j * ld;
+      row[j] = (row[j] - MWP::simd::dot<T>(j - j0, row + j0, pivotRow + j0)) /
+               pivotRow[j];
+    }
+    if (i < j1) {
+      const T diagonal =
+          row[i] - MWP::simd::dot<T>(i - j0, row + j0, row + j0);
+      if (!(diagonal > (T)0)) {
+        return false;
+      }
+      row[i] = (T)std::sqrt(diagonal);
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+template <typename T> bool MWP::choleskyFactorInPlace(MatrixView<T> A) {
+  static_assert(!std::is_integral<T>::value,
+                "Cholesky factors are only computed for floating-point "
+                "matrices");
+  if (A._rows != A._columns) {
+    throw std::runtime_error(
+        "The matrix should be square to be decomposed into Cholesky factors!");
+  }
+  const std::size_t n = A._rows;
+  const std::size_t ld = A._ld;
+  T *a = A._data;
+  // Left-looking blocked Cholesky: each block column first receives the
+  // contributions of every block column left of it with one GEMM, then is
+  // factored as a panel.
+  WorkspaceScope scope;
+  T *diagonalUpdate =
+      scope.allocate<T>(CholeskyBlockSize * CholeskyBlockSize);
+  for (std::size_t j0 = 0; j0 < n; j0 += CholeskyBlockSize) {
+    const std::size_t j1 = std::min(n, j0 + CholeskyBlockSize);
+    const std::size_t jb = j1 - j0;
+    if (j0 > 0) {
+      // A11 -= L10 * L10^T through a scratch block so that only its lower
+      // triangle is written.
+      gemm<T>(false, true, jb, jb, j0, (T)1, a + j0 * ld, ld, a + j0 * ld, ld,
+              (T)0, diagonalUpdate, jb);
+      for (std::size_t i = 0; i < jb; i++) {
+        T *row = a + (j0 + i) * ld + j0;
+        for (std::size_t j = 0; j <= i; j++) {
+          row[j] -= diagonalUpdate[i * jb + j];
+        }
+      }
+      // A21 -= L20 * L10^T
+      if (j1 < n) {
+        gemm<T>(false, true, n - j1, jb, j0, (T)-1, a + j1 * ld, ld,
+                a + j0 * ld, ld, (T)1, a + j1 * ld + j0, ld);
+      }
+    }
+    if (!factorPanel(a, ld, n, j0, j1)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+template <typename T>
+MWP::Cholesky<T>::Cholesky(Matrix<T> matrix) : _factors(std::move(matrix)) {
+  _positiveDefinite = choleskyFactorInPlace(
+      _factors.view(0, _factors._rows, 0, _factors._columns));
+}
+
+template <typename T> bool MWP::Cholesky<T>::isPositiveDefinite() const {
+  return _positiveDefinite;
+}
+
+template <typename T> MWP::Matrix<T> MWP::Cholesky<T>::lower() const {
+  const Index n = _factors._rows;
+  Matrix<T> lowerMatrix(n, n);
+  for (Index i = 0; i < n; i++) {
+    std::copy(_factors._elements.begin() + i * n,
+              _factors._elements.begin() + i * n + i + 1,
+              lowerMatrix._elements.begin() + i * n);
+  }
+  return lowerMatrix;
+}
+
+template <typename T> void MWP::Cholesky<T>::solveInPlace(T *b) const {
+  const std::size_t n = _factors._rows;
+  const T *a = _factors._elements.data();
+  for (std::size_t i = 0; i < n; i++) {
+    b[i] = (b[i] - simd::dot<T>(i, a + i * n, b)) / a[i * n + i];
+  }
+  // L^T is walked by rows of L: once x[i] is known, it is removed from every
+  // earlier equation with one contiguous axpy.
+  for (std::size_t i = n; i-- > 0;) {
+    b[i] /= a[i * n + i];
+    simd::axpy<T>(i, -b[i], a + i * n, b);
+  }
+}
+
+template <typename T>
+MWP::Vector<T> MWP::Cholesky<T>::solve(const Vector<T> &constants) const {
+  Vector<T> variables;
+  solve(constants, variables);
+  return variables;
+}
+
+template <typename T>
+void MWP::Cholesky<T>::solve(const Vector<T> &constants,
+                             Vector<T> &variables) const {
+  if (constants._rows != _factors._rows || constants._columns != 1) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants vector");
+  }
+  if (!_positiveDefinite) {
+    throw std::runtime_error("The matrix is not positive definite");
+  }
+  variables = constants;
+  solveInPlace(variables._elements.data());
+}
+
+template <typename T>
+void MWP::Cholesky<T>::solveInPlace(MatrixView<T> B) const {
+  if (B._rows != _factors._rows) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants matrix");
+  }
+  const std::size_t n = _factors._rows;
+  trsm<T>(true, false, false, n, B._columns, _factors._elements.data(), n,
+          B._data, B._ld);
+  trsm<T>(true, true, false, n, B._columns, _factors._elements.data(), n,
+          B._data, B._ld);
+}
+
+template <typename T>
+MWP::Matrix<T> MWP::Cholesky<T>::solve(const Matrix<T> &constants) const {
+  if (constants._rows != _factors._rows) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants matrix");
+  }
+  if (!_positiveDefinite) {
+    throw std::runtime_error("The matrix is not positive definite");
+  }
+  Matrix<T> variables = constants;
+  solveInPlace(variables.view(0, variables._rows, 0, variables._columns));
+  return variables;
+}
+
+#ifndef MWP_HEADER_ONLY
+template bool MWP::choleskyFactorInPlace<double>(MatrixView<double>);
+template bool MWP::choleskyFactorInPlace<float>(MatrixView<float>);
+template class MWP::Cholesky<double>;
+template class MWP::Cholesky<float>;
+#endif
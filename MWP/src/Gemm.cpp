@@ -0,0 +1,306 @@
+#include "Gemm.hpp"
+#include "Scalar.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace MWP {
+
+namespace {
+
+// Conjugation is applied while reading, so packing absorbs it at no extra
+// pass over the operands.
+template <typename T>
+inline T elementAt(Operation op, const T *X, std::size_t ldx, std::size_t i,
+                   std::size_t j) {
+  if (op == Operation::None) {
+    return X[i * ldx + j];
+  }
+  const T value = X[j * ldx + i];
+  return op == Operation::ConjugateTranspose ? conjugate(value) : value;
+}
+
+template <typename T>
+inline const T *blockAt(Operation op, const T *X, std::size_t ldx,
+                        std::size_t i, std::size_t j) {
+  return op != Operation::None ? X + j * ldx + i : X + i * ldx + j;
+}
+
+template <typename T>
+void scaleC(std::size_t m, std::size_t n, T beta, T *C, std::size_t ldc) {
+  if (beta == (T)1) {
+    return;
+  }
+  for (std::size_t i = 0; i < m; i++) {
+    T *row = C + i * ldc;
+    if (beta == (T)0) {
+      std::fill(row, row + n, (T)0);
+    } else {
+      for (std::size_t j = 0; j < n; j++) {
+        row[j] *= beta;
+      }
+    }
+  }
+}
+
+template <typename T>
+void gemmNaive(Operation opA, Operation opB, std::size_t m, std::size_t n,
+               std::size_t k, T alpha, const T *A, std::size_t lda, const T *B,
+               std::size_t ldb, T *C, std::size_t ldc) {
+  for (std::size_t i = 0; i < m; i++) {
+    for (std::size_t j = 0; j < n; j++) {
+      T sum = (T)0;
+      for (std::size_t p = 0; p < k; p++) {
+        sum += elementAt(opA, A, lda, i, p) * elementAt(opB, B, ldb, p, j);
+      }
+      C[i * ldc + j] += alpha * sum;
+    }
+  }
+}
+
+// Packs an mc x kc block of op(A) into mr-row micro-panels, zero padded.
+template <typename T>
+void packA(Operation opA, std::size_t mc, std::size_t kc, const T *A,
+           std::size_t lda, std::size_t mr, T *buffer) {
+  for (std::size_t ir = 0; ir < mc; ir += mr) {
+    const std::size_t rows = std::min(mr, mc - ir);
+    for (std::size_t p = 0; p < kc; p++) {
+      for (std::size_t i = 0; i < rows; i++) {
+        buffer[i] = elementAt(opA, A, lda, ir + i, p);
+      }
+      for (std::size_t i = rows; i < mr; i++) {
+        buffer[i] = (T)0;
+      }
+      buffer += mr;
+    }
+  }
+}
+
+// Packs a kc x nc panel of op(B) into nr-column micro-panels, zero padded.
+template <typename T>
+void packB(Operation opB, std::size_t kc, std::size_t nc, const T *B,
+           std::size_t ldb, std::size_t nr, T *buffer) {
+  for (std::size_t jr = 0; jr < nc; jr += nr) {
+    const std::size_t columns = std::min(nr, nc - jr);
+    for (std::size_t p = 0; p < kc; p++) {
+      for (std::size_t j = 0; j < columns; j++) {
+        buffer[j] = elementAt(opB, B, ldb, p, jr + j);
+      }
+      for (std::size_t j = columns; j < nr; j++) {
+        buffer[j] = (T)0;
+      }
+      buffer += nr;
+    }
+  }
+}
+
+// Runs the packed engine on a whole product. Packing buffers are kept per
+// thread so parallel tiles do not allocate. MC and NC are trimmed to whole
+// micro-panels of the kernel so the padded panels fit the buffers.
+template <typename T>
+void gemmBlocked(const simd::GemmMicroKernel<T> &kernel, Operation opA,
+                 Operation opB, std::size_t m, std::size_t n, std::size_t k,
+                 T alpha, const T *A, std::size_t lda, const T *B,
+                 std::size_t ldb, T *C, std::size_t ldc) {
+  constexpr std::size_t KC = GemmBlocking<T>::KC;
+  constexpr std::size_t MC = GemmBlocking<T>::MC;
+  constexpr std::size_t NC = GemmBlocking<T>::NC;
+  const std::size_t mr = kernel.mr;
+  const std::size_t nr = kernel.nr;
+  const std::size_t mcBlock = MC - MC % mr;
+  const std::size_t ncBlock = NC - NC % nr;
+
+  thread_local std::vector<T> packedA(MC * KC);
+  thread_local std::vector<T> packedB(KC * NC);
+
+  for (std::size_t jc = 0; jc < n; jc += ncBlock) {
+    const std::size_t nc = std::min(ncBlock, n - jc);
+    for (std::size_t pc = 0; pc < k; pc += KC) {
+      const std::size_t kc = std::min(KC, k - pc);
+      packB(opB, kc, nc, blockAt(opB, B, ldb, pc, jc), ldb, nr,
+            packedB.data());
+      for (std::size_t ic = 0; ic < m; ic += mcBlock) {
+        const std::size_t mc = std::min(mcBlock, m - ic);
+        packA(opA, mc, kc, blockAt(opA, A, lda, ic, pc), lda, mr,
+              packedA.data());
+        for (std::size_t jr = 0; jr < nc; jr += nr) {
+          for (std::size_t ir = 0; ir < mc; ir += mr) {
+            kernel.run(kc, alpha, packedA.data() + ir * kc,
+                       packedB.data() + jr * kc,
+                       C + (ic + ir) * ldc + jc + jr, ldc,
+                       std::min(mr, mc - ir), std::min(nr, nc - jr));
+          }
+        }
+      }
+    }
+  }
+}
+
+inline std::size_t roundUp(std::size_t value, std::size_t multiple) {
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+// Splits threads into a gridRows x gridColumns grid whose tiles are as close
+// to square as the m x n output allows.
+void chooseGrid(std::size_t m, std::size_t n, std::size_t threads,
+                std::size_t &gridRows, std::size_t &gridColumns) {
+  gridRows = 1;
+  gridColumns = threads;
+  double bestRatio = -1.0;
+  for (std::size_t rows = 1; rows <= threads; rows++) {
+    if (threads % rows != 0) {
+      continue;
+    }
+    const std::size_t columns = threads / rows;
+    const double tileRows = (double)m / rows;
+    const double tileColumns = (double)n / columns;
+    const double ratio = tileRows < tileColumns ? tileRows / tileColumns
+                                                : tileColumns / tileRows;
+    if (ratio > bestRatio) {
+      bestRatio = ratio;
+      gridRows = rows;
+      gridColumns = columns;
+    }
+  }
+}
+
+} // namespace
+
+template <typename T>
+void gemm(Operation opA, Operation opB, std::size_t m, std::size_t n,
+               std::size_t k, T alpha, const T *A, std::size_t lda, const T *B,
+               std::size_t ldb, T beta, T *C, std::size_t ldc) {
+  if (m == 0 || n == 0) {
+    return;
+  }
+  scaleC(m, n, beta, C, ldc);
+  if (k == 0 || alpha == (T)0) {
+    return;
+  }
+  if (m * n * k < GemmSmallThreshold) {
+    gemmNaive(opA, opB, m, n, k, alpha, A, lda, B, ldb, C, ldc);
+    return;
+  }
+
+  const simd::GemmMicroKernel<T> kernel = simd::gemmMicroKernel<T>();
+  ThreadPool &pool = ThreadPool::instance();
+  if (pool.size() == 1 || m * n * k < GemmParallelThreshold) {
+    gemmBlocked(kernel, opA, opB, m, n, k, alpha, A, lda, B, ldb, C, ldc);
+    return;
+  }
+
+  // Every task owns a 2D macro-tile of C and runs the packed engine on it.
+  std::size_t gridRows, gridColumns;
+  chooseGrid(m, n, pool.size(), gridRows, gridColumns);
+  const std::size_t tileRows =
+      roundUp((m + gridRows - 1) / gridRows, kernel.mr);
+  const std::size_t tileColumns =
+      roundUp((n + gridColumns - 1) / gridColumns, kernel.nr);
+  pool.parallelFor(gridRows * gridColumns, [&](std::size_t tile) {
+    const std::size_t i0 = (tile / gridColumns) * tileRows;
+    const std::size_t j0 = (tile % gridColumns) * tileColumns;
+    if (i0 >= m || j0 >= n) {
+      return;
+    }
+    gemmBlocked(kernel, opA, opB, std::min(tileRows, m - i0),
+                std::min(tileColumns, n - j0), k, alpha,
+                blockAt(opA, A, lda, i0, (std::size_t)0), lda,
+                blockAt(opB, B, ldb, (std::size_t)0, j0), ldb,
+                C + i0 * ldc + j0, ldc);
+  });
+}
+
+template <typename T>
+void gemv(Operation opA, std::size_t m, std::size_t n, T alpha,
+               const T *A, std::size_t lda, const T *x, T beta, T *y) {
+  const std::size_t length = opA != Operation::None ? n : m;
+  if (length == 0) {
+    return;
+  }
+  ThreadPool &pool = ThreadPool::instance();
+  std::size_t chunks = 1;
+  if (pool.size() > 1 && m * n >= GemvParallelThreshold) {
+    chunks = std::min<std::size_t>(pool.size(), (length + 63) / 64);
+  }
+  const std::size_t chunk = roundUp((length + chunks - 1) / chunks, 8);
+  auto run = [&](std::size_t index) {
+    const std::size_t begin = index * chunk;
+    if (begin >= length) {
+      return;
+    }
+    const std::size_t end = std::min(length, begin + chunk);
+    if (opA == Operation::None) {
+      for (std::size_t i = begin; i < end; i++) {
+        const T sum = alpha * simd::dot<T>(n, A + i * lda, x);
+        y[i] = beta == (T)0 ? sum : sum + beta * y[i];
+      }
+      return;
+    }
+    // Rows of A are streamed once per chunk of output columns.
+    if (beta == (T)0) {
+      std::fill(y + begin, y + end, (T)0);
+    } else if (beta != (T)1) {
+      simd::scale<T>(end - begin, beta, y + begin, y + begin);
+    }
+    for (std::size_t i = 0; i < m; i++) {
+      if (opA == Operation::ConjugateTranspose) {
+        simd::axpyConjugate<T>(end - begin, alpha * x[i], A + i * lda + begin,
+                               y + begin);
+      } else {
+        simd::axpy<T>(end - begin, alpha * x[i], A + i * lda + begin,
+                      y + begin);
+      }
+    }
+  };
+  if (chunks == 1) {
+    run(0);
+  } else {
+    pool.parallelFor(chunks, run);
+  }
+}
+
+} // namespace MWP
+
+#ifndef MWP_HEADER_ONLY
+template void MWP::gemm<double>(Operation, Operation, std::size_t,
+                                std::size_t, std::size_t, double,
+                                const double *, std::size_t, const double *,
+                                std::size_t, double, double *, std::size_t);
+template void MWP::gemm<float>(Operation, Operation, std::size_t, std::size_t,
+                               std::size_t, float, const float *, std::size_t,
+                               const float *, std::size_t, float, float *,
+                               std::size_t);
+template void MWP::gemm<std::complex<double>>(
+    Operation, Operation, std::size_t, std::size_t, std::size_t,
+    std::complex<double>, const std::complex<double> *, std::size_t,
+    const std::complex<double> *, std::size_t, std::complex<double>,
+    std::complex<double> *, std::size_t);
+template void MWP::gemm<std::complex<float>>(
+    Operation, Operation, std::size_t, std::size_t, std::size_t,
+    std::complex<float>, const std::complex<float> *, std::size_t,
+    const std::complex<float> *, std::size_t, std::complex<float>,
+    std::complex<float> *, std::size_t);
+template void MWP::gemm<int>(Operation, Operation, std::size_t, std::size_t,
+                             std::size_t, int, const int *, std::size_t,
+                             const int *, std::size_t, int, int *,
+                             std::size_t);
+template void MWP::gemv<double>(Operation, std::size_t, std::size_t, double,
+                                const double *, std::size_t, const double *,
+                                double, double *);
+template void MWP::gemv<float>(Operation, std::size_t, std::size_t, float,
+                               const float *, std::size_t, const float *,
+                               float, float *);
+template void MWP::gemv<std::complex<double>>(
+    Operation, std::size_t, std::size_t, std::complex<double>,
+    const std::complex<double> *, std::size_t, const std::complex<double> *,
+    std::complex<double>, std::complex<double> *);
+template void MWP::gemv<std::complex<float>>(
+    Operation, std::size_t, std::size_t, std::complex<float>,
+    const std::complex<float> *, std::size_t, const std::complex<float> *,
+    std::complex<float>, std::complex<float> *);
+template void MWP::gemv<int>(Operation, std::size_t, std::size_t, int,
+                             const int *, std::size_t, const int *, int,
+                             int *);
+#endif
@@ -0,0 +1,334 @@
+#include "Krylov.hpp"
+#include "Gemm.hpp"
+#include "Simd.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+template <typename T> double norm(std::size_t n, const T *x) {
+  return std::sqrt(MWP::simd::sumSquares<T>(n, x));
+}
+
+// r = b - A * x.
+template <typename T>
+void residual(const MWP::LinearOperator<T> &A, const T *b, const T *x, T *r) {
+  A.apply(x, r);
+  MWP::simd::sub<T>(A._size, b, r, r);
+}
+
+// Records the residual norm and reports whether it meets the target.
+bool record(MWP::IterativeResult &result, double residualNorm,
+            double target) {
+  result._residualNorm = residualNorm;
+  result._residualHistory.push_back(residualNorm);
+  result._converged = residualNorm <= target;
+  return result._converged;
+}
+
+// z = M * r, or a copy of r without a preconditioner.
+template <typename T>
+void precondition(const MWP::LinearOperator<T> *M, std::size_t n, const T *r,
+                  T *z) {
+  if (M) {
+    M->apply(r, z);
+  } else {
+    std::copy(r, r + n, z);
+  }
+}
+
+inline double target(const MWP::IterativeSettings &settings, double normB) {
+  return std::max(settings._tolerance * normB, settings._absoluteTolerance);
+}
+
+} // namespace
+
+template <typename T>
+MWP::LinearOperator<T>::LinearOperator(
+    std::size_t size, std::function<void(const T *, T *)> apply)
+    : _size(size), _apply(std::move(apply)) {}
+
+template <typename T>
+MWP::LinearOperator<T>::LinearOperator(const Matrix<T> &matrix)
+    : _size(matrix._rows) {
+  if (matrix._rows != matrix._columns) {
+    throw std::runtime_error("The linear operator should be square");
+  }
+  const Matrix<T> *A = &matrix;
+  _apply = [A](const T *x, T *y) {
+    gemv<T>(false, A->_rows, A->_columns, (T)1, A->_elements.data(),
+            A->_columns, x, (T)0, y);
+  };
+}
+
+template <typename T>
+MWP::LinearOperator<T>::LinearOperator(const SparseMatrix<T> &matrix)
+    : _size(matrix._rows) {
+  if (matrix._rows != matrix._columns) {
+    throw std::runtime_error("The linear operator should be square");
+  }
+  const SparseMatrix<T> *A = &matrix;
+  _apply = [A](const T *x, T *y) { A->multiply(x, y); };
+}
+
+template <typename T>
+MWP::IterativeResult
+MWP::KrylovSolver<T>::cg(const LinearOperator<T> &A, const T *b, T *x,
+                         const IterativeSettings &settings,
+                         const LinearOperator<T> *preconditioner) {
+  const std::size_t n = A._size;
+  _r.resize(n);
+  _p.resize(n);
+  _q.resize(n);
+  _z.resize(n);
+  IterativeResult result;
+  const double goal = target(settings, norm(n, b));
+  residual(A, b, x, _r.data());
+  if (record(result, norm(n, _r.data()), goal)) {
+    return result;
+  }
+  precondition(preconditioner, n, _r.data(), _z.data());
+  std::copy(_z.begin(), _z.end(), _p.begin());
+  T rz = simd::dot<T>(n, _r.data(), _z.data());
+  while (result._iterations < settings._maxIterations) {
+    A.apply(_p.data(), _q.data());
+    const T pq = simd::dot<T>(n, _p.data(), _q.data());
+    if (pq == (T)0) {
+      break;
+    }
+    const T alpha = rz / pq;
+    simd::axpy<T>(n, alpha, _p.data(), x);
+    simd::axpy<T>(n, -alpha, _q.data(), _r.data());
+    result._iterations++;
+    if (record(result, norm(n, _r.data()), goal)) {
+      break;
+    }
+    precondition(preconditioner, n, _r.data(), _z.data());
+    const T rzNext = simd::dot<T>(n, _r.data(), _z.data());
+    // p = z + beta * p.
+    simd::scale<T>(n, rzNext / rz, _p.data(), _p.data());
+    simd::add<T>(n, _z.data(), _p.data(), _p.data());
+    rz = rzNext;
+  }
+  return result;
+}
+
+template <typename T>
+MWP::IterativeResult
+MWP::KrylovSolver<T>::bicgstab(const LinearOperator<T> &A, const T *b, T *x,
+                               const IterativeSettings &settings,
+                               const LinearOperator<T> *preconditioner) {
+  const std::size_t n = A._size;
+  // _q holds the shadow residual, _basis the direction A * M * p and _y, _z
+  // the preconditioned p and s.
+  _r.resize(n);
+  _p.assign(n, (T)0);
+  _q.resize(n);
+  _s.resize(n);
+  _t.resize(n);
+  _y.resize(n);
+  _z.resize(n);
+  _basis.assign(n, (T)0);
+  T *v = _basis.data();
+  IterativeResult result;
+  const double goal = target(settings, norm(n, b));
+  residual(A, b, x, _r.data());
+  if (record(result, norm(n, _r.data()), goal)) {
+    return result;
+  }
+  std::copy(_r.begin(), _r.end(), _q.begin());
+  T rho = (T)1;
+  T alpha = (T)1;
+  T omega = (T)1;
+  while (result._iterations < settings._maxIterations) {
+    const T rhoNext = simd::dot<T>(n, _q.data(), _r.data());
+    if (rhoNext == (T)0 || omega == (T)0) {
+      // Breakdown: the shadow space is exhausted.
+      break;
+    }
+    // p = r + beta * (p - omega * v).
+    const T beta = (rhoNext / rho) * (alpha / omega);
+    simd::axpy<T>(n, -omega, v, _p.data());
+    simd::scale<T>(n, beta, _p.data(), _p.data());
+    simd::add<T>(n, _r.data(), _p.data(), _p.data());
+    precondition(preconditioner, n, _p.data(), _y.data());
+    A.apply(_y.data(), v);
+    const T qv = simd::dot<T>(n, _q.data(), v);
+    if (qv == (T)0) {
+      break;
+    }
+    alpha = rhoNext / qv;
+    // s = r - alpha * v.
+    std::copy(_r.begin(), _r.end(), _s.begin());
+    simd::axpy<T>(n, -alpha, v, _s.data());
+    simd::axpy<T>(n, alpha, _y.data(), x);
+    result._iterations++;
+    const double normS = norm(n, _s.data());
+    if (normS <= goal) {
+      record(result, normS, goal);
+      break;
+    }
+    precondition(preconditioner, n, _s.data(), _z.data());
+    A.apply(_z.data(), _t.data());
+    const T tt = simd::dot<T>(n, _t.data(), _t.data());
+    omega = tt == (T)0 ? (T)0 : simd::dot<T>(n, _t.data(), _s.data()) / tt;
+    simd::axpy<T>(n, omega, _z.data(), x);
+    // r = s - omega * t.
+    std::copy(_s.begin(), _s.end(), _r.begin());
+    simd::axpy<T>(n, -omega, _t.data(), _r.data());
+    rho = rhoNext;
+    if (record(result, norm(n, _r.data()), goal)) {
+      break;
+    }
+  }
+  return result;
+}
+
+template <typename T>
+MWP::IterativeResult
+MWP::KrylovSolver<T>::gmres(const LinearOperator<T> &A, const T *b, T *x,
+                            const IterativeSettings &settings,
+                            const LinearOperator<T> *preconditioner) {
+  const std::size_t n = A._size;
+  const std::size_t m =
+      std::max<std::size_t>(1, std::min(settings._restart, n));
+  _r.resize(n);
+  _y.resize(n);
+  _z.resize(n);
+  _basis.resize((m + 1) * n);
+  _hessenberg.resize((m + 1) * m);
+  _cosines.resize(m);
+  _sines.resize(m);
+  _g.resize(m + 1);
+  T *V = _basis.data();
+  T *H = _hessenberg.data();
+  IterativeResult result;
+  const double goal = target(settings, norm(n, b));
+  residual(A, b, x, _r.data());
+  double beta = norm(n, _r.data());
+  if (record(result, beta, goal)) {
+    return result;
+  }
+
+  while (result._iterations < settings._maxIterations) {
+    simd::scale<T>(n, (T)(1.0 / beta), _r.data(), V);
+    std::fill(_g.begin(), _g.end(), (T)0);
+    _g[0] = (T)beta;
+    std::size_t k = 0;
+    bool done = false;
+    while (k < m && result._iterations < settings._maxIterations) {
+      const std::size_t j = k;
+      T *w = V + (j + 1) * n;
+      if (preconditioner) {
+        preconditioner->apply(V + j * n, _z.data());
+        A.apply(_z.data(), w);
+      } else {
+        A.apply(V + j * n, w);
+      }
+      for (std::size_t i = 0; i <= j; i++) {
+        H[i * m + j] = simd::dot<T>(n, w, V + i * n);
+        simd::axpy<T>(n, -H[i * m + j], V + i * n, w);
+      }
+      const double wNorm = norm(n, w);
+      H[(j + 1) * m + j] = (T)wNorm;
+      if (wNorm != 0.0) {
+        simd::scale<T>(n, (T)(1.0 / wNorm), w, w);
+      }
+      // Previous rotations, then a new one zeroing H(j + 1, j).
+      for (std::size_t i = 0; i < j; i++) {
+        const T top = H[i * m + j];
+        const T bottom = H[(i + 1) * m + j];
+        H[i * m + j] = _cosines[i] * top + _sines[i] * bottom;
+        H[(i + 1) * m + j] = _cosines[i] * bottom - _sines[i] * top;
+      }
+      const T diagonal = H[j * m + j];
+      const T below = H[(j + 1) * m + j];
+      const T radius = (T)std::hypot((double)diagonal, (double)below);
+      _cosines[j] = radius == (T)0 ? (T)1 : diagonal / radius;
+      _sines[j] = radius == (T)0 ? (T)0 : below / radius;
+      H[j * m + j] = radius;
+      H[(j + 1) * m + j] = (T)0;
+      _g[j + 1] = -_sines[j] * _g[j];
+      _g[j] = _cosines[j] * _g[j];
+      k++;
+      result._iterations++;
+      done = record(result, std::abs((double)_g[j + 1]), goal);
+      // A zero subdiagonal means the Krylov space is invariant: the
+      // least-squares solution is exact.
+      if (done || wNorm == 0.0) {
+        break;
+      }
+    }
+
+    // y = H^-1 * g on the leading k x k triangle, then x += M * V * y.
+    for (std::size_t i = k; i-- > 0;) {
+      T sum = _g[i];
+      for (std::size_t l = i + 1; l < k; l++) {
+        sum -= H[i * m + l] * _g[l];
+      }
+      _g[i] = H[i * m + i] == (T)0 ? (T)0 : sum / H[i * m + i];
+    }
+    std::fill(_z.begin(), _z.end(), (T)0);
+    for (std::size_t i = 0; i < k; i++) {
+      simd::axpy<T>(n, _g[i], V + i * n, _z.data());
+    }
+    precondition(preconditioner, n, _z.data(), _y.data());
+    simd::add<T>(n, x, _y.data(), x);
+    if (done) {
+      break;
+    }
+    // Restart from the true residual.
+    residual(A, b, x, _r.data());
+    beta = norm(n, _r.data());
+    result._residualNorm = beta;
+    if (beta <= goal) {
+      result._converged = true;
+      break;
+    }
+  }
+  return result;
+}
+
+template <typename T>
+MWP::IterativeResult
+MWP::KrylovSolver<T>::solve(IterativeMethod method, const LinearOperator<T> &A,
+                            const T *b, T *x,
+                            const IterativeSettings &settings,
+                            const LinearOperator<T> *preconditioner) {
+  switch (method) {
+  case IterativeMethod::CG:
+    return cg(A, b, x, settings, preconditioner);
+  case IterativeMethod::BiCGSTAB:
+    return bicgstab(A, b, x, settings, preconditioner);
+  case IterativeMethod::GMRES:
+    return gmres(A, b, x, settings, preconditioner);
+  }
+  throw std::runtime_error("Unknown iterative method");
+}
+
+template <typename T>
+MWP::IterativeResult
+MWP::KrylovSolver<T>::solve(IterativeMethod method, const LinearOperator<T> &A,
+                            const Vector<T> &b, Vector<T> &x,
+                            const IterativeSettings &settings,
+                            const LinearOperator<T> *preconditioner) {
+  if (b._rows != A._size || b._columns != 1 || x._rows != A._size ||
+      x._columns != 1) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants vector");
+  }
+  if (preconditioner && preconditioner->_size != A._size) {
+    throw std::runtime_error(
+        "Incompatible dimension of the preconditioner with the operator");
+  }
+  return solve(method, A, b._elements.data(), x._elements.data(), settings,
+               preconditioner);
+}
+
+#ifndef MWP_HEADER_ONLY
+template class MWP::LinearOperator<double>;
+template class MWP::LinearOperator<float>;
+template class MWP::KrylovSolver<double>;
+template class MWP::KrylovSolver<float>;
+#endif
@@ -0,0 +1,270 @@
+#include "LDLT.hpp"
+#include "Scalar.hpp"
+#include "Simd.hpp"
+#include "Workspace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+// Swaps rows i and j of the n x nrhs block at B.
+template <typename T>
+void swapRows(T *B, std::size_t ldb, std::size_t nrhs, std::size_t i,
+              std::size_t j) {
+  if (i != j) {
+    std::swap_ranges(B + i * ldb, B + i * ldb + nrhs, B + j * ldb);
+  }
+}
+
+} // namespace
+
+template <typename T>
+bool MWP::ldltFactorInPlace(MatrixView<T> A, std::vector<std::size_t> &pivots,
+                            std::vector<std::size_t> &blockSizes) {
+  static_assert(!std::is_integral<T>::value,
+                "LDLT factors are only computed for floating-point matrices");
+  if (A._rows != A._columns) {
+    throw std::runtime_error(
+        "The matrix should be square to be decomposed into LDLT factors!");
+  }
+  const std::size_t n = A._rows;
+  const std::size_t ld = A._ld;
+  T *a = A._data;
+  pivots.assign(n, 0);
+  blockSizes.assign(n, 0);
+  bool nonsingular = true;
+  // Growth bound of the Bunch-Kaufman pivoting strategy.
+  const double alpha = (1.0 + std::sqrt(17.0)) / 8.0;
+  WorkspaceScope scope;
+  T *w1 = scope.allocate<T>(n);
+  T *w2 = scope.allocate<T>(n);
+  std::size_t k = 0;
+  while (k < n) {
+    const double absakk = MWP::magnitude(a[k * ld + k]);
+    double colmax = 0.0;
+    std::size_t imax = k;
+    for (std::size_t i = k + 1; i < n; i++) {
+      if (MWP::magnitude(a[i * ld + k]) > colmax) {
+        colmax = MWP::magnitude(a[i * ld + k]);
+        imax = i;
+      }
+    }
+    if (absakk == 0.0 && colmax == 0.0) {
+      // Column already eliminated: a zero 1 x 1 block of D.
+      nonsingular = false;
+      pivots[k] = k;
+      blockSizes[k] = 1;
+      k++;
+      continue;
+    }
+    std::size_t size = 1;
+    std::size_t kp = k;
+    if (absakk < alpha * colmax) {
+      // Largest off-diagonal entry in row and column imax, walked through
+      // the lower triangle only.
+      double rowmax = 0.0;
+      for (std::size_t j = k; j < imax; j++) {
+        rowmax = std::max(rowmax, MWP::magnitude(a[imax * ld + j]));
+      }
+      for (std::size_t i = imax + 1; i < n; i++) {
+        rowmax = std::max(rowmax, MWP::magnitude(a[i * ld + imax]));
+      }
+      if (absakk * rowmax >= alpha * colmax * colmax) {
+        kp = k;
+      } else if (MWP::magnitude(a[imax * ld + imax]) >= alpha * rowmax) {
+        kp = imax;
+      } else {
+        kp = imax;
+        size = 2;
+      }
+    }
+
+    // Symmetric interchange of rows and columns kk and kp of the trailing
+    // matrix, touching its lower triangle only.
+    const std::size_t kk = k + size - 1;
+    if (kp != kk) {
+      for (std::size_t i = kp + 1; i < n; i++) {
+        std::swap(a[i * ld + kk], a[i * ld + kp]);
+      }
+      for (std::size_t j = kk + 1; j < kp; j++) {
+        std::swap(a[j * ld + kk], a[kp * ld + j]);
+      }
+      std::swap(a[kk * ld + kk], a[kp * ld + kp]);
+      if (size == 2) {
+        std::swap(a[(k + 1) * ld + k], a[kp * ld + k]);
+      }
+    }
+
+    // Trailing update A22 -= W * D^-1 * W^T row by row: the columns W are
+    // copied out once so that every update is a contiguous axpy.
+    if (size == 1) {
+      const T d = a[k * ld + k];
+      for (std::size_t i = k + 1; i < n; i++) {
+        w1[i] = a[i * ld + k];
+      }
+      for (std::size_t i = k + 1; i < n; i++) {
+        const T l = w1[i] / d;
+        simd::axpy<T>(i - k, -l, w1 + k + 1, a + i * ld + k + 1);
+        a[i * ld + k] = l;
+      }
+    } else {
+      const T d11 = a[k * ld + k];
+      const T d21 = a[(k + 1) * ld + k];
+      const T d22 = a[(k + 1) * ld + k + 1];
+      const T det = d11 * d22 - d21 * d21;
+      if (det == (T)0) {
+        nonsingular = false;
+      } else {
+        for (std::size_t i = k + 2; i < n; i++) {
+          w1[i] = a[i * ld + k];
+          w2[i] = a[i * ld + k + 1];
+        }
+        for (std::size_t i = k + 2; i < n; i++) {
+          const T l1 = (d22 * w1[i] - d21 * w2[i]) / det;
+          const T l2 = (d11 * w2[i] - d21 * w1[i]) / det;
+          simd::axpy<T>(i - k - 1, -l1, w1 + k + 2, a + i * ld + k + 2);
+          simd::axpy<T>(i - k - 1, -l2, w2 + k + 2, a + i * ld + k + 2);
+          a[i * ld + k] = l1;
+          a[i * ld + k + 1] = l2;
+        }
+      }
+      pivots[k + 1] = kp;
+    }
+    pivots[k] = kp;
+    blockSizes[k] = size;
+    k += size;
+  }
+  return nonsingular;
+}
+
+
+template <typename T>
+MWP::LDLT<T>::LDLT(Matrix<T> matrix) : _factors(std::move(matrix)) {
+  _nonsingular = ldltFactorInPlace(
+      _factors.view(0, _factors._rows, 0, _factors._columns), _pivots,
+      _blockSizes);
+}
+
+template <typename T> bool MWP::LDLT<T>::isNonsingular() const {
+  return _nonsingular;
+}
+
+template <typename T> void MWP::LDLT<T>::solveInPlace(T *b) const {
+  solveInPlace(MatrixView<T>(b, _factors._rows, 1, 1));
+}
+
+template <typename T>
+MWP::Vector<T> MWP::LDLT<T>::solve(const Vector<T> &constants) const {
+  Vector<T> variables;
+  solve(constants, variables);
+  return variables;
+}
+
+template <typename T>
+void MWP::LDLT<T>::solve(const Vector<T> &constants,
+                         Vector<T> &variables) const {
+  if (constants._rows != _factors._rows || constants._columns != 1) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants vector");
+  }
+  if (!_nonsingular) {
+    throw std::runtime_error("The matrix is singular");
+  }
+  variables = constants;
+  solveInPlace(variables._elements.data());
+}
+
+template <typename T>
+void MWP::LDLT<T>::solveInPlace(MatrixView<T> B) const {
+  if (B._rows != _factors._rows) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants matrix");
+  }
+  const std::size_t n = _factors._rows;
+  const std::size_t nrhs = B._columns;
+  const std::size_t ldb = B._ld;
+  const T *a = _factors._elements.data();
+  T *b = B._data;
+
+  // Forward: apply each interchange, the multipliers of its block and D^-1.
+  for (std::size_t k = 0; k < n;) {
+    if (_blockSizes[k] == 1) {
+      swapRows(b, ldb, nrhs, k, _pivots[k]);
+      for (std::size_t i = k + 1; i < n; i++) {
+        simd::axpy<T>(nrhs, -a[i * n + k], b + k * ldb, b + i * ldb);
+      }
+      const T d = a[k * n + k];
+      for (std::size_t j = 0; j < nrhs; j++) {
+        b[k * ldb + j] /= d;
+      }
+      k++;
+    } else {
+      swapRows(b, ldb, nrhs, k + 1, _pivots[k]);
+      for (std::size_t i = k + 2; i < n; i++) {
+        simd::axpy<T>(nrhs, -a[i * n + k], b + k * ldb, b + i * ldb);
+        simd::axpy<T>(nrhs, -a[i * n + k + 1], b + (k + 1) * ldb,
+                      b + i * ldb);
+      }
+      const T d11 = a[k * n + k];
+      const T d21 = a[(k + 1) * n + k];
+      const T d22 = a[(k + 1) * n + k + 1];
+      const T det = d11 * d22 - d21 * d21;
+      for (std::size_t j = 0; j < nrhs; j++) {
+        const T first = b[k * ldb + j];
+        const T second = b[(k + 1) * ldb + j];
+        b[k * ldb + j] = (d22 * first - d21 * second) / det;
+        b[(k + 1) * ldb + j] = (d11 * second - d21 * first) / det;
+      }
+      k += 2;
+    }
+  }
+
+  // Backward: apply L^T block by block, undoing the interchanges.
+  for (std::size_t end = n; end > 0;) {
+    const std::size_t k = end - 1;
+    if (_blockSizes[k] == 1) {
+      for (std::size_t i = k + 1; i < n; i++) {
+        simd::axpy<T>(nrhs, -a[i * n + k], b + i * ldb, b + k * ldb);
+      }
+      swapRows(b, ldb, nrhs, k, _pivots[k]);
+      end = k;
+    } else {
+      const std::size_t first = k - 1;
+      for (std::size_t i = k + 1; i < n; i++) {
+        simd::axpy<T>(nrhs, -a[i * n + first], b + i * ldb,
+                      b + first * ldb);
+        simd::axpy<T>(nrhs, -a[i * n + k], b + i * ldb, b + k * ldb);
+      }
+      swapRows(b, ldb, nrhs, k, _pivots[first]);
+      end = first;
+    }
+  }
+}
+
+template <typename T>
+MWP::Matrix<T> MWP::LDLT<T>::solve(const Matrix<T> &constants) const {
+  if (constants._rows != _factors._rows) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants matrix");
+  }
+  if (!_nonsingular) {
+    throw std::runtime_error("The matrix is singular");
+  }
+  Matrix<T> variables = constants;
+  solveInPlace(variables.view(0, variables._rows, 0, variables._columns));
+  return variables;
+}
+
+#ifndef MWP_HEADER_ONLY
+template bool MWP::ldltFactorInPlace<double>(MatrixView<double>,
+                                             std::vector<std::size_t> &,
+                                             std::vector<std::size_t> &);
+template bool MWP::ldltFactorInPlace<float>(MatrixView<float>,
+                                            std::vector<std::size_t> &,
+                                            std::vector<std::size_t> &);
+template class MWP::LDLT<double>;
+template class MWP::LDLT<float>;
+#endif
@@ -0,0 +1,354 @@
+#include "LU.hpp"
+#include "Gemm.hpp"
+#include "Scalar.hpp"
+#include "Simd.hpp"
+#include "Trsm.hpp"
+#include "Workspace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// Unblocked LU of the panel A[k0:n, k0:k0 + kb]. Pivot rows are swapped
+// across the full width of A, so the columns left and right of the panel
+// follow the interchanges.
+template <typename T>
+bool factorPanel(MWP::MatrixView<T> A, std::size_t k0, std::size_t kb,
+                 std::size_t *pivots) {
+  T *a = A._data;
+  const std::size_t ld = A._ld;
+  const std::size_t n = A._rows;
+  const std::size_t panelEnd = k0 + kb;
+  bool nonsingular = true;
+  for (std::size_t j = k0; j < panelEnd; j++) {
+    std::size_t pivot = j;
+    double largest = MWP::magnitude(a[j * ld + j]);
+    for (std::size_t i = j + 1; i < n; i++) {
+      const double current = MWP::magnitude(a[i * ld + j]);
+      if (current > largest) {
+        largest = current;
+        pivot = i;
+      }
+    }
+    pivots[j] = pivot;
+    if (pivot != j) {
+      std::swap_ranges(a + j * ld, a + j * ld + A._columns, a + pivot * ld);
+    }
+    const T diagonal = a[j * ld + j];
+    if (diagonal == (T)0) {
+      nonsingular = false;
+      continue;
+    }
+    const T *pivotRow = a + j * ld + j + 1;
+    for (std::size_t i = j + 1; i < n; i++) {
+      T *row = a + i * ld;
+      row[j] /= diagonal;
+      MWP::simd::axpy<T>(panelEnd - j - 1, -row[j], pivotRow, row + j + 1);
+    }
+  }
+  return nonsingular;
+}
+
+// Inverts the upper triangle of the n x n block at a in place, leaving the
+// strictly lower part untouched. Block columns are processed right to left,
+// so the leading block U00 is still the original factor when
+// X01 = -U00^-1 * U01 * X11 is formed: a GEMM and a blocked TRSM.
+template <typename T>
+void invertUpperInPlace(T *a, std::size_t ld, std::size_t n) {
+  const std::size_t blocks = (n + MWP::LUBlockSize - 1) / MWP::LUBlockSize;
+  MWP::WorkspaceScope scope;
+  T *diagonalInverse =
+      scope.allocate<T>(MWP::LUBlockSize * MWP::LUBlockSize);
+  T *column = scope.allocate<T>(n * MWP::LUBlockSize);
+  for (std::size_t b = blocks; b-- > 0;) {
+    const std::size_t j0 = b * MWP::LUBlockSize;
+    const std::size_t jb = std::min(MWP::LUBlockSize, n - j0);
+    T *diagonal = a + j0 * ld + j0;
+    // X11 = U11^-1, column by column: X[0:j, j] = -X[j][j] * X00 * U[0:j, j].
+    for (std::size_t j = 0; j < jb; j++) {
+      diagonal[j * ld + j] = (T)1 / diagonal[j * ld + j];
+      const T scale = -diagonal[j * ld + j];
+      for (std::size_t i = 0; i < j; i++) {
+        T sum = (T)0;
+        for (std::size_t p = i; p < j; p++) {
+          sum += diagonal[i * ld + p] * diagonal[p * ld + j];
+        }
+        diagonal[i * ld + j] = scale * sum;
+      }
+    }
+    if (j0 == 0) {
+      continue;
+    }
+    // U01 * X11 with X11 copied out as a full upper triangular block.
+    std::fill(diagonalInverse, diagonalInverse + jb * jb, (T)0);
+    for (std::size_t i = 0; i < jb; i++) {
+      std::copy(diagonal + i * ld + i, diagonal + i * ld + jb,
+                diagonalInverse + i * jb + i);
+    }
+    for (std::size_t i = 0; i < j0; i++) {
+      std::copy(a + i * ld + j0, a + i * ld + j0 + jb, column + i * jb);
+    }
+    MWP::gemm<T>(false, false, j0, jb, jb, (T)-1, column, jb, diagonalInverse,
+                 jb, (T)0, a + j0, ld);
+    MWP::trsm<T>(false, false, false, j0, jb, a, ld, a + j0, ld);
+  }
+}
+
+// Overwrites the n x n block holding U^-1 above its diagonal and L below it
+// with U^-1 * L^-1 by solving X * L = U^-1 one block column at a time, right
+// to left.
+template <typename T>
+void multiplyLowerInverse(T *a, std::size_t ld, std::size_t n) {
+  const std::size_t blocks = (n + MWP::LUBlockSize - 1) / MWP::LUBlockSize;
+  MWP::WorkspaceScope scope;
+  T *lower = scope.allocate<T>(n * MWP::LUBlockSize);
+  for (std::size_t b = blocks; b-- > 0;) {
+    const std::size_t j0 = b * MWP::LUBlockSize;
+    const std::size_t jb = std::min(MWP::LUBlockSize, n - j0);
+    const std::size_t j1 = j0 + jb;
+    // Move the block column of L out of the way.
+    std::fill(lower, lower + (n - j0) * jb, (T)0);
+    for (std::size_t i = j0; i < n; i++) {
+      const std::size_t end = std::min(i, j1);
+      for (std::size_t j = j0; j < end; j++) {
+        lower[(i - j0) * jb + (j - j0)] = a[i * ld + j];
+        a[i * ld + j] = (T)0;
+      }
+    }
+    if (j1 < n) {
+      MWP::gemm<T>(false, false, n, jb, n - j1, (T)-1, a + j1, ld,
+                   lower + jb * jb, jb, (T)1, a + j0, ld);
+    }
+    // X11 * L11 = B row by row, backward over the unit lower triangle.
+    for (std::size_t i = 0; i < n; i++) {
+      T *row = a + i * ld + j0;
+      for (std::size_t j = jb; j-- > 0;) {
+        T sum = (T)0;
+        for (std::size_t p = j + 1; p < jb; p++) {
+          sum += row[p] * lower[p * jb + j];
+        }
+        row[j] -= sum;
+      }
+    }
+  }
+}
+
+} // namespace
+
+template <typename T>
+bool MWP::luFactorInPlace(MatrixView<T> A, std::vector<std::size_t> &pivots) {
+  if (A._rows != A._columns) {
+    throw std::runtime_error(
+        "The matrix should be square to be decomposed into LU matrices!");
+  }
+  const std::size_t n = A._rows;
+  const std::size_t ld = A._ld;
+  T *a = A._data;
+  pivots.resize(n);
+  bool nonsingular = true;
+  for (std::size_t k0 = 0; k0 < n; k0 += LUBlockSize) {
+    const std::size_t kb = std::min(LUBlockSize, n - k0);
+    const std::size_t next = k0 + kb;
+    nonsingular = factorPanel(A, k0, kb, pivots.data()) && nonsingular;
+    if (next == n) {
+      break;
+    }
+    // U12 = L11^-1 * A12, row by row over the unit lower triangle.
+    for (std::size_t i = k0 + 1; i < next; i++) {
+      for (std::size_t p = k0; p < i; p++) {
+        simd::axpy<T>(n - next, -a[i * ld + p], a + p * ld + next,
+                      a + i * ld + next);
+      }
+    }
+    // A22 -= L21 * U12 carries almost all of the flops.
+    gemm<T>(false, false, n - next, n - next, kb, (T)-1, a + next * ld + k0, ld,
+            a + k0 * ld + next, ld, (T)1, a + next * ld + next, ld);
+  }
+  return nonsingular;
+}
+
+
+template <typename T>
+MWP::LU<T>::LU(Matrix<T> matrix) : _factors(std::move(matrix)) {
+  _nonsingular = luFactorInPlace(
+      _factors.view(0, _factors._rows, 0, _factors._columns), _pivots);
+}
+
+template <typename T> bool MWP::LU<T>::isNonsingular() const {
+  return _nonsingular;
+}
+
+template <typename T> MWP::Matrix<T> MWP::LU<T>::lower() const {
+  const Index n = _factors._rows;
+  Matrix<T> lowerMatrix(n, n);
+  for (Index i = 0; i < n; i++) {
+    std::copy(_factors._elements.begin() + i * n,
+              _factors._elements.begin() + i * n + i,
+              lowerMatrix._elements.begin() + i * n);
+    lowerMatrix._elements[i * n + i] = (T)1;
+  }
+  return lowerMatrix;
+}
+
+template <typename T> MWP::Matrix<T> MWP::LU<T>::upper() const {
+  const Index n = _factors._rows;
+  Matrix<T> upperMatrix(n, n);
+  for (Index i = 0; i < n; i++) {
+    std::copy(_factors._elements.begin() + i * n + i,
+              _factors._elements.begin() + (i + 1) * n,
+              upperMatrix._elements.begin() + i * n + i);
+  }
+  return upperMatrix;
+}
+
+template <typename T>
+std::vector<std::size_t> MWP::LU<T>::permutation() const {
+  std::vector<std::size_t> rows(_pivots.size());
+  for (std::size_t i = 0; i < rows.size(); i++) {
+    rows[i] = i;
+  }
+  for (std::size_t i = 0; i < _pivots.size(); i++) {
+    std::swap(rows[i], rows[_pivots[i]]);
+  }
+  return rows;
+}
+
+template <typename T> void MWP::LU<T>::solveInPlace(T *b) const {
+  const std::size_t n = _factors._rows;
+  const T *a = _factors._elements.data();
+  for (std::size_t i = 0; i < n; i++) {
+    if (_pivots[i] != i) {
+      std::swap(b[i], b[_pivots[i]]);
+    }
+  }
+  for (std::size_t i = 1; i < n; i++) {
+    b[i] -= simd::dot<T>(i, a + i * n, b);
+  }
+  for (std::size_t i = n; i-- > 0;) {
+    const T sum = simd::dot<T>(n - i - 1, a + i * n + i + 1, b + i + 1);
+    b[i] = (b[i] - sum) / a[i * n + i];
+  }
+}
+
+template <typename T>
+MWP::Vector<T> MWP::LU<T>::solve(const Vector<T> &constants) const {
+  Vector<T> variables;
+  solve(constants, variables);
+  return variables;
+}
+
+template <typename T>
+void MWP::LU<T>::solve(const Vector<T> &constants,
+                       Vector<T> &variables) const {
+  if (constants._rows != _factors._rows || constants._columns != 1) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants vector");
+  }
+  if (!_nonsingular) {
+    throw std::runtime_error("The matrix is singular");
+  }
+  variables = constants;
+  solveInPlace(variables._elements.data());
+}
+
+template <typename T> void MWP::LU<T>::solveInPlace(MatrixView<T> B) const {
+  if (B._rows != _factors._rows) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants matrix");
+  }
+  const std::size_t n = _factors._rows;
+  for (std::size_t i = 0; i < n; i++) {
+    if (_pivots[i] != i) {
+      std::swap_ranges(B._data + i * B._ld, B._data + i * B._ld + B._columns,
+                       B._data + _pivots[i] * B._ld);
+    }
+  }
+  trsm<T>(true, false, true, n, B._columns, _factors._elements.data(), n,
+          B._data, B._ld);
+  trsm<T>(false, false, false, n, B._columns, _factors._elements.data(), n,
+          B._data, B._ld);
+}
+
+template <typename T>
+MWP::Matrix<T> MWP::LU<T>::solve(const Matrix<T> &constants) const {
+  if (constants._rows != _factors._rows) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants matrix");
+  }
+  if (!_nonsingular) {
+    throw std::runtime_error("The matrix is singular");
+  }
+  Matrix<T> variables = constants;
+  solveInPlace(variables.view(0, variables._rows, 0, variables._columns));
+  return variables;
+}
+
+template <typename T> T MWP::LU<T>::determinant() const {
+  const std::size_t n = _factors._rows;
+  T product = (T)1;
+  for (std::size_t i = 0; i < n; i++) {
+    product *= _factors._elements[i * n + i];
+    if (_pivots[i] != i) {
+      product = -product;
+    }
+  }
+  return product;
+}
+
+template <typename T> double MWP::LU<T>::logDeterminant(int &sign) const {
+  const std::size_t n = _factors._rows;
+  double logSum = 0.0;
+  sign = 1;
+  for (std::size_t i = 0; i < n; i++) {
+    const T diagonal = _factors._elements[i * n + i];
+    if (diagonal == (T)0) {
+      sign = 0;
+      return -std::numeric_limits<double>::infinity();
+    }
+    if constexpr (!IsComplex<T>::value) {
+      if (((double)diagonal < 0.0) != (_pivots[i] != i)) {
+        sign = -sign;
+      }
+    }
+    logSum += std::log(MWP::magnitude(diagonal));
+  }
+  return logSum;
+}
+
+template <typename T> MWP::Matrix<T> MWP::LU<T>::inverse() const {
+  if (!_nonsingular) {
+    throw std::runtime_error("The matrix is singular");
+  }
+  const std::size_t n = _factors._rows;
+  Matrix<T> inverseMatrix = _factors;
+  T *a = inverseMatrix._elements.data();
+  invertUpperInPlace(a, n, n);
+  multiplyLowerInverse(a, n, n);
+  // A^-1 = U^-1 * L^-1 * P: the row interchanges become column interchanges
+  // applied in reverse order.
+  for (std::size_t j = n; j-- > 0;) {
+    if (_pivots[j] != j) {
+      for (std::size_t i = 0; i < n; i++) {
+        std::swap(a[i * n + j], a[i * n + _pivots[j]]);
+      }
+    }
+  }
+  return inverseMatrix;
+}
+
+#ifndef MWP_HEADER_ONLY
+template bool MWP::luFactorInPlace<double>(MatrixView<double>,
+                                           std::vector<std::size_t> &);
+template bool MWP::luFactorInPlace<float>(MatrixView<float>,
+                                          std::vector<std::size_t> &);
+template bool MWP::luFactorInPlace<std::complex<double>>(
+    MatrixView<std::complex<double>>, std::vector<std::size_t> &);
+template bool MWP::luFactorInPlace<std::complex<float>>(
+    MatrixView<std::complex<float>>, std::vector<std::size_t> &);
+template class MWP::LU<double>;
+template class MWP::LU<float>;
+template class MWP::LU<std::complex<double>>;
+template class MWP::LU<std::complex<float>>;
+#endif
@@ -1,8 +1,63 @@
 #include "LinSys.hpp"
+#include "Trsm.hpp"
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
-using namespace MWP;
+namespace MWP {
+
+namespace {
+
+struct Structure {
+  bool lower;
+  bool upper;
+  bool symmetric;
+  bool positiveDiagonal;
+};
+
+// Single pass over the coefficients plus a symmetry check. Triangularity is
+// decided on exact zeros: the substitutions never read the other triangle,
+// so any entry left there, however small next to the matrix scale, would be
+// silently dropped from the system.
+template <typename T> Structure detectStructure(const Matrix<T> &matrix) {
+  const Index n = matrix._rows;
+  const T *a = matrix._elements.data();
+  const T tolerance = 16 * std::numeric_limits<T>::epsilon();
+  Structure structure{true, true, true, true};
+  for (Index i = 0; i < n; i++) {
+    if (!(a[i * n + i] > (T)0)) {
+      structure.positiveDiagonal = false;
+    }
+    for (Index j = 0; j < i; j++) {
+      const T below = a[i * n + j];
+      const T above = a[j * n + i];
+      if (below != (T)0) {
+        structure.upper = false;
+      }
+      if (above != (T)0) {
+        structure.lower = false;
+      }
+      if (std::abs(below - above) >
+          tolerance * std::max(std::abs(below), std::abs(above))) {
+        structure.symmetric = false;
+      }
+    }
+  }
+  return structure;
+}
+
+// Every solver below divides by pivots and the Cholesky factor takes square
+// roots, both of which truncate in integer arithmetic and give wrong answers
+// without any error. Integral systems are rejected instead.
+[[noreturn]] void rejectIntegral() {
+  throw std::runtime_error(
+      "Linear systems are only solved for floating-point matrices");
+}
+
+} // namespace
 
 template <typename T>
 LinSys<T>::LinSys(Matrix<T> coefficients, Vector<T> constants) {
@@ -16,27 +71,23 @@ LinSys<T>::LinSys(Matrix<T> coefficients, Vector<T> constants) {
   if (coefficients._rows == 1) {
     throw std::runtime_error("Incompatible coefficient matrix dimension");
   }
-  this->coefficients = coefficients;
-  Vector<T> variables(coefficients._columns, constants._columns);
-  this->variables = variables;
-  this->constants = constants;
+  this->variables = Vector<T>(coefficients._columns, constants._columns);
+  this->coefficients = std::move(coefficients);
+  this->constants = std::move(constants);
+  this->_method = SolverMethod::None;
+  this->_mixedPrecision = false;
 }
 
 template <typename T> void LinSys<T>::solveForwardSubstitution() {
-  if (this->coefficients.isLowerTriangular()) {
-    this->variables._elements[0] =
-        this->constants._elements[0] / this->coefficients._elements[0];
-    for (int i = 1; i < this->coefficients._rows; i++) {
-      double sum = (T)0;
-      for (int j = 0; j <= i - 1; j++) {
-        sum += this->coefficients._elements[i * this->coefficients._rows + j] *
-               this->variables._elements[j];
-      }
-      this->variables._elements[i] =
-          (1.0f /
-           this->coefficients._elements[i * this->coefficients._columns + i]) *
-          (this->constants._elements[i] - sum);
-    }
+  if constexpr (std::is_integral<T>::value) {
+    rejectIntegral();
+  }
+  if (this->coefficients.isSquare() &&
+      this->coefficients.isLowerTriangular()) {
+    this->variables = this->constants;
+    trsm<T>(true, false, false, this->coefficients._rows, 1,
+            this->coefficients._elements.data(), this->coefficients._columns,
+            this->variables._elements.data(), 1);
   } else {
     throw std::runtime_error(
         "The given linear system is not a lower triangular "
@@ -45,22 +96,15 @@ template <typename T> void LinSys<T>::solveForwardSubstitution() {
 }
 
 template <typename T> void LinSys<T>::solveBackSubstitution() {
-  if (this->coefficients.isUpperTriangular()) {
-    this->variables._elements[this->coefficients._rows - 1] =
-        this->constants._elements[this->coefficients._rows - 1] /
-        this->coefficients(this->coefficients._rows - 1,
-                           this->coefficients._rows - 1);
-    for (int i = this->coefficients._rows - 2; i >= 0; i--) {
-      double sum = (T)0;
-      for (int j = i + 1; j < this->coefficients._rows; j++) {
-        sum += this->coefficients._elements[i * this->coefficients._rows + j] *
-               this->variables._elements[j];
-      }
-      this->variables._elements[i] =
-          (1.0f /
-           this->coefficients._elements[i * this->coefficients._columns + i]) *
-          (this->constants._elements[i] - sum);
-    }
+  if constexpr (std::is_integral<T>::value) {
+    rejectIntegral();
+  }
+  if (this->coefficients.isSquare() &&
+      this->coefficients.isUpperTriangular()) {
+    this->variables = this->constants;
+    trsm<T>(false, false, false, this->coefficients._rows, 1,
+            this->coefficients._elements.data(), this->coefficients._columns,
+            this->variables._elements.data(), 1);
   } else {
     throw std::runtime_error(
         "The given linear system is not an upper triangular "
@@ -68,5 +112,182 @@ template <typename T> void LinSys<T>::solveBackSubstitution() {
   }
 }
 
+template <typename T> void LinSys<T>::factor() {
+  if constexpr (std::is_integral<T>::value) {
+    rejectIntegral();
+  } else {
+    if (this->coefficients._rows < this->coefficients._columns) {
+      throw std::runtime_error(
+          "Underdetermined linear systems are not supported");
+    }
+    this->_lu = LU<T>();
+    this->_cholesky = Cholesky<T>();
+    this->_ldlt = LDLT<T>();
+    this->_qr = QR<T>();
+    this->_mixed = MixedPrecisionLU<T>();
+    if (!this->coefficients.isSquare()) {
+      this->_qr = QR<T>(this->coefficients);
+      this->_method = SolverMethod::QR;
+      return;
+    }
+    const Structure structure = detectStructure(this->coefficients);
+    if (structure.lower) {
+      this->_method = SolverMethod::LowerTriangular;
+      return;
+    }
+    if (structure.upper) {
+      this->_method = SolverMethod::UpperTriangular;
+      return;
+    }
+    if (structure.symmetric) {
+      if (structure.positiveDiagonal) {
+        this->_cholesky = Cholesky<T>(this->coefficients);
+        if (this->_cholesky.isPositiveDefinite()) {
+          this->_method = SolverMethod::Cholesky;
+          return;
+        }
+        this->_cholesky = Cholesky<T>();
+      }
+      this->_ldlt = LDLT<T>(this->coefficients);
+      this->_method = SolverMethod::LDLT;
+      return;
+    }
+    if (this->_mixedPrecision) {
+      this->_mixed = MixedPrecisionLU<T>(this->coefficients);
+      this->_method = SolverMethod::MixedPrecisionLU;
+      return;
+    }
+    this->_lu = LU<T>(this->coefficients);
+    this->_method = SolverMethod::LU;
+  }
+}
+
+template <typename T> void LinSys<T>::solve() {
+  if constexpr (std::is_integral<T>::value) {
+    rejectIntegral();
+  } else {
+    if (this->_method == SolverMethod::None) {
+      this->factor();
+    }
+    switch (this->_method) {
+    case SolverMethod::LowerTriangular:
+    case SolverMethod::UpperTriangular:
+      // factor() already checked the structure; the substitution entry
+      // points would rescan the whole matrix on every solve.
+      this->variables = this->constants;
+      trsm<T>(this->_method == SolverMethod::LowerTriangular, false, false,
+              this->coefficients._rows, 1, this->coefficients._elements.data(),
+              this->coefficients._columns, this->variables._elements.data(),
+              1);
+      break;
+    case SolverMethod::Cholesky:
+      this->_cholesky.solve(this->constants, this->variables);
+      break;
+    case SolverMethod::LDLT:
+      this->_ldlt.solve(this->constants, this->variables);
+      break;
+    case SolverMethod::LU:
+      this->_lu.solve(this->constants, this->variables);
+      break;
+    case SolverMethod::MixedPrecisionLU:
+      this->_refinement =
+          this->_mixed.solve(this->constants, this->variables);
+      break;
+    case SolverMethod::QR:
+      // Least squares: R1 * x = (Q^T * b)[0:n] with R1 the leading n x n
+      // block.
+      this->variables = this->_qr.solve(this->constants);
+      break;
+    case SolverMethod::None:
+      break;
+    }
+  }
+}
+
+template <typename T>
+Vector<T> LinSys<T>::solve(const Vector<T> &constants) {
+  if (constants._rows != this->coefficients._rows || constants._columns != 1) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants vector");
+  }
+  this->constants = constants;
+  this->solve();
+  return this->variables;
+}
+
+template <typename T>
+Matrix<T> LinSys<T>::solve(const Matrix<T> &constants) {
+  if constexpr (std::is_integral<T>::value) {
+    rejectIntegral();
+  } else {
+    if (constants._rows != this->coefficients._rows) {
+      throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                               "with the constants matrix");
+    }
+    if (this->_method == SolverMethod::None) {
+      this->factor();
+    }
+    const Index n = this->coefficients._columns;
+    const Index nrhs = constants._columns;
+    switch (this->_method) {
+    case SolverMethod::LowerTriangular:
+    case SolverMethod::UpperTriangular: {
+      Matrix<T> variables = constants;
+      trsm<T>(this->_method == SolverMethod::LowerTriangular, false, false, n,
+              nrhs, this->coefficients._elements.data(), n,
+              variables._elements.data(), nrhs);
+      return variables;
+    }
+    case SolverMethod::Cholesky:
+      return this->_cholesky.solve(constants);
+    case SolverMethod::LDLT:
+      return this->_ldlt.solve(constants);
+    case SolverMethod::LU:
+      return this->_lu.solve(constants);
+    case SolverMethod::MixedPrecisionLU:
+      return this->_mixed.solve(constants);
+    case SolverMethod::QR:
+      return this->_qr.solve(constants);
+    case SolverMethod::None:
+      break;
+    }
+    return Matrix<T>();
+  }
+}
+
+template <typename T>
+IterativeResult
+LinSys<T>::solveIterative(IterativeMethod method,
+                          const IterativeSettings &settings,
+                          const LinearOperator<T> *preconditioner) {
+  if constexpr (std::is_integral<T>::value) {
+    rejectIntegral();
+  } else {
+    if (!this->coefficients.isSquare()) {
+      throw std::runtime_error("The coefficient matrix should be square to be "
+                               "solved iteratively");
+    }
+    return this->_krylov.solve(method, LinearOperator<T>(this->coefficients),
+                               this->constants, this->variables, settings,
+                               preconditioner);
+  }
+}
+
+template <typename T> void LinSys<T>::setMixedPrecision(bool enabled) {
+  if (this->_mixedPrecision != enabled) {
+    this->_mixedPrecision = enabled;
+    this->_method = SolverMethod::None;
+  }
+}
+
+template <typename T> SolverMethod LinSys<T>::method() const {
+  return this->_method;
+}
+
+} // namespace MWP
+
+#ifndef MWP_HEADER_ONLY
 template class MWP::LinSys<double>;
-template class MWP::LinSys<int>;
\ No newline at end of file
+template class MWP::LinSys<float>;
+template class MWP::LinSys<int>;
+#endif
@@ -1,41 +1,59 @@
 #include "Matrix.hpp"
+#include "FixedMatrix.hpp"
+#include "Gemm.hpp"
+#include "LU.hpp"
+#include "QR.hpp"
+#include "Scalar.hpp"
+#include "Simd.hpp"
+#include "Transpose.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
-using namespace MWP;
+namespace MWP {
 
 template <typename T> Matrix<T>::Matrix() {
   _rows = 0;
   _columns = 0;
   _size = 0;
-  _elements = std::vector<T>();
+  _elements = AlignedVector<T>();
 }
 
 template <typename T>
-Matrix<T>::Matrix(unsigned int rows, unsigned int columns) {
+Matrix<T>::Matrix(Index rows, Index columns)
+    : Matrix(rows, columns, Uninitialized) {
+  std::fill(_elements.begin(), _elements.end(), (T)0);
+}
+
+template <typename T>
+Matrix<T>::Matrix(Index rows, Index columns, UninitializedTag) {
   if (columns == 0 || rows == 0) {
     throw std::runtime_error("The row or column attribute cannot be zero");
   }
+  if (rows > std::numeric_limits<Index>::max() / columns) {
+    throw std::runtime_error("The matrix size exceeds the index type range");
+  }
   this->_rows = rows;
   this->_columns = columns;
   this->_size = rows * columns;
   _elements.resize(this->_size);
-  for (int i = 0; i < this->_rows; i++) {
-    for (int j = 0; j < this->_columns; j++) {
-      this->_elements[i * this->_columns + j] = (T)0;
-    }
-  }
 }
 
 template <typename T>
-Matrix<T>::Matrix(std::vector<T> elements, unsigned int rows,
-                  unsigned int columns) {
+Matrix<T>::Matrix(AlignedVector<T> elements, Index rows, Index columns) {
   if (columns == 0 || rows == 0) {
     throw std::runtime_error("The row or column attribute cannot be zero");
   }
+  if (rows > std::numeric_limits<Index>::max() / columns) {
+    throw std::runtime_error("The matrix size exceeds the index type range");
+  }
   if (elements.size() != columns * rows) {
     throw std::runtime_error(
         "The amount of elements do not match with the matrix size");
@@ -43,17 +61,32 @@ Matrix<T>::Matrix(std::vector<T> elements, unsigned int rows,
   _rows = rows;
   _columns = columns;
   _size = rows * columns;
-  _elements = elements;
+  _elements = std::move(elements);
 }
 
-template <typename T> T Matrix<T>::operator[](unsigned int index) const {
+template <typename T>
+Matrix<T>::Matrix(const std::vector<T> &elements, Index rows, Index columns)
+    : Matrix(AlignedVector<T>(elements.begin(), elements.end()), rows,
+             columns) {}
+
+template <typename T>
+Matrix<T>::Matrix(std::vector<T> &&elements, Index rows, Index columns)
+    : Matrix(AlignedVector<T>(elements), rows, columns) {
+  std::vector<T>().swap(elements);
+}
+
+template <typename T>
+Matrix<T>::Matrix(std::initializer_list<T> elements, Index rows, Index columns)
+    : Matrix(AlignedVector<T>(elements), rows, columns) {}
+
+template <typename T> T Matrix<T>::operator[](Index index) const {
   if (index > this->_size - 1) {
     throw std::runtime_error("Index out of bounds");
   }
   return this->_elements[index];
 }
 
-template <typename T> T &Matrix<T>::operator[](unsigned int index) {
+template <typename T> T &Matrix<T>::operator[](Index index) {
   if (index > this->_size - 1) {
     throw std::runtime_error("Index out of bounds");
   }
@@ -61,8 +94,7 @@ template <typename T> T &Matrix<T>::operator[](unsigned int index) {
 }
 
 template <typename T>
-T Matrix<T>::operator()(unsigned int rowIndex,
-                        unsigned int columnsIndex) const {
+T Matrix<T>::operator()(Index rowIndex, Index columnsIndex) const {
   if (rowIndex > this->_size - 1 || columnsIndex > this->_size) {
     throw std::runtime_error("Index out of bounds");
   }
@@ -70,107 +102,42 @@ T Matrix<T>::operator()(unsigned int rowIndex,
 }
 
 template <typename T>
-T &Matrix<T>::operator()(unsigned int rowIndex, unsigned int columnsIndex) {
+T &Matrix<T>::operator()(Index rowIndex, Index columnsIndex) {
   if (rowIndex > this->_size - 1 || columnsIndex > this->_size) {
     throw std::runtime_error("Index out of bounds");
   }
   return this->_elements[rowIndex * this->_columns + columnsIndex];
 }
 
-template <typename T>
-Matrix<T> Matrix<T>::operator+(const Matrix<T> &matrix) const {
-  if (this->_rows != matrix._rows || this->_columns != matrix._columns) {
-    throw std::runtime_error(
-        "Invalid matrices dimensions for addition operation");
-  }
-  Matrix<T> result(this->_rows, this->_columns);
-  for (int i = 0; i < result._rows; i++) {
-    for (int j = 0; j < result._columns; j++) {
-      result._elements[i * result._columns + j] =
-          this->_elements[i * result._columns + j] +
-          matrix._elements[i * result._columns + j];
-    }
-  }
-  return result;
-}
-
-template <typename T>
-Matrix<T> Matrix<T>::operator-(const Matrix<T> &matrix) const {
-  if (this->_rows != matrix._rows || this->_columns != matrix._columns) {
-    throw std::runtime_error(
-        "Invalid matrices dimensions for subtraction operation");
-  }
-  Matrix<T> result(this->_rows, this->_columns);
-  for (int i = 0; i < result._rows; i++) {
-    for (int j = 0; j < result._columns; j++) {
-      result._elements[i * result._columns + j] =
-          this->_elements[i * result._columns + j] -
-          matrix._elements[i * result._columns + j];
-    }
-  }
-  return result;
-}
-
-template <typename T> Matrix<T> Matrix<T>::operator*(T scalar) const {
-  Matrix<T> result(this->_rows, this->_columns);
-  for (int i = 0; i < result._rows; i++) {
-    for (int j = 0; j < result._columns; j++) {
-      result._elements[i * result._columns + j] =
-          this->_elements[i * result._columns + j] * scalar;
-    }
-  }
-  return result;
-}
-
-template <typename T>
-Matrix<T> Matrix<T>::operator*(const Matrix<T> &matrix) const {
-  if (this->_columns != matrix._rows) {
-    throw std::runtime_error(
-        "Invalid matrices dimensions for multiplication operation");
-  }
-  Matrix<T> result(this->_rows, matrix._columns);
-  for (int i = 0; i < this->_rows; i++) {
-    for (int j = 0; j < matrix._columns; j++) {
-      for (int k = 0; k < this->_columns; k++) {
-        result._elements[i * matrix._columns + j] +=
-            this->_elements[i * this->_columns + k] *
-            matrix._elements[k * matrix._columns + j];
-      }
-    }
-  }
-  return result;
-}
-
 template <typename T>
 Vector<T> Matrix<T>::operator*(const Vector<T> &vector) const {
   if (this->_columns != vector._rows || vector._columns != 1) {
     throw std::runtime_error(
         "Invalid dimensions for matrix-vector multiplication");
   }
-  Vector<T> result(this->_rows, vector._columns);
-  for (int i = 0; i < this->_rows; i++) {
-    result[i] = (T)0;
-    for (int j = 0; j < this->_columns; j++) {
-      result[i] += this->_elements[i * this->_columns + j] * vector[j];
-    }
-  }
+  Vector<T> result(this->_rows, vector._columns, Uninitialized);
+  gemv<T>(false, this->_rows, this->_columns, (T)1, this->_elements.data(),
+          this->_columns, vector._elements.data(), (T)0,
+          result._elements.data());
   return result;
 }
 
 template <typename T> Matrix<T> &Matrix<T>::transpose() {
-  std::vector<T> transposedElements;
-  transposedElements.resize(this->_size);
-  const int rows = this->_rows;
-  const int columns = this->_columns;
-  this->_rows = columns;
-  this->_columns = rows;
-  for (int i = 0; i < this->_rows; i++) {
-    for (int j = 0; j < this->_columns; j++) {
-      transposedElements[i * this->_columns + j] =
-          this->_elements[j * this->_rows + i];
-    }
+  if (this->_rows == this->_columns) {
+    transposeInPlace<T>(this->_rows, this->_columns, this->_elements.data());
+  } else {
+    AlignedVector<T> transposedElements(this->_size);
+    MWP::transpose<T>(this->_rows, this->_columns, this->_elements.data(),
+                      this->_columns, transposedElements.data(), this->_rows);
+    this->_elements.swap(transposedElements);
   }
-  this->_elements = transposedElements;
+  std::swap(this->_rows, this->_columns);
+  return *this;
+}
+
+template <typename T> Matrix<T> &Matrix<T>::operator*=(T scalar) {
+  simd::scale<T>(this->_size, scalar, this->_elements.data(),
+                 this->_elements.data());
   return *this;
 }
 
@@ -179,8 +146,8 @@ template <typename T> bool Matrix<T>::isSquare() const {
 }
 
 template <typename T> bool Matrix<T>::isLowerTriangular()  const {
-  for (int i = 0; i < this->_rows; i++) {
-    for (int j = 0; j < this->_columns; j++) {
+  for (Index i = 0; i < this->_rows; i++) {
+    for (Index j = 0; j < this->_columns; j++) {
       if (i < j && std::abs((this->_elements[i * this->_columns + j])) > 10e-10) {
         std::cout << this->_elements[i * this->_columns + j] << '\n';
         return false;
@@ -191,8 +158,8 @@ template <typename T> bool Matrix<T>::isLowerTriangular()  const {
 }
 
 template <typename T> bool Matrix<T>::isUpperTriangular() const  {
-  for (int i = 0; i < this->_rows; i++) {
-    for (int j = 0; j < this->_columns; j++) {
+  for (Index i = 0; i < this->_rows; i++) {
+    for (Index j = 0; j < this->_columns; j++) {
       if (i > j && std::abs((this->_elements[i * this->_columns + j])) > 10e-10) {
         std::cout << this->_elements[i * this->_columns + j] << '\n';
         return false;
@@ -207,107 +174,253 @@ template <typename T> std::pair<MatrixD, MatrixD> Matrix<T>::LUDecomposition() {
     throw std::runtime_error(
         "The matrix should be square to be decomposed into LU matrices!");
   }
-  MatrixD LMatrix = IdentityMatrix<double>(this->_rows, this->_columns);
-  std::vector<double> elementsDouble(this->_elements.begin(),
-                                     this->_elements.end());
-  MatrixD UMatrix(elementsDouble, this->_rows, this->_columns);
-  for (int i = 0; i < this->_rows; i++) {
-    for (int j = 0; j < this->_columns; j++) {
-      if (i > j) {
-        LMatrix[i * this->_columns + j] =
-            UMatrix[i * this->_columns + j] / UMatrix[j * this->_columns + j];
-        for (int k = j; k < this->_columns; k++) {
-          UMatrix[i * this->_columns + k] -=
-              LMatrix[i * this->_columns + j] * UMatrix[j * this->_columns + k];
-        }
+  if constexpr (IsComplex<T>::value) {
+    throw std::runtime_error("Complex matrices are decomposed with the LU "
+                             "class, which keeps their element type");
+  } else {
+    MatrixD LMatrix = IdentityMatrix<double>(this->_rows, this->_columns);
+    std::vector<double> elementsDouble(this->_elements.begin(),
+                                       this->_elements.end());
+    MatrixD UMatrix(elementsDouble, this->_rows, this->_columns);
+    const Index n = this->_rows;
+    for (Index i = 1; i < n; i++) {
+      double *uRow = UMatrix._elements.data() + i * n;
+      for (Index j = 0; j < i; j++) {
+        const double *pivotRow = UMatrix._elements.data() + j * n;
+        const double factor = uRow[j] / pivotRow[j];
+        LMatrix[i * n + j] = factor;
+        simd::axpy<double>(n - j, -factor, pivotRow + j, uRow + j);
       }
     }
+    return std::pair<MatrixD, MatrixD>{LMatrix, UMatrix};
   }
-  return std::pair<MatrixD, MatrixD>{LMatrix, UMatrix};
 }
 
 template <typename T>
-MWP::Matrix<T>
-MWP::Matrix<T>::subMatrix(unsigned int startRow, unsigned int endRow,
-                          unsigned int startCol, unsigned int endCol) const {
-  if (startRow > endRow || startCol >= endCol || endRow > _rows ||
+MatrixView<T> Matrix<T>::view(Index startRow, Index endRow, Index startCol,
+                              Index endCol) {
+  if (startRow > endRow || startCol > endCol || endRow > _rows ||
       endCol > _columns) {
-    throw std::out_of_range("Invalid submatrix range");
+    throw std::out_of_range("Invalid view range");
   }
+  return MatrixView<T>(_elements.data() + startRow * _columns + startCol,
+                       endRow - startRow, endCol - startCol, _columns);
+}
 
-  unsigned int subRows = endRow - startRow;
-  unsigned int subCols = endCol - startCol;
-  std::vector<T> subElements(subRows * subCols);
+template <typename T>
+ConstMatrixView<T> Matrix<T>::view(Index startRow, Index endRow, Index startCol,
+                                   Index endCol) const {
+  if (startRow > endRow || startCol > endCol || endRow > _rows ||
+      endCol > _columns) {
+    throw std::out_of_range("Invalid view range");
+  }
+  return ConstMatrixView<T>(_elements.data() + startRow * _columns + startCol,
+                            endRow - startRow, endCol - startCol, _columns);
+}
 
-  for (unsigned int i = startRow; i < endRow; i++) {
-    for (unsigned int j = startCol; j < endCol; j++) {
-      subElements[(i - startRow) * subCols + (j - startCol)] =
-          _elements[i * _columns + j];
-    }
+template <typename T>
+VectorView<T> Matrix<T>::row(Index rowIndex) {
+  if (rowIndex >= _rows) {
+    throw std::out_of_range("Out of range row.");
   }
+  return VectorView<T>(_elements.data() + rowIndex * _columns, 1, _columns);
+}
+
+template <typename T>
+ConstVectorView<T> Matrix<T>::row(Index rowIndex) const {
+  if (rowIndex >= _rows) {
+    throw std::out_of_range("Out of range row.");
+  }
+  return ConstVectorView<T>(_elements.data() + rowIndex * _columns, 1,
+                            _columns);
+}
+
+template <typename T>
+VectorView<T> Matrix<T>::column(Index columnIndex) {
+  if (columnIndex >= _columns) {
+    throw std::out_of_range("Out of range column.");
+  }
+  return VectorView<T>(_elements.data() + columnIndex, _rows, 1, _columns);
+}
+
+template <typename T>
+ConstVectorView<T> Matrix<T>::column(Index columnIndex) const {
+  if (columnIndex >= _columns) {
+    throw std::out_of_range("Out of range column.");
+  }
+  return ConstVectorView<T>(_elements.data() + columnIndex, _rows, 1,
+                            _columns);
+}
 
-  return Matrix<T>(subElements, subRows, subCols);
+template <typename T>
+Matrix<T>
+Matrix<T>::subMatrix(Index startRow, Index endRow, Index startCol,
+                     Index endCol) const {
+  if (startRow > endRow || startCol >= endCol || endRow > _rows ||
+      endCol > _columns) {
+    throw std::out_of_range("Invalid submatrix range");
+  }
+  return Matrix<T>(view(startRow, endRow, startCol, endCol));
 }
 
 template <typename T>
-void MWP::Matrix<T>::replaceSubmatrix(const Matrix<T> &smallerMatrix,
-                                      unsigned int startRow,
-                                      unsigned int startCol) {
+void Matrix<T>::replaceSubmatrix(const Matrix<T> &smallerMatrix,
+                                      Index startRow,
+                                      Index startCol) {
   if (startRow + smallerMatrix._rows > _rows ||
       startCol + smallerMatrix._columns > _columns) {
     throw std::out_of_range("Smaller matrix does not fit within the larger "
                             "matrix at the specified indices.");
   }
-
-  for (unsigned int i = 0; i < smallerMatrix._rows; i++) {
-    for (unsigned int j = 0; j < smallerMatrix._columns; j++) {
-      unsigned int largerIndex = (startRow + i) * _columns + (startCol + j);
-      _elements[largerIndex] = smallerMatrix(i, j);
-    }
-  }
+  view(startRow, startRow + smallerMatrix._rows, startCol,
+       startCol + smallerMatrix._columns) = smallerMatrix;
 }
 
-template <typename T> T MWP::Matrix<T>::colMax(unsigned int col) const {
+template <typename T> T Matrix<T>::colMax(Index col) const {
   if (col >= _columns) {
     throw std::out_of_range("Out of range column.");
   }
-  T max = std::abs(this->operator()(0, col));
-  T current;
-  for (int i = 1; i < _rows; i++) {
-    current = std::abs(this->operator()(i, col));
+  double max = magnitude(_elements[col]);
+  double current;
+  for (Index i = 1; i < _rows; i++) {
+    current = magnitude(_elements[i * _columns + col]);
     if (current > max) {
       max = current;
     }
   }
-  return max;
+  return (T)max;
+}
+
+template <typename T> T Matrix<T>::norm2() const {
+  return std::sqrt(simd::sumSquares<T>(_size, _elements.data()));
 }
 
-template <typename T> T MWP::Matrix<T>::norm2() const {
-  T sum = 0;
-  for (T e : _elements) {
-    sum += (e * e);
+template <typename T>
+std::pair<Matrix<T>, Matrix<T>> Matrix<T>::QRdecomp() const {
+  if constexpr (IsComplex<T>::value) {
+    throw std::runtime_error(
+        "The QR decomposition is only available for real matrices");
+  } else if constexpr (std::is_integral<T>::value) {
+    // The Householder reflectors are not integral.
+    throw std::runtime_error(
+        "The QR decomposition is only available for floating-point matrices");
+  } else {
+    // The blocked factorization keeps Q implicit; it is only formed here
+    // because this interface returns it explicitly.
+    const QR<T> qr(*this);
+    Matrix<T> R(this->_rows, this->_columns);
+    R.view(0, (Index)qr._tau.size(), 0, this->_columns) = qr.upper();
+    return {qr.orthogonal(true), R};
   }
-  return std::sqrt(sum);
 }
 
+namespace {
+
+// Closed-form determinant of a row-major n x n block, n <= 4, evaluated in
+// double whatever the element type. The empty product makes it 1 for n = 0.
+template <typename T> double smallDeterminant(const T *a, Index n) {
+  std::array<double, 16> values{};
+  std::copy(a, a + n * n, values.begin());
+  switch (n) {
+  case 0:
+    return 1.0;
+  case 1:
+    return detail::smallDeterminant<1>(values.data());
+  case 2:
+    return detail::smallDeterminant<2>(values.data());
+  case 3:
+    return detail::smallDeterminant<3>(values.data());
+  default:
+    return detail::smallDeterminant<4>(values.data());
+  }
+}
+
+// Closed-form inverse of a row-major n x n block, n <= 4.
 template <typename T>
-std::pair<MWP::Matrix<T>, MWP::Matrix<T>> MWP::Matrix<T>::QRdecomp() const {
-  MWP::Matrix<T> R = *this;
-  MWP::Matrix<T> Q = IdentityMatrix<T>(this->_rows, this->_rows);
-  unsigned int k = std::min(this->_rows - 1, this->_columns);
-  std::pair<MWP::Matrix<T>, MWP::Matrix<T>> ru;
-  for (int i = 0; i < k; i++) {
-    ru = hh(R.subMatrix(i, R._rows, i, R._columns));
-    R.replaceSubmatrix(ru.first, i, i);
-    Matrix<T> uh = ru.second;
-    T uhNorm = uh.norm2();
-    Matrix<T> qsub = Q.subMatrix(0, Q._rows, i, Q._columns);
-    Matrix<T> qres = qsub - (qsub * (2.f / (uhNorm * uhNorm))) *
-                                (uh * TransposeMatrix<T>(uh)); // qsub - qumul;
-    Q.replaceSubmatrix(qres, 0, i);
-  }
-  return {Q, R};
+bool smallInverse(const T *a, Index n, T *out) {
+  switch (n) {
+  case 1:
+    return detail::smallInverse<1>(a, out);
+  case 2:
+    return detail::smallInverse<2>(a, out);
+  case 3:
+    return detail::smallInverse<3>(a, out);
+  default:
+    return detail::smallInverse<4>(a, out);
+  }
+}
+
+} // namespace
+
+template <typename T> double Matrix<T>::det() const {
+  if (!this->isSquare()) {
+    throw std::runtime_error(
+        "The matrix should be square to compute its determinant!");
+  }
+  if constexpr (IsComplex<T>::value) {
+    throw std::runtime_error("The determinant of a complex matrix is not "
+                             "real; use LU::determinant()");
+  } else {
+    if (this->_rows <= 4) {
+      return smallDeterminant(this->_elements.data(), this->_rows);
+    }
+    // The factorization is done in floating point whatever the element type.
+    const LU<double> lu(Matrix<double>(
+        std::vector<double>(this->_elements.begin(), this->_elements.end()),
+        this->_rows, this->_columns));
+    return lu.determinant();
+  }
 }
 
+template <typename T> double Matrix<T>::logDet(int &sign) const {
+  if (!this->isSquare()) {
+    throw std::runtime_error(
+        "The matrix should be square to compute its determinant!");
+  }
+  if constexpr (IsComplex<T>::value) {
+    return LU<T>(*this).logDeterminant(sign);
+  } else {
+    if (this->_rows <= 4) {
+      const double determinant =
+          smallDeterminant(this->_elements.data(), this->_rows);
+      sign = determinant > 0.0 ? 1 : (determinant < 0.0 ? -1 : 0);
+      return std::log(std::abs(determinant));
+    }
+    const LU<double> lu(Matrix<double>(
+        std::vector<double>(this->_elements.begin(), this->_elements.end()),
+        this->_rows, this->_columns));
+    return lu.logDeterminant(sign);
+  }
+}
+
+template <typename T> Matrix<T> Matrix<T>::inverse() const {
+  if (!this->isSquare()) {
+    throw std::runtime_error(
+        "The matrix should be square to compute its inverse!");
+  }
+  if constexpr (std::is_integral<T>::value) {
+    // Integer division would silently truncate a non-integral inverse.
+    throw std::runtime_error(
+        "The inverse is only available for floating-point matrices");
+  } else {
+    if (this->_rows <= 4) {
+      Matrix<T> inverseMatrix(this->_rows, this->_columns);
+      if (!smallInverse(this->_elements.data(), this->_rows,
+                        inverseMatrix._elements.data())) {
+        throw std::runtime_error("The matrix is singular");
+      }
+      return inverseMatrix;
+    }
+    return LU<T>(*this).inverse();
+  }
+}
+
+} // namespace MWP
+
+#ifndef MWP_HEADER_ONLY
 template class MWP::Matrix<double>;
-template class MWP::Matrix<int>;
\ No newline at end of file
+template class MWP::Matrix<float>;
+template class MWP::Matrix<std::complex<double>>;
+template class MWP::Matrix<std::complex<float>>;
+template class MWP::Matrix<int>;
+#endif
@@ -0,0 +1,186 @@
+#include "MixedPrecision.hpp"
+#include "Gemm.hpp"
+#include "Workspace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace MWP {
+
+namespace {
+
+template <typename T> T maxNorm(std::size_t n, const T *x) {
+  T largest = (T)0;
+  for (std::size_t i = 0; i < n; i++) {
+    largest = std::max(largest, (T)std::abs(x[i]));
+  }
+  return largest;
+}
+
+// A float factorization that hit a zero pivot, or whose factors overflowed
+// because A has entries beyond the float range, cannot be refined.
+bool usable(const LU<float> &factors) {
+  if (!factors.isNonsingular()) {
+    return false;
+  }
+  for (float value : factors._factors._elements) {
+    if (!std::isfinite(value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+template <typename T>
+MixedPrecisionLU<T>::MixedPrecisionLU(Matrix<T> matrix,
+                                      const RefinementSettings &settings)
+    : _matrix(std::move(matrix)), _fellBack(false), _settings(settings),
+      _matrixNorm((T)0) {
+  if (!_matrix.isSquare()) {
+    throw std::runtime_error(
+        "The matrix should be square to be decomposed into LU matrices!");
+  }
+  const std::size_t n = _matrix._rows;
+  Matrix<float> low(_matrix._rows, _matrix._columns);
+  for (std::size_t i = 0; i < _matrix._elements.size(); i++) {
+    low._elements[i] = (float)_matrix._elements[i];
+  }
+  for (std::size_t i = 0; i < n; i++) {
+    T sum = (T)0;
+    for (std::size_t j = 0; j < n; j++) {
+      sum += std::abs(_matrix._elements[i * n + j]);
+    }
+    _matrixNorm = std::max(_matrixNorm, sum);
+  }
+  _lowFactors = LU<float>(std::move(low));
+  _residual.resize(n);
+  _correction.resize(n);
+  if (!usable(_lowFactors)) {
+    fallBack();
+  }
+}
+
+template <typename T> bool MixedPrecisionLU<T>::isNonsingular() const {
+  return _fellBack ? _fallback.isNonsingular() : _lowFactors.isNonsingular();
+}
+
+template <typename T> bool MixedPrecisionLU<T>::usedFallback() const {
+  return _fellBack;
+}
+
+template <typename T> void MixedPrecisionLU<T>::fallBack() {
+  _fellBack = true;
+  _lowFactors = LU<float>();
+  _fallback = LU<T>(_matrix);
+}
+
+// r = b - A * x in the working precision; returns ||r||_inf.
+template <typename T> T MixedPrecisionLU<T>::residual(const T *b, const T *x) {
+  const std::size_t n = _matrix._rows;
+  std::copy(b, b + n, _residual.begin());
+  gemv<T>(false, n, n, (T)-1, _matrix._elements.data(), n, x, (T)1,
+          _residual.data());
+  return maxNorm(n, _residual.data());
+}
+
+template <typename T>
+RefinementResult MixedPrecisionLU<T>::solve(const T *b, T *x) {
+  const std::size_t n = _matrix._rows;
+  if (!isNonsingular()) {
+    throw std::runtime_error("The matrix is singular");
+  }
+  RefinementResult result;
+  if (!_fellBack) {
+    const double tolerance = std::sqrt((double)n) *
+                             (double)std::numeric_limits<T>::epsilon() *
+                             (double)_matrixNorm;
+    // Starting from x = 0 makes the first correction the plain float solve.
+    std::fill(x, x + n, (T)0);
+    std::copy(b, b + n, _residual.begin());
+    T norm = maxNorm(n, b);
+    while (true) {
+      result._residualHistory.push_back((double)norm);
+      if ((double)norm <= tolerance * (double)maxNorm(n, x)) {
+        result._converged = true;
+        result._residualNorm = (double)norm;
+        return result;
+      }
+      const std::size_t steps = result._residualHistory.size();
+      const bool stalled =
+          steps > 1 && !((double)norm <= _settings._stallRatio *
+                                             result._residualHistory[steps - 2]);
+      if (stalled || result._iterations == _settings._maxIterations) {
+        break;
+      }
+      // The residual is scaled to unit norm before rounding so that neither
+      // tiny nor huge residuals leave the float range.
+      for (std::size_t i = 0; i < n; i++) {
+        _correction[i] = (float)(_residual[i] / norm);
+      }
+      _lowFactors.solveInPlace(_correction.data());
+      for (std::size_t i = 0; i < n; i++) {
+        x[i] += norm * (T)_correction[i];
+      }
+      result._iterations++;
+      norm = residual(b, x);
+    }
+    fallBack();
+    if (!_fallback.isNonsingular()) {
+      throw std::runtime_error("The matrix is singular");
+    }
+  }
+  std::copy(b, b + n, x);
+  _fallback.solveInPlace(x);
+  result._fallback = true;
+  result._converged = true;
+  result._residualNorm = (double)residual(b, x);
+  result._residualHistory.push_back(result._residualNorm);
+  return result;
+}
+
+template <typename T>
+RefinementResult MixedPrecisionLU<T>::solve(const Vector<T> &constants,
+                                            Vector<T> &variables) {
+  if (constants._rows != _matrix._rows || constants._columns != 1) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants vector");
+  }
+  if (variables._rows != constants._rows || variables._columns != 1) {
+    variables = Vector<T>(constants._rows, 1);
+  }
+  return solve(constants._elements.data(), variables._elements.data());
+}
+
+template <typename T>
+Matrix<T> MixedPrecisionLU<T>::solve(const Matrix<T> &constants) {
+  if (constants._rows != _matrix._rows) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants matrix");
+  }
+  const std::size_t n = constants._rows;
+  const std::size_t nrhs = constants._columns;
+  Matrix<T> variables(constants._rows, constants._columns, Uninitialized);
+  WorkspaceScope scope;
+  T *b = scope.allocate<T>(n);
+  T *x = scope.allocate<T>(n);
+  for (std::size_t j = 0; j < nrhs; j++) {
+    for (std::size_t i = 0; i < n; i++) {
+      b[i] = constants._elements[i * nrhs + j];
+    }
+    solve(b, x);
+    for (std::size_t i = 0; i < n; i++) {
+      variables._elements[i * nrhs + j] = x[i];
+    }
+  }
+  return variables;
+}
+
+} // namespace MWP
+
+#ifndef MWP_HEADER_ONLY
+template class MWP::MixedPrecisionLU<double>;
+template class MWP::MixedPrecisionLU<float>;
+#endif
@@ -0,0 +1,322 @@
+#include "Preconditioner.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Rows of one level handed to a task at once.
+constexpr std::size_t LevelChunkSize = 256;
+
+// Runs task(row) over the rows of every level, levels in order. Levels too
+// small to amortize a parallel loop run on the calling thread.
+template <typename Task>
+void forEachLevel(const MWP::LevelSchedule &schedule, Task task) {
+  MWP::ThreadPool &pool = MWP::ThreadPool::instance();
+  for (std::size_t level = 0; level < schedule.levels(); level++) {
+    const std::size_t first = schedule._levelStarts[level];
+    const std::size_t count = schedule._levelStarts[level + 1] - first;
+    if (count < 2 * LevelChunkSize) {
+      for (std::size_t r = first; r < first + count; r++) {
+        task(schedule._rows[r]);
+      }
+      continue;
+    }
+    const std::size_t chunks = (count + LevelChunkSize - 1) / LevelChunkSize;
+    pool.parallelFor(chunks, [&](std::size_t c) {
+      const std::size_t begin = first + c * LevelChunkSize;
+      const std::size_t end = std::min(first + count, begin + LevelChunkSize);
+      for (std::size_t r = begin; r < end; r++) {
+        task(schedule._rows[r]);
+      }
+    });
+  }
+}
+
+// Position of the diagonal entry of every row of a CSR matrix.
+template <typename T>
+std::vector<std::size_t> diagonalPositions(const MWP::SparseMatrix<T> &A) {
+  std::vector<std::size_t> diagonal(A._rows);
+  for (std::size_t i = 0; i < A._rows; i++) {
+    auto first = A._indices.begin() + A._offsets[i];
+    auto last = A._indices.begin() + A._offsets[i + 1];
+    auto found = std::lower_bound(first, last, i);
+    if (found == last || *found != i) {
+      throw std::runtime_error(
+          "The matrix should have a full diagonal to be preconditioned");
+    }
+    diagonal[i] = found - A._indices.begin();
+  }
+  return diagonal;
+}
+
+template <typename T> void checkSquare(const MWP::SparseMatrix<T> &A) {
+  if (A._rows != A._columns) {
+    throw std::runtime_error("The matrix should be square to be preconditioned");
+  }
+}
+
+// In-place sparse triangular solve of a CSR matrix, level by level. The
+// lower solve reads the entries before the diagonal and the upper solve the
+// entries after it.
+template <typename T>
+void solveTriangular(const MWP::SparseMatrix<T> &A,
+                     const std::vector<std::size_t> &diagonal,
+                     const MWP::LevelSchedule &schedule, bool lower,
+                     bool unitDiagonal, T *x) {
+  forEachLevel(schedule, [&](std::size_t i) {
+    const std::size_t first = lower ? A._offsets[i] : diagonal[i] + 1;
+    const std::size_t last = lower ? diagonal[i] : A._offsets[i + 1];
+    T sum = x[i];
+    for (std::size_t p = first; p < last; p++) {
+      sum -= A._values[p] * x[A._indices[p]];
+    }
+    x[i] = unitDiagonal ? sum : sum / A._values[diagonal[i]];
+  });
+}
+
+} // namespace
+
+MWP::LevelSchedule::LevelSchedule(const std::vector<std::size_t> &offsets,
+                                  const std::vector<std::size_t> &indices,
+                                  const std::vector<std::size_t> &diagonal,
+                                  bool lower) {
+  const std::size_t n = offsets.size() - 1;
+  std::vector<std::size_t> level(n, 0);
+  std::size_t levelCount = n == 0 ? 0 : 1;
+  for (std::size_t step = 0; step < n; step++) {
+    const std::size_t i = lower ? step : n - 1 - step;
+    const std::size_t first = lower ? offsets[i] : diagonal[i] + 1;
+    const std::size_t last = lower ? diagonal[i] : offsets[i + 1];
+    std::size_t deepest = 0;
+    for (std::size_t p = first; p < last; p++) {
+      deepest = std::max(deepest, level[indices[p]] + 1);
+    }
+    level[i] = deepest;
+    levelCount = std::max(levelCount, deepest + 1);
+  }
+  // Bucket the rows by level, keeping the solve order inside each level.
+  _levelStarts.assign(levelCount + 1, 0);
+  for (std::size_t i = 0; i < n; i++) {
+    _levelStarts[level[i] + 1]++;
+  }
+  for (std::size_t l = 0; l < levelCount; l++) {
+    _levelStarts[l + 1] += _levelStarts[l];
+  }
+  _rows.resize(n);
+  std::vector<std::size_t> next(_levelStarts.begin(), _levelStarts.end() - 1);
+  for (std::size_t step = 0; step < n; step++) {
+    const std::size_t i = lower ? step : n - 1 - step;
+    _rows[next[level[i]]++] = i;
+  }
+}
+
+template <typename T>
+MWP::JacobiPreconditioner<T>::JacobiPreconditioner(
+    const SparseMatrix<T> &matrix) {
+  checkSquare(matrix);
+  _inverseDiagonal.resize(matrix._rows);
+  for (std::size_t i = 0; i < matrix._rows; i++) {
+    const T diagonal = matrix(i, i);
+    if (diagonal == (T)0) {
+      throw std::runtime_error(
+          "The matrix should have a full diagonal to be preconditioned");
+    }
+    _inverseDiagonal[i] = (T)1 / diagonal;
+  }
+}
+
+template <typename T>
+void MWP::JacobiPreconditioner<T>::apply(const T *r, T *z) const {
+  for (std::size_t i = 0; i < _inverseDiagonal.size(); i++) {
+    z[i] = _inverseDiagonal[i] * r[i];
+  }
+}
+
+template <typename T>
+MWP::LinearOperator<T> MWP::JacobiPreconditioner<T>::linearOperator() const {
+  return LinearOperator<T>(_inverseDiagonal.size(),
+                           [this](const T *r, T *z) { apply(r, z); });
+}
+
+template <typename T>
+MWP::ILU0Preconditioner<T>::ILU0Preconditioner(const SparseMatrix<T> &matrix)
+    : _factors(matrix.toCSR()) {
+  checkSquare(_factors);
+  _diagonal = diagonalPositions(_factors);
+  _lowerLevels = LevelSchedule(_factors._offsets, _factors._indices,
+                               _diagonal, true);
+  _upperLevels = LevelSchedule(_factors._offsets, _factors._indices,
+                               _diagonal, false);
+  const std::vector<std::size_t> &offsets = _factors._offsets;
+  const std::vector<std::size_t> &indices = _factors._indices;
+  std::vector<T> &values = _factors._values;
+  // Row i only combines rows k < i it references, which is exactly the
+  // dependency of the lower solve, so the same levels factor in parallel.
+  forEachLevel(_lowerLevels, [&](std::size_t i) {
+    const std::size_t end = offsets[i + 1];
+    for (std::size_t p = offsets[i]; p < _diagonal[i]; p++) {
+      const std::size_t k = indices[p];
+      values[p] /= values[_diagonal[k]];
+      std::size_t search = p + 1;
+      for (std::size_t q = _diagonal[k] + 1; q < offsets[k + 1]; q++) {
+        // Both rows are sorted, so the search resumes where it stopped.
+        search = std::lower_bound(indices.begin() + search,
+                                  indices.begin() + end, indices[q]) -
+                 indices.begin();
+        if (search == end) {
+          break;
+        }
+        if (indices[search] == indices[q]) {
+          values[search] -= values[p] * values[q];
+        }
+      }
+    }
+    if (values[_diagonal[i]] == (T)0) {
+      throw std::runtime_error("Zero pivot in the incomplete factorization");
+    }
+  });
+}
+
+template <typename T>
+void MWP::ILU0Preconditioner<T>::apply(const T *r, T *z) const {
+  std::copy(r, r + _factors._rows, z);
+  solveTriangular(_factors, _diagonal, _lowerLevels, true, true, z);
+  solveTriangular(_factors, _diagonal, _upperLevels, false, false, z);
+}
+
+template <typename T>
+MWP::LinearOperator<T> MWP::ILU0Preconditioner<T>::linearOperator() const {
+  return LinearOperator<T>(_factors._rows,
+                           [this](const T *r, T *z) { apply(r, z); });
+}
+
+template <typename T>
+MWP::IC0Preconditioner<T>::IC0Preconditioner(const SparseMatrix<T> &matrix) {
+  checkSquare(matrix);
+  const SparseMatrix<T> csr = matrix.toCSR();
+  const std::size_t n = csr._rows;
+  _lower = SparseMatrix<T>(n, n);
+  for (std::size_t i = 0; i < n; i++) {
+    for (std::size_t p = csr._offsets[i]; p < csr._offsets[i + 1]; p++) {
+      if (csr._indices[p] > i) {
+        break;
+      }
+      _lower._indices.push_back(csr._indices[p]);
+      _lower._values.push_back(csr._values[p]);
+    }
+    _lower._offsets[i + 1] = _lower._indices.size();
+  }
+  _lowerDiagonal = diagonalPositions(_lower);
+  _lowerLevels = LevelSchedule(_lower._offsets, _lower._indices,
+                               _lowerDiagonal, true);
+
+  const std::vector<std::size_t> &offsets = _lower._offsets;
+  const std::vector<std::size_t> &indices = _lower._indices;
+  std::vector<T> &values = _lower._values;
+  forEachLevel(_lowerLevels, [&](std::size_t i) {
+    T squares = (T)0;
+    for (std::size_t p = offsets[i]; p < _lowerDiagonal[i]; p++) {
+      const std::size_t j = indices[p];
+      // Sparse dot product of rows i and j over the columns before j.
+      T sum = (T)0;
+      std::size_t a = offsets[i];
+      std::size_t b = offsets[j];
+      while (a < p && b < _lowerDiagonal[j]) {
+        if (indices[a] < indices[b]) {
+          a++;
+        } else if (indices[b] < indices[a]) {
+          b++;
+        } else {
+          sum += values[a++] * values[b++];
+        }
+      }
+      values[p] = (values[p] - sum) / values[_lowerDiagonal[j]];
+      squares += values[p] * values[p];
+    }
+    const T pivot = values[_lowerDiagonal[i]] - squares;
+    if (!(pivot > (T)0)) {
+      throw std::runtime_error(
+          "The incomplete Cholesky factorization broke down");
+    }
+    values[_lowerDiagonal[i]] = (T)std::sqrt(pivot);
+  });
+
+  // Rows of L^T are the columns of L.
+  _upper = _lower.toCSC().transposed();
+  _upperDiagonal.assign(_upper._offsets.begin(), _upper._offsets.end() - 1);
+  _upperLevels = LevelSchedule(_upper._offsets, _upper._indices,
+                               _upperDiagonal, false);
+}
+
+template <typename T>
+void MWP::IC0Preconditioner<T>::apply(const T *r, T *z) const {
+  std::copy(r, r + _lower._rows, z);
+  solveTriangular(_lower, _lowerDiagonal, _lowerLevels, true, false, z);
+  solveTriangular(_upper, _upperDiagonal, _upperLevels, false, false, z);
+}
+
+template <typename T>
+MWP::LinearOperator<T> MWP::IC0Preconditioner<T>::linearOperator() const {
+  return LinearOperator<T>(_lower._rows,
+                           [this](const T *r, T *z) { apply(r, z); });
+}
+
+template <typename T>
+MWP::BlockJacobiPreconditioner<T>::BlockJacobiPreconditioner(
+    const SparseMatrix<T> &matrix, std::size_t blockSize)
+    : _size(matrix._rows), _blockSize(blockSize) {
+  checkSquare(matrix);
+  if (blockSize == 0) {
+    throw std::runtime_error("The block size should be positive");
+  }
+  const SparseMatrix<T> csr = matrix.toCSR();
+  const std::size_t n = csr._rows;
+  _blocks.resize((n + blockSize - 1) / blockSize);
+  ThreadPool::instance().parallelFor(_blocks.size(), [&](std::size_t b) {
+    const std::size_t start = b * blockSize;
+    const std::size_t size = std::min(blockSize, n - start);
+    Matrix<T> block(size, size);
+    for (std::size_t i = 0; i < size; i++) {
+      auto first = csr._indices.begin() + csr._offsets[start + i];
+      auto last = csr._indices.begin() + csr._offsets[start + i + 1];
+      for (auto it = std::lower_bound(first, last, start);
+           it != last && *it < start + size; ++it) {
+        block._elements[i * size + (*it - start)] =
+            csr._values[it - csr._indices.begin()];
+      }
+    }
+    _blocks[b] = LU<T>(std::move(block));
+    if (!_blocks[b].isNonsingular()) {
+      throw std::runtime_error("The matrix is singular");
+    }
+  });
+}
+
+template <typename T>
+void MWP::BlockJacobiPreconditioner<T>::apply(const T *r, T *z) const {
+  ThreadPool::instance().parallelFor(_blocks.size(), [&](std::size_t b) {
+    const std::size_t start = b * _blockSize;
+    const std::size_t size = std::min(_blockSize, _size - start);
+    std::copy(r + start, r + start + size, z + start);
+    _blocks[b].solveInPlace(z + start);
+  });
+}
+
+template <typename T>
+MWP::LinearOperator<T>
+MWP::BlockJacobiPreconditioner<T>::linearOperator() const {
+  return LinearOperator<T>(_size, [this](const T *r, T *z) { apply(r, z); });
+}
+
+#ifndef MWP_HEADER_ONLY
+template class MWP::JacobiPreconditioner<double>;
+template class MWP::JacobiPreconditioner<float>;
+template class MWP::ILU0Preconditioner<double>;
+template class MWP::ILU0Preconditioner<float>;
+template class MWP::IC0Preconditioner<double>;
+template class MWP::IC0Preconditioner<float>;
+template class MWP::BlockJacobiPreconditioner<double>;
+template class MWP::BlockJacobiPreconditioner<float>;
+#endif
@@ -0,0 +1,304 @@
+#include "QR.hpp"
+#include "Gemm.hpp"
+#include "Simd.hpp"
+#include "Trsm.hpp"
+#include "Workspace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+// Unblocked Householder QR of the m x n block at a. Reflectors are applied to
+// the remaining columns of the block only.
+template <typename T>
+void factorPanel(T *a, std::size_t lda, std::size_t m, std::size_t n, T *tau) {
+  const std::size_t k = std::min(m, n);
+  MWP::WorkspaceScope scope;
+  T *w = scope.allocate<T>(n);
+  for (std::size_t j = 0; j < k; j++) {
+    T *pivot = a + j * lda + j;
+    const T alpha = *pivot;
+    T sumSquares = (T)0;
+    for (std::size_t i = j + 1; i < m; i++) {
+      sumSquares += a[i * lda + j] * a[i * lda + j];
+    }
+    if (sumSquares == (T)0) {
+      tau[j] = (T)0;
+      continue;
+    }
+    const T norm = (T)std::sqrt(alpha * alpha + sumSquares);
+    const T beta = alpha >= (T)0 ? -norm : norm;
+    tau[j] = (beta - alpha) / beta;
+    const T scale = (T)1 / (alpha - beta);
+    for (std::size_t i = j + 1; i < m; i++) {
+      a[i * lda + j] *= scale;
+    }
+    *pivot = beta;
+
+    // A[j:m, j+1:n] -= tau * v * (v^T * A[j:m, j+1:n]), all by row axpys.
+    const std::size_t r = n - j - 1;
+    if (r == 0) {
+      continue;
+    }
+    std::copy(pivot + 1, pivot + 1 + r, w);
+    for (std::size_t i = j + 1; i < m; i++) {
+      MWP::simd::axpy<T>(r, a[i * lda + j], a + i * lda + j + 1, w);
+    }
+    MWP::simd::axpy<T>(r, -tau[j], w, pivot + 1);
+    for (std::size_t i = j + 1; i < m; i++) {
+      MWP::simd::axpy<T>(r, -tau[j] * a[i * lda + j], w,
+                         a + i * lda + j + 1);
+    }
+  }
+}
+
+// Compact WY form of the reflectors j0 .. j0 + jb of a factored block: the
+// explicit (m - j0) x jb matrix V (unit diagonal, zeros above) and the upper
+// triangular jb x jb T with H_j0 ... H_j0+jb-1 = I - V * T * V^T. Both live
+// in the workspace scope they were built in.
+template <typename T> struct BlockReflector {
+  T *V;
+  T *T_;
+  std::size_t rows;
+  std::size_t size;
+};
+
+template <typename T>
+BlockReflector<T> blockReflector(MWP::WorkspaceScope &scope, const T *a,
+                                 std::size_t lda, std::size_t m,
+                                 std::size_t j0, std::size_t jb,
+                                 const T *tau) {
+  BlockReflector<T> block;
+  block.rows = m - j0;
+  block.size = jb;
+  block.V = scope.allocate<T>(block.rows * jb, (T)0);
+  block.T_ = scope.allocate<T>(jb * jb, (T)0);
+  T *V = block.V;
+  for (std::size_t r = 0; r < block.rows; r++) {
+    const T *row = a + (j0 + r) * lda + j0;
+    const std::size_t count = std::min(r, jb);
+    std::copy(row, row + count, V + r * jb);
+    if (r < jb) {
+      V[r * jb + r] = (T)1;
+    }
+  }
+  T *Tm = block.T_;
+  T *z = scope.allocate<T>(jb);
+  for (std::size_t i = 0; i < jb; i++) {
+    Tm[i * jb + i] = tau[j0 + i];
+    if (tau[j0 + i] == (T)0 || i == 0) {
+      continue;
+    }
+    // z = V[:, 0:i]^T * v_i, v_i being zero above row i.
+    std::fill(z, z + jb, (T)0);
+    for (std::size_t r = i; r < block.rows; r++) {
+      MWP::simd::axpy<T>(i, V[r * jb + i], V + r * jb, z);
+    }
+    // T[0:i, i] = -tau_i * T[0:i, 0:i] * z
+    for (std::size_t p = 0; p < i; p++) {
+      T sum = (T)0;
+      for (std::size_t q = p; q < i; q++) {
+        sum += Tm[p * jb + q] * z[q];
+      }
+      Tm[p * jb + i] = -tau[j0 + i] * sum;
+    }
+  }
+  return block;
+}
+
+// C = (I - V * op(T) * V^T) * C with op(T) = T^T when transposeT is set,
+// which applies Q^T of the block instead of Q.
+template <typename T>
+void applyBlockReflector(const BlockReflector<T> &block, bool transposeT,
+                         T *C, std::size_t ldc, std::size_t nc) {
+  if (nc == 0) {
+    return;
+  }
+  const std::size_t jb = block.size;
+  MWP::WorkspaceScope scope;
+  T *W = scope.allocate<T>(jb * nc);
+  T *W2 = scope.allocate<T>(jb * nc);
+  MWP::gemm<T>(true, false, jb, nc, block.rows, (T)1, block.V, jb, C, ldc,
+               (T)0, W, nc);
+  MWP::gemm<T>(transposeT, false, jb, nc, jb, (T)1, block.T_, jb, W, nc,
+               (T)0, W2, nc);
+  MWP::gemm<T>(false, false, block.rows, nc, jb, (T)-1, block.V, jb, W2, nc,
+               (T)1, C, ldc);
+}
+
+} // namespace
+
+template <typename T>
+void MWP::qrFactorInPlace(MatrixView<T> A, std::vector<T> &tau) {
+  const std::size_t m = A._rows;
+  const std::size_t n = A._columns;
+  const std::size_t lda = A._ld;
+  const std::size_t k = std::min(m, n);
+  T *a = A._data;
+  tau.assign(k, (T)0);
+  for (std::size_t j0 = 0; j0 < k; j0 += QRBlockSize) {
+    const std::size_t jb = std::min(QRBlockSize, k - j0);
+    factorPanel(a + j0 * lda + j0, lda, m - j0, jb, tau.data() + j0);
+    if (j0 + jb < n) {
+      WorkspaceScope scope;
+      const BlockReflector<T> block =
+          blockReflector(scope, a, lda, m, j0, jb, tau.data());
+      applyBlockReflector(block, true, a + j0 * lda + j0 + jb, lda,
+                          n - j0 - jb);
+    }
+  }
+}
+
+
+template <typename T>
+MWP::QR<T>::QR(Matrix<T> matrix) : _factors(std::move(matrix)) {
+  qrFactorInPlace(_factors.view(0, _factors._rows, 0, _factors._columns),
+                  _tau);
+}
+
+template <typename T> MWP::Matrix<T> MWP::QR<T>::upper() const {
+  const Index n = _factors._columns;
+  const Index k = (Index)_tau.size();
+  Matrix<T> upperMatrix(k, n);
+  for (Index i = 0; i < k; i++) {
+    std::copy(_factors._elements.begin() + i * n + i,
+              _factors._elements.begin() + (i + 1) * n,
+              upperMatrix._elements.begin() + i * n + i);
+  }
+  return upperMatrix;
+}
+
+template <typename T>
+MWP::Matrix<T> MWP::QR<T>::orthogonal(bool full) const {
+  const Index m = _factors._rows;
+  const Index columns = full ? m : (Index)_tau.size();
+  Matrix<T> orthogonalMatrix(m, columns);
+  for (Index i = 0; i < std::min(m, columns); i++) {
+    orthogonalMatrix._elements[i * columns + i] = (T)1;
+  }
+  applyQ(orthogonalMatrix.view(0, m, 0, columns));
+  return orthogonalMatrix;
+}
+
+template <typename T>
+void MWP::applyHouseholder(ConstMatrixView<T> factors, const std::vector<T> &tau,
+                           bool transpose, MatrixView<T> C) {
+  if (C._rows != factors._rows) {
+    throw std::runtime_error(
+        "Invalid matrices dimensions for multiplication operation");
+  }
+  const std::size_t k = tau.size();
+  const std::size_t blocks = (k + QRBlockSize - 1) / QRBlockSize;
+  // Q = H_1 ... H_k, so Q^T applies the blocks first to last and Q last to
+  // first.
+  for (std::size_t step = 0; step < blocks; step++) {
+    const std::size_t b = transpose ? step : blocks - 1 - step;
+    const std::size_t j0 = b * QRBlockSize;
+    const std::size_t jb = std::min(QRBlockSize, k - j0);
+    WorkspaceScope scope;
+    const BlockReflector<T> block =
+        blockReflector(scope, factors._data, factors._ld, factors._rows, j0,
+                       jb, tau.data());
+    applyBlockReflector(block, transpose, C._data + j0 * C._ld, C._ld,
+                        C._columns);
+  }
+}
+
+template <typename T> void MWP::QR<T>::applyQ(MatrixView<T> C) const {
+  applyHouseholder(
+      _factors.view(0, _factors._rows, 0, _factors._columns), _tau, false, C);
+}
+
+template <typename T>
+void MWP::QR<T>::applyQTransposed(MatrixView<T> C) const {
+  applyHouseholder(
+      _factors.view(0, _factors._rows, 0, _factors._columns), _tau, true, C);
+}
+
+template <typename T> bool MWP::QR<T>::isFullRank() const {
+  const Index m = _factors._rows;
+  const Index n = _factors._columns;
+  if (_tau.size() < n) {
+    return false;
+  }
+  // Rounding rarely leaves an exact zero on the diagonal of R, so a pivot is
+  // treated as zero when it is negligible next to the largest one.
+  T largest = (T)0;
+  for (Index i = 0; i < n; i++) {
+    largest = std::max(largest, (T)std::abs(_factors._elements[i * n + i]));
+  }
+  const T tolerance = largest * (T)std::max(m, n) *
+                      std::numeric_limits<T>::epsilon();
+  for (Index i = 0; i < n; i++) {
+    const T diagonal = (T)std::abs(_factors._elements[i * n + i]);
+    if (diagonal == (T)0 || diagonal <= tolerance) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+MWP::Vector<T> MWP::QR<T>::solve(const Vector<T> &constants) const {
+  if (constants._columns != 1) {
+    throw std::runtime_error("Incompatible constants vector dimension");
+  }
+  if (constants._rows != _factors._rows) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants matrix");
+  }
+  Vector<T> variables(_factors._columns, 1, Uninitialized);
+  solve(constants._elements.data(), 1, variables._elements.data());
+  return variables;
+}
+
+template <typename T>
+MWP::Matrix<T> MWP::QR<T>::solve(const Matrix<T> &constants) const {
+  if (constants._rows != _factors._rows) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants matrix");
+  }
+  Matrix<T> variables(_factors._columns, constants._columns, Uninitialized);
+  solve(constants._elements.data(), constants._columns,
+        variables._elements.data());
+  return variables;
+}
+
+template <typename T>
+void MWP::QR<T>::solve(const T *constants, std::size_t nrhs,
+                       T *variables) const {
+  if (_factors._rows < _factors._columns) {
+    throw std::runtime_error(
+        "Underdetermined linear systems are not supported");
+  }
+  if (!isFullRank()) {
+    throw std::runtime_error("The matrix is singular");
+  }
+  const std::size_t m = _factors._rows;
+  const std::size_t n = _factors._columns;
+  // Q^T * B is formed in the workspace; only its first n rows are kept.
+  WorkspaceScope scope;
+  T *projected = scope.allocate<T>(m * nrhs);
+  std::copy(constants, constants + m * nrhs, projected);
+  applyQTransposed(MatrixView<T>(projected, m, nrhs, nrhs));
+  trsm<T>(false, false, false, n, nrhs, _factors._elements.data(), n,
+          projected, nrhs);
+  std::copy(projected, projected + n * nrhs, variables);
+}
+
+#ifndef MWP_HEADER_ONLY
+template void MWP::qrFactorInPlace<double>(MatrixView<double>,
+                                           std::vector<double> &);
+template void MWP::qrFactorInPlace<float>(MatrixView<float>,
+                                          std::vector<float> &);
+template void MWP::applyHouseholder<double>(ConstMatrixView<double>,
+                                            const std::vector<double> &, bool,
+                                            MatrixView<double>);
+template void MWP::applyHouseholder<float>(ConstMatrixView<float>,
+                                           const std::vector<float> &, bool,
+                                           MatrixView<float>);
+template class MWP::QR<double>;
+template class MWP::QR<float>;
+#endif
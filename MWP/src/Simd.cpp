@@ -0,0 +1,1451 @@
+#include "Simd.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||            \
+    defined(_M_IX86)
+#define MWP_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define MWP_TARGET(isa)
+#else
+#include <cpuid.h>
+#define MWP_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace MWP {
+
+namespace {
+
+struct Kernels {
+  void (*add)(std::size_t, const double *, const double *, double *);
+  void (*sub)(std::size_t, const double *, const double *, double *);
+  void (*scale)(std::size_t, double, const double *, double *);
+  void (*axpy)(std::size_t, double, const double *, double *);
+  void (*multiplyAdd)(std::size_t, const double *, const double *, double *);
+  double (*dot)(std::size_t, const double *, const double *);
+  double (*sumSquares)(std::size_t, const double *);
+  void (*transpose)(std::size_t, std::size_t, const double *, std::size_t,
+                    double *, std::size_t);
+  simd::GemmMicroKernel<double> gemm;
+};
+
+// Single precision only needs the kernels of the LU factorization and the
+// triangular solves; a register holds twice as many floats as doubles.
+struct FloatKernels {
+  void (*axpy)(std::size_t, float, const float *, float *);
+  float (*dot)(std::size_t, const float *, const float *);
+  simd::GemmMicroKernel<float> gemm;
+};
+
+typedef std::complex<double> Complex;
+
+// Complex kernels work on the interleaved (real, imaginary) pairs that
+// std::complex is guaranteed to store.
+struct ComplexKernels {
+  void (*axpy)(std::size_t, Complex, const Complex *, Complex *);
+  void (*axpyConjugate)(std::size_t, Complex, const Complex *, Complex *);
+  void (*multiplyAdd)(std::size_t, const Complex *, const Complex *,
+                      Complex *);
+  Complex (*dot)(std::size_t, const Complex *, const Complex *);
+  Complex (*dotConjugate)(std::size_t, const Complex *, const Complex *);
+};
+
+void addScalar(std::size_t n, const double *x, const double *y, double *out) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = x[i] + y[i];
+  }
+}
+
+void subScalar(std::size_t n, const double *x, const double *y, double *out) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = x[i] - y[i];
+  }
+}
+
+void scaleScalar(std::size_t n, double alpha, const double *x, double *out) {
+  for (std::size_t i = 0; i < n; i++) {
+    out[i] = x[i] * alpha;
+  }
+}
+
+void axpyScalar(std::size_t n, double alpha, const double *x, double *y) {
+  for (std::size_t i = 0; i < n; i++) {
+    y[i] += alpha * x[i];
+  }
+}
+
+void multiplyAddScalar(std::size_t n, const double *x, const double *y,
+                       double *z) {
+  for (std::size_t i = 0; i < n; i++) {
+    z[i] += x[i] * y[i];
+  }
+}
+
+double dotScalar(std::size_t n, const double *x, const double *y) {
+  double sum = 0.0;
+  for (std::size_t i = 0; i < n; i++) {
+    sum += x[i] * y[i];
+  }
+  return sum;
+}
+
+double sumSquaresScalar(std::size_t n, const double *x) {
+  return dotScalar(n, x, x);
+}
+
+void transposeScalar(std::size_t rows, std::size_t columns, const double *a,
+                     std::size_t lda, double *b, std::size_t ldb) {
+  for (std::size_t i = 0; i < rows; i++) {
+    for (std::size_t j = 0; j < columns; j++) {
+      b[j * ldb + i] = a[i * lda + j];
+    }
+  }
+}
+
+// Transposes the edges left over by a kernel working on width x width
+// blocks: the columns right of the blocks, then the rows below them.
+void transposeEdges(std::size_t width, std::size_t rows, std::size_t columns,
+                    const double *a, std::size_t lda, double *b,
+                    std::size_t ldb) {
+  const std::size_t blockRows = rows - rows % width;
+  const std::size_t blockColumns = columns - columns % width;
+  transposeScalar(blockRows, columns - blockColumns, a + blockColumns, lda,
+                  b + blockColumns * ldb, ldb);
+  transposeScalar(rows - blockRows, columns, a + blockRows * lda, lda,
+                  b + blockRows, ldb);
+}
+
+void axpyScalarF(std::size_t n, float alpha, const float *x, float *y) {
+  for (std::size_t i = 0; i < n; i++) {
+    y[i] += alpha * x[i];
+  }
+}
+
+float dotScalarF(std::size_t n, const float *x, const float *y) {
+  float sum = 0.0f;
+  for (std::size_t i = 0; i < n; i++) {
+    sum += x[i] * y[i];
+  }
+  return sum;
+}
+
+void axpyScalarC(std::size_t n, Complex alpha, const Complex *x, Complex *y) {
+  for (std::size_t i = 0; i < n; i++) {
+    y[i] += alpha * x[i];
+  }
+}
+
+void axpyConjugateScalarC(std::size_t n, Complex alpha, const Complex *x,
+                          Complex *y) {
+  for (std::size_t i = 0; i < n; i++) {
+    y[i] += alpha * std::conj(x[i]);
+  }
+}
+
+void multiplyAddScalarC(std::size_t n, const Complex *x, const Complex *y,
+                        Complex *z) {
+  for (std::size_t i = 0; i < n; i++) {
+    z[i] += x[i] * y[i];
+  }
+}
+
+Complex dotScalarC(std::size_t n, const Complex *x, const Complex *y) {
+  Complex sum = 0.0;
+  for (std::size_t i = 0; i < n; i++) {
+    sum += x[i] * y[i];
+  }
+  return sum;
+}
+
+Complex dotConjugateScalarC(std::size_t n, const Complex *x,
+                            const Complex *y) {
+  Complex sum = 0.0;
+  for (std::size_t i = 0; i < n; i++) {
+    sum += std::conj(x[i]) * y[i];
+  }
+  return sum;
+}
+
+// Adds the leading rows x columns of an accumulated tile with nr columns to
+// C; the vector micro-kernels spill edge tiles here instead of masking.
+template <typename T>
+void addTileEdge(std::size_t rows, std::size_t columns, T alpha,
+                 const T *tile, std::size_t nr, T *C, std::size_t ldc) {
+  for (std::size_t i = 0; i < rows; i++) {
+    for (std::size_t j = 0; j < columns; j++) {
+      C[i * ldc + j] += alpha * tile[i * nr + j];
+    }
+  }
+}
+
+#ifdef MWP_SIMD_X86
+
+// SSE2: two doubles per register.
+
+MWP_TARGET("sse2")
+inline double hsum128(__m128d v) {
+  return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+MWP_TARGET("sse2")
+void addSse2(std::size_t n, const double *x, const double *y, double *out) {
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(out + i, _mm_add_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+  }
+  for (; i < n; i++) {
+    out[i] = x[i] + y[i];
+  }
+}
+
+MWP_TARGET("sse2")
+void subSse2(std::size_t n, const double *x, const double *y, double *out) {
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(out + i, _mm_sub_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+  }
+  for (; i < n; i++) {
+    out[i] = x[i] - y[i];
+  }
+}
+
+MWP_TARGET("sse2")
+void scaleSse2(std::size_t n, double alpha, const double *x, double *out) {
+  const __m128d a = _mm_set1_pd(alpha);
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(out + i, _mm_mul_pd(_mm_loadu_pd(x + i), a));
+  }
+  for (; i < n; i++) {
+    out[i] = x[i] * alpha;
+  }
+}
+
+MWP_TARGET("sse2")
+void axpySse2(std::size_t n, double alpha, const double *x, double *y) {
+  const __m128d a = _mm_set1_pd(alpha);
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i),
+                                    _mm_mul_pd(a, _mm_loadu_pd(x + i))));
+  }
+  for (; i < n; i++) {
+    y[i] += alpha * x[i];
+  }
+}
+
+MWP_TARGET("sse2")
+void multiplyAddSse2(std::size_t n, const double *x, const double *y,
+                     double *z) {
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    _mm_storeu_pd(z + i, _mm_add_pd(_mm_loadu_pd(z + i),
+                                    _mm_mul_pd(_mm_loadu_pd(x + i),
+                                               _mm_loadu_pd(y + i))));
+  }
+  for (; i < n; i++) {
+    z[i] += x[i] * y[i];
+  }
+}
+
+MWP_TARGET("sse2")
+double dotSse2(std::size_t n, const double *x, const double *y) {
+  __m128d acc0 = _mm_setzero_pd();
+  __m128d acc1 = _mm_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc0 = _mm_add_pd(acc0, _mm_mul_pd(_mm_loadu_pd(x + i), _mm_loadu_pd(y + i)));
+    acc1 = _mm_add_pd(acc1, _mm_mul_pd(_mm_loadu_pd(x + i + 2),
+                                       _mm_loadu_pd(y + i + 2)));
+  }
+  double sum = hsum128(_mm_add_pd(acc0, acc1));
+  for (; i < n; i++) {
+    sum += x[i] * y[i];
+  }
+  return sum;
+}
+
+MWP_TARGET("sse2")
+double sumSquaresSse2(std::size_t n, const double *x) {
+  return dotSse2(n, x, x);
+}
+
+MWP_TARGET("sse2")
+void transposeSse2(std::size_t rows, std::size_t columns, const double *a,
+                   std::size_t lda, double *b, std::size_t ldb) {
+  for (std::size_t i = 0; i + 2 <= rows; i += 2) {
+    for (std::size_t j = 0; j + 2 <= columns; j += 2) {
+      const __m128d r0 = _mm_loadu_pd(a + i * lda + j);
+      const __m128d r1 = _mm_loadu_pd(a + (i + 1) * lda + j);
+      _mm_storeu_pd(b + j * ldb + i, _mm_unpacklo_pd(r0, r1));
+      _mm_storeu_pd(b + (j + 1) * ldb + i, _mm_unpackhi_pd(r0, r1));
+    }
+  }
+  transposeEdges(2, rows, columns, a, lda, b, ldb);
+}
+
+// AVX2 + FMA: four doubles per register.
+
+MWP_TARGET("avx2,fma")
+inline double hsum256(__m256d v) {
+  __m128d low = _mm256_castpd256_pd128(v);
+  __m128d high = _mm256_extractf128_pd(v, 1);
+  low = _mm_add_pd(low, high);
+  return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+MWP_TARGET("avx2,fma")
+void addAvx2(std::size_t n, const double *x, const double *y, double *out) {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(x + i),
+                                            _mm256_loadu_pd(y + i)));
+  }
+  for (; i < n; i++) {
+    out[i] = x[i] + y[i];
+  }
+}
+
+MWP_TARGET("avx2,fma")
+void subAvx2(std::size_t n, const double *x, const double *y, double *out) {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(out + i, _mm256_sub_pd(_mm256_loadu_pd(x + i),
+                                            _mm256_loadu_pd(y + i)));
+  }
+  for (; i < n; i++) {
+    out[i] = x[i] - y[i];
+  }
+}
+
+MWP_TARGET("avx2,fma")
+void scaleAvx2(std::size_t n, double alpha, const double *x, double *out) {
+  const __m256d a = _mm256_set1_pd(alpha);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(x + i), a));
+  }
+  for (; i < n; i++) {
+    out[i] = x[i] * alpha;
+  }
+}
+
+MWP_TARGET("avx2,fma")
+void axpyAvx2(std::size_t n, double alpha, const double *x, double *y) {
+  const __m256d a = _mm256_set1_pd(alpha);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(y + i, _mm256_fmadd_pd(a, _mm256_loadu_pd(x + i),
+                                            _mm256_loadu_pd(y + i)));
+  }
+  for (; i < n; i++) {
+    y[i] += alpha * x[i];
+  }
+}
+
+MWP_TARGET("avx2,fma")
+void multiplyAddAvx2(std::size_t n, const double *x, const double *y,
+                     double *z) {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(z + i, _mm256_fmadd_pd(_mm256_loadu_pd(x + i),
+                                            _mm256_loadu_pd(y + i),
+                                            _mm256_loadu_pd(z + i)));
+  }
+  for (; i < n; i++) {
+    z[i] += x[i] * y[i];
+  }
+}
+
+MWP_TARGET("avx2,fma")
+double dotAvx2(std::size_t n, const double *x, const double *y) {
+  __m256d acc0 = _mm256_setzero_pd();
+  __m256d acc1 = _mm256_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), acc0);
+    acc1 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i + 4),
+                           _mm256_loadu_pd(y + i + 4), acc1);
+  }
+  for (; i + 4 <= n; i += 4) {
+    acc0 = _mm256_fmadd_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i), acc0);
+  }
+  double sum = hsum256(_mm256_add_pd(acc0, acc1));
+  for (; i < n; i++) {
+    sum += x[i] * y[i];
+  }
+  return sum;
+}
+
+MWP_TARGET("avx2,fma")
+double sumSquaresAvx2(std::size_t n, const double *x) {
+  return dotAvx2(n, x, x);
+}
+
+// 4 x 4 blocks transposed in registers: the unpacks interleave pairs of rows
+// inside each 128-bit lane, the lane permutes then gather the columns.
+MWP_TARGET("avx2,fma")
+void transposeAvx2(std::size_t rows, std::size_t columns, const double *a,
+                   std::size_t lda, double *b, std::size_t ldb) {
+  for (std::size_t i = 0; i + 4 <= rows; i += 4) {
+    const double *row = a + i * lda;
+    for (std::size_t j = 0; j + 4 <= columns; j += 4) {
+      const __m256d r0 = _mm256_loadu_pd(row + j);
+      const __m256d r1 = _mm256_loadu_pd(row + lda + j);
+      const __m256d r2 = _mm256_loadu_pd(row + 2 * lda + j);
+      const __m256d r3 = _mm256_loadu_pd(row + 3 * lda + j);
+      const __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+      const __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+      const __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+      const __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+      double *column = b + j * ldb + i;
+      _mm256_storeu_pd(column, _mm256_permute2f128_pd(t0, t2, 0x20));
+      _mm256_storeu_pd(column + ldb, _mm256_permute2f128_pd(t1, t3, 0x20));
+      _mm256_storeu_pd(column + 2 * ldb,
+                       _mm256_permute2f128_pd(t0, t2, 0x31));
+      _mm256_storeu_pd(column + 3 * ldb,
+                       _mm256_permute2f128_pd(t1, t3, 0x31));
+    }
+  }
+  transposeEdges(4, rows, columns, a, lda, b, ldb);
+}
+
+// 6 x 8 GEMM tile: twelve accumulators, two registers for the row of B and
+// one for the broadcast element of A fill fifteen of the sixteen registers.
+MWP_TARGET("avx2,fma")
+void gemmAvx2(std::size_t kc, double alpha, const double *a, const double *b,
+              double *C, std::size_t ldc, std::size_t rows,
+              std::size_t columns) {
+  constexpr std::size_t MR = 6;
+  constexpr std::size_t NR = 8;
+  __m256d acc[MR][2];
+  for (std::size_t i = 0; i < MR; i++) {
+    acc[i][0] = _mm256_setzero_pd();
+    acc[i][1] = _mm256_setzero_pd();
+  }
+  for (std::size_t p = 0; p < kc; p++) {
+    const __m256d b0 = _mm256_loadu_pd(b);
+    const __m256d b1 = _mm256_loadu_pd(b + 4);
+    for (std::size_t i = 0; i < MR; i++) {
+      const __m256d ai = _mm256_broadcast_sd(a + i);
+      acc[i][0] = _mm256_fmadd_pd(ai, b0, acc[i][0]);
+      acc[i][1] = _mm256_fmadd_pd(ai, b1, acc[i][1]);
+    }
+    a += MR;
+    b += NR;
+  }
+  const __m256d scale = _mm256_set1_pd(alpha);
+  if (rows == MR && columns == NR) {
+    for (std::size_t i = 0; i < MR; i++) {
+      double *row = C + i * ldc;
+      _mm256_storeu_pd(row, _mm256_fmadd_pd(scale, acc[i][0],
+                                            _mm256_loadu_pd(row)));
+      _mm256_storeu_pd(row + 4, _mm256_fmadd_pd(scale, acc[i][1],
+                                                _mm256_loadu_pd(row + 4)));
+    }
+    return;
+  }
+  double tile[MR * NR];
+  for (std::size_t i = 0; i < MR; i++) {
+    _mm256_storeu_pd(tile + i * NR, acc[i][0]);
+    _mm256_storeu_pd(tile + i * NR + 4, acc[i][1]);
+  }
+  addTileEdge(rows, columns, alpha, tile, NR, C, ldc);
+}
+
+// AVX-512: eight doubles per register, tails handled with masks.
+
+MWP_TARGET("avx512f")
+inline __mmask8 tailMask(std::size_t remaining) {
+  return (__mmask8)((1u << remaining) - 1u);
+}
+
+MWP_TARGET("avx512f")
+void addAvx512(std::size_t n, const double *x, const double *y, double *out) {
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_pd(out + i, _mm512_add_pd(_mm512_loadu_pd(x + i),
+                                            _mm512_loadu_pd(y + i)));
+  }
+  if (i < n) {
+    const __mmask8 mask = tailMask(n - i);
+    _mm512_mask_storeu_pd(out + i, mask,
+                          _mm512_add_pd(_mm512_maskz_loadu_pd(mask, x + i),
+                                        _mm512_maskz_loadu_pd(mask, y + i)));
+  }
+}
+
+MWP_TARGET("avx512f")
+void subAvx512(std::size_t n, const double *x, const double *y, double *out) {
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_pd(out + i, _mm512_sub_pd(_mm512_loadu_pd(x + i),
+                                            _mm512_loadu_pd(y + i)));
+  }
+  if (i < n) {
+    const __mmask8 mask = tailMask(n - i);
+    _mm512_mask_storeu_pd(out + i, mask,
+                          _mm512_sub_pd(_mm512_maskz_loadu_pd(mask, x + i),
+                                        _mm512_maskz_loadu_pd(mask, y + i)));
+  }
+}
+
+MWP_TARGET("avx512f")
+void scaleAvx512(std::size_t n, double alpha, const double *x, double *out) {
+  const __m512d a = _mm512_set1_pd(alpha);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_pd(out + i, _mm512_mul_pd(_mm512_loadu_pd(x + i), a));
+  }
+  if (i < n) {
+    const __mmask8 mask = tailMask(n - i);
+    _mm512_mask_storeu_pd(out + i, mask,
+                          _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, x + i), a));
+  }
+}
+
+MWP_TARGET("avx512f")
+void axpyAvx512(std::size_t n, double alpha, const double *x, double *y) {
+  const __m512d a = _mm512_set1_pd(alpha);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_pd(y + i, _mm512_fmadd_pd(a, _mm512_loadu_pd(x + i),
+                                            _mm512_loadu_pd(y + i)));
+  }
+  if (i < n) {
+    const __mmask8 mask = tailMask(n - i);
+    _mm512_mask_storeu_pd(y + i, mask,
+                          _mm512_fmadd_pd(a, _mm512_maskz_loadu_pd(mask, x + i),
+                                          _mm512_maskz_loadu_pd(mask, y + i)));
+  }
+}
+
+MWP_TARGET("avx512f")
+void multiplyAddAvx512(std::size_t n, const double *x, const double *y,
+                       double *z) {
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_pd(z + i, _mm512_fmadd_pd(_mm512_loadu_pd(x + i),
+                                            _mm512_loadu_pd(y + i),
+                                            _mm512_loadu_pd(z + i)));
+  }
+  if (i < n) {
+    const __mmask8 mask = tailMask(n - i);
+    _mm512_mask_storeu_pd(z + i, mask,
+                          _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, x + i),
+                                          _mm512_maskz_loadu_pd(mask, y + i),
+                                          _mm512_maskz_loadu_pd(mask, z + i)));
+  }
+}
+
+MWP_TARGET("avx512f")
+double dotAvx512(std::size_t n, const double *x, const double *y) {
+  __m512d acc0 = _mm512_setzero_pd();
+  __m512d acc1 = _mm512_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), acc0);
+    acc1 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i + 8),
+                           _mm512_loadu_pd(y + i + 8), acc1);
+  }
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm512_fmadd_pd(_mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i), acc0);
+  }
+  if (i < n) {
+    const __mmask8 mask = tailMask(n - i);
+    acc1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, x + i),
+                           _mm512_maskz_loadu_pd(mask, y + i), acc1);
+  }
+  return _mm512_reduce_add_pd(_mm512_add_pd(acc0, acc1));
+}
+
+MWP_TARGET("avx512f")
+double sumSquaresAvx512(std::size_t n, const double *x) {
+  return dotAvx512(n, x, x);
+}
+
+// 8 x 8 blocks transposed in registers: unpacks interleave pairs of rows,
+// then two rounds of 128-bit lane shuffles gather the columns.
+MWP_TARGET("avx512f")
+void transposeAvx512(std::size_t rows, std::size_t columns, const double *a,
+                     std::size_t lda, double *b, std::size_t ldb) {
+  for (std::size_t i = 0; i + 8 <= rows; i += 8) {
+    const double *row = a + i * lda;
+    for (std::size_t j = 0; j + 8 <= columns; j += 8) {
+      __m512d r[8];
+      for (std::size_t k = 0; k < 8; k++) {
+        r[k] = _mm512_loadu_pd(row + k * lda + j);
+      }
+      __m512d t[8];
+      for (std::size_t k = 0; k < 8; k += 2) {
+        t[k] = _mm512_unpacklo_pd(r[k], r[k + 1]);
+        t[k + 1] = _mm512_unpackhi_pd(r[k], r[k + 1]);
+      }
+      // u[0] holds columns 0 and 4 of rows 0-3, u[1] columns 2 and 6,
+      // u[2] columns 1 and 5, u[3] columns 3 and 7; u[4-7] rows 4-7.
+      __m512d u[8];
+      for (std::size_t k = 0; k < 8; k += 4) {
+        u[k] = _mm512_shuffle_f64x2(t[k], t[k + 2], 0x88);
+        u[k + 1] = _mm512_shuffle_f64x2(t[k], t[k + 2], 0xDD);
+        u[k + 2] = _mm512_shuffle_f64x2(t[k + 1], t[k + 3], 0x88);
+        u[k + 3] = _mm512_shuffle_f64x2(t[k + 1], t[k + 3], 0xDD);
+      }
+      static const std::size_t first[4] = {0, 2, 1, 3};
+      double *column = b + j * ldb + i;
+      for (std::size_t k = 0; k < 4; k++) {
+        _mm512_storeu_pd(column + first[k] * ldb,
+                         _mm512_shuffle_f64x2(u[k], u[k + 4], 0x88));
+        _mm512_storeu_pd(column + (first[k] + 4) * ldb,
+                         _mm512_shuffle_f64x2(u[k], u[k + 4], 0xDD));
+      }
+    }
+  }
+  transposeEdges(8, rows, columns, a, lda, b, ldb);
+}
+
+// 8 x 24 GEMM tile: 24 accumulators plus three registers for the row of B.
+// Each step issues 24 FMAs for three loads and eight broadcasts.
+MWP_TARGET("avx512f")
+void gemmAvx512(std::size_t kc, double alpha, const double *a,
+                const double *b, double *C, std::size_t ldc, std::size_t rows,
+                std::size_t columns) {
+  constexpr std::size_t MR = 8;
+  constexpr std::size_t NR = 24;
+  __m512d acc[MR][3];
+  for (std::size_t i = 0; i < MR; i++) {
+    for (std::size_t v = 0; v < 3; v++) {
+      acc[i][v] = _mm512_setzero_pd();
+    }
+  }
+  for (std::size_t p = 0; p < kc; p++) {
+    const __m512d b0 = _mm512_loadu_pd(b);
+    const __m512d b1 = _mm512_loadu_pd(b + 8);
+    const __m512d b2 = _mm512_loadu_pd(b + 16);
+    for (std::size_t i = 0; i < MR; i++) {
+      const __m512d ai = _mm512_set1_pd(a[i]);
+      acc[i][0] = _mm512_fmadd_pd(ai, b0, acc[i][0]);
+      acc[i][1] = _mm512_fmadd_pd(ai, b1, acc[i][1]);
+      acc[i][2] = _mm512_fmadd_pd(ai, b2, acc[i][2]);
+    }
+    a += MR;
+    b += NR;
+  }
+  const __m512d scale = _mm512_set1_pd(alpha);
+  if (rows == MR && columns == NR) {
+    for (std::size_t i = 0; i < MR; i++) {
+      double *row = C + i * ldc;
+      for (std::size_t v = 0; v < 3; v++) {
+        _mm512_storeu_pd(row + 8 * v,
+                         _mm512_fmadd_pd(scale, acc[i][v],
+                                         _mm512_loadu_pd(row + 8 * v)));
+      }
+    }
+    return;
+  }
+  double tile[MR * NR];
+  for (std::size_t i = 0; i < MR; i++) {
+    for (std::size_t v = 0; v < 3; v++) {
+      _mm512_storeu_pd(tile + i * NR + 8 * v, acc[i][v]);
+    }
+  }
+  addTileEdge(rows, columns, alpha, tile, NR, C, ldc);
+}
+
+// Single precision: four, eight and sixteen floats per register.
+
+MWP_TARGET("sse2")
+void axpySse2F(std::size_t n, float alpha, const float *x, float *y) {
+  const __m128 a = _mm_set1_ps(alpha);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i),
+                                    _mm_mul_ps(a, _mm_loadu_ps(x + i))));
+  }
+  for (; i < n; i++) {
+    y[i] += alpha * x[i];
+  }
+}
+
+MWP_TARGET("sse2")
+float dotSse2F(std::size_t n, const float *x, const float *y) {
+  __m128 acc0 = _mm_setzero_ps();
+  __m128 acc1 = _mm_setzero_ps();
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(x + i + 4),
+                                       _mm_loadu_ps(y + i + 4)));
+  }
+  for (; i + 4 <= n; i += 4) {
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(y + i)));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+  float sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  for (; i < n; i++) {
+    sum += x[i] * y[i];
+  }
+  return sum;
+}
+
+MWP_TARGET("avx2,fma")
+void axpyAvx2F(std::size_t n, float alpha, const float *x, float *y) {
+  const __m256 a = _mm256_set1_ps(alpha);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(y + i, _mm256_fmadd_ps(a, _mm256_loadu_ps(x + i),
+                                            _mm256_loadu_ps(y + i)));
+  }
+  for (; i < n; i++) {
+    y[i] += alpha * x[i];
+  }
+}
+
+MWP_TARGET("avx2,fma")
+float dotAvx2F(std::size_t n, const float *x, const float *y) {
+  __m256 acc0 = _mm256_setzero_ps();
+  __m256 acc1 = _mm256_setzero_ps();
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), acc0);
+    acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i + 8),
+                           _mm256_loadu_ps(y + i + 8), acc1);
+  }
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i), acc0);
+  }
+  const __m256 acc = _mm256_add_ps(acc0, acc1);
+  __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc),
+                           _mm256_extractf128_ps(acc, 1));
+  half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+  half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+  float sum = _mm_cvtss_f32(half);
+  for (; i < n; i++) {
+    sum += x[i] * y[i];
+  }
+  return sum;
+}
+
+MWP_TARGET("avx512f")
+inline __mmask16 tailMaskF(std::size_t remaining) {
+  return (__mmask16)((1u << remaining) - 1u);
+}
+
+MWP_TARGET("avx512f")
+void axpyAvx512F(std::size_t n, float alpha, const float *x, float *y) {
+  const __m512 a = _mm512_set1_ps(alpha);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm512_storeu_ps(y + i, _mm512_fmadd_ps(a, _mm512_loadu_ps(x + i),
+                                            _mm512_loadu_ps(y + i)));
+  }
+  if (i < n) {
+    const __mmask16 mask = tailMaskF(n - i);
+    _mm512_mask_storeu_ps(y + i, mask,
+                          _mm512_fmadd_ps(a, _mm512_maskz_loadu_ps(mask, x + i),
+                                          _mm512_maskz_loadu_ps(mask, y + i)));
+  }
+}
+
+MWP_TARGET("avx512f")
+float dotAvx512F(std::size_t n, const float *x, const float *y) {
+  __m512 acc0 = _mm512_setzero_ps();
+  __m512 acc1 = _mm512_setzero_ps();
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), acc0);
+    acc1 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i + 16),
+                           _mm512_loadu_ps(y + i + 16), acc1);
+  }
+  for (; i + 16 <= n; i += 16) {
+    acc0 = _mm512_fmadd_ps(_mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i), acc0);
+  }
+  if (i < n) {
+    const __mmask16 mask = tailMaskF(n - i);
+    acc1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, x + i),
+                           _mm512_maskz_loadu_ps(mask, y + i), acc1);
+  }
+  return _mm512_reduce_add_ps(_mm512_add_ps(acc0, acc1));
+}
+
+// Same register tiles as double precision, with twice as many columns.
+
+MWP_TARGET("avx2,fma")
+void gemmAvx2F(std::size_t kc, float alpha, const float *a, const float *b,
+               float *C, std::size_t ldc, std::size_t rows,
+               std::size_t columns) {
+  constexpr std::size_t MR = 6;
+  constexpr std::size_t NR = 16;
+  __m256 acc[MR][2];
+  for (std::size_t i = 0; i < MR; i++) {
+    acc[i][0] = _mm256_setzero_ps();
+    acc[i][1] = _mm256_setzero_ps();
+  }
+  for (std::size_t p = 0; p < kc; p++) {
+    const __m256 b0 = _mm256_loadu_ps(b);
+    const __m256 b1 = _mm256_loadu_ps(b + 8);
+    for (std::size_t i = 0; i < MR; i++) {
+      const __m256 ai = _mm256_broadcast_ss(a + i);
+      acc[i][0] = _mm256_fmadd_ps(ai, b0, acc[i][0]);
+      acc[i][1] = _mm256_fmadd_ps(ai, b1, acc[i][1]);
+    }
+    a += MR;
+    b += NR;
+  }
+  const __m256 scale = _mm256_set1_ps(alpha);
+  if (rows == MR && columns == NR) {
+    for (std::size_t i = 0; i < MR; i++) {
+      float *row = C + i * ldc;
+      _mm256_storeu_ps(row, _mm256_fmadd_ps(scale, acc[i][0],
+                                            _mm256_loadu_ps(row)));
+      _mm256_storeu_ps(row + 8, _mm256_fmadd_ps(scale, acc[i][1],
+                                                _mm256_loadu_ps(row + 8)));
+    }
+    return;
+  }
+  float tile[MR * NR];
+  for (std::size_t i = 0; i < MR; i++) {
+    _mm256_storeu_ps(tile + i * NR, acc[i][0]);
+    _mm256_storeu_ps(tile + i * NR + 8, acc[i][1]);
+  }
+  addTileEdge(rows, columns, alpha, tile, NR, C, ldc);
+}
+
+MWP_TARGET("avx512f")
+void gemmAvx512F(std::size_t kc, float alpha, const float *a, const float *b,
+                 float *C, std::size_t ldc, std::size_t rows,
+                 std::size_t columns) {
+  constexpr std::size_t MR = 8;
+  constexpr std::size_t NR = 48;
+  __m512 acc[MR][3];
+  for (std::size_t i = 0; i < MR; i++) {
+    for (std::size_t v = 0; v < 3; v++) {
+      acc[i][v] = _mm512_setzero_ps();
+    }
+  }
+  for (std::size_t p = 0; p < kc; p++) {
+    const __m512 b0 = _mm512_loadu_ps(b);
+    const __m512 b1 = _mm512_loadu_ps(b + 16);
+    const __m512 b2 = _mm512_loadu_ps(b + 32);
+    for (std::size_t i = 0; i < MR; i++) {
+      const __m512 ai = _mm512_set1_ps(a[i]);
+      acc[i][0] = _mm512_fmadd_ps(ai, b0, acc[i][0]);
+      acc[i][1] = _mm512_fmadd_ps(ai, b1, acc[i][1]);
+      acc[i][2] = _mm512_fmadd_ps(ai, b2, acc[i][2]);
+    }
+    a += MR;
+    b += NR;
+  }
+  const __m512 scale = _mm512_set1_ps(alpha);
+  if (rows == MR && columns == NR) {
+    for (std::size_t i = 0; i < MR; i++) {
+      float *row = C + i * ldc;
+      for (std::size_t v = 0; v < 3; v++) {
+        _mm512_storeu_ps(row + 16 * v,
+                         _mm512_fmadd_ps(scale, acc[i][v],
+                                         _mm512_loadu_ps(row + 16 * v)));
+      }
+    }
+    return;
+  }
+  float tile[MR * NR];
+  for (std::size_t i = 0; i < MR; i++) {
+    for (std::size_t v = 0; v < 3; v++) {
+      _mm512_storeu_ps(tile + i * NR + 16 * v, acc[i][v]);
+    }
+  }
+  addTileEdge(rows, columns, alpha, tile, NR, C, ldc);
+}
+
+// Complex double: one, two and four numbers per register. A complex product
+// multiplies by the duplicated real parts of one factor, then adds or
+// subtracts the pair-swapped factor times the duplicated imaginary parts
+// (addsub with SSE2 sign flips, fmaddsub with AVX2 and AVX-512).
+
+MWP_TARGET("sse2")
+inline __m128d multiplySse2C(__m128d a, __m128d x) {
+  const __m128d real = _mm_unpacklo_pd(a, a);
+  const __m128d imaginary = _mm_unpackhi_pd(a, a);
+  const __m128d swapped = _mm_mul_pd(imaginary, _mm_shuffle_pd(x, x, 1));
+  return _mm_add_pd(_mm_mul_pd(real, x),
+                    _mm_xor_pd(swapped, _mm_set_pd(0.0, -0.0)));
+}
+
+MWP_TARGET("sse2")
+inline __m128d conjugateSse2C(__m128d x) {
+  return _mm_xor_pd(x, _mm_set_pd(-0.0, 0.0));
+}
+
+MWP_TARGET("sse2")
+void axpySse2C(std::size_t n, Complex alpha, const Complex *x, Complex *y) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  double *ys = reinterpret_cast<double *>(y);
+  const __m128d a = _mm_loadu_pd(reinterpret_cast<const double *>(&alpha));
+  for (std::size_t i = 0; i < n; i++) {
+    const __m128d product = multiplySse2C(a, _mm_loadu_pd(xs + 2 * i));
+    _mm_storeu_pd(ys + 2 * i, _mm_add_pd(_mm_loadu_pd(ys + 2 * i), product));
+  }
+}
+
+MWP_TARGET("sse2")
+void axpyConjugateSse2C(std::size_t n, Complex alpha, const Complex *x,
+                        Complex *y) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  double *ys = reinterpret_cast<double *>(y);
+  const __m128d a = _mm_loadu_pd(reinterpret_cast<const double *>(&alpha));
+  for (std::size_t i = 0; i < n; i++) {
+    const __m128d product =
+        multiplySse2C(a, conjugateSse2C(_mm_loadu_pd(xs + 2 * i)));
+    _mm_storeu_pd(ys + 2 * i, _mm_add_pd(_mm_loadu_pd(ys + 2 * i), product));
+  }
+}
+
+MWP_TARGET("sse2")
+void multiplyAddSse2C(std::size_t n, const Complex *x, const Complex *y,
+                      Complex *z) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  const double *ys = reinterpret_cast<const double *>(y);
+  double *zs = reinterpret_cast<double *>(z);
+  for (std::size_t i = 0; i < n; i++) {
+    const __m128d product =
+        multiplySse2C(_mm_loadu_pd(xs + 2 * i), _mm_loadu_pd(ys + 2 * i));
+    _mm_storeu_pd(zs + 2 * i, _mm_add_pd(_mm_loadu_pd(zs + 2 * i), product));
+  }
+}
+
+MWP_TARGET("sse2")
+Complex dotSse2C(std::size_t n, const Complex *x, const Complex *y) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  const double *ys = reinterpret_cast<const double *>(y);
+  __m128d acc = _mm_setzero_pd();
+  for (std::size_t i = 0; i < n; i++) {
+    acc = _mm_add_pd(acc, multiplySse2C(_mm_loadu_pd(xs + 2 * i),
+                                        _mm_loadu_pd(ys + 2 * i)));
+  }
+  double sum[2];
+  _mm_storeu_pd(sum, acc);
+  return Complex(sum[0], sum[1]);
+}
+
+MWP_TARGET("sse2")
+Complex dotConjugateSse2C(std::size_t n, const Complex *x, const Complex *y) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  const double *ys = reinterpret_cast<const double *>(y);
+  __m128d acc = _mm_setzero_pd();
+  for (std::size_t i = 0; i < n; i++) {
+    acc = _mm_add_pd(acc,
+                     multiplySse2C(conjugateSse2C(_mm_loadu_pd(xs + 2 * i)),
+                                   _mm_loadu_pd(ys + 2 * i)));
+  }
+  double sum[2];
+  _mm_storeu_pd(sum, acc);
+  return Complex(sum[0], sum[1]);
+}
+
+MWP_TARGET("avx2,fma")
+inline __m256d multiplyAvx2C(__m256d a, __m256d x) {
+  const __m256d swapped =
+      _mm256_mul_pd(_mm256_permute_pd(a, 0xf), _mm256_permute_pd(x, 0x5));
+  return _mm256_fmaddsub_pd(_mm256_movedup_pd(a), x, swapped);
+}
+
+MWP_TARGET("avx2,fma")
+inline __m256d conjugateAvx2C(__m256d x) {
+  return _mm256_xor_pd(x, _mm256_set_pd(-0.0, 0.0, -0.0, 0.0));
+}
+
+MWP_TARGET("avx2,fma")
+inline Complex sumAvx2C(__m256d acc) {
+  double sum[2];
+  _mm_storeu_pd(sum, _mm_add_pd(_mm256_castpd256_pd128(acc),
+                                _mm256_extractf128_pd(acc, 1)));
+  return Complex(sum[0], sum[1]);
+}
+
+MWP_TARGET("avx2,fma")
+void axpyAvx2C(std::size_t n, Complex alpha, const Complex *x, Complex *y) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  double *ys = reinterpret_cast<double *>(y);
+  const __m256d a =
+      _mm256_set_pd(alpha.imag(), alpha.real(), alpha.imag(), alpha.real());
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    const __m256d product = multiplyAvx2C(a, _mm256_loadu_pd(xs + 2 * i));
+    _mm256_storeu_pd(ys + 2 * i,
+                     _mm256_add_pd(_mm256_loadu_pd(ys + 2 * i), product));
+  }
+  for (; i < n; i++) {
+    y[i] += alpha * x[i];
+  }
+}
+
+MWP_TARGET("avx2,fma")
+void axpyConjugateAvx2C(std::size_t n, Complex alpha, const Complex *x,
+                        Complex *y) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  double *ys = reinterpret_cast<double *>(y);
+  const __m256d a =
+      _mm256_set_pd(alpha.imag(), alpha.real(), alpha.imag(), alpha.real());
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    const __m256d product =
+        multiplyAvx2C(a, conjugateAvx2C(_mm256_loadu_pd(xs + 2 * i)));
+    _mm256_storeu_pd(ys + 2 * i,
+                     _mm256_add_pd(_mm256_loadu_pd(ys + 2 * i), product));
+  }
+  for (; i < n; i++) {
+    y[i] += alpha * std::conj(x[i]);
+  }
+}
+
+MWP_TARGET("avx2,fma")
+void multiplyAddAvx2C(std::size_t n, const Complex *x, const Complex *y,
+                      Complex *z) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  const double *ys = reinterpret_cast<const double *>(y);
+  double *zs = reinterpret_cast<double *>(z);
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    const __m256d product = multiplyAvx2C(_mm256_loadu_pd(xs + 2 * i),
+                                          _mm256_loadu_pd(ys + 2 * i));
+    _mm256_storeu_pd(zs + 2 * i,
+                     _mm256_add_pd(_mm256_loadu_pd(zs + 2 * i), product));
+  }
+  for (; i < n; i++) {
+    z[i] += x[i] * y[i];
+  }
+}
+
+MWP_TARGET("avx2,fma")
+Complex dotAvx2C(std::size_t n, const Complex *x, const Complex *y) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  const double *ys = reinterpret_cast<const double *>(y);
+  __m256d acc = _mm256_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    acc = _mm256_add_pd(acc, multiplyAvx2C(_mm256_loadu_pd(xs + 2 * i),
+                                           _mm256_loadu_pd(ys + 2 * i)));
+  }
+  Complex sum = sumAvx2C(acc);
+  for (; i < n; i++) {
+    sum += x[i] * y[i];
+  }
+  return sum;
+}
+
+MWP_TARGET("avx2,fma")
+Complex dotConjugateAvx2C(std::size_t n, const Complex *x, const Complex *y) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  const double *ys = reinterpret_cast<const double *>(y);
+  __m256d acc = _mm256_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    acc = _mm256_add_pd(
+        acc, multiplyAvx2C(conjugateAvx2C(_mm256_loadu_pd(xs + 2 * i)),
+                           _mm256_loadu_pd(ys + 2 * i)));
+  }
+  Complex sum = sumAvx2C(acc);
+  for (; i < n; i++) {
+    sum += std::conj(x[i]) * y[i];
+  }
+  return sum;
+}
+
+MWP_TARGET("avx512f")
+inline __m512d multiplyAvx512C(__m512d a, __m512d x) {
+  const __m512d swapped =
+      _mm512_mul_pd(_mm512_permute_pd(a, 0xff), _mm512_permute_pd(x, 0x55));
+  return _mm512_fmaddsub_pd(_mm512_movedup_pd(a), x, swapped);
+}
+
+MWP_TARGET("avx512f")
+inline __m512d conjugateAvx512C(__m512d x) {
+  return _mm512_mask_sub_pd(x, 0xaa, _mm512_setzero_pd(), x);
+}
+
+MWP_TARGET("avx512f")
+inline Complex sumAvx512C(__m512d acc) {
+  return Complex(_mm512_mask_reduce_add_pd(0x55, acc),
+                 _mm512_mask_reduce_add_pd(0xaa, acc));
+}
+
+MWP_TARGET("avx512f")
+void axpyAvx512C(std::size_t n, Complex alpha, const Complex *x, Complex *y) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  double *ys = reinterpret_cast<double *>(y);
+  const __m512d a = _mm512_set_pd(alpha.imag(), alpha.real(), alpha.imag(),
+                                  alpha.real(), alpha.imag(), alpha.real(),
+                                  alpha.imag(), alpha.real());
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m512d product = multiplyAvx512C(a, _mm512_loadu_pd(xs + 2 * i));
+    _mm512_storeu_pd(ys + 2 * i,
+                     _mm512_add_pd(_mm512_loadu_pd(ys + 2 * i), product));
+  }
+  if (i < n) {
+    const __mmask8 mask = tailMask(2 * (n - i));
+    const __m512d product =
+        multiplyAvx512C(a, _mm512_maskz_loadu_pd(mask, xs + 2 * i));
+    _mm512_mask_storeu_pd(
+        ys + 2 * i, mask,
+        _mm512_add_pd(_mm512_maskz_loadu_pd(mask, ys + 2 * i), product));
+  }
+}
+
+MWP_TARGET("avx512f")
+void axpyConjugateAvx512C(std::size_t n, Complex alpha, const Complex *x,
+                          Complex *y) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  double *ys = reinterpret_cast<double *>(y);
+  const __m512d a = _mm512_set_pd(alpha.imag(), alpha.real(), alpha.imag(),
+                                  alpha.real(), alpha.imag(), alpha.real(),
+                                  alpha.imag(), alpha.real());
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m512d product =
+        multiplyAvx512C(a, conjugateAvx512C(_mm512_loadu_pd(xs + 2 * i)));
+    _mm512_storeu_pd(ys + 2 * i,
+                     _mm512_add_pd(_mm512_loadu_pd(ys + 2 * i), product));
+  }
+  if (i < n) {
+    const __mmask8 mask = tailMask(2 * (n - i));
+    const __m512d product = multiplyAvx512C(
+        a, conjugateAvx512C(_mm512_maskz_loadu_pd(mask, xs + 2 * i)));
+    _mm512_mask_storeu_pd(
+        ys + 2 * i, mask,
+        _mm512_add_pd(_mm512_maskz_loadu_pd(mask, ys + 2 * i), product));
+  }
+}
+
+MWP_TARGET("avx512f")
+void multiplyAddAvx512C(std::size_t n, const Complex *x, const Complex *y,
+                        Complex *z) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  const double *ys = reinterpret_cast<const double *>(y);
+  double *zs = reinterpret_cast<double *>(z);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m512d product = multiplyAvx512C(_mm512_loadu_pd(xs + 2 * i),
+                                            _mm512_loadu_pd(ys + 2 * i));
+    _mm512_storeu_pd(zs + 2 * i,
+                     _mm512_add_pd(_mm512_loadu_pd(zs + 2 * i), product));
+  }
+  if (i < n) {
+    const __mmask8 mask = tailMask(2 * (n - i));
+    const __m512d product =
+        multiplyAvx512C(_mm512_maskz_loadu_pd(mask, xs + 2 * i),
+                        _mm512_maskz_loadu_pd(mask, ys + 2 * i));
+    _mm512_mask_storeu_pd(
+        zs + 2 * i, mask,
+        _mm512_add_pd(_mm512_maskz_loadu_pd(mask, zs + 2 * i), product));
+  }
+}
+
+MWP_TARGET("avx512f")
+Complex dotAvx512C(std::size_t n, const Complex *x, const Complex *y) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  const double *ys = reinterpret_cast<const double *>(y);
+  __m512d acc = _mm512_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc = _mm512_add_pd(acc, multiplyAvx512C(_mm512_loadu_pd(xs + 2 * i),
+                                             _mm512_loadu_pd(ys + 2 * i)));
+  }
+  if (i < n) {
+    const __mmask8 mask = tailMask(2 * (n - i));
+    acc = _mm512_add_pd(
+        acc, multiplyAvx512C(_mm512_maskz_loadu_pd(mask, xs + 2 * i),
+                             _mm512_maskz_loadu_pd(mask, ys + 2 * i)));
+  }
+  return sumAvx512C(acc);
+}
+
+MWP_TARGET("avx512f")
+Complex dotConjugateAvx512C(std::size_t n, const Complex *x,
+                            const Complex *y) {
+  const double *xs = reinterpret_cast<const double *>(x);
+  const double *ys = reinterpret_cast<const double *>(y);
+  __m512d acc = _mm512_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    acc = _mm512_add_pd(
+        acc, multiplyAvx512C(conjugateAvx512C(_mm512_loadu_pd(xs + 2 * i)),
+                             _mm512_loadu_pd(ys + 2 * i)));
+  }
+  if (i < n) {
+    const __mmask8 mask = tailMask(2 * (n - i));
+    const __m512d conjugated =
+        conjugateAvx512C(_mm512_maskz_loadu_pd(mask, xs + 2 * i));
+    const __m512d other = _mm512_maskz_loadu_pd(mask, ys + 2 * i);
+    acc = _mm512_add_pd(acc, multiplyAvx512C(conjugated, other));
+  }
+  return sumAvx512C(acc);
+}
+
+void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuidex(info, (int)leaf, (int)subleaf);
+  for (int i = 0; i < 4; i++) {
+    regs[i] = (unsigned int)info[i];
+  }
+#else
+  __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+unsigned long long xgetbv() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  return _xgetbv(0);
+#else
+  unsigned int eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+
+#endif
+
+simd::Level detectLevel() {
+#ifdef MWP_SIMD_X86
+  unsigned int regs[4];
+  cpuid(0, 0, regs);
+  const unsigned int maxLeaf = regs[0];
+  cpuid(1, 0, regs);
+  const bool sse2 = (regs[3] >> 26) & 1u;
+  const bool osxsave = (regs[2] >> 27) & 1u;
+  const bool avx = (regs[2] >> 28) & 1u;
+  const bool fma = (regs[2] >> 12) & 1u;
+  if (!sse2) {
+    return simd::Level::Scalar;
+  }
+  if (!osxsave || !avx || maxLeaf < 7) {
+    return simd::Level::SSE2;
+  }
+  const unsigned long long xcr0 = xgetbv();
+  const bool ymmState = (xcr0 & 0x6) == 0x6;
+  const bool zmmState = (xcr0 & 0xe6) == 0xe6;
+  cpuid(7, 0, regs);
+  const bool avx2 = (regs[1] >> 5) & 1u;
+  const bool avx512f = (regs[1] >> 16) & 1u;
+  if (avx512f && zmmState) {
+    return simd::Level::AVX512;
+  }
+  if (avx2 && fma && ymmState) {
+    return simd::Level::AVX2;
+  }
+  return simd::Level::SSE2;
+#else
+  return simd::Level::Scalar;
+#endif
+}
+
+simd::Level selectLevel() {
+  simd::Level level = detectLevel();
+  const char *requested = std::getenv("MWP_SIMD");
+  if (requested == nullptr) {
+    return level;
+  }
+  simd::Level cap = level;
+  if (std::strcmp(requested, "scalar") == 0) {
+    cap = simd::Level::Scalar;
+  } else if (std::strcmp(requested, "sse2") == 0) {
+    cap = simd::Level::SSE2;
+  } else if (std::strcmp(requested, "avx2") == 0) {
+    cap = simd::Level::AVX2;
+  } else if (std::strcmp(requested, "avx512") == 0) {
+    cap = simd::Level::AVX512;
+  }
+  return cap < level ? cap : level;
+}
+
+Kernels makeKernels(simd::Level level) {
+  switch (level) {
+#ifdef MWP_SIMD_X86
+  case simd::Level::AVX512:
+    return {addAvx512, subAvx512, scaleAvx512, axpyAvx512, multiplyAddAvx512,
+            dotAvx512, sumSquaresAvx512, transposeAvx512, {8, 24, gemmAvx512}};
+  case simd::Level::AVX2:
+    return {addAvx2, subAvx2, scaleAvx2, axpyAvx2, multiplyAddAvx2,
+            dotAvx2, sumSquaresAvx2, transposeAvx2, {6, 8, gemmAvx2}};
+  case simd::Level::SSE2:
+    return {addSse2, subSse2, scaleSse2, axpySse2, multiplyAddSse2,
+            dotSse2, sumSquaresSse2, transposeSse2,
+            {4, 8, simd::gemmTile<double, 4, 8>}};
+#endif
+  default:
+    return {addScalar, subScalar, scaleScalar, axpyScalar, multiplyAddScalar,
+            dotScalar, sumSquaresScalar, transposeScalar,
+            {4, 8, simd::gemmTile<double, 4, 8>}};
+  }
+}
+
+const Kernels &kernels() {
+  static const Kernels table = makeKernels(simd::activeLevel());
+  return table;
+}
+
+FloatKernels makeFloatKernels(simd::Level level) {
+  switch (level) {
+#ifdef MWP_SIMD_X86
+  case simd::Level::AVX512:
+    return {axpyAvx512F, dotAvx512F, {8, 48, gemmAvx512F}};
+  case simd::Level::AVX2:
+    return {axpyAvx2F, dotAvx2F, {6, 16, gemmAvx2F}};
+  case simd::Level::SSE2:
+    return {axpySse2F, dotSse2F, {4, 16, simd::gemmTile<float, 4, 16>}};
+#endif
+  default:
+    return {axpyScalarF, dotScalarF, {4, 16, simd::gemmTile<float, 4, 16>}};
+  }
+}
+
+const FloatKernels &floatKernels() {
+  static const FloatKernels table = makeFloatKernels(simd::activeLevel());
+  return table;
+}
+
+ComplexKernels makeComplexKernels(simd::Level level) {
+  switch (level) {
+#ifdef MWP_SIMD_X86
+  case simd::Level::AVX512:
+    return {axpyAvx512C, axpyConjugateAvx512C, multiplyAddAvx512C, dotAvx512C,
+            dotConjugateAvx512C};
+  case simd::Level::AVX2:
+    return {axpyAvx2C, axpyConjugateAvx2C, multiplyAddAvx2C, dotAvx2C,
+            dotConjugateAvx2C};
+  case simd::Level::SSE2:
+    return {axpySse2C, axpyConjugateSse2C, multiplyAddSse2C, dotSse2C,
+            dotConjugateSse2C};
+#endif
+  default:
+    return {axpyScalarC, axpyConjugateScalarC, multiplyAddScalarC, dotScalarC,
+            dotConjugateScalarC};
+  }
+}
+
+const ComplexKernels &complexKernels() {
+  static const ComplexKernels table = makeComplexKernels(simd::activeLevel());
+  return table;
+}
+
+} // namespace
+
+simd::Level simd::activeLevel() {
+  static const Level level = selectLevel();
+  return level;
+}
+
+const char *simd::levelName(Level level) {
+  switch (level) {
+  case Level::SSE2:
+    return "sse2";
+  case Level::AVX2:
+    return "avx2";
+  case Level::AVX512:
+    return "avx512";
+  default:
+    return "scalar";
+  }
+}
+
+template <>
+void simd::add<double>(std::size_t n, const double *x, const double *y,
+                       double *out) {
+  kernels().add(n, x, y, out);
+}
+
+template <>
+void simd::sub<double>(std::size_t n, const double *x, const double *y,
+                       double *out) {
+  kernels().sub(n, x, y, out);
+}
+
+template <>
+void simd::scale<double>(std::size_t n, double alpha, const double *x,
+                         double *out) {
+  kernels().scale(n, alpha, x, out);
+}
+
+template <>
+void simd::axpy<double>(std::size_t n, double alpha, const double *x,
+                        double *y) {
+  kernels().axpy(n, alpha, x, y);
+}
+
+template <>
+void simd::multiplyAdd<double>(std::size_t n, const double *x,
+                               const double *y, double *z) {
+  kernels().multiplyAdd(n, x, y, z);
+}
+
+template <>
+double simd::dot<double>(std::size_t n, const double *x, const double *y) {
+  return kernels().dot(n, x, y);
+}
+
+template <> double simd::sumSquares<double>(std::size_t n, const double *x) {
+  return kernels().sumSquares(n, x);
+}
+
+template <>
+void simd::transpose<double>(std::size_t rows, std::size_t columns,
+                             const double *a, std::size_t lda, double *b,
+                             std::size_t ldb) {
+  kernels().transpose(rows, columns, a, lda, b, ldb);
+}
+
+template <>
+simd::GemmMicroKernel<double> simd::gemmMicroKernel<double>() {
+  return kernels().gemm;
+}
+
+template <>
+simd::GemmMicroKernel<float> simd::gemmMicroKernel<float>() {
+  return floatKernels().gemm;
+}
+
+template <>
+void simd::axpy<float>(std::size_t n, float alpha, const float *x, float *y) {
+  floatKernels().axpy(n, alpha, x, y);
+}
+
+template <>
+float simd::dot<float>(std::size_t n, const float *x, const float *y) {
+  return floatKernels().dot(n, x, y);
+}
+
+template <>
+void simd::axpy<Complex>(std::size_t n, Complex alpha, const Complex *x,
+                         Complex *y) {
+  complexKernels().axpy(n, alpha, x, y);
+}
+
+template <>
+void simd::axpyConjugate<Complex>(std::size_t n, Complex alpha,
+                                  const Complex *x, Complex *y) {
+  complexKernels().axpyConjugate(n, alpha, x, y);
+}
+
+template <>
+void simd::multiplyAdd<Complex>(std::size_t n, const Complex *x,
+                                const Complex *y, Complex *z) {
+  complexKernels().multiplyAdd(n, x, y, z);
+}
+
+template <>
+Complex simd::dot<Complex>(std::size_t n, const Complex *x, const Complex *y) {
+  return complexKernels().dot(n, x, y);
+}
+
+template <>
+Complex simd::dotConjugate<Complex>(std::size_t n, const Complex *x,
+                                    const Complex *y) {
+  return complexKernels().dotConjugate(n, x, y);
+}
+
+} // namespace MWP
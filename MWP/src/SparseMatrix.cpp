@@ -0,0 +1,325 @@
+#include "SparseMatrix.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+
+// Splits the major lines into parts holding about the same number of
+// nonzeros; returns parts + 1 line boundaries.
+std::vector<std::size_t> balancedSplit(const std::vector<std::size_t> &offsets,
+                                       std::size_t parts) {
+  const std::size_t lines = offsets.size() - 1;
+  const std::size_t nonZeros = offsets.back();
+  std::vector<std::size_t> bounds(parts + 1, lines);
+  bounds[0] = 0;
+  for (std::size_t p = 1; p < parts; p++) {
+    const std::size_t target = p * nonZeros / parts;
+    bounds[p] = std::lower_bound(offsets.begin(), offsets.end(), target) -
+                offsets.begin();
+    bounds[p] = std::max(bounds[p - 1], std::min(bounds[p], lines));
+  }
+  return bounds;
+}
+
+// Recompresses the nonzeros along the other dimension with a counting sort.
+// Walking the input lines in order leaves the new minor indices sorted.
+template <typename T>
+void compressTransposed(std::size_t minorSize,
+                        const std::vector<std::size_t> &offsets,
+                        const std::vector<std::size_t> &indices,
+                        const std::vector<T> &values,
+                        std::vector<std::size_t> &outOffsets,
+                        std::vector<std::size_t> &outIndices,
+                        std::vector<T> &outValues) {
+  const std::size_t majorSize = offsets.size() - 1;
+  outOffsets.assign(minorSize + 1, 0);
+  for (std::size_t index : indices) {
+    outOffsets[index + 1]++;
+  }
+  for (std::size_t l = 0; l < minorSize; l++) {
+    outOffsets[l + 1] += outOffsets[l];
+  }
+  outIndices.resize(indices.size());
+  outValues.resize(values.size());
+  std::vector<std::size_t> next(outOffsets.begin(), outOffsets.end() - 1);
+  for (std::size_t l = 0; l < majorSize; l++) {
+    for (std::size_t p = offsets[l]; p < offsets[l + 1]; p++) {
+      const std::size_t q = next[indices[p]]++;
+      outIndices[q] = l;
+      outValues[q] = values[p];
+    }
+  }
+}
+
+} // namespace
+
+template <typename T>
+MWP::SparseMatrix<T>::SparseMatrix()
+    : _rows(0), _columns(0), _format(SparseFormat::CSR), _offsets(1, 0) {}
+
+template <typename T>
+MWP::SparseMatrix<T>::SparseMatrix(std::size_t rows, std::size_t columns,
+                                   SparseFormat format)
+    : _rows(rows), _columns(columns), _format(format),
+      _offsets((format == SparseFormat::CSR ? rows : columns) + 1, 0) {}
+
+template <typename T>
+MWP::SparseMatrix<T>::SparseMatrix(std::size_t rows, std::size_t columns,
+                                   const std::vector<Triplet<T>> &triplets,
+                                   SparseFormat format)
+    : SparseMatrix(rows, columns, format) {
+  const bool csr = format == SparseFormat::CSR;
+  std::vector<std::pair<std::size_t, std::size_t>> keys;
+  keys.reserve(triplets.size());
+  for (std::size_t t = 0; t < triplets.size(); t++) {
+    if (triplets[t]._row >= rows || triplets[t]._column >= columns) {
+      throw std::runtime_error("Index out of bounds");
+    }
+    keys.emplace_back(csr ? triplets[t]._row : triplets[t]._column, t);
+  }
+  // Ordered by major index, then by minor index, so duplicates are adjacent.
+  auto minor = [&](std::size_t t) {
+    return csr ? triplets[t]._column : triplets[t]._row;
+  };
+  std::sort(keys.begin(), keys.end(), [&](const auto &a, const auto &b) {
+    return a.first != b.first ? a.first < b.first
+                              : minor(a.second) < minor(b.second);
+  });
+  for (std::size_t e = 0; e < keys.size(); e++) {
+    const std::size_t line = keys[e].first;
+    const std::size_t index = minor(keys[e].second);
+    const T value = triplets[keys[e].second]._value;
+    if (e > 0 && keys[e - 1].first == line && _indices.back() == index) {
+      _values.back() += value;
+      continue;
+    }
+    _indices.push_back(index);
+    _values.push_back(value);
+    _offsets[line + 1]++;
+  }
+  for (std::size_t l = 0; l + 1 < _offsets.size(); l++) {
+    _offsets[l + 1] += _offsets[l];
+  }
+}
+
+template <typename T>
+MWP::SparseMatrix<T>::SparseMatrix(const Matrix<T> &matrix,
+                                   SparseFormat format)
+    : SparseMatrix(matrix._rows, matrix._columns, SparseFormat::CSR) {
+  for (std::size_t i = 0; i < _rows; i++) {
+    for (std::size_t j = 0; j < _columns; j++) {
+      const T value = matrix._elements[i * _columns + j];
+      if (value != (T)0) {
+        _indices.push_back(j);
+        _values.push_back(value);
+      }
+    }
+    _offsets[i + 1] = _indices.size();
+  }
+  if (format == SparseFormat::CSC) {
+    *this = toCSC();
+  }
+}
+
+template <typename T> std::size_t MWP::SparseMatrix<T>::nonZeros() const {
+  return _values.size();
+}
+
+template <typename T> std::size_t MWP::SparseMatrix<T>::majorSize() const {
+  return _format == SparseFormat::CSR ? _rows : _columns;
+}
+
+template <typename T>
+T MWP::SparseMatrix<T>::operator()(std::size_t row, std::size_t column) const {
+  if (row >= _rows || column >= _columns) {
+    throw std::runtime_error("Index out of bounds");
+  }
+  const bool csr = _format == SparseFormat::CSR;
+  const std::size_t line = csr ? row : column;
+  const std::size_t index = csr ? column : row;
+  auto first = _indices.begin() + _offsets[line];
+  auto last = _indices.begin() + _offsets[line + 1];
+  auto found = std::lower_bound(first, last, index);
+  if (found == last || *found != index) {
+    return (T)0;
+  }
+  return _values[found - _indices.begin()];
+}
+
+template <typename T> MWP::Matrix<T> MWP::SparseMatrix<T>::toDense() const {
+  Matrix<T> matrix(_rows, _columns);
+  const bool csr = _format == SparseFormat::CSR;
+  for (std::size_t l = 0; l < majorSize(); l++) {
+    for (std::size_t p = _offsets[l]; p < _offsets[l + 1]; p++) {
+      const std::size_t i = csr ? l : _indices[p];
+      const std::size_t j = csr ? _indices[p] : l;
+      matrix._elements[i * _columns + j] = _values[p];
+    }
+  }
+  return matrix;
+}
+
+template <typename T>
+MWP::SparseMatrix<T> MWP::SparseMatrix<T>::transposed() const {
+  SparseMatrix<T> transpose = *this;
+  std::swap(transpose._rows, transpose._columns);
+  transpose._format = _format == SparseFormat::CSR ? SparseFormat::CSC
+                                                   : SparseFormat::CSR;
+  return transpose;
+}
+
+template <typename T>
+MWP::SparseMatrix<T> MWP::SparseMatrix<T>::toCSR() const {
+  if (_format == SparseFormat::CSR) {
+    return *this;
+  }
+  SparseMatrix<T> converted(_rows, _columns, SparseFormat::CSR);
+  compressTransposed(_rows, _offsets, _indices, _values, converted._offsets,
+                     converted._indices, converted._values);
+  return converted;
+}
+
+template <typename T>
+MWP::SparseMatrix<T> MWP::SparseMatrix<T>::toCSC() const {
+  if (_format == SparseFormat::CSC) {
+    return *this;
+  }
+  SparseMatrix<T> converted(_rows, _columns, SparseFormat::CSC);
+  compressTransposed(_columns, _offsets, _indices, _values,
+                     converted._offsets, converted._indices,
+                     converted._values);
+  return converted;
+}
+
+template <typename T>
+void MWP::SparseMatrix<T>::product(bool transpose, const T *B, std::size_t k,
+                                   T *C) const {
+  const std::size_t outputs = transpose ? _columns : _rows;
+  const bool gather = (_format == SparseFormat::CSR) != transpose;
+  ThreadPool &pool = ThreadPool::instance();
+  const std::size_t parts = std::max<std::size_t>(
+      1, std::min<std::size_t>(getNumThreads(), nonZeros() / 4096));
+  const std::vector<std::size_t> bounds = balancedSplit(_offsets, parts);
+
+  if (gather) {
+    // Each output line is a sparse combination of rows of B.
+    pool.parallelFor(parts, [&](std::size_t part) {
+      for (std::size_t l = bounds[part]; l < bounds[part + 1]; l++) {
+        T *out = C + l * k;
+        if (k == 1) {
+          T sum = (T)0;
+          for (std::size_t p = _offsets[l]; p < _offsets[l + 1]; p++) {
+            sum += _values[p] * B[_indices[p]];
+          }
+          *out = sum;
+          continue;
+        }
+        std::fill(out, out + k, (T)0);
+        for (std::size_t p = _offsets[l]; p < _offsets[l + 1]; p++) {
+          simd::axpy<T>(k, _values[p], B + _indices[p] * k, out);
+        }
+      }
+    });
+    return;
+  }
+
+  // Each input line scatters into the output; every part owns a private
+  // accumulator so that no two threads write the same entry.
+  auto scatter = [&](std::size_t part, T *out) {
+    for (std::size_t l = bounds[part]; l < bounds[part + 1]; l++) {
+      const T *in = B + l * k;
+      for (std::size_t p = _offsets[l]; p < _offsets[l + 1]; p++) {
+        if (k == 1) {
+          out[_indices[p]] += _values[p] * *in;
+        } else {
+          simd::axpy<T>(k, _values[p], in, out + _indices[p] * k);
+        }
+      }
+    }
+  };
+  std::fill(C, C + outputs * k, (T)0);
+  if (parts == 1) {
+    scatter(0, C);
+    return;
+  }
+  std::vector<std::vector<T>> partial(parts);
+  pool.parallelFor(parts, [&](std::size_t part) {
+    partial[part].assign(outputs * k, (T)0);
+    scatter(part, partial[part].data());
+  });
+  const std::size_t size = outputs * k;
+  pool.parallelFor(parts, [&](std::size_t part) {
+    const std::size_t first = part * size / parts;
+    const std::size_t last = (part + 1) * size / parts;
+    for (std::size_t q = 0; q < parts; q++) {
+      simd::add<T>(last - first, C + first, partial[q].data() + first,
+                   C + first);
+    }
+  });
+}
+
+template <typename T>
+void MWP::SparseMatrix<T>::multiply(const T *x, T *y) const {
+  product(false, x, 1, y);
+}
+
+template <typename T>
+void MWP::SparseMatrix<T>::multiplyTransposed(const T *x, T *y) const {
+  product(true, x, 1, y);
+}
+
+template <typename T>
+MWP::Vector<T> MWP::SparseMatrix<T>::operator*(const Vector<T> &vector) const {
+  if (vector._rows != _columns || vector._columns != 1) {
+    throw std::runtime_error(
+        "Invalid matrix and vector dimensions for multiplication operation");
+  }
+  Vector<T> result(_rows, 1, Uninitialized);
+  product(false, vector._elements.data(), 1, result._elements.data());
+  return result;
+}
+
+template <typename T>
+MWP::Vector<T>
+MWP::SparseMatrix<T>::multiplyTransposed(const Vector<T> &vector) const {
+  if (vector._rows != _rows || vector._columns != 1) {
+    throw std::runtime_error(
+        "Invalid matrix and vector dimensions for multiplication operation");
+  }
+  Vector<T> result(_columns, 1, Uninitialized);
+  product(true, vector._elements.data(), 1, result._elements.data());
+  return result;
+}
+
+template <typename T>
+MWP::Matrix<T> MWP::SparseMatrix<T>::operator*(const Matrix<T> &matrix) const {
+  if (matrix._rows != _columns) {
+    throw std::runtime_error(
+        "Invalid matrices dimensions for multiplication operation");
+  }
+  Matrix<T> result(_rows, matrix._columns, Uninitialized);
+  product(false, matrix._elements.data(), matrix._columns,
+          result._elements.data());
+  return result;
+}
+
+template <typename T>
+MWP::Matrix<T>
+MWP::SparseMatrix<T>::multiplyTransposed(const Matrix<T> &matrix) const {
+  if (matrix._rows != _rows) {
+    throw std::runtime_error(
+        "Invalid matrices dimensions for multiplication operation");
+  }
+  Matrix<T> result(_columns, matrix._columns, Uninitialized);
+  product(true, matrix._elements.data(), matrix._columns,
+          result._elements.data());
+  return result;
+}
+
+#ifndef MWP_HEADER_ONLY
+template class MWP::SparseMatrix<double>;
+template class MWP::SparseMatrix<float>;
+template class MWP::SparseMatrix<int>;
+#endif
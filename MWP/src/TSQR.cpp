@@ -0,0 +1,206 @@
+#include "TSQR.hpp"
+#include "ThreadPool.hpp"
+#include "Trsm.hpp"
+#include "Workspace.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+
+template <typename T>
+MWP::TSQR<T>::TSQR(Matrix<T> matrix, unsigned int blocks)
+    : _factors(std::move(matrix)) {
+  const std::size_t m = _factors._rows;
+  const std::size_t n = _factors._columns;
+  if (m < n) {
+    throw std::runtime_error(
+        "Underdetermined linear systems are not supported");
+  }
+  std::size_t leaves = blocks == 0 ? getNumThreads() : blocks;
+  leaves = std::max<std::size_t>(1, std::min(leaves, n == 0 ? 1 : m / n));
+  _leafStarts.resize(leaves + 1);
+  for (std::size_t j = 0; j <= leaves; j++) {
+    _leafStarts[j] = j * m / leaves;
+  }
+
+  _leafTau.resize(leaves);
+  ThreadPool::instance().parallelFor(leaves, [&](std::size_t j) {
+    qrFactorInPlace(
+        _factors.view(_leafStarts[j], _leafStarts[j + 1], 0, n), _leafTau[j]);
+  });
+
+  // R factors of the nodes of the current level. Leaves keep theirs in
+  // place, so only the upper triangles of their first n rows are copied.
+  std::vector<Matrix<T>> uppers(leaves, Matrix<T>(n, n));
+  ThreadPool::instance().parallelFor(leaves, [&](std::size_t j) {
+    const T *leaf = _factors._elements.data() + _leafStarts[j] * n;
+    for (std::size_t i = 0; i < n; i++) {
+      std::copy(leaf + i * n + i, leaf + (i + 1) * n,
+                uppers[j]._elements.begin() + i * n + i);
+    }
+  });
+
+  while (uppers.size() > 1) {
+    const std::size_t pairs = uppers.size() / 2;
+    std::vector<QR<T>> level(pairs);
+    std::vector<Matrix<T>> next((uppers.size() + 1) / 2);
+    ThreadPool::instance().parallelFor(pairs, [&](std::size_t p) {
+      Matrix<T> stacked(2 * n, n);
+      std::copy(uppers[2 * p]._elements.begin(),
+                uppers[2 * p]._elements.end(), stacked._elements.begin());
+      std::copy(uppers[2 * p + 1]._elements.begin(),
+                uppers[2 * p + 1]._elements.end(),
+                stacked._elements.begin() + n * n);
+      level[p] = QR<T>(std::move(stacked));
+      next[p] = level[p].upper();
+    });
+    // An odd node is carried to the next level unchanged.
+    if (uppers.size() % 2 == 1) {
+      next.back() = std::move(uppers.back());
+    }
+    _levels.push_back(std::move(level));
+    uppers = std::move(next);
+  }
+  _upper = std::move(uppers.front());
+}
+
+template <typename T> const MWP::Matrix<T> &MWP::TSQR<T>::upper() const {
+  return _upper;
+}
+
+template <typename T> std::size_t MWP::TSQR<T>::blocks() const {
+  return _leafTau.size();
+}
+
+template <typename T>
+std::size_t MWP::TSQR<T>::nodeRow(std::size_t level, std::size_t node) const {
+  // A node stands for its leftmost leaf: its part of Q^T * B lives in the
+  // first n rows of that leaf's block.
+  return _leafStarts[node << level];
+}
+
+template <typename T>
+void MWP::TSQR<T>::applyNode(const QR<T> &qr, bool transpose, T *work,
+                             std::size_t k, std::size_t topRow,
+                             std::size_t bottomRow) const {
+  const std::size_t n = _factors._columns;
+  WorkspaceScope scope;
+  T *stacked = scope.allocate<T>(2 * n * k);
+  T *top = work + topRow * k;
+  T *bottom = work + bottomRow * k;
+  std::copy(top, top + n * k, stacked);
+  std::copy(bottom, bottom + n * k, stacked + n * k);
+  MatrixView<T> view(stacked, 2 * n, k, k);
+  if (transpose) {
+    qr.applyQTransposed(view);
+  } else {
+    qr.applyQ(view);
+  }
+  std::copy(stacked, stacked + n * k, top);
+  std::copy(stacked + n * k, stacked + 2 * n * k, bottom);
+}
+
+template <typename T>
+MWP::Matrix<T> MWP::TSQR<T>::multiplyQTransposed(const Matrix<T> &B) const {
+  if (B._rows != _factors._rows) {
+    throw std::runtime_error(
+        "Invalid matrices dimensions for multiplication operation");
+  }
+  const std::size_t n = _factors._columns;
+  const std::size_t m = _factors._rows;
+  const std::size_t k = B._columns;
+  // Only the first n rows of Q^T * B are returned, so the product is formed
+  // in the workspace.
+  WorkspaceScope scope;
+  T *work = scope.allocate<T>(m * k);
+  std::copy(B._elements.begin(), B._elements.end(), work);
+  ThreadPool::instance().parallelFor(blocks(), [&](std::size_t j) {
+    applyHouseholder<T>(
+        _factors.view(_leafStarts[j], _leafStarts[j + 1], 0, n), _leafTau[j],
+        true,
+        MatrixView<T>(work + _leafStarts[j] * k,
+                      _leafStarts[j + 1] - _leafStarts[j], k, k));
+  });
+  for (std::size_t level = 0; level < _levels.size(); level++) {
+    ThreadPool::instance().parallelFor(
+        _levels[level].size(), [&](std::size_t p) {
+          applyNode(_levels[level][p], true, work, k, nodeRow(level, 2 * p),
+                    nodeRow(level, 2 * p + 1));
+        });
+  }
+  return Matrix<T>(MatrixView<T>(work, n, k, k));
+}
+
+template <typename T>
+MWP::Matrix<T> MWP::TSQR<T>::multiplyQ(const Matrix<T> &X) const {
+  const std::size_t m = _factors._rows;
+  const std::size_t n = _factors._columns;
+  if (X._rows != n) {
+    throw std::runtime_error(
+        "Invalid matrices dimensions for multiplication operation");
+  }
+  const std::size_t k = X._columns;
+  Matrix<T> work(m, k);
+  std::copy(X._elements.begin(), X._elements.end(), work._elements.begin());
+  for (std::size_t level = _levels.size(); level-- > 0;) {
+    ThreadPool::instance().parallelFor(
+        _levels[level].size(), [&](std::size_t p) {
+          applyNode(_levels[level][p], false, work._elements.data(), k,
+                    nodeRow(level, 2 * p), nodeRow(level, 2 * p + 1));
+        });
+  }
+  ThreadPool::instance().parallelFor(blocks(), [&](std::size_t j) {
+    applyHouseholder<T>(
+        _factors.view(_leafStarts[j], _leafStarts[j + 1], 0, n), _leafTau[j],
+        false, work.view(_leafStarts[j], _leafStarts[j + 1], 0, k));
+  });
+  return work;
+}
+
+template <typename T> MWP::Matrix<T> MWP::TSQR<T>::orthogonal() const {
+  const Index n = _factors._columns;
+  return multiplyQ(IdentityMatrix<T>(n, n));
+}
+
+template <typename T>
+MWP::Vector<T> MWP::TSQR<T>::solve(const Vector<T> &constants) const {
+  if (constants._columns != 1) {
+    throw std::runtime_error("Incompatible constants vector dimension");
+  }
+  Matrix<T> solution = solve(toMatrix(constants));
+  return toVector(solution);
+}
+
+template <typename T>
+MWP::Matrix<T> MWP::TSQR<T>::solve(const Matrix<T> &constants) const {
+  if (constants._rows != _factors._rows) {
+    throw std::runtime_error("Incompatible dimension of coefficient matrix "
+                             "with the constants matrix");
+  }
+  const Index m = _factors._rows;
+  const Index n = _factors._columns;
+  // Same rank test as QR::isFullRank, on the final R.
+  T largest = (T)0;
+  for (Index i = 0; i < n; i++) {
+    largest = std::max(largest, (T)std::abs(_upper._elements[i * n + i]));
+  }
+  const T tolerance =
+      largest * (T)std::max(m, n) * std::numeric_limits<T>::epsilon();
+  for (Index i = 0; i < n; i++) {
+    const T diagonal = (T)std::abs(_upper._elements[i * n + i]);
+    if (diagonal == (T)0 || diagonal <= tolerance) {
+      throw std::runtime_error("The matrix is singular");
+    }
+  }
+  Matrix<T> projected = multiplyQTransposed(constants);
+  trsm<T>(false, false, false, n, projected._columns,
+          _upper._elements.data(), n, projected._elements.data(),
+          projected._columns);
+  return projected;
+}
+
+#ifndef MWP_HEADER_ONLY
+template class MWP::TSQR<double>;
+template class MWP::TSQR<float>;
+#endif
@@ -0,0 +1,166 @@
+#include "ThreadPool.hpp"
+#include <cstdlib>
+#include <stdexcept>
+
+namespace MWP {
+
+namespace {
+
+unsigned int resolveThreadCount(unsigned int threads) {
+  if (threads == 0) {
+    threads = std::thread::hardware_concurrency();
+  }
+  return threads == 0 ? 1 : threads;
+}
+
+unsigned int threadCountFromEnvironment() {
+  const char *value = std::getenv("MWP_NUM_THREADS");
+  if (value == nullptr) {
+    return 0;
+  }
+  long threads = std::strtol(value, nullptr, 10);
+  return threads > 0 ? (unsigned int)threads : 0;
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned int threads)
+    : _size(1), _task(nullptr), _count(0), _next(0), _active(0),
+      _generation(0), _stop(false) {
+  start(resolveThreadCount(threads));
+}
+
+ThreadPool::~ThreadPool() { stop(); }
+
+ThreadPool &ThreadPool::instance() {
+  static ThreadPool pool(threadCountFromEnvironment());
+  return pool;
+}
+
+bool &ThreadPool::insideParallelRegion() {
+  thread_local bool inside = false;
+  return inside;
+}
+
+unsigned int ThreadPool::size() const { return _size.load(); }
+
+void ThreadPool::resize(unsigned int threads) {
+  if (insideParallelRegion()) {
+    throw std::runtime_error("The thread pool cannot be resized from a task");
+  }
+  std::lock_guard<std::mutex> submitLock(_submitMutex);
+  threads = resolveThreadCount(threads);
+  if (threads == size()) {
+    return;
+  }
+  stop();
+  start(threads);
+}
+
+void ThreadPool::parallelFor(std::size_t count,
+                             const std::function<void(std::size_t)> &task) {
+  if (count == 0) {
+    return;
+  }
+  if (count == 1 || size() == 1 || insideParallelRegion()) {
+    for (std::size_t i = 0; i < count; i++) {
+      task(i);
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> submitLock(_submitMutex);
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _task = &task;
+    _count = count;
+    _next = 0;
+    _active = _workers.size();
+    _error = nullptr;
+    _generation++;
+  }
+  _wakeWorkers.notify_all();
+
+  insideParallelRegion() = true;
+  runTasks();
+  insideParallelRegion() = false;
+
+  std::unique_lock<std::mutex> lock(_mutex);
+  _jobDone.wait(lock, [this] { return _active == 0; });
+  _task = nullptr;
+  if (_error) {
+    std::exception_ptr error = _error;
+    _error = nullptr;
+    std::rethrow_exception(error);
+  }
+}
+
+void ThreadPool::start(unsigned int threads) {
+  _stop = false;
+  for (unsigned int i = 1; i < threads; i++) {
+    _workers.emplace_back(&ThreadPool::workerLoop, this, _generation);
+  }
+  _size.store(threads);
+}
+
+void ThreadPool::stop() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _stop = true;
+  }
+  _wakeWorkers.notify_all();
+  _size.store(1);
+  for (std::thread &worker : _workers) {
+    worker.join();
+  }
+  _workers.clear();
+}
+
+void ThreadPool::workerLoop(std::size_t seenGeneration) {
+  insideParallelRegion() = true;
+  std::unique_lock<std::mutex> lock(_mutex);
+  while (true) {
+    _wakeWorkers.wait(lock, [this, seenGeneration] {
+      return _stop || _generation != seenGeneration;
+    });
+    if (_stop) {
+      return;
+    }
+    seenGeneration = _generation;
+    lock.unlock();
+    runTasks();
+    lock.lock();
+    if (--_active == 0) {
+      _jobDone.notify_all();
+    }
+  }
+}
+
+void ThreadPool::runTasks() {
+  while (true) {
+    std::size_t index;
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (_next >= _count || _error) {
+        return;
+      }
+      index = _next++;
+    }
+    try {
+      (*_task)(index);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      if (!_error) {
+        _error = std::current_exception();
+      }
+    }
+  }
+}
+
+void setNumThreads(unsigned int threads) {
+  ThreadPool::instance().resize(threads);
+}
+
+unsigned int getNumThreads() { return ThreadPool::instance().size(); }
+
+} // namespace MWP
@@ -0,0 +1,128 @@
+#include "Transpose.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+#include "Workspace.hpp"
+#include <algorithm>
+#include <complex>
+#include <utility>
+#include <vector>
+
+namespace MWP {
+
+namespace {
+
+// Runs task(band) for every band of tile rows, on the thread pool when the
+// matrix is large enough.
+template <typename Task>
+void forEachBand(std::size_t bands, std::size_t size, const Task &task) {
+  ThreadPool &pool = ThreadPool::instance();
+  if (pool.size() > 1 && bands > 1 && size >= TransposeParallelThreshold) {
+    pool.parallelFor(bands, task);
+    return;
+  }
+  for (std::size_t band = 0; band < bands; band++) {
+    task(band);
+  }
+}
+
+// Band ib of a square matrix: the diagonal tile is transposed through the
+// buffer, every tile right of it is swapped with its transposed mirror below
+// the diagonal.
+template <typename T>
+void transposeSquareBand(std::size_t n, std::size_t ib, T *A, T *buffer) {
+  constexpr std::size_t tile = TransposeBlockSize;
+  const std::size_t bi = std::min(tile, n - ib);
+  T *diagonal = A + ib * n + ib;
+  simd::transpose<T>(bi, bi, diagonal, n, buffer, tile);
+  for (std::size_t r = 0; r < bi; r++) {
+    std::copy(buffer + r * tile, buffer + r * tile + bi,
+              diagonal + r * n);
+  }
+  for (std::size_t jb = ib + tile; jb < n; jb += tile) {
+    const std::size_t bj = std::min(tile, n - jb);
+    T *upper = A + ib * n + jb;
+    T *lower = A + jb * n + ib;
+    simd::transpose<T>(bi, bj, upper, n, buffer, tile);
+    simd::transpose<T>(bj, bi, lower, n, upper, n);
+    for (std::size_t r = 0; r < bj; r++) {
+      std::copy(buffer + r * tile, buffer + r * tile + bi,
+                lower + r * n);
+    }
+  }
+}
+
+} // namespace
+
+template <typename T>
+void transpose(std::size_t rows, std::size_t columns, const T *A,
+               std::size_t lda, T *B, std::size_t ldb) {
+  constexpr std::size_t tile = TransposeBlockSize;
+  const std::size_t bands = (rows + tile - 1) / tile;
+  forEachBand(bands, rows * columns, [&](std::size_t band) {
+    const std::size_t i0 = band * tile;
+    const std::size_t bi = std::min(tile, rows - i0);
+    for (std::size_t j0 = 0; j0 < columns; j0 += tile) {
+      simd::transpose<T>(bi, std::min(tile, columns - j0), A + i0 * lda + j0,
+                         lda, B + j0 * ldb + i0, ldb);
+    }
+  });
+}
+
+template <typename T>
+void transposeInPlace(std::size_t rows, std::size_t columns, T *A) {
+  if (rows == columns) {
+    constexpr std::size_t tile = TransposeBlockSize;
+    const std::size_t bands = (rows + tile - 1) / tile;
+    forEachBand(bands, rows * columns, [&](std::size_t band) {
+      WorkspaceScope scope;
+      T *buffer = scope.allocate<T>(tile * tile);
+      transposeSquareBand(rows, band * tile, A, buffer);
+    });
+    return;
+  }
+  if (rows <= 1 || columns <= 1) {
+    // Row and column vectors share the same layout.
+    return;
+  }
+  // The element at position p, other than the first and the last, moves to
+  // p * rows mod (size - 1).
+  const std::size_t last = rows * columns - 1;
+  std::vector<bool> visited(last + 1, false);
+  for (std::size_t start = 1; start < last; start++) {
+    if (visited[start]) {
+      continue;
+    }
+    T carried = A[start];
+    std::size_t position = start;
+    do {
+      position = position * rows % last;
+      std::swap(carried, A[position]);
+      visited[position] = true;
+    } while (position != start);
+  }
+}
+
+} // namespace MWP
+
+#ifndef MWP_HEADER_ONLY
+template void MWP::transpose<double>(std::size_t, std::size_t, const double *,
+                                     std::size_t, double *, std::size_t);
+template void MWP::transpose<float>(std::size_t, std::size_t, const float *,
+                                    std::size_t, float *, std::size_t);
+template void MWP::transpose<std::complex<double>>(
+    std::size_t, std::size_t, const std::complex<double> *, std::size_t,
+    std::complex<double> *, std::size_t);
+template void MWP::transpose<std::complex<float>>(
+    std::size_t, std::size_t, const std::complex<float> *, std::size_t,
+    std::complex<float> *, std::size_t);
+template void MWP::transpose<int>(std::size_t, std::size_t, const int *,
+                                  std::size_t, int *, std::size_t);
+template void MWP::transposeInPlace<double>(std::size_t, std::size_t,
+                                            double *);
+template void MWP::transposeInPlace<float>(std::size_t, std::size_t, float *);
+template void MWP::transposeInPlace<std::complex<double>>(
+    std::size_t, std::size_t, std::complex<double> *);
+template void MWP::transposeInPlace<std::complex<float>>(
+    std::size_t, std::size_t, std::complex<float> *);
+template void MWP::transposeInPlace<int>(std::size_t, std::size_t, int *);
+#endif
@@ -0,0 +1,99 @@
+#include "Trsm.hpp"
+#include "Gemm.hpp"
+#include "Simd.hpp"
+#include <algorithm>
+
+namespace {
+
+// Element (i, p) of op(A).
+template <typename T>
+T elementAt(const T *A, std::size_t lda, bool transA, std::size_t i,
+            std::size_t p) {
+  return transA ? A[p * lda + i] : A[i * lda + p];
+}
+
+// Substitution on the diagonal block op(A)[k0:k1, k0:k1], all right-hand
+// sides at once: every step is an axpy over a row of B.
+template <typename T>
+void solveDiagonalBlock(bool forward, bool transA, bool unitDiagonal,
+                        std::size_t k0, std::size_t k1, std::size_t nrhs,
+                        const T *A, std::size_t lda, T *B, std::size_t ldb) {
+  for (std::size_t step = 0; step < k1 - k0; step++) {
+    const std::size_t i = forward ? k0 + step : k1 - 1 - step;
+    T *row = B + i * ldb;
+    if (forward) {
+      for (std::size_t p = k0; p < i; p++) {
+        MWP::simd::axpy<T>(nrhs, -elementAt(A, lda, transA, i, p),
+                           B + p * ldb, row);
+      }
+    } else {
+      for (std::size_t p = i + 1; p < k1; p++) {
+        MWP::simd::axpy<T>(nrhs, -elementAt(A, lda, transA, i, p),
+                           B + p * ldb, row);
+      }
+    }
+    if (!unitDiagonal) {
+      const T diagonal = A[i * lda + i];
+      for (std::size_t j = 0; j < nrhs; j++) {
+        row[j] /= diagonal;
+      }
+    }
+  }
+}
+
+} // namespace
+
+template <typename T>
+void MWP::trsm(bool lower, bool transA, bool unitDiagonal, std::size_t n,
+               std::size_t nrhs, const T *A, std::size_t lda, T *B,
+               std::size_t ldb) {
+  if (n == 0 || nrhs == 0) {
+    return;
+  }
+  // op(A) is lower triangular when exactly one of lower/transA holds, which
+  // makes the solve run forward through the rows of B.
+  const bool forward = lower != transA;
+  if (forward) {
+    for (std::size_t k0 = 0; k0 < n; k0 += TrsmBlockSize) {
+      const std::size_t k1 = std::min(n, k0 + TrsmBlockSize);
+      solveDiagonalBlock(true, transA, unitDiagonal, k0, k1, nrhs, A, lda, B,
+                         ldb);
+      if (k1 < n) {
+        // B[k1:n] -= op(A)[k1:n, k0:k1] * B[k0:k1]
+        const T *block = transA ? A + k0 * lda + k1 : A + k1 * lda + k0;
+        gemm<T>(transA, false, n - k1, nrhs, k1 - k0, (T)-1, block, lda,
+                B + k0 * ldb, ldb, (T)1, B + k1 * ldb, ldb);
+      }
+    }
+  } else {
+    for (std::size_t k1 = n; k1 > 0;) {
+      const std::size_t k0 = k1 > TrsmBlockSize ? k1 - TrsmBlockSize : 0;
+      solveDiagonalBlock(false, transA, unitDiagonal, k0, k1, nrhs, A, lda, B,
+                         ldb);
+      if (k0 > 0) {
+        // B[0:k0] -= op(A)[0:k0, k0:k1] * B[k0:k1]
+        const T *block = transA ? A + k0 * lda : A + k0;
+        gemm<T>(transA, false, k0, nrhs, k1 - k0, (T)-1, block, lda,
+                B + k0 * ldb, ldb, (T)1, B, ldb);
+      }
+      k1 = k0;
+    }
+  }
+}
+
+#ifndef MWP_HEADER_ONLY
+template void MWP::trsm<double>(bool, bool, bool, std::size_t, std::size_t,
+                                const double *, std::size_t, double *,
+                                std::size_t);
+template void MWP::trsm<float>(bool, bool, bool, std::size_t, std::size_t,
+                               const float *, std::size_t, float *,
+                               std::size_t);
+template void MWP::trsm<std::complex<double>>(
+    bool, bool, bool, std::size_t, std::size_t, const std::complex<double> *,
+    std::size_t, std::complex<double> *, std::size_t);
+template void MWP::trsm<std::complex<float>>(
+    bool, bool, bool, std::size_t, std::size_t, const std::complex<float> *,
+    std::size_t, std::complex<float> *, std::size_t);
+template void MWP::trsm<int>(bool, bool, bool, std::size_t, std::size_t,
+                             const int *, std::size_t, int *, std::size_t);
+#endif
@@ -1,18 +1,27 @@
 #include "Vector.hpp"
+#include "Simd.hpp"
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
+#include <utility>
 
-using namespace MWP;
+namespace MWP {
 
 template <typename T> Vector<T>::Vector() {
   _rows = 0;
   _columns = 0;
   _size = 0;
-  _elements = std::vector<T>();
+  _elements = AlignedVector<T>();
 }
 
 template <typename T>
-Vector<T>::Vector(unsigned int rows, unsigned int columns) {
+Vector<T>::Vector(Index rows, Index columns)
+    : Vector(rows, columns, Uninitialized) {
+  std::fill(_elements.begin(), _elements.end(), (T)0);
+}
+
+template <typename T>
+Vector<T>::Vector(Index rows, Index columns, UninitializedTag) {
   if (columns == 0 || rows == 0) {
     throw std::runtime_error("The row or column attribute cannot be zero");
   }
@@ -24,16 +33,10 @@ Vector<T>::Vector(unsigned int rows, unsigned int columns) {
   this->_columns = columns;
   this->_size = rows * columns;
   _elements.resize(this->_size);
-  for (int i = 0; i < this->_rows; i++) {
-    for (int j = 0; j < this->_columns; j++) {
-      this->_elements[i * this->_columns + j] = (T)0;
-    }
-  }
 }
 
 template <typename T>
-Vector<T>::Vector(std::vector<T> elements, unsigned int rows,
-                  unsigned int columns) {
+Vector<T>::Vector(AlignedVector<T> elements, Index rows, Index columns) {
   if (columns == 0 || rows == 0) {
     throw std::runtime_error("The row or column attribute cannot be zero");
   }
@@ -48,55 +51,36 @@ Vector<T>::Vector(std::vector<T> elements, unsigned int rows,
   _rows = rows;
   _columns = columns;
   _size = rows * columns;
-  _elements = elements;
-}
-
-template <typename T> T Vector<T>::operator[](int index) const {
-  if (index < 0 || index >= this->_size) {
-    throw std::runtime_error("Index out of bounds");
-  }
-  return this->_elements[index];
+  _elements = std::move(elements);
 }
 
-template <typename T> T &Vector<T>::operator[](int index) {
-  if (index < 0 || index >= this->_size) {
-    throw std::runtime_error("Index out of bounds");
-  }
-  return this->_elements[index];
-}
+template <typename T>
+Vector<T>::Vector(const std::vector<T> &elements, Index rows, Index columns)
+    : Vector(AlignedVector<T>(elements.begin(), elements.end()), rows,
+             columns) {}
 
 template <typename T>
-Vector<T> Vector<T>::operator+(const Vector<T> &vector) const {
-  if (this->_rows != vector._rows || this->_columns != vector._columns) {
-    throw std::runtime_error(
-        "Invalid vectors dimensions for addition operation");
-  }
-  Vector<T> result(this->_elements, this->_rows, this->_columns);
-  for (int i = 0; i < this->_size; i++) {
-    result._elements[i] = this->_elements[i] + vector._elements[i];
-  }
-  return result;
+Vector<T>::Vector(std::vector<T> &&elements, Index rows, Index columns)
+    : Vector(AlignedVector<T>(elements), rows, columns) {
+  std::vector<T>().swap(elements);
 }
 
 template <typename T>
-Vector<T> Vector<T>::operator-(const Vector<T> &vector) const {
-  if (this->_rows != vector._rows || this->_columns != vector._columns) {
-    throw std::runtime_error(
-        "Invalid vectors dimensions for subtraction operation");
-  }
-  Vector<T> result(this->_elements, this->_rows, this->_columns);
-  for (int i = 0; i < this->_size; i++) {
-    result._elements[i] = this->_elements[i] - vector._elements[i];
+Vector<T>::Vector(std::initializer_list<T> elements, Index rows, Index columns)
+    : Vector(AlignedVector<T>(elements), rows, columns) {}
+
+template <typename T> T Vector<T>::operator[](Index index) const {
+  if (index >= this->_size) {
+    throw std::runtime_error("Index out of bounds");
   }
-  return result;
+  return this->_elements[index];
 }
 
-template <typename T> Vector<T> Vector<T>::operator*(T scalar) const {
-  Vector<T> result(this->_elements, this->_rows, this->_columns);
-  for (int i = 0; i < this->_size; i++) {
-    result._elements[i] = this->_elements[i] * scalar;
+template <typename T> T &Vector<T>::operator[](Index index) {
+  if (index >= this->_size) {
+    throw std::runtime_error("Index out of bounds");
   }
-  return result;
+  return this->_elements[index];
 }
 
 template <typename T>
@@ -105,12 +89,11 @@ Vector<T> Vector<T>::operator*(const Vector<T> &vector) const {
     throw std::runtime_error(
         "Invalid dimensions for vector-vector multiplication");
   }
-  Vector<T> result(this->_rows, vector._columns);
-  for (int i = 0; i < this->_rows; i++) {
-    result[i] = (T)0;
-    for (int j = 0; j < this->_columns; j++) {
-      result[i] += this->_elements[i * this->_columns + j] * vector[j];
-    }
+  Vector<T> result(this->_rows, vector._columns, Uninitialized);
+  for (Index i = 0; i < this->_rows; i++) {
+    result._elements[i] =
+        simd::dot<T>(this->_columns, this->_elements.data() + i * this->_columns,
+                     vector._elements.data());
   }
   return result;
 }
@@ -121,19 +104,35 @@ Vector<T> Vector<T>::projectedOnto(const Vector<T> &vector) {
     throw std::runtime_error(
         "Invalid vectors dimensions for projection operation");
   }
-  Vector<T> transposedVector = transposeVector(vector);
-  Vector<T> projectionVector =
-      vector * ((transposedVector * *this)[0] / (transposedVector * vector)[0]);
-  return projectionVector;
+  if (vector._rows != this->_rows) {
+    throw std::runtime_error(
+        "Invalid dimensions for vector-vector multiplication");
+  }
+  // Projection scale <v, x> / <v, v> from two dot products, with no
+  // intermediate vectors.
+  const T scale = simd::dot<T>(this->_rows, vector._elements.data(),
+                               this->_elements.data()) /
+                  simd::dot<T>(vector._size, vector._elements.data(),
+                               vector._elements.data());
+  return Vector<T>(vector * scale);
+}
+
+template <typename T> Vector<T> &Vector<T>::operator*=(T scalar) {
+  simd::scale<T>(this->_size, scalar, this->_elements.data(),
+                 this->_elements.data());
+  return *this;
 }
 
 template <typename T> double Vector<T>::norm2() const {
-  double sum = 0.0f;
-  for (T element : this->_elements) {
-    sum += std::pow(element, 2);
-  }
-  return std::sqrt(sum);
+  return std::sqrt(simd::sumSquares<T>(this->_size, this->_elements.data()));
 }
 
+} // namespace MWP
+
+#ifndef MWP_HEADER_ONLY
 template class MWP::Vector<double>;
-template class MWP::Vector<int>;
\ No newline at end of file
+template class MWP::Vector<float>;
+template class MWP::Vector<std::complex<double>>;
+template class MWP::Vector<std::complex<float>>;
+template class MWP::Vector<int>;
+#endif
@@ -0,0 +1,101 @@
+#include "Workspace.hpp"
+#include <algorithm>
+#include <new>
+
+namespace MWP {
+
+namespace {
+
+// Smallest chunk worth asking the heap for.
+constexpr std::size_t MinimumChunkSize = 64 * 1024;
+
+} // namespace
+
+Workspace::Workspace() : _chunk(0), _offset(0), _used(0), _peak(0) {}
+
+Workspace::~Workspace() { resize(0); }
+
+Workspace &Workspace::local() {
+  thread_local Workspace workspace;
+  return workspace;
+}
+
+void Workspace::reserve(std::size_t bytes) {
+  if (_used != 0 || (_chunks.size() == 1 && _chunks[0].size >= bytes)) {
+    return;
+  }
+  resize(std::max(bytes, capacity()));
+}
+
+void Workspace::release() {
+  if (_used != 0) {
+    return;
+  }
+  resize(0);
+  _peak = 0;
+}
+
+std::size_t Workspace::capacity() const {
+  std::size_t total = 0;
+  for (const Chunk &chunk : _chunks) {
+    total += chunk.size;
+  }
+  return total;
+}
+
+std::size_t Workspace::used() const { return _used; }
+
+std::size_t Workspace::peak() const { return _peak; }
+
+void *Workspace::allocate(std::size_t bytes) {
+  // Rounding every block up keeps the next one aligned.
+  bytes = std::max<std::size_t>(1, (bytes + StorageAlignment - 1) /
+                                       StorageAlignment) *
+          StorageAlignment;
+  while (_chunk < _chunks.size() && _offset + bytes > _chunks[_chunk].size) {
+    _chunk++;
+    _offset = 0;
+  }
+  if (_chunk == _chunks.size()) {
+    // Doubling the capacity keeps the number of chunks logarithmic until
+    // the next merge.
+    const std::size_t size =
+        std::max(std::max(bytes, capacity()), MinimumChunkSize);
+    _chunks.push_back(
+        {static_cast<unsigned char *>(
+             ::operator new(size, std::align_val_t(StorageAlignment))),
+         size});
+  }
+  void *block = _chunks[_chunk].data + _offset;
+  _offset += bytes;
+  _used += bytes;
+  _peak = std::max(_peak, _used);
+  return block;
+}
+
+void Workspace::rewind(std::size_t chunk, std::size_t offset,
+                       std::size_t used) {
+  _chunk = chunk;
+  _offset = offset;
+  _used = used;
+  if (used == 0 && _chunks.size() > 1) {
+    resize(_peak);
+  }
+}
+
+void Workspace::resize(std::size_t bytes) {
+  for (const Chunk &chunk : _chunks) {
+    ::operator delete(chunk.data, std::align_val_t(StorageAlignment));
+  }
+  _chunks.clear();
+  if (bytes != 0) {
+    _chunks.push_back(
+        {static_cast<unsigned char *>(
+             ::operator new(bytes, std::align_val_t(StorageAlignment))),
+         bytes});
+  }
+  _chunk = 0;
+  _offset = 0;
+}
+
+} // namespace MWP
@@ -0,0 +1,184 @@
+#include "Batched.hpp"
+#include "Cholesky.hpp"
+#include "LU.hpp"
+#include "doctest/doctest.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+MWP::MatrixD randomMatrix(unsigned int rows, unsigned int columns,
+                          unsigned int &seed) {
+  MWP::MatrixD matrix(rows, columns);
+  for (unsigned int i = 0; i < rows; i++) {
+    for (unsigned int j = 0; j < columns; j++) {
+      seed = seed * 1103515245u + 12345u;
+      matrix(i, j) = (double)((seed >> 16) % 2001) / 1000.0 - 1.0;
+    }
+  }
+  return matrix;
+}
+
+double maxDifference(const MWP::MatrixD &a, const MWP::MatrixD &b) {
+  double difference = 0.0;
+  for (std::size_t e = 0; e < a._elements.size(); e++) {
+    difference = std::max(difference, std::abs(a._elements[e] - b._elements[e]));
+  }
+  return difference;
+}
+
+} // namespace
+
+TEST_CASE("Tests the BatchedMatrix class") {
+  MWP::BatchedMatrixD batch(3, 2, 2);
+  MWP::MatrixD matrix(2, 2);
+  matrix(0, 0) = 1;
+  matrix(0, 1) = 2;
+  matrix(1, 0) = 3;
+  matrix(1, 1) = 4;
+
+  SUBCASE("Should round-trip a member") {
+    batch.set(1, matrix);
+    CHECK(batch.get(1)._elements == matrix._elements);
+    CHECK(batch(1, 1, 0) == 3);
+    CHECK(batch.get(0)._elements == MWP::MatrixD(2, 2)._elements);
+  }
+  SUBCASE("Should interleave the members") {
+    batch.set(2, matrix);
+    CHECK(batch._elements[2] == 1);
+    CHECK(batch._elements[3 + 2] == 2);
+  }
+  SUBCASE("Should reject a member of other dimensions") {
+    CHECK_THROWS_WITH_AS(batch.set(0, MWP::MatrixD(3, 2)),
+                         "Invalid matrix dimensions for the batch",
+                         std::runtime_error);
+    CHECK_THROWS_AS(batch.get(3), std::out_of_range);
+  }
+}
+
+TEST_CASE("Tests the batched kernels") {
+  // Not a multiple of the chunk size, so the last chunk is partial.
+  const std::size_t batch = 300;
+  unsigned int seed = 2024;
+
+  for (unsigned int n : {4u, 16u}) {
+    CAPTURE(n);
+    MWP::BatchedMatrixD A(batch, n, n);
+    MWP::BatchedMatrixD B(batch, n, 3);
+    std::vector<MWP::MatrixD> as;
+    std::vector<MWP::MatrixD> bs;
+    for (std::size_t b = 0; b < batch; b++) {
+      as.push_back(randomMatrix(n, n, seed));
+      bs.push_back(randomMatrix(n, 3, seed));
+      A.set(b, as.back());
+      B.set(b, bs.back());
+    }
+
+    SUBCASE("Should multiply every member") {
+      MWP::BatchedMatrixD C(batch, n, 3);
+      for (std::size_t b = 0; b < batch; b++) {
+        C.set(b, bs[b]);
+      }
+      MWP::batchedGemm(2.0, A, B, 0.5, C);
+      for (std::size_t b = 0; b < batch; b += 17) {
+        MWP::MatrixD expected = as[b] * bs[b] * 2.0 + bs[b] * 0.5;
+        CHECK(maxDifference(C.get(b), expected) < 1e-12);
+      }
+    }
+    SUBCASE("Should solve triangular systems of every member") {
+      for (bool lower : {true, false}) {
+        // Well-conditioned triangular members.
+        MWP::BatchedMatrixD T(batch, n, n);
+        for (std::size_t b = 0; b < batch; b++) {
+          MWP::MatrixD triangular = as[b];
+          for (unsigned int i = 0; i < n; i++) {
+            for (unsigned int j = 0; j < n; j++) {
+              if (lower ? j > i : j < i) {
+                triangular(i, j) = 0;
+              }
+            }
+            triangular(i, i) += 4.0;
+          }
+          T.set(b, triangular);
+        }
+        for (bool transA : {false, true}) {
+          CAPTURE(lower);
+          CAPTURE(transA);
+          MWP::BatchedMatrixD X = B;
+          MWP::batchedTrsm(lower, transA, false, T, X);
+          for (std::size_t b = 0; b < batch; b += 23) {
+            MWP::MatrixD t = T.get(b);
+            MWP::MatrixD product =
+                (transA ? MWP::MatrixD(TransposeMatrix(t)) : t) * X.get(b);
+            CHECK(maxDifference(product, bs[b]) < 1e-10);
+          }
+        }
+      }
+    }
+    SUBCASE("Should match the LU factorization of every member") {
+      MWP::BatchedLUD lu(A);
+      MWP::BatchedMatrixD X = B;
+      lu.solveInPlace(X);
+      for (std::size_t b = 0; b < batch; b += 13) {
+        CHECK(lu.isNonsingular(b));
+        MWP::MatrixD expected = MWP::LUD(as[b]).solve(bs[b]);
+        CHECK(maxDifference(X.get(b), expected) < 1e-8);
+      }
+    }
+    SUBCASE("Should match the Cholesky factorization of every member") {
+      MWP::BatchedMatrixD S(batch, n, n);
+      std::vector<MWP::MatrixD> ss;
+      for (std::size_t b = 0; b < batch; b++) {
+        MWP::MatrixD spd = TransposeMatrix(as[b]) * as[b];
+        for (unsigned int i = 0; i < n; i++) {
+          spd(i, i) += 1.0;
+        }
+        ss.push_back(spd);
+        S.set(b, spd);
+      }
+      MWP::BatchedCholeskyD cholesky(S);
+      MWP::BatchedMatrixD X = B;
+      cholesky.solveInPlace(X);
+      for (std::size_t b = 0; b < batch; b += 11) {
+        CHECK(cholesky.isPositiveDefinite(b));
+        MWP::MatrixD expected = MWP::CholeskyD(ss[b]).solve(bs[b]);
+        CHECK(maxDifference(X.get(b), expected) < 1e-8);
+      }
+    }
+  }
+
+  SUBCASE("Should flag failing members without disturbing the others") {
+    MWP::BatchedMatrixD A(5, 3, 3);
+    for (std::size_t b = 0; b < 5; b++) {
+      MWP::MatrixD matrix = IdentityMatrix<double>(3, 3) * 2.0;
+      if (b == 3) {
+        matrix(1, 1) = 0.0;
+        matrix(2, 2) = -1.0;
+      }
+      A.set(b, matrix);
+    }
+    MWP::BatchedLUD lu(A);
+    MWP::BatchedCholeskyD cholesky(A);
+    for (std::size_t b = 0; b < 5; b++) {
+      CHECK(lu.isNonsingular(b) == (b != 3));
+      CHECK(cholesky.isPositiveDefinite(b) == (b != 3));
+    }
+    MWP::BatchedMatrixD B(5, 3, 1);
+    for (std::size_t b = 0; b < 5; b++) {
+      B(b, 0, 0) = 2.0;
+      B(b, 1, 0) = 4.0;
+      B(b, 2, 0) = 6.0;
+    }
+    lu.solveInPlace(B);
+    CHECK(B(4, 2, 0) == doctest::Approx(3.0));
+    CHECK(B(2, 1, 0) == doctest::Approx(2.0));
+  }
+  SUBCASE("Should reject mismatched batches") {
+    MWP::BatchedMatrixD A(4, 2, 2);
+    MWP::BatchedMatrixD B(5, 2, 2);
+    CHECK_THROWS_WITH_AS(MWP::batchedGemm(1.0, A, B, 0.0, B),
+                         "Incompatible batch sizes", std::runtime_error);
+    CHECK_THROWS_AS(MWP::BatchedLUD(MWP::BatchedMatrixD(2, 2, 3)),
+                    std::runtime_error);
+  }
+}
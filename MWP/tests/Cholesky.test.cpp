@@ -0,0 +1,71 @@
+#include "Cholesky.hpp"
+#include "doctest/doctest.h"
+#include <stdexcept>
+
+TEST_CASE("Tests the Cholesky class") {
+  SUBCASE("Should not factor a matrix that is not square") {
+    MWP::MatrixD matrix({1.0, 4.0}, 1, 2);
+    CHECK_THROWS_WITH_AS(
+        MWP::CholeskyD cholesky(matrix),
+        "The matrix should be square to be decomposed into Cholesky factors!",
+        std::runtime_error);
+  }
+  SUBCASE("Should factor a symmetric positive definite matrix") {
+    MWP::MatrixD matrix({4.0, 2.0, 2.0, 2.0, 5.0, 3.0, 2.0, 3.0, 6.0}, 3, 3);
+    MWP::CholeskyD cholesky(matrix);
+    CHECK(cholesky.isPositiveDefinite());
+    MWP::MatrixD lower = cholesky.lower();
+    CHECK(lower(0, 0) == 2.0);
+    CHECK(lower(1, 0) == 1.0);
+    CHECK(lower(0, 1) == 0.0);
+    MWP::MatrixD product = lower * TransposeMatrix(lower);
+    for (unsigned int i = 0; i < 9; i++) {
+      CHECK(product[i] == doctest::Approx(matrix[i]));
+    }
+    MWP::VectorD constants({8.0, 10.0, 11.0}, 3, 1);
+    MWP::VectorD variables = cholesky.solve(constants);
+    CHECK(variables[0] == doctest::Approx(1.0));
+    CHECK(variables[1] == doctest::Approx(1.0));
+    CHECK(variables[2] == doctest::Approx(1.0));
+  }
+  SUBCASE("Should factor across several blocks reading one triangle") {
+    const unsigned int n = 150;
+    MWP::MatrixD random(n, n);
+    unsigned int seed = 12345;
+    for (unsigned int i = 0; i < n * n; i++) {
+      seed = seed * 1103515245u + 12345u;
+      random[i] = (double)((seed >> 16) % 2001) / 1000.0 - 1.0;
+    }
+    MWP::MatrixD matrix = random * TransposeMatrix(random);
+    MWP::MatrixD lowerOnly(n, n);
+    for (unsigned int i = 0; i < n; i++) {
+      matrix(i, i) += (double)n;
+      for (unsigned int j = 0; j <= i; j++) {
+        lowerOnly(i, j) = matrix(i, j);
+      }
+      for (unsigned int j = i + 1; j < n; j++) {
+        lowerOnly(i, j) = -7.0;
+      }
+    }
+    MWP::CholeskyD cholesky(lowerOnly);
+    CHECK(cholesky.isPositiveDefinite());
+    CHECK(cholesky._factors(0, n - 1) == -7.0);
+    CHECK(cholesky._factors(n - 2, n - 1) == -7.0);
+    MWP::MatrixD lower = cholesky.lower();
+    MWP::MatrixD product = lower * TransposeMatrix(lower);
+    for (unsigned int i = 0; i < n; i += 7) {
+      for (unsigned int j = 0; j < n; j += 5) {
+        CHECK(product(i, j) == doctest::Approx(matrix(i, j)));
+      }
+    }
+  }
+  SUBCASE("Should report a matrix that is not positive definite") {
+    MWP::MatrixD matrix({1.0, 2.0, 2.0, 1.0}, 2, 2);
+    MWP::CholeskyD cholesky(matrix);
+    CHECK_FALSE(cholesky.isPositiveDefinite());
+    MWP::VectorD constants({1.0, 2.0}, 2, 1);
+    CHECK_THROWS_WITH_AS(cholesky.solve(constants),
+                         "The matrix is not positive definite",
+                         std::runtime_error);
+  }
+}
@@ -0,0 +1,158 @@
+#include "Gemm.hpp"
+#include "LU.hpp"
+#include "LinSys.hpp"
+#include "Matrix.hpp"
+#include "Simd.hpp"
+#include "doctest/doctest.h"
+#include <cmath>
+#include <complex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+typedef std::complex<double> Complex;
+
+std::vector<Complex> sequence(std::size_t n, double shift) {
+  std::vector<Complex> values(n);
+  for (std::size_t i = 0; i < n; i++) {
+    values[i] = Complex(std::sin((double)i + shift), std::cos(2.0 * (double)i));
+  }
+  return values;
+}
+
+bool near(Complex a, Complex b) { return std::abs(a - b) < 1e-10; }
+
+} // namespace
+
+TEST_CASE("Tests the complex SIMD kernels") {
+  // Odd lengths exercise the masked and scalar tails of every level.
+  for (std::size_t n : {0u, 1u, 3u, 7u, 16u, 37u}) {
+    std::vector<Complex> x = sequence(n, 0.0);
+    std::vector<Complex> y = sequence(n, 1.0);
+    const Complex alpha(0.5, -2.0);
+
+    Complex dot(0.0, 0.0);
+    Complex dotConjugate(0.0, 0.0);
+    for (std::size_t i = 0; i < n; i++) {
+      dot += x[i] * y[i];
+      dotConjugate += std::conj(x[i]) * y[i];
+    }
+    CHECK(near(MWP::simd::dot<Complex>(n, x.data(), y.data()), dot));
+    CHECK(near(MWP::simd::dotConjugate<Complex>(n, x.data(), y.data()),
+               dotConjugate));
+
+    std::vector<Complex> z = y;
+    MWP::simd::axpy<Complex>(n, alpha, x.data(), z.data());
+    for (std::size_t i = 0; i < n; i++) {
+      CHECK(near(z[i], y[i] + alpha * x[i]));
+    }
+    z = y;
+    MWP::simd::axpyConjugate<Complex>(n, alpha, x.data(), z.data());
+    for (std::size_t i = 0; i < n; i++) {
+      CHECK(near(z[i], y[i] + alpha * std::conj(x[i])));
+    }
+    z = y;
+    MWP::simd::multiplyAdd<Complex>(n, x.data(), x.data(), z.data());
+    for (std::size_t i = 0; i < n; i++) {
+      CHECK(near(z[i], y[i] + x[i] * x[i]));
+    }
+    CHECK(MWP::simd::sumSquares<Complex>(n, x.data()) ==
+          doctest::Approx(std::real(
+              MWP::simd::dotConjugate<Complex>(n, x.data(), x.data()))));
+  }
+}
+
+TEST_CASE("Tests the complex views") {
+  SUBCASE("Should compute the norm of strided and contiguous views") {
+    MWP::MatrixCD matrix({Complex(3.0, 4.0), Complex(1.0, 0.0),
+                          Complex(0.0, 0.0), Complex(0.0, 2.0)},
+                         2, 2);
+    CHECK(matrix.column(0).norm2() == doctest::Approx(5.0));
+    CHECK(matrix.column(1).norm2() == doctest::Approx(std::sqrt(5.0)));
+    CHECK(matrix.row(0).norm2() == doctest::Approx(std::sqrt(26.0)));
+  }
+}
+
+TEST_CASE("Tests the complex GEMM") {
+  SUBCASE("Should conjugate the transposed operand") {
+    // Large enough to use the packed, blocked path.
+    const std::size_t m = 67, n = 45, k = 53;
+    std::vector<Complex> A = sequence(k * m, 0.0);
+    std::vector<Complex> B = sequence(k * n, 2.0);
+    std::vector<Complex> C(m * n, Complex(1.0, 1.0));
+    std::vector<Complex> expected = C;
+    const Complex alpha(1.0, 0.5);
+    const Complex beta(0.0, 1.0);
+    for (std::size_t i = 0; i < m; i++) {
+      for (std::size_t j = 0; j < n; j++) {
+        Complex sum(0.0, 0.0);
+        for (std::size_t p = 0; p < k; p++) {
+          sum += std::conj(A[p * m + i]) * B[p * n + j];
+        }
+        expected[i * n + j] = alpha * sum + beta * expected[i * n + j];
+      }
+    }
+    MWP::gemm<Complex>(MWP::Operation::ConjugateTranspose,
+                       MWP::Operation::None, m, n, k, alpha, A.data(), m,
+                       B.data(), n, beta, C.data(), n);
+    for (std::size_t i = 0; i < C.size(); i++) {
+      CHECK(near(C[i], expected[i]));
+    }
+  }
+  SUBCASE("Should compute the conjugate transposed matrix-vector product") {
+    const std::size_t m = 9, n = 5;
+    std::vector<Complex> A = sequence(m * n, 0.0);
+    std::vector<Complex> x = sequence(m, 3.0);
+    std::vector<Complex> y(n, Complex(0.0, 0.0));
+    MWP::gemv<Complex>(MWP::Operation::ConjugateTranspose, m, n,
+                       Complex(1.0, 0.0), A.data(), n, x.data(),
+                       Complex(0.0, 0.0), y.data());
+    for (std::size_t j = 0; j < n; j++) {
+      Complex sum(0.0, 0.0);
+      for (std::size_t i = 0; i < m; i++) {
+        sum += std::conj(A[i * n + j]) * x[i];
+      }
+      CHECK(near(y[j], sum));
+    }
+  }
+}
+
+TEST_CASE("Tests the complex LU") {
+  const unsigned int n = 40;
+  MWP::MatrixCD A(n, n);
+  std::vector<Complex> values = sequence(n * n, 0.5);
+  for (unsigned int i = 0; i < n; i++) {
+    for (unsigned int j = 0; j < n; j++) {
+      A(i, j) = values[i * n + j];
+    }
+    A(i, i) += Complex(0.0, (double)n);
+  }
+  std::vector<Complex> expected = sequence(n, 4.0);
+  MWP::VectorCD b(n, 1);
+  for (unsigned int i = 0; i < n; i++) {
+    Complex sum(0.0, 0.0);
+    for (unsigned int j = 0; j < n; j++) {
+      sum += A(i, j) * expected[j];
+    }
+    b._elements[i] = sum;
+  }
+  MWP::LUCD lu(A);
+  CHECK(lu.isNonsingular());
+  MWP::VectorCD x = lu.solve(b);
+  for (unsigned int i = 0; i < n; i++) {
+    CHECK(near(x._elements[i], expected[i]));
+  }
+  CHECK_THROWS_AS(A.det(), std::runtime_error);
+}
+
+TEST_CASE("Tests the single precision linear system") {
+  MWP::MatrixF A(3, 3);
+  A._elements = {4.0f, 1.0f, 2.0f, 1.0f, 5.0f, 1.0f, 2.0f, 0.0f, 6.0f};
+  MWP::VectorF b(std::vector<float>{7.0f, 7.0f, 8.0f}, 3, 1);
+  MWP::LinSysF linearSystem(A, b);
+  linearSystem.solve();
+  for (float value : linearSystem.variables._elements) {
+    CHECK(value == doctest::Approx(1.0f));
+  }
+}
@@ -0,0 +1,78 @@
+#include "FixedMatrix.hpp"
+#include "doctest/doctest.h"
+#include <stdexcept>
+
+namespace {
+
+constexpr MWP::Matrix2D rotation(0.0, -1.0, 1.0, 0.0);
+static_assert(rotation * rotation.transposed() == MWP::Matrix2D::identity(),
+              "Products are evaluated at compile time");
+static_assert(MWP::Matrix3D(2.0, 0.0, 0.0, 0.0, 3.0, 0.0, 0.0, 0.0, 4.0)
+                      .det() == 24.0,
+              "Determinants are evaluated at compile time");
+static_assert(MWP::Matrix2D(4.0, 7.0, 2.0, 6.0).inverse()(0, 0) == 0.6,
+              "Inverses are evaluated at compile time");
+static_assert(sizeof(MWP::Matrix4D) == 16 * sizeof(double),
+              "Fixed matrices store nothing but their elements");
+
+} // namespace
+
+TEST_CASE("Tests the FixedMatrix class") {
+  SUBCASE("Should multiply matrices of compatible dimensions") {
+    MWP::FixedMatrix<double, 2, 3> left(1.0, 2.0, 3.0, 4.0, 5.0, 6.0);
+    MWP::FixedMatrix<double, 3, 2> right(7.0, 8.0, 9.0, 10.0, 11.0, 12.0);
+    MWP::Matrix2D product = left * right;
+    CHECK(product == MWP::Matrix2D(58.0, 64.0, 139.0, 154.0));
+    MWP::Vector3D column(1.0, 0.0, -1.0);
+    MWP::FixedVector<double, 2> image = left * column;
+    CHECK(image[0] == -2.0);
+    CHECK(image[1] == -2.0);
+  }
+  SUBCASE("Should add, subtract and scale") {
+    MWP::Matrix2D matrix(1.0, 2.0, 3.0, 4.0);
+    MWP::Matrix2D sum = matrix + matrix;
+    CHECK(sum == matrix * 2.0);
+    CHECK(sum - matrix == matrix);
+    matrix += matrix;
+    matrix *= 0.5;
+    matrix -= MWP::Matrix2D::identity();
+    CHECK(matrix == MWP::Matrix2D(0.0, 2.0, 3.0, 3.0));
+    CHECK(2.0 * matrix == matrix + matrix);
+  }
+  SUBCASE("Should invert matrices up to 4x4 in closed form") {
+    MWP::Matrix4D matrix(4.0, 1.0, 0.0, 2.0, 1.0, 5.0, 1.0, 0.0, 0.0, 1.0,
+                         6.0, 1.0, 2.0, 0.0, 1.0, 7.0);
+    MWP::Matrix4D product = matrix * matrix.inverse();
+    for (std::size_t i = 0; i < 4; i++) {
+      for (std::size_t j = 0; j < 4; j++) {
+        CHECK(product(i, j) ==
+              doctest::Approx(i == j ? 1.0 : 0.0).epsilon(1e-12));
+      }
+    }
+    CHECK(matrix.det() == doctest::Approx(MWP::MatrixD(matrix).det()));
+    MWP::Matrix3D singular(1.0, 2.0, 3.0, 2.0, 4.0, 6.0, 1.0, 1.0, 1.0);
+    CHECK_THROWS_WITH_AS(singular.inverse(), "The matrix is singular",
+                         std::runtime_error);
+  }
+  SUBCASE("Should fall back to LU beyond 4x4") {
+    MWP::FixedMatrix<double, 5, 5> matrix =
+        MWP::FixedMatrix<double, 5, 5>::identity() * 2.0;
+    matrix(0, 4) = 1.0;
+    CHECK(matrix.det() == doctest::Approx(32.0));
+    MWP::FixedMatrix<double, 5, 5> product = matrix * matrix.inverse();
+    CHECK(product(0, 4) == doctest::Approx(0.0));
+    CHECK(product(4, 4) == doctest::Approx(1.0));
+  }
+  SUBCASE("Should convert to and from dynamic matrices") {
+    MWP::MatrixD dynamic({1.0, 2.0, 3.0, 4.0, 5.0, 6.0}, 2, 3);
+    MWP::FixedMatrix<double, 2, 3> fixed(dynamic);
+    CHECK(fixed(1, 2) == 6.0);
+    MWP::MatrixD back(fixed);
+    CHECK(back._rows == 2);
+    CHECK(back._columns == 3);
+    CHECK(back(1, 0) == 4.0);
+    CHECK_THROWS_WITH_AS((MWP::FixedMatrix<double, 3, 2>(dynamic)),
+                         "Invalid matrix dimensions for conversion",
+                         std::runtime_error);
+  }
+}
@@ -0,0 +1,33 @@
+#include "MWP.hpp"
+#include "doctest/doctest.h"
+#include <atomic>
+
+// Defined in HeaderOnlySecondUnit.cpp.
+void nestedParallelLoop(MWP::ThreadPool &pool,
+                        std::atomic<unsigned int> &count);
+
+TEST_CASE("Tests the header-only build with a custom element type") {
+  // long double is not instantiated by the compiled library.
+  typedef long double Real;
+  MWP::Matrix<Real> A(3, 3);
+  A._elements = {2.0L, 1.0L, 0.0L, 1.0L, 3.0L, 1.0L, 0.0L, 1.0L, 4.0L};
+  MWP::Vector<Real> b(std::vector<Real>{3.0L, 5.0L, 5.0L}, 3, 1);
+  MWP::LinSys<Real> linearSystem(A, b);
+  linearSystem.solve();
+  for (Real value : linearSystem.variables._elements) {
+    CHECK((double)value == doctest::Approx(1.0));
+  }
+  MWP::Vector<Real> x = MWP::LU<Real>(A).solve(b);
+  CHECK((double)x._elements[2] == doctest::Approx(1.0));
+}
+
+TEST_CASE("Tests nested parallel loops across translation units") {
+  // The nested loops run on the worker threads from another unit, which
+  // must see them as inside the parallel region and run serially.
+  MWP::ThreadPool pool(4);
+  std::atomic<unsigned int> count(0);
+  pool.parallelFor(16, [&pool, &count](std::size_t) {
+    nestedParallelLoop(pool, count);
+  });
+  CHECK(count == 64);
+}
@@ -0,0 +1,9 @@
+// Second translation unit of HeaderOnly.test. Including MWP.hpp in two units
+// checks that state used by the inline library code is shared between them.
+#include "MWP.hpp"
+#include <atomic>
+
+void nestedParallelLoop(MWP::ThreadPool &pool,
+                        std::atomic<unsigned int> &count) {
+  pool.parallelFor(4, [&count](std::size_t) { count++; });
+}
@@ -0,0 +1,154 @@
+#include "Krylov.hpp"
+#include "LinSys.hpp"
+#include "doctest/doctest.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// 5-point Laplacian on a side x side grid, symmetric positive definite.
+MWP::SparseMatrixD laplacian(std::size_t side) {
+  std::vector<MWP::Triplet<double>> triplets;
+  for (std::size_t i = 0; i < side; i++) {
+    for (std::size_t j = 0; j < side; j++) {
+      const std::size_t row = i * side + j;
+      triplets.push_back({row, row, 4.0});
+      if (i > 0) {
+        triplets.push_back({row, row - side, -1.0});
+      }
+      if (i + 1 < side) {
+        triplets.push_back({row, row + side, -1.0});
+      }
+      if (j > 0) {
+        triplets.push_back({row, row - 1, -1.0});
+      }
+      if (j + 1 < side) {
+        triplets.push_back({row, row + 1, -1.0});
+      }
+    }
+  }
+  return MWP::SparseMatrixD(side * side, side * side, triplets);
+}
+
+// Upwinded convection-diffusion stencil, nonsymmetric.
+MWP::SparseMatrixD convection(std::size_t n) {
+  std::vector<MWP::Triplet<double>> triplets;
+  for (std::size_t i = 0; i < n; i++) {
+    triplets.push_back({i, i, 3.0});
+    if (i > 0) {
+      triplets.push_back({i, i - 1, -2.0});
+    }
+    if (i + 1 < n) {
+      triplets.push_back({i, i + 1, -0.5});
+    }
+  }
+  return MWP::SparseMatrixD(n, n, triplets);
+}
+
+double residualNorm(const MWP::SparseMatrixD &A, const MWP::VectorD &x,
+                    const MWP::VectorD &b) {
+  MWP::VectorD r = A * x;
+  double sum = 0.0;
+  for (std::size_t i = 0; i < r._elements.size(); i++) {
+    sum += (b._elements[i] - r._elements[i]) * (b._elements[i] - r._elements[i]);
+  }
+  return std::sqrt(sum);
+}
+
+MWP::VectorD ones(std::size_t n) {
+  return MWP::VectorD(std::vector<double>(n, 1.0), n, 1);
+}
+
+} // namespace
+
+TEST_CASE("Tests the Krylov solvers") {
+  MWP::KrylovSolverD solver;
+
+  SUBCASE("Should solve a sparse SPD system with CG") {
+    MWP::SparseMatrixD A = laplacian(20);
+    MWP::VectorD b = ones(400);
+    MWP::VectorD x(400, 1);
+    MWP::IterativeResult result =
+        solver.solve(MWP::IterativeMethod::CG, A, b, x);
+    CHECK(result._converged);
+    CHECK(result._residualHistory.size() == result._iterations + 1);
+    CHECK(result._residualHistory.back() <= 1e-10 * 20.0);
+    CHECK(residualNorm(A, x, b) < 1e-8);
+  }
+  SUBCASE("Should solve nonsymmetric systems with BiCGSTAB and GMRES") {
+    MWP::SparseMatrixD A = convection(300);
+    MWP::VectorD b = ones(300);
+    for (MWP::IterativeMethod method :
+         {MWP::IterativeMethod::BiCGSTAB, MWP::IterativeMethod::GMRES}) {
+      MWP::IterativeSettings settings;
+      settings._restart = 10;
+      MWP::VectorD x(300, 1);
+      MWP::IterativeResult result = solver.solve(method, A, b, x, settings);
+      CHECK(result._converged);
+      CHECK(residualNorm(A, x, b) < 1e-8);
+    }
+  }
+  SUBCASE("Should accept a callback operator") {
+    // Three distinct eigenvalues: CG converges in three iterations.
+    MWP::LinearOperatorD diagonal(90, [](const double *x, double *y) {
+      for (std::size_t i = 0; i < 90; i++) {
+        y[i] = (double)(i % 3 + 1) * x[i];
+      }
+    });
+    MWP::VectorD b = ones(90);
+    MWP::VectorD x(90, 1);
+    MWP::IterativeResult result =
+        solver.solve(MWP::IterativeMethod::CG, diagonal, b, x);
+    CHECK(result._converged);
+    CHECK(result._iterations <= 3);
+    CHECK(x._elements[5] == doctest::Approx(1.0 / 3.0));
+  }
+  SUBCASE("Should stop at the iteration limit") {
+    MWP::SparseMatrixD A = laplacian(20);
+    MWP::VectorD b = ones(400);
+    MWP::IterativeSettings settings;
+    settings._maxIterations = 2;
+    for (MWP::IterativeMethod method :
+         {MWP::IterativeMethod::CG, MWP::IterativeMethod::BiCGSTAB,
+          MWP::IterativeMethod::GMRES}) {
+      MWP::VectorD x(400, 1);
+      MWP::IterativeResult result = solver.solve(method, A, b, x, settings);
+      CHECK_FALSE(result._converged);
+      CHECK(result._iterations == 2);
+      CHECK(result._residualHistory.front() == doctest::Approx(20.0));
+    }
+  }
+  SUBCASE("Should reuse the workspace across solves") {
+    MWP::SparseMatrixD A = laplacian(10);
+    MWP::VectorD b = ones(100);
+    MWP::VectorD x(100, 1);
+    solver.solve(MWP::IterativeMethod::GMRES, A, b, x);
+    const double *basis = solver._basis.data();
+    MWP::VectorD y(100, 1);
+    solver.solve(MWP::IterativeMethod::GMRES, A, b, y);
+    CHECK(solver._basis.data() == basis);
+  }
+  SUBCASE("Should reject mismatched dimensions") {
+    MWP::SparseMatrixD A = laplacian(3);
+    MWP::VectorD b = ones(8);
+    MWP::VectorD x(9, 1);
+    CHECK_THROWS_AS(solver.solve(MWP::IterativeMethod::CG, A, b, x),
+                    std::runtime_error);
+    CHECK_THROWS_WITH_AS(MWP::LinearOperatorD(MWP::MatrixD(2, 3)),
+                         "The linear operator should be square",
+                         std::runtime_error);
+  }
+}
+
+TEST_CASE("Tests the LinSys iterative solver") {
+  MWP::MatrixD A = laplacian(6).toDense();
+  MWP::LinSysD linearSystem(A, ones(36));
+  MWP::IterativeResult result =
+      linearSystem.solveIterative(MWP::IterativeMethod::CG);
+  CHECK(result._converged);
+  MWP::VectorD expected = linearSystem.solve(ones(36));
+  for (std::size_t i = 0; i < 36; i++) {
+    CHECK(linearSystem.variables._elements[i] ==
+          doctest::Approx(expected._elements[i]));
+  }
+}
@@ -0,0 +1,62 @@
+#include "LDLT.hpp"
+#include "doctest/doctest.h"
+#include <stdexcept>
+
+TEST_CASE("Tests the LDLT class") {
+  SUBCASE("Should not factor a matrix that is not square") {
+    MWP::MatrixD matrix({1.0, 4.0}, 1, 2);
+    CHECK_THROWS_WITH_AS(
+        MWP::LDLTD ldlt(matrix),
+        "The matrix should be square to be decomposed into LDLT factors!",
+        std::runtime_error);
+  }
+  SUBCASE("Should use a 2 x 2 pivot when the diagonal is zero") {
+    MWP::MatrixD matrix({0.0, 1.0, 2.0, 1.0, 0.0, 3.0, 2.0, 3.0, 0.0}, 3, 3);
+    MWP::LDLTD ldlt(matrix);
+    CHECK(ldlt.isNonsingular());
+    CHECK(ldlt._blockSizes[0] == 2);
+    MWP::VectorD constants({3.0, 4.0, 5.0}, 3, 1);
+    MWP::VectorD variables = ldlt.solve(constants);
+    CHECK(variables[0] == doctest::Approx(1.0));
+    CHECK(variables[1] == doctest::Approx(1.0));
+    CHECK(variables[2] == doctest::Approx(1.0));
+  }
+  SUBCASE("Should factor a symmetric indefinite matrix reading one triangle") {
+    const unsigned int n = 150;
+    const unsigned int nrhs = 3;
+    MWP::MatrixD matrix(n, n);
+    MWP::MatrixD lowerOnly(n, n);
+    unsigned int seed = 12345;
+    for (unsigned int i = 0; i < n; i++) {
+      for (unsigned int j = 0; j <= i; j++) {
+        seed = seed * 1103515245u + 12345u;
+        const double value = (double)((seed >> 16) % 2001) / 1000.0 - 1.0;
+        matrix(i, j) = value;
+        matrix(j, i) = value;
+        lowerOnly(i, j) = value;
+      }
+      for (unsigned int j = i + 1; j < n; j++) {
+        lowerOnly(i, j) = -7.0;
+      }
+    }
+    MWP::LDLTD ldlt(lowerOnly);
+    CHECK(ldlt.isNonsingular());
+    CHECK(ldlt._factors(0, n - 1) == -7.0);
+    MWP::MatrixD expected(n, nrhs);
+    for (unsigned int i = 0; i < n * nrhs; i++) {
+      expected[i] = (double)(i % 5) - 2.0;
+    }
+    MWP::MatrixD variables = ldlt.solve(matrix * expected);
+    for (unsigned int i = 0; i < n * nrhs; i++) {
+      CHECK(variables[i] == doctest::Approx(expected[i]).epsilon(1e-8));
+    }
+  }
+  SUBCASE("Should report a singular matrix") {
+    MWP::MatrixD matrix({1.0, 2.0, 2.0, 4.0}, 2, 2);
+    MWP::LDLTD ldlt(matrix);
+    CHECK_FALSE(ldlt.isNonsingular());
+    MWP::VectorD constants({1.0, 2.0}, 2, 1);
+    CHECK_THROWS_WITH_AS(ldlt.solve(constants), "The matrix is singular",
+                         std::runtime_error);
+  }
+}
@@ -0,0 +1,103 @@
+#include "LU.hpp"
+#include "doctest/doctest.h"
+#include <cmath>
+#include <stdexcept>
+
+TEST_CASE("Tests the LU class") {
+  SUBCASE("Should not factor a matrix that is not square") {
+    MWP::MatrixD matrix({1.0, 4.0}, 1, 2);
+    CHECK_THROWS_WITH_AS(
+        MWP::LUD lu(matrix),
+        "The matrix should be square to be decomposed into LU matrices!",
+        std::runtime_error);
+  }
+  SUBCASE("Should factor a matrix with partial pivoting") {
+    MWP::MatrixD matrix({1.0, 4.0, -3.0, -2.0, 8.0, 5.0, 3.0, 4.0, 7.0}, 3, 3);
+    MWP::LUD lu(matrix);
+    CHECK(lu.isNonsingular());
+    std::vector<std::size_t> permutation = lu.permutation();
+    CHECK(permutation[0] == 2);
+    MWP::MatrixD lower = lu.lower();
+    MWP::MatrixD upper = lu.upper();
+    CHECK(lower(0, 0) == 1.0);
+    CHECK(lower(0, 1) == 0.0);
+    CHECK(upper(1, 0) == 0.0);
+    CHECK(upper(0, 0) == 3.0);
+    MWP::MatrixD product = lower * upper;
+    for (unsigned int i = 0; i < 3; i++) {
+      for (unsigned int j = 0; j < 3; j++) {
+        CHECK(product(i, j) ==
+              doctest::Approx(matrix((unsigned int)permutation[i], j)));
+      }
+    }
+  }
+  SUBCASE("Should factor across several blocks and solve") {
+    const unsigned int n = 150;
+    MWP::MatrixD matrix(n, n);
+    MWP::VectorD expected(n, 1);
+    unsigned int seed = 12345;
+    for (unsigned int i = 0; i < n; i++) {
+      for (unsigned int j = 0; j < n; j++) {
+        seed = seed * 1103515245u + 12345u;
+        matrix(i, j) = (double)((seed >> 16) % 2001) / 1000.0 - 1.0;
+      }
+      expected[i] = (double)(i % 7) - 3.0;
+    }
+    MWP::VectorD constants = matrix * expected;
+    MWP::LUD lu(matrix);
+    CHECK(lu.isNonsingular());
+    MWP::VectorD variables = lu.solve(constants);
+    for (unsigned int i = 0; i < n; i++) {
+      CHECK(variables[i] == doctest::Approx(expected[i]).epsilon(1e-8));
+    }
+    std::vector<std::size_t> permutation = lu.permutation();
+    MWP::MatrixD product = lu.lower() * lu.upper();
+    for (unsigned int i = 0; i < n; i += 13) {
+      for (unsigned int j = 0; j < n; j += 7) {
+        CHECK(product(i, j) ==
+              doctest::Approx(matrix((unsigned int)permutation[i], j)));
+      }
+    }
+  }
+  SUBCASE("Should invert a matrix across several blocks") {
+    const unsigned int n = 150;
+    MWP::MatrixD matrix(n, n);
+    unsigned int seed = 54321;
+    for (unsigned int i = 0; i < n * n; i++) {
+      seed = seed * 1103515245u + 12345u;
+      matrix[i] = (double)((seed >> 16) % 2001) / 1000.0 - 1.0;
+    }
+    MWP::MatrixD inverse = matrix.inverse();
+    MWP::MatrixD product = matrix * inverse;
+    for (unsigned int i = 0; i < n; i += 7) {
+      for (unsigned int j = 0; j < n; j += 3) {
+        CHECK(product(i, j) ==
+              doctest::Approx(i == j ? 1.0 : 0.0).epsilon(1e-9));
+      }
+    }
+    MWP::LUD lu(matrix);
+    int sign = 0;
+    const double logDeterminant = lu.logDeterminant(sign);
+    CHECK(sign * std::exp(logDeterminant) ==
+          doctest::Approx(lu.determinant()));
+    CHECK(matrix.det() == doctest::Approx(lu.determinant()));
+  }
+  SUBCASE("Should not solve in place a view with a different row count") {
+    MWP::MatrixD matrix({1.0, 4.0, -3.0, -2.0, 8.0, 5.0, 3.0, 4.0, 7.0}, 3, 3);
+    MWP::LUD lu(matrix);
+    MWP::MatrixD constants(4, 2);
+    CHECK_THROWS_WITH_AS(lu.solveInPlace(constants.view(0, 2, 0, 2)),
+                         "Incompatible dimension of coefficient matrix with "
+                         "the constants matrix",
+                         std::runtime_error);
+    CHECK_NOTHROW(lu.solveInPlace(constants.view(1, 4, 0, 2)));
+  }
+  SUBCASE("Should report a singular matrix") {
+    MWP::MatrixD matrix({1.0, 2.0, 2.0, 4.0}, 2, 2);
+    MWP::LUD lu(matrix);
+    CHECK_FALSE(lu.isNonsingular());
+    MWP::VectorD constants({1.0, 2.0}, 2, 1);
+    CHECK_THROWS_WITH_AS(lu.solve(constants), "The matrix is singular",
+                         std::runtime_error);
+  }
+}
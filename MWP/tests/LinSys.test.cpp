@@ -97,4 +97,209 @@ TEST_CASE("Tests the LinSys class") {
     CHECK(linearSystem.variables[2] == 2.0f);
     CHECK(linearSystem.variables[3] == 4.0f);
   }
-}
\ No newline at end of file
+}
+
+TEST_CASE("Tests the LinSys general solver") {
+  SUBCASE("Should solve a linear system choosing the method by structure") {
+    SUBCASE("Should use LU for a general square system") {
+      MWP::MatrixD coefficientMatrix({1.0f, 4.0f, -3.0f, -2.0f, 8.0f, 5.0f,
+                                      3.0f, 4.0f, 7.0f},
+                                     3, 3);
+      MWP::VectorD constantVector({-5.0f, 52.0f, 57.0f}, 3, 1);
+      MWP::LinSysD linearSystem(coefficientMatrix, constantVector);
+      CHECK(linearSystem.method() == MWP::SolverMethod::None);
+      linearSystem.solve();
+      CHECK(linearSystem.method() == MWP::SolverMethod::LU);
+      CHECK(linearSystem.variables[0] == doctest::Approx(1.0));
+      CHECK(linearSystem.variables[1] == doctest::Approx(3.0));
+      CHECK(linearSystem.variables[2] == doctest::Approx(6.0));
+      SUBCASE("Should reuse the factorization for new constants") {
+        MWP::VectorD newConstants({2.0f, -3.0f, -10.0f}, 3, 1);
+        const double *storage = linearSystem.variables._elements.data();
+        MWP::VectorD variables = linearSystem.solve(newConstants);
+        // The solution is written into the storage of the previous one.
+        CHECK(linearSystem.variables._elements.data() == storage);
+        CHECK(linearSystem.method() == MWP::SolverMethod::LU);
+        CHECK(variables[0] == doctest::Approx(-1.0));
+        CHECK(variables[1] == doctest::Approx(0.0));
+        CHECK(variables[2] == doctest::Approx(-1.0).epsilon(1e-12));
+        CHECK(linearSystem.variables[0] == doctest::Approx(-1.0));
+      }
+    }
+    SUBCASE("Should use Cholesky for a symmetric positive definite system") {
+      MWP::MatrixD coefficientMatrix({4.0f, 2.0f, 2.0f, 2.0f, 5.0f, 3.0f, 2.0f,
+                                      3.0f, 6.0f},
+                                     3, 3);
+      MWP::VectorD constantVector({8.0f, 10.0f, 11.0f}, 3, 1);
+      MWP::LinSysD linearSystem(coefficientMatrix, constantVector);
+      linearSystem.solve();
+      CHECK(linearSystem.method() == MWP::SolverMethod::Cholesky);
+      CHECK(linearSystem.variables[0] == doctest::Approx(1.0));
+      CHECK(linearSystem.variables[1] == doctest::Approx(1.0));
+      CHECK(linearSystem.variables[2] == doctest::Approx(1.0));
+    }
+    SUBCASE("Should fall back to LDLT for a symmetric indefinite system") {
+      MWP::MatrixD coefficientMatrix({1.0f, 2.0f, 2.0f, 1.0f}, 2, 2);
+      MWP::VectorD constantVector({3.0f, 3.0f}, 2, 1);
+      MWP::LinSysD linearSystem(coefficientMatrix, constantVector);
+      linearSystem.solve();
+      CHECK(linearSystem.method() == MWP::SolverMethod::LDLT);
+      CHECK(linearSystem.variables[0] == doctest::Approx(1.0));
+      CHECK(linearSystem.variables[1] == doctest::Approx(1.0));
+    }
+    SUBCASE("Should solve triangular systems by substitution") {
+      MWP::MatrixD coefficientMatrix({2.0f, 0.0f, 3.0f, 5.0f}, 2, 2);
+      MWP::VectorD constantVector({4.0f, 1.0f}, 2, 1);
+      MWP::LinSysD linearSystem(coefficientMatrix, constantVector);
+      linearSystem.solve();
+      CHECK(linearSystem.method() == MWP::SolverMethod::LowerTriangular);
+      CHECK(linearSystem.variables[0] == 2.0f);
+      CHECK(linearSystem.variables[1] == -1.0f);
+      SUBCASE("Should reuse the structure for new constants") {
+        MWP::VectorD variables =
+            linearSystem.solve(MWP::VectorD({2.0, 8.0}, 2, 1));
+        CHECK(linearSystem.method() == MWP::SolverMethod::LowerTriangular);
+        CHECK(variables[0] == 1.0);
+        CHECK(variables[1] == 1.0);
+      }
+      SUBCASE("Should solve an upper triangular system from the cache") {
+        MWP::MatrixD upperMatrix({2.0, 3.0, 0.0, 5.0}, 2, 2);
+        MWP::LinSysD upperSystem(upperMatrix, MWP::VectorD({5.0, 5.0}, 2, 1));
+        upperSystem.solve();
+        CHECK(upperSystem.method() == MWP::SolverMethod::UpperTriangular);
+        MWP::VectorD variables =
+            upperSystem.solve(MWP::VectorD({7.0, 10.0}, 2, 1));
+        CHECK(variables[0] == 0.5);
+        CHECK(variables[1] == 2.0);
+      }
+    }
+    SUBCASE("Should not take a tiny-scaled matrix for a triangular one") {
+      MWP::MatrixD coefficientMatrix({2.0, 1.0, 0.0, 0.5, 3.0, 0.0, 0.0, 0.0,
+                                      4.0},
+                                     3, 3);
+      coefficientMatrix *= 1e-12;
+      MWP::VectorD constantVector({3e-12, 3.5e-12, 4e-12}, 3, 1);
+      MWP::LinSysD linearSystem(coefficientMatrix, constantVector);
+      linearSystem.solve();
+      CHECK(linearSystem.method() == MWP::SolverMethod::LU);
+      CHECK(linearSystem.variables[0] == doctest::Approx(1.0));
+      CHECK(linearSystem.variables[1] == doctest::Approx(1.0));
+      CHECK(linearSystem.variables[2] == doctest::Approx(1.0));
+    }
+    SUBCASE("Should solve overdetermined systems in the least-squares sense") {
+      MWP::MatrixD coefficientMatrix({1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 2.0f}, 3,
+                                     2);
+      MWP::VectorD constantVector({6.0f, 0.0f, 0.0f}, 3, 1);
+      MWP::LinSysD linearSystem(coefficientMatrix, constantVector);
+      linearSystem.solve();
+      CHECK(linearSystem.method() == MWP::SolverMethod::QR);
+      CHECK(linearSystem.variables._rows == 2);
+      CHECK(linearSystem.variables[0] == doctest::Approx(5.0));
+      CHECK(linearSystem.variables[1] == doctest::Approx(-3.0));
+      MWP::MatrixD constants({6.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f}, 3, 2);
+      MWP::MatrixD variables = linearSystem.solve(constants);
+      CHECK(variables._rows == 2);
+      CHECK(variables(0, 0) == doctest::Approx(5.0));
+      CHECK(variables(1, 0) == doctest::Approx(-3.0));
+      CHECK(variables(0, 1) == doctest::Approx(1.0));
+      CHECK(variables(1, 1) == doctest::Approx(0.0).epsilon(1e-12));
+    }
+    SUBCASE("Should not solve a singular system") {
+      MWP::MatrixD coefficientMatrix({1.0f, 2.0f, 3.0f, 2.0f, 4.0f, 6.0f, 1.0f,
+                                      1.0f, 1.0f},
+                                     3, 3);
+      MWP::VectorD constantVector({1.0f, 2.0f, 3.0f}, 3, 1);
+      MWP::LinSysD linearSystem(coefficientMatrix, constantVector);
+      CHECK_THROWS_WITH_AS(linearSystem.solve(), "The matrix is singular",
+                           std::runtime_error);
+    }
+    SUBCASE("Should not solve an integer system") {
+      MWP::MatrixI coefficientMatrix({2, 1, 1, 3}, 2, 2);
+      MWP::VectorI constantVector({3, 4}, 2, 1);
+      MWP::LinSysI linearSystem(coefficientMatrix, constantVector);
+      CHECK_THROWS_WITH_AS(
+          linearSystem.solve(),
+          "Linear systems are only solved for floating-point matrices",
+          std::runtime_error);
+      CHECK_THROWS_WITH_AS(
+          linearSystem.factor(),
+          "Linear systems are only solved for floating-point matrices",
+          std::runtime_error);
+    }
+  }
+  SUBCASE("Should solve several right-hand sides at once") {
+    const unsigned int n = 150;
+    const unsigned int nrhs = 9;
+    MWP::MatrixD random(n, n);
+    MWP::MatrixD expected(n, nrhs);
+    unsigned int seed = 2024;
+    for (unsigned int i = 0; i < n * n; i++) {
+      seed = seed * 1103515245u + 12345u;
+      random[i] = (double)((seed >> 16) % 2001) / 1000.0 - 1.0;
+    }
+    for (unsigned int i = 0; i < n * nrhs; i++) {
+      expected[i] = (double)(i % 11) - 5.0;
+    }
+    SUBCASE("Should not solve with an incompatible constants matrix") {
+      MWP::VectorD constantVector(n, 1);
+      MWP::LinSysD linearSystem(random, constantVector);
+      MWP::MatrixD constants(n + 1, nrhs);
+      CHECK_THROWS_WITH_AS(linearSystem.solve(constants),
+                           "Incompatible dimension of coefficient matrix with "
+                           "the constants matrix",
+                           std::runtime_error);
+    }
+    SUBCASE("Should solve with LU") {
+      MWP::VectorD constantVector(n, 1);
+      MWP::LinSysD linearSystem(random, constantVector);
+      MWP::MatrixD constants = random * expected;
+      MWP::MatrixD variables = linearSystem.solve(constants);
+      CHECK(linearSystem.method() == MWP::SolverMethod::LU);
+      for (unsigned int i = 0; i < n * nrhs; i++) {
+        CHECK(variables[i] == doctest::Approx(expected[i]).epsilon(1e-8));
+      }
+    }
+    SUBCASE("Should solve with Cholesky") {
+      MWP::MatrixD coefficients = random * TransposeMatrix(random);
+      for (unsigned int i = 0; i < n; i++) {
+        coefficients(i, i) += (double)n;
+      }
+      MWP::VectorD constantVector(n, 1);
+      MWP::LinSysD linearSystem(coefficients, constantVector);
+      MWP::MatrixD constants = coefficients * expected;
+      MWP::MatrixD variables = linearSystem.solve(constants);
+      CHECK(linearSystem.method() == MWP::SolverMethod::Cholesky);
+      for (unsigned int i = 0; i < n * nrhs; i++) {
+        CHECK(variables[i] == doctest::Approx(expected[i]).epsilon(1e-8));
+      }
+    }
+    SUBCASE("Should solve with LDLT") {
+      MWP::MatrixD coefficients = random + TransposeMatrix(random);
+      MWP::VectorD constantVector(n, 1);
+      MWP::LinSysD linearSystem(coefficients, constantVector);
+      MWP::MatrixD constants = coefficients * expected;
+      MWP::MatrixD variables = linearSystem.solve(constants);
+      CHECK(linearSystem.method() == MWP::SolverMethod::LDLT);
+      for (unsigned int i = 0; i < n * nrhs; i++) {
+        CHECK(variables[i] == doctest::Approx(expected[i]).epsilon(1e-8));
+      }
+    }
+    SUBCASE("Should solve upper triangular systems") {
+      MWP::MatrixD coefficients(n, n);
+      for (unsigned int i = 0; i < n; i++) {
+        for (unsigned int j = i; j < n; j++) {
+          coefficients(i, j) = random(i, j);
+        }
+        coefficients(i, i) += 4.0;
+      }
+      MWP::VectorD constantVector(n, 1);
+      MWP::LinSysD linearSystem(coefficients, constantVector);
+      MWP::MatrixD constants = coefficients * expected;
+      MWP::MatrixD variables = linearSystem.solve(constants);
+      CHECK(linearSystem.method() == MWP::SolverMethod::UpperTriangular);
+      for (unsigned int i = 0; i < n * nrhs; i++) {
+        CHECK(variables[i] == doctest::Approx(expected[i]).epsilon(1e-8));
+      }
+    }
+  }
+}
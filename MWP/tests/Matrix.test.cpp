@@ -1,9 +1,16 @@
+#include "Gemm.hpp"
 #include "Matrix.hpp"
+#include "ThreadPool.hpp"
 #include "Vector.hpp"
 #include "doctest/doctest.h"
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
+#include <thread>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -142,6 +149,37 @@ TEST_CASE("Tests the matrix class") {
     CHECK(matrixIRes(1, 0) == 6);
     CHECK(matrixIRes(2, 0) == 9);
   }
+  SUBCASE("Should update a matrix in place with compound assignments") {
+    std::vector<double> elements = {1.0, 2.0, 3.0, 4.0};
+    MWP::MatrixD moved(std::move(elements), 2, 2);
+    // The buffer of a std::vector is not aligned: the elements are copied
+    // once and the source released.
+    CHECK(elements.empty());
+    CHECK(moved._elements == std::vector<double>{1.0, 2.0, 3.0, 4.0});
+    MWP::AlignedVector<double> aligned = {1.0, 2.0, 3.0, 4.0};
+    const double *storage = aligned.data();
+    MWP::MatrixD matrixD(std::move(aligned), 2, 2);
+    CHECK(matrixD._elements.data() == storage);
+    MWP::MatrixD other({1.0, 1.0, 2.0, 2.0}, 2, 2);
+    matrixD += other * 2.0;
+    CHECK(matrixD(1, 1) == 8.0);
+    matrixD -= other;
+    CHECK(matrixD(0, 1) == 3.0);
+    matrixD *= 0.5;
+    CHECK(matrixD(1, 0) == 2.5);
+    // Products accumulate into the target, also when they read it.
+    matrixD += matrixD * other;
+    CHECK(matrixD(0, 0) == 1.0 + 1.0 + 3.0);
+    CHECK(matrixD(1, 1) == 3.0 + 2.5 + 6.0);
+    CHECK(matrixD._elements.data() == storage);
+    CHECK_THROWS_WITH_AS(matrixD += MWP::MatrixD(3, 2),
+                         "Invalid matrices dimensions for addition operation",
+                         std::runtime_error);
+    CHECK_THROWS_WITH_AS(
+        matrixD -= MWP::MatrixD(2, 3),
+        "Invalid matrices dimensions for subtraction operation",
+        std::runtime_error);
+  }
   SUBCASE("Should multiply a matrix by another matrix") {
     SUBCASE("Should not multiply a matrix by another matrix with incompatible "
             "dimensions for multiplication operation") {
@@ -159,6 +197,234 @@ TEST_CASE("Tests the matrix class") {
     CHECK(matrixDRes(0, 1) == 12.0f);
     CHECK(matrixDRes(0, 2) == 15.0f);
   }
+  SUBCASE("Should multiply large matrices with the blocked engine") {
+    const unsigned int m = 131, k = 67, n = 259;
+    MWP::MatrixD matrix1D(m, k);
+    MWP::MatrixD matrix2D(k, n);
+    for (unsigned int i = 0; i < matrix1D._size; i++) {
+      matrix1D[i] = (double)((i * 7) % 13) - 6.0;
+    }
+    for (unsigned int i = 0; i < matrix2D._size; i++) {
+      matrix2D[i] = (double)((i * 5) % 11) - 5.0;
+    }
+    MWP::MatrixD matrixDRes = matrix1D * matrix2D;
+    CHECK(matrixDRes._rows == m);
+    CHECK(matrixDRes._columns == n);
+    bool matches = true;
+    for (unsigned int i = 0; i < m; i++) {
+      for (unsigned int j = 0; j < n; j++) {
+        double expected = 0.0;
+        for (unsigned int p = 0; p < k; p++) {
+          expected += matrix1D(i, p) * matrix2D(p, j);
+        }
+        matches = matches && matrixDRes(i, j) == expected;
+      }
+    }
+    CHECK(matches);
+  }
+  SUBCASE("Should multiply transposed operands deeper than one panel") {
+    // k spans more than one KC panel in both precisions and m, n leave
+    // partial register tiles. The products stay exact in single precision.
+    const std::size_t m = 37, k = 600, n = 53;
+    auto multiply = [&](auto zero) {
+      typedef decltype(zero) Real;
+      std::vector<Real> A(k * m), B(n * k), C(m * n, (Real)1);
+      for (std::size_t i = 0; i < A.size(); i++) {
+        A[i] = (Real)((i * 7) % 13) - (Real)6;
+      }
+      for (std::size_t i = 0; i < B.size(); i++) {
+        B[i] = (Real)((i * 5) % 11) - (Real)5;
+      }
+      MWP::gemm<Real>(true, true, m, n, k, (Real)2, A.data(), m, B.data(), k,
+                      (Real)0.5, C.data(), n);
+      bool matches = true;
+      for (std::size_t i = 0; i < m; i++) {
+        for (std::size_t j = 0; j < n; j++) {
+          Real expected = (Real)0;
+          for (std::size_t p = 0; p < k; p++) {
+            expected += A[p * m + i] * B[j * k + p];
+          }
+          matches = matches && C[i * n + j] == (Real)2 * expected + (Real)0.5;
+        }
+      }
+      return matches;
+    };
+    CHECK(multiply(0.0));
+    CHECK(multiply(0.0f));
+  }
+  SUBCASE("Should multiply large matrices and vectors across the thread "
+          "pool") {
+    const unsigned int previousThreads = MWP::getNumThreads();
+    MWP::MatrixD matrix1D(203, 229);
+    MWP::MatrixD matrix2D(229, 211);
+    MWP::VectorD vectorD(229, 1);
+    for (unsigned int i = 0; i < matrix1D._size; i++) {
+      matrix1D[i] = (double)((i * 7) % 13) - 6.0;
+    }
+    for (unsigned int i = 0; i < matrix2D._size; i++) {
+      matrix2D[i] = (double)((i * 5) % 11) - 5.0;
+    }
+    for (unsigned int i = 0; i < vectorD._size; i++) {
+      vectorD[i] = (double)(i % 3) - 1.0;
+    }
+    MWP::setNumThreads(1);
+    MWP::MatrixD serialProduct = matrix1D * matrix2D;
+    MWP::VectorD serialVector = matrix1D * vectorD;
+    MWP::setNumThreads(4);
+    CHECK(MWP::getNumThreads() == 4);
+    MWP::MatrixD parallelProduct = matrix1D * matrix2D;
+    MWP::VectorD parallelVector = matrix1D * vectorD;
+    MWP::setNumThreads(previousThreads);
+    CHECK(parallelProduct._elements == serialProduct._elements);
+    CHECK(parallelVector._elements == serialVector._elements);
+    SUBCASE("Should resize the thread pool while other threads use it") {
+      MWP::ThreadPool pool(2);
+      std::atomic<bool> done(false);
+      std::atomic<unsigned int> sum(0);
+      std::thread user([&pool, &done, &sum] {
+        while (!done) {
+          pool.parallelFor(8, [&sum](std::size_t) { sum++; });
+          CHECK(pool.size() >= 1);
+        }
+      });
+      for (unsigned int threads : {4u, 1u, 3u, 2u}) {
+        pool.resize(threads);
+      }
+      done = true;
+      user.join();
+      CHECK(pool.size() == 2);
+      CHECK(sum % 8 == 0);
+    }
+  }
+  SUBCASE("Should view blocks of a matrix without copying") {
+    MWP::MatrixD matrix({1.0, 2.0, 3.0, 4.0,
+                         5.0, 6.0, 7.0, 8.0,
+                         9.0, 10.0, 11.0, 12.0}, 3, 4);
+    SUBCASE("Should not view a block out of the matrix bounds") {
+      CHECK_THROWS_WITH_AS(matrix.view(0, 4, 0, 1), "Invalid view range",
+                           std::out_of_range);
+      CHECK_THROWS_WITH_AS(matrix.view(0, 1, 3, 5), "Invalid view range",
+                           std::out_of_range);
+    }
+    MWP::MatrixView<double> block = matrix.view(1, 3, 1, 3);
+    CHECK(block.rows() == 2);
+    CHECK(block.columns() == 2);
+    CHECK(block(0, 0) == 6.0);
+    CHECK(block(1, 1) == 11.0);
+    CHECK(&block(0, 0) == &matrix(1, 1));
+
+    MWP::MatrixD sum = block + block;
+    CHECK(sum(1, 0) == 20.0);
+    MWP::MatrixD product = matrix.view(0, 1, 0, 3) * matrix.view(0, 3, 3, 4);
+    CHECK(product._rows == 1);
+    CHECK(product._columns == 1);
+    CHECK(product(0, 0) == 56.0);
+
+    SUBCASE("Should update the viewed block in place") {
+      block = block * 2.0 - matrix.view(0, 2, 0, 2);
+      CHECK(matrix(1, 1) == 11.0);
+      CHECK(matrix(1, 2) == 12.0);
+      CHECK(matrix(2, 1) == 15.0);
+      CHECK(matrix(2, 2) == 16.0);
+      CHECK(matrix(0, 0) == 1.0);
+      CHECK(matrix(2, 3) == 12.0);
+      CHECK_THROWS_WITH_AS(block = matrix.view(0, 1, 0, 2),
+                           "Invalid view dimensions for assignment",
+                           std::runtime_error);
+    }
+    SUBCASE("Should copy between overlapping blocks") {
+      matrix.view(0, 2, 1, 4) = matrix.view(1, 3, 0, 3);
+      CHECK(matrix(0, 1) == 5.0);
+      CHECK(matrix(0, 3) == 7.0);
+      CHECK(matrix(1, 1) == 9.0);
+      CHECK(matrix(1, 3) == 11.0);
+    }
+    SUBCASE("Should view rows and columns as vectors") {
+      MWP::VectorView<double> column = matrix.column(2);
+      CHECK(column.size() == 3);
+      CHECK(column[2] == 11.0);
+      CHECK(Dot(column, matrix.column(0)) == 137.0);
+      CHECK(Dot(matrix.row(0), matrix.row(1)) == 70.0);
+      column = column - matrix.column(0) * 2.0;
+      CHECK(matrix(0, 2) == 1.0);
+      CHECK(matrix(1, 2) == -3.0);
+      CHECK(matrix(2, 2) == -7.0);
+      CHECK_THROWS_WITH_AS(matrix.row(3), "Out of range row.",
+                           std::out_of_range);
+    }
+  }
+  SUBCASE("Should evaluate lazy matrix expressions") {
+    MWP::MatrixD matrix1D({1.0f, 2.0f, 3.0f, 4.0f}, 2, 2);
+    MWP::MatrixD matrix2D({5.0f, 6.0f, 7.0f, 8.0f}, 2, 2);
+    MWP::MatrixD fused = matrix1D * 2.0 + matrix2D - TransposeMatrix(matrix1D);
+    CHECK(fused(0, 0) == 6.0f);
+    CHECK(fused(0, 1) == 7.0f);
+    CHECK(fused(1, 0) == 11.0f);
+    CHECK(fused(1, 1) == 12.0f);
+    CHECK((matrix1D + matrix2D)(1, 0) == 10.0f);
+    CHECK((matrix1D * matrix2D)(0, 1) == 22.0f);
+
+    MWP::MatrixD product = TransposeMatrix(matrix1D) * matrix2D * 0.5;
+    CHECK(product(0, 0) == 13.0f);
+    CHECK(product(0, 1) == 15.0f);
+    CHECK(product(1, 0) == 19.0f);
+    CHECK(product(1, 1) == 22.0f);
+
+    MWP::MatrixD column({1.0f, 2.0f}, 2, 1);
+    MWP::MatrixD rankOne = matrix2D - column * TransposeMatrix(column);
+    CHECK(rankOne(0, 0) == 4.0f);
+    CHECK(rankOne(0, 1) == 4.0f);
+    CHECK(rankOne(1, 0) == 5.0f);
+    CHECK(rankOne(1, 1) == 4.0f);
+    MWP::MatrixD matrixVector = matrix1D * column;
+    CHECK(matrixVector(0, 0) == 5.0f);
+    CHECK(matrixVector(1, 0) == 11.0f);
+    MWP::VectorD vectorD({1.0f, 2.0f}, 2, 1);
+    MWP::VectorD transposedVector = TransposeMatrix(matrix1D) * vectorD;
+    CHECK(transposedVector[0] == 7.0f);
+    CHECK(transposedVector[1] == 10.0f);
+
+    SUBCASE("Should evaluate expressions that read the assigned matrix") {
+      MWP::MatrixD aliased = matrix1D;
+      aliased = aliased + TransposeMatrix(aliased);
+      CHECK(aliased(0, 1) == 5.0f);
+      CHECK(aliased(1, 0) == 5.0f);
+      aliased = matrix1D;
+      aliased = matrix2D + aliased * matrix1D;
+      CHECK(aliased(0, 0) == 12.0f);
+      CHECK(aliased(0, 1) == 16.0f);
+      CHECK(aliased(1, 0) == 22.0f);
+      CHECK(aliased(1, 1) == 30.0f);
+      aliased = matrix1D;
+      aliased = aliased - (aliased * 0.5) * matrix2D;
+      CHECK(aliased(0, 0) == -8.5f);
+      CHECK(aliased(1, 1) == -21.0f);
+      aliased = TransposeMatrix(column);
+      CHECK(aliased._rows == 1);
+      CHECK(aliased._columns == 2);
+      CHECK(aliased(0, 1) == 2.0f);
+    }
+    SUBCASE("Should keep the matrix API on expression results") {
+      CHECK((matrix1D + matrix2D).norm2() ==
+            doctest::Approx(MWP::MatrixD(matrix1D + matrix2D).norm2()));
+      CHECK((matrix1D - matrix2D)[0] == -4.0f);
+      CHECK((matrix1D - matrix2D)[3] == -4.0f);
+      CHECK((matrix1D * 2.0)[2] == 6.0f);
+      CHECK(TransposeMatrix(matrix1D)[1] == 3.0f);
+      CHECK_THROWS_WITH_AS((matrix1D + matrix2D)[4], "Index out of bounds",
+                           std::runtime_error);
+      auto product = matrix1D * matrix2D;
+      CHECK(product._elements[0] == 19.0f);
+      CHECK(product._elements[3] == 50.0f);
+      MWP::MatrixD transposedProduct = TransposeMatrix(matrix1D * matrix2D);
+      CHECK(transposedProduct(0, 1) == 43.0f);
+      CHECK(transposedProduct(1, 0) == 22.0f);
+      // The transpose of a temporary owns its elements.
+      auto transposedTemporary = TransposeMatrix(MWP::MatrixD(matrix2D));
+      CHECK(transposedTemporary._elements[1] == 7.0f);
+      CHECK(TransposeMatrix(matrix1D + matrix2D)(0, 1) == 10.0f);
+    }
+  }
   SUBCASE("Should transpose a matrix") {
     MWP::MatrixD matrixD({1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f}, 3, 2);
     matrixD.transpose();
@@ -368,4 +634,143 @@ TEST_CASE("Tests the matrix class") {
     
 
   }
+  SUBCASE("Should compute determinants") {
+    MWP::MatrixD m2({3.0, 8.0, 4.0, 6.0}, 2, 2);
+    CHECK(m2.det() == doctest::Approx(-14.0));
+    MWP::MatrixD m3({6.0, 1.0, 1.0, 4.0, -2.0, 5.0, 2.0, 8.0, 7.0}, 3, 3);
+    CHECK(m3.det() == doctest::Approx(-306.0));
+    MWP::MatrixD m4({1.0, 0.0, 2.0, -1.0, 3.0, 0.0, 0.0, 5.0, 2.0, 1.0, 4.0,
+                     -3.0, 1.0, 0.0, 5.0, 0.0},
+                    4, 4);
+    CHECK(m4.det() == doctest::Approx(30.0));
+    int sign = 0;
+    CHECK(m4.logDet(sign) == doctest::Approx(std::log(30.0)));
+    CHECK(sign == 1);
+    MWP::MatrixI integers({2, 1, 1, 3}, 2, 2);
+    CHECK(integers.det() == doctest::Approx(5.0));
+    MWP::MatrixD singular({1.0, 2.0, 2.0, 4.0}, 2, 2);
+    CHECK(singular.det() == 0.0);
+    CHECK(singular.logDet(sign) == -std::numeric_limits<double>::infinity());
+    CHECK(sign == 0);
+    // The determinant of the empty matrix is the empty product.
+    MWP::MatrixD empty;
+    CHECK(empty.det() == 1.0);
+    CHECK(empty.logDet(sign) == 0.0);
+    CHECK(sign == 1);
+    MWP::MatrixD rectangular(2, 3);
+    CHECK_THROWS_WITH_AS(rectangular.det(),
+                         "The matrix should be square to compute its "
+                         "determinant!",
+                         std::runtime_error);
+  }
+  SUBCASE("Should compute the determinant of a large matrix") {
+    const unsigned int n = 100;
+    MWP::MatrixD triangular(n, n);
+    for (unsigned int i = 0; i < n; i++) {
+      triangular(i, i) = (i % 2 == 0) ? 2.0 : -1.0;
+      for (unsigned int j = i + 1; j < n; j++) {
+        triangular(i, j) = 0.5;
+      }
+    }
+    // Swapping two rows flips the sign: the product is 2^50 * (-1)^50.
+    MWP::MatrixD swapped = triangular;
+    for (unsigned int j = 0; j < n; j++) {
+      std::swap(swapped(3, j), swapped(70, j));
+    }
+    CHECK(triangular.det() == doctest::Approx(std::pow(2.0, 50)));
+    CHECK(swapped.det() == doctest::Approx(-std::pow(2.0, 50)));
+    int sign = 0;
+    CHECK(swapped.logDet(sign) == doctest::Approx(50.0 * std::log(2.0)));
+    CHECK(sign == -1);
+  }
+  SUBCASE("Should compute inverses") {
+    for (unsigned int n = 1; n <= 4; n++) {
+      MWP::MatrixD matrix(n, n);
+      for (unsigned int i = 0; i < n; i++) {
+        for (unsigned int j = 0; j < n; j++) {
+          matrix(i, j) = (double)((i * 7 + j * 3) % 5) + (i == j ? 4.0 : 0.0);
+        }
+      }
+      MWP::MatrixD product = matrix * matrix.inverse();
+      for (unsigned int i = 0; i < n; i++) {
+        for (unsigned int j = 0; j < n; j++) {
+          CHECK(product(i, j) ==
+                doctest::Approx(i == j ? 1.0 : 0.0).epsilon(1e-12));
+        }
+      }
+    }
+    MWP::MatrixD singular({1.0, 2.0, 3.0, 2.0, 4.0, 6.0, 1.0, 1.0, 1.0}, 3, 3);
+    CHECK_THROWS_WITH_AS(singular.inverse(), "The matrix is singular",
+                         std::runtime_error);
+    // The inverse of [[2, 1], [1, 3]] is [[0.6, -0.2], [-0.2, 0.4]].
+    MWP::MatrixI integers({2, 1, 1, 3}, 2, 2);
+    CHECK_THROWS_WITH_AS(
+        integers.inverse(),
+        "The inverse is only available for floating-point matrices",
+        std::runtime_error);
+    MWP::MatrixI bidiagonal(5, 5);
+    for (unsigned int i = 0; i < 5; i++) {
+      bidiagonal(i, i) = 2;
+      if (i + 1 < 5) {
+        bidiagonal(i, i + 1) = 1;
+      }
+    }
+    CHECK_THROWS_WITH_AS(
+        bidiagonal.inverse(),
+        "The inverse is only available for floating-point matrices",
+        std::runtime_error);
+  }
+}
+
+TEST_CASE("Tests the matrix storage") {
+  SUBCASE("Should align the elements to a cache line") {
+    for (unsigned int n : {1u, 3u, 17u, 100u}) {
+      MWP::MatrixD matrix(n, n + 1);
+      MWP::VectorD vector(n, 1);
+      MWP::MatrixF product = MWP::MatrixF(n, n) * MWP::MatrixF(n, n);
+      CHECK(reinterpret_cast<std::uintptr_t>(matrix._elements.data()) %
+                MWP::StorageAlignment ==
+            0);
+      CHECK(reinterpret_cast<std::uintptr_t>(vector._elements.data()) %
+                MWP::StorageAlignment ==
+            0);
+      CHECK(reinterpret_cast<std::uintptr_t>(product._elements.data()) %
+                MWP::StorageAlignment ==
+            0);
+    }
+  }
+  SUBCASE("Should construct uninitialized matrices and vectors") {
+    MWP::MatrixD matrix(3, 4, MWP::Uninitialized);
+    CHECK(matrix._rows == 3);
+    CHECK(matrix._columns == 4);
+    CHECK(matrix._elements.size() == 12);
+    MWP::VectorD vector(5, 1, MWP::Uninitialized);
+    CHECK(vector._size == 5);
+    CHECK_THROWS_WITH_AS(MWP::MatrixD(0, 4, MWP::Uninitialized),
+                         "The row or column attribute cannot be zero",
+                         std::runtime_error);
+    CHECK_THROWS_WITH_AS(MWP::VectorD(2, 2, MWP::Uninitialized),
+                         "Both rows and columns cannot be different from 1",
+                         std::runtime_error);
+  }
+  SUBCASE("Should index with the configured index type") {
+    MWP::MatrixD matrix(3, 4);
+    CHECK(std::is_same<decltype(matrix._size), MWP::Index>::value);
+    CHECK(sizeof(MWP::Index) == sizeof(std::size_t));
+    const MWP::Index largest = std::numeric_limits<MWP::Index>::max();
+    CHECK_THROWS_WITH_AS(MWP::MatrixD(largest / 2 + 1, 2),
+                         "The matrix size exceeds the index type range",
+                         std::runtime_error);
+    CHECK_THROWS_WITH_AS(
+        MWP::MatrixD(MWP::AlignedVector<double>(4), largest, largest),
+        "The matrix size exceeds the index type range", std::runtime_error);
+  }
+  SUBCASE("Should keep zeroing in the sized constructors") {
+    MWP::MatrixD matrix(7, 9);
+    for (double element : matrix._elements) {
+      CHECK(element == 0.0);
+    }
+    MWP::MatrixD copied(std::vector<double>{1.0, 2.0, 3.0, 4.0}, 2, 2);
+    CHECK(copied(1, 0) == 3.0);
+  }
 }
@@ -0,0 +1,172 @@
+#include "LinSys.hpp"
+#include "MixedPrecision.hpp"
+#include "Simd.hpp"
+#include "doctest/doctest.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Diagonally dominant nonsymmetric matrix, well conditioned.
+MWP::MatrixD dominant(unsigned int n) {
+  MWP::MatrixD A(n, n);
+  for (unsigned int i = 0; i < n; i++) {
+    for (unsigned int j = 0; j < n; j++) {
+      A(i, j) = std::sin((double)(i * n + j + 1)) / 3.0;
+    }
+    A(i, i) += (double)n / 4.0;
+  }
+  return A;
+}
+
+// Hilbert matrix, cond(H_10) ~ 1.6e13: far beyond float, fine in double.
+MWP::MatrixD hilbert(unsigned int n) {
+  MWP::MatrixD H(n, n);
+  for (unsigned int i = 0; i < n; i++) {
+    for (unsigned int j = 0; j < n; j++) {
+      H(i, j) = 1.0 / (double)(i + j + 1);
+    }
+  }
+  return H;
+}
+
+MWP::VectorD product(const MWP::MatrixD &A, const std::vector<double> &x) {
+  const unsigned int n = A._rows;
+  MWP::VectorD b(n, 1);
+  for (unsigned int i = 0; i < n; i++) {
+    double sum = 0.0;
+    for (unsigned int j = 0; j < n; j++) {
+      sum += A(i, j) * x[j];
+    }
+    b._elements[i] = sum;
+  }
+  return b;
+}
+
+std::vector<double> cosines(unsigned int n) {
+  std::vector<double> x(n);
+  for (unsigned int i = 0; i < n; i++) {
+    x[i] = std::cos((double)i) + 2.0;
+  }
+  return x;
+}
+
+double maxError(const MWP::VectorD &x, const std::vector<double> &expected) {
+  double largest = 0.0;
+  for (std::size_t i = 0; i < expected.size(); i++) {
+    largest = std::max(largest, std::abs(x._elements[i] - expected[i]));
+  }
+  return largest;
+}
+
+} // namespace
+
+TEST_CASE("Tests the single precision kernels") {
+  std::vector<float> x(37);
+  std::vector<float> y(37);
+  for (std::size_t i = 0; i < x.size(); i++) {
+    x[i] = (float)i;
+    y[i] = 1.0f;
+  }
+  CHECK(MWP::simd::dot<float>(37, x.data(), y.data()) == 666.0f);
+  MWP::simd::axpy<float>(37, 2.0f, x.data(), y.data());
+  CHECK(y[36] == 73.0f);
+  CHECK(y[0] == 1.0f);
+
+  MWP::MatrixF A(3, 3);
+  A._elements = {2.0f, 1.0f, 0.0f, 1.0f, 3.0f, 1.0f, 0.0f, 1.0f, 4.0f};
+  MWP::LUF lu(A);
+  MWP::VectorF b(std::vector<float>{3.0f, 5.0f, 5.0f}, 3, 1);
+  MWP::VectorF solution = lu.solve(b);
+  for (float value : solution._elements) {
+    CHECK(value == doctest::Approx(1.0f));
+  }
+}
+
+TEST_CASE("Tests the mixed precision LU") {
+  SUBCASE("Should refine a float factorization to double accuracy") {
+    const unsigned int n = 200;
+    MWP::MatrixD A = dominant(n);
+    std::vector<double> expected = cosines(n);
+    MWP::MixedPrecisionLUD mixed(A);
+    MWP::VectorD x;
+    MWP::RefinementResult result = mixed.solve(product(A, expected), x);
+    CHECK(result._converged);
+    CHECK_FALSE(result._fallback);
+    CHECK_FALSE(mixed.usedFallback());
+    CHECK(result._iterations >= 2);
+    CHECK(result._iterations <= 5);
+    CHECK(result._residualHistory.size() == result._iterations + 1);
+    CHECK(maxError(x, expected) < 1e-12);
+  }
+  SUBCASE("Should fall back to double when the refinement stalls") {
+    const unsigned int n = 10;
+    MWP::MatrixD H = hilbert(n);
+    std::vector<double> expected(n, 1.0);
+    MWP::VectorD b = product(H, expected);
+    MWP::MixedPrecisionLUD mixed(H);
+    MWP::VectorD x;
+    MWP::RefinementResult result = mixed.solve(b, x);
+    CHECK(result._converged);
+    CHECK(result._fallback);
+    CHECK(mixed.usedFallback());
+    MWP::VectorD reference = MWP::LUD(H).solve(b);
+    CHECK(maxError(x, reference._elements) < 1e-12);
+    // The double factorization is kept for the next solves.
+    result = mixed.solve(b, x);
+    CHECK(result._fallback);
+    CHECK(result._iterations == 0);
+  }
+  SUBCASE("Should fall back when the matrix leaves the float range") {
+    MWP::MatrixD A(2, 2);
+    A._elements = {1e300, 1.0, 1.0, 1e300};
+    MWP::MixedPrecisionLUD mixed(A);
+    CHECK(mixed.usedFallback());
+    MWP::VectorD x;
+    mixed.solve(MWP::VectorD(std::vector<double>{1e300, 1e300}, 2, 1), x);
+    CHECK(x._elements[0] == doctest::Approx(1.0));
+  }
+  SUBCASE("Should solve several right-hand sides") {
+    const unsigned int n = 50;
+    MWP::MatrixD A = dominant(n);
+    MWP::MatrixD B(n, 2);
+    for (unsigned int i = 0; i < n; i++) {
+      B(i, 0) = 1.0;
+      B(i, 1) = (double)i;
+    }
+    MWP::MatrixD X = MWP::MixedPrecisionLUD(A).solve(B);
+    MWP::MatrixD expected = MWP::LUD(A).solve(B);
+    for (std::size_t i = 0; i < X._elements.size(); i++) {
+      CHECK(X._elements[i] == doctest::Approx(expected._elements[i]).epsilon(1e-12));
+    }
+  }
+  SUBCASE("Should reject singular and non-square matrices") {
+    MWP::MatrixD singular(2, 2);
+    singular._elements = {1.0, 2.0, 2.0, 4.0};
+    MWP::MixedPrecisionLUD mixed(singular);
+    CHECK_FALSE(mixed.isNonsingular());
+    MWP::VectorD x;
+    CHECK_THROWS_WITH_AS(
+        mixed.solve(MWP::VectorD(std::vector<double>{1.0, 1.0}, 2, 1), x),
+        "The matrix is singular", std::runtime_error);
+    CHECK_THROWS_AS(MWP::MixedPrecisionLUD(MWP::MatrixD(2, 3)),
+                    std::runtime_error);
+  }
+}
+
+TEST_CASE("Tests the LinSys mixed precision mode") {
+  const unsigned int n = 100;
+  MWP::MatrixD A = dominant(n);
+  std::vector<double> expected = cosines(n);
+  MWP::LinSysD linearSystem(A, product(A, expected));
+  linearSystem.setMixedPrecision(true);
+  linearSystem.solve();
+  CHECK(linearSystem.method() == MWP::SolverMethod::MixedPrecisionLU);
+  CHECK(linearSystem._refinement._converged);
+  CHECK_FALSE(linearSystem._refinement._fallback);
+  CHECK(maxError(linearSystem.variables, expected) < 1e-12);
+
+  linearSystem.setMixedPrecision(false);
+  linearSystem.solve();
+  CHECK(linearSystem.method() == MWP::SolverMethod::LU);
+}
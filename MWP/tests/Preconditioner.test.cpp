@@ -0,0 +1,208 @@
+#include "Preconditioner.hpp"
+#include "doctest/doctest.h"
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// 5-point Laplacian on a side x side grid, rows scaled by D * A * D with
+// diagonal entries spread over several orders of magnitude.
+MWP::SparseMatrixD scaledLaplacian(std::size_t side, bool scaled) {
+  const std::size_t n = side * side;
+  std::vector<double> d(n, 1.0);
+  if (scaled) {
+    for (std::size_t i = 0; i < n; i++) {
+      d[i] = std::pow(10.0, (double)(i % 7) / 2.0);
+    }
+  }
+  std::vector<MWP::Triplet<double>> triplets;
+  auto add = [&](std::size_t i, std::size_t j, double value) {
+    triplets.push_back({i, j, d[i] * value * d[j]});
+  };
+  for (std::size_t i = 0; i < side; i++) {
+    for (std::size_t j = 0; j < side; j++) {
+      const std::size_t row = i * side + j;
+      add(row, row, 4.0);
+      if (i > 0) {
+        add(row, row - side, -1.0);
+      }
+      if (i + 1 < side) {
+        add(row, row + side, -1.0);
+      }
+      if (j > 0) {
+        add(row, row - 1, -1.0);
+      }
+      if (j + 1 < side) {
+        add(row, row + 1, -1.0);
+      }
+    }
+  }
+  return MWP::SparseMatrixD(n, n, triplets);
+}
+
+// Couples every row to the rows stride away; LU produces no fill-in, so the
+// incomplete factorizations are exact, and each of the n / stride levels
+// holds stride rows.
+MWP::SparseMatrixD strided(std::size_t n, std::size_t stride, double upper) {
+  std::vector<MWP::Triplet<double>> triplets;
+  for (std::size_t i = 0; i < n; i++) {
+    triplets.push_back({i, i, 4.0});
+    if (i >= stride) {
+      triplets.push_back({i, i - stride, -1.0});
+    }
+    if (i + stride < n) {
+      triplets.push_back({i, i + stride, upper});
+    }
+  }
+  return MWP::SparseMatrixD(n, n, triplets);
+}
+
+double maxResidual(const MWP::SparseMatrixD &A, const std::vector<double> &z,
+                   const std::vector<double> &r) {
+  std::vector<double> product(A._rows);
+  A.multiply(z.data(), product.data());
+  double largest = 0.0;
+  for (std::size_t i = 0; i < product.size(); i++) {
+    largest = std::max(largest, std::abs(product[i] - r[i]));
+  }
+  return largest;
+}
+
+std::vector<double> sines(std::size_t n) {
+  std::vector<double> r(n);
+  for (std::size_t i = 0; i < n; i++) {
+    r[i] = std::sin((double)i);
+  }
+  return r;
+}
+
+} // namespace
+
+TEST_CASE("Tests the level scheduling") {
+  SUBCASE("Should schedule a grid by wavefronts") {
+    MWP::SparseMatrixD A = scaledLaplacian(5, false);
+    MWP::ILU0PreconditionerD ilu(A);
+    CHECK(ilu._lowerLevels.levels() == 9);
+    CHECK(ilu._upperLevels.levels() == 9);
+    CHECK(ilu._lowerLevels._rows.front() == 0);
+    CHECK(ilu._upperLevels._rows.front() == 24);
+  }
+  SUBCASE("Should put independent rows on one level") {
+    MWP::ILU0PreconditionerD ilu(strided(4000, 1000, -1.0));
+    CHECK(ilu._lowerLevels.levels() == 4);
+    CHECK(ilu._lowerLevels._levelStarts[1] == 1000);
+  }
+}
+
+TEST_CASE("Tests the preconditioners") {
+  SUBCASE("Should invert the diagonal with Jacobi") {
+    MWP::SparseMatrixD A = scaledLaplacian(3, true);
+    MWP::JacobiPreconditionerD jacobi(A);
+    std::vector<double> r(9, 1.0);
+    std::vector<double> z(9);
+    jacobi.apply(r.data(), z.data());
+    for (std::size_t i = 0; i < 9; i++) {
+      CHECK(z[i] == doctest::Approx(1.0 / A(i, i)));
+    }
+    CHECK_THROWS_WITH_AS(
+        MWP::JacobiPreconditionerD(MWP::SparseMatrixD(2, 2)),
+        "The matrix should have a full diagonal to be preconditioned",
+        std::runtime_error);
+  }
+  SUBCASE("Should be exact when the factorization has no fill-in") {
+    const std::size_t n = 4000;
+    std::vector<double> r = sines(n);
+    std::vector<double> z(n);
+    MWP::SparseMatrixD nonsymmetric = strided(n, 1000, -0.5);
+    MWP::ILU0PreconditionerD ilu(nonsymmetric);
+    ilu.apply(r.data(), z.data());
+    CHECK(maxResidual(nonsymmetric, z, r) < 1e-12);
+
+    MWP::SparseMatrixD symmetric = strided(n, 1000, -1.0);
+    MWP::IC0PreconditionerD ic(symmetric);
+    ic.apply(r.data(), z.data());
+    CHECK(maxResidual(symmetric, z, r) < 1e-12);
+  }
+  SUBCASE("Should solve the diagonal blocks with block-Jacobi") {
+    MWP::SparseMatrixD A = scaledLaplacian(4, false);
+    std::vector<double> r = sines(16);
+    std::vector<double> z(16);
+    MWP::BlockJacobiPreconditionerD whole(A, 16);
+    whole.apply(r.data(), z.data());
+    CHECK(maxResidual(A, z, r) < 1e-12);
+    // Blocks of one grid row drop only the couplings between grid rows.
+    MWP::BlockJacobiPreconditionerD rows(A, 4);
+    CHECK(rows._blocks.size() == 4);
+    rows.apply(r.data(), z.data());
+    std::vector<double> block(z.begin(), z.begin() + 4);
+    MWP::MatrixD first = A.toDense();
+    for (std::size_t i = 0; i < 4; i++) {
+      double sum = 0.0;
+      for (std::size_t j = 0; j < 4; j++) {
+        sum += first(i, j) * block[j];
+      }
+      CHECK(sum == doctest::Approx(r[i]));
+    }
+    CHECK_THROWS_AS(MWP::BlockJacobiPreconditionerD(A, 0), std::runtime_error);
+  }
+  SUBCASE("Should report a breakdown") {
+    std::vector<MWP::Triplet<double>> triplets = {
+        {0, 0, 1.0}, {1, 0, 2.0}, {0, 1, 2.0}, {1, 1, 1.0}};
+    MWP::SparseMatrixD indefinite(2, 2, triplets);
+    CHECK_THROWS_WITH_AS(MWP::IC0PreconditionerD{indefinite},
+                         "The incomplete Cholesky factorization broke down",
+                         std::runtime_error);
+  }
+}
+
+TEST_CASE("Tests the preconditioned Krylov solvers") {
+  MWP::KrylovSolverD solver;
+  MWP::IterativeSettings settings;
+  settings._maxIterations = 5000;
+
+  SUBCASE("Should cut the CG iterations on a badly scaled system") {
+    MWP::SparseMatrixD A = scaledLaplacian(30, true);
+    MWP::LinearOperatorD op(A);
+    std::vector<double> b = sines(900);
+    std::vector<double> x(900, 0.0);
+    MWP::IterativeResult plain =
+        solver.cg(op, b.data(), x.data(), settings);
+
+    MWP::JacobiPreconditionerD jacobi(A);
+    MWP::LinearOperatorD jacobiOperator = jacobi.linearOperator();
+    std::fill(x.begin(), x.end(), 0.0);
+    MWP::IterativeResult scaled =
+        solver.cg(op, b.data(), x.data(), settings, &jacobiOperator);
+
+    MWP::IC0PreconditionerD ic(A);
+    MWP::LinearOperatorD icOperator = ic.linearOperator();
+    std::fill(x.begin(), x.end(), 0.0);
+    MWP::IterativeResult incomplete =
+        solver.cg(op, b.data(), x.data(), settings, &icOperator);
+
+    CHECK(plain._converged);
+    CHECK(scaled._converged);
+    CHECK(incomplete._converged);
+    CHECK(scaled._iterations * 10 < plain._iterations);
+    CHECK(incomplete._iterations < scaled._iterations);
+    CHECK(maxResidual(A, x, b) < 1e-6);
+  }
+  SUBCASE("Should precondition BiCGSTAB and GMRES on the right") {
+    MWP::SparseMatrixD A = scaledLaplacian(20, false);
+    MWP::ILU0PreconditionerD ilu(A);
+    MWP::LinearOperatorD M = ilu.linearOperator();
+    std::vector<double> b = sines(400);
+    for (MWP::IterativeMethod method :
+         {MWP::IterativeMethod::BiCGSTAB, MWP::IterativeMethod::GMRES}) {
+      std::vector<double> x(400, 0.0);
+      MWP::IterativeResult plain =
+          solver.solve(method, A, b.data(), x.data(), settings);
+      std::fill(x.begin(), x.end(), 0.0);
+      MWP::IterativeResult preconditioned =
+          solver.solve(method, A, b.data(), x.data(), settings, &M);
+      CHECK(preconditioned._converged);
+      CHECK(preconditioned._iterations < plain._iterations);
+      CHECK(maxResidual(A, x, b) < 1e-8);
+    }
+  }
+}
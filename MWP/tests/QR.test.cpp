@@ -0,0 +1,80 @@
+#include "QR.hpp"
+#include "doctest/doctest.h"
+#include <stdexcept>
+
+TEST_CASE("Tests the QR class") {
+  SUBCASE("Should factor a small matrix") {
+    MWP::MatrixD matrix({12.0, -51.0, 4.0, 6.0, 167.0, -68.0, -4.0, 24.0, -41.0},
+                        3, 3);
+    MWP::QRD qr(matrix);
+    MWP::MatrixD upper = qr.upper();
+    CHECK(upper(0, 0) == doctest::Approx(-14.0));
+    CHECK(upper(0, 1) == doctest::Approx(-21.0));
+    CHECK(upper(1, 1) == doctest::Approx(-175.0));
+    CHECK(upper(1, 0) == 0.0);
+    MWP::MatrixD orthogonal = qr.orthogonal();
+    MWP::MatrixD product = orthogonal * upper;
+    for (unsigned int i = 0; i < 9; i++) {
+      CHECK(product[i] == doctest::Approx(matrix[i]));
+    }
+  }
+  SUBCASE("Should factor across several blocks") {
+    const unsigned int m = 150;
+    const unsigned int n = 70;
+    MWP::MatrixD matrix(m, n);
+    unsigned int seed = 12345;
+    for (unsigned int i = 0; i < m; i++) {
+      for (unsigned int j = 0; j < n; j++) {
+        seed = seed * 1103515245u + 12345u;
+        matrix(i, j) = (double)((seed >> 16) % 2001) / 1000.0 - 1.0;
+      }
+    }
+    MWP::QRD qr(matrix);
+    CHECK(qr.isFullRank());
+    MWP::MatrixD orthogonal = qr.orthogonal();
+    CHECK(orthogonal._rows == m);
+    CHECK(orthogonal._columns == n);
+    MWP::MatrixD identity = TransposeMatrix(orthogonal) * orthogonal;
+    for (unsigned int i = 0; i < n; i += 3) {
+      for (unsigned int j = 0; j < n; j += 5) {
+        CHECK(identity(i, j) ==
+              doctest::Approx(i == j ? 1.0 : 0.0).epsilon(1e-10));
+      }
+    }
+    MWP::MatrixD product = orthogonal * qr.upper();
+    for (unsigned int i = 0; i < m; i += 11) {
+      for (unsigned int j = 0; j < n; j += 7) {
+        CHECK(product(i, j) == doctest::Approx(matrix(i, j)));
+      }
+    }
+    MWP::MatrixD full = qr.orthogonal(true);
+    MWP::MatrixD applied = IdentityMatrix<double>(m, m);
+    qr.applyQ(applied.view(0, m, 0, m));
+    for (unsigned int i = 0; i < m; i += 13) {
+      for (unsigned int j = 0; j < m; j += 9) {
+        CHECK(applied(i, j) == doctest::Approx(full(i, j)));
+      }
+    }
+    qr.applyQTransposed(applied.view(0, m, 0, m));
+    for (unsigned int i = 0; i < m; i += 13) {
+      CHECK(applied(i, i) == doctest::Approx(1.0));
+    }
+  }
+  SUBCASE("Should solve a least-squares problem") {
+    MWP::MatrixD matrix({1.0, 1.0, 1.0, 2.0, 1.0, 3.0, 1.0, 4.0}, 4, 2);
+    MWP::QRD qr(matrix);
+    MWP::VectorD constants({6.0, 5.0, 7.0, 10.0}, 4, 1);
+    MWP::VectorD variables = qr.solve(constants);
+    CHECK(variables._rows == 2);
+    CHECK(variables[0] == doctest::Approx(3.5));
+    CHECK(variables[1] == doctest::Approx(1.4));
+  }
+  SUBCASE("Should report a rank deficient matrix") {
+    MWP::MatrixD matrix({1.0, 2.0, 2.0, 4.0, 3.0, 6.0}, 3, 2);
+    MWP::QRD qr(matrix);
+    CHECK_FALSE(qr.isFullRank());
+    MWP::VectorD constants({1.0, 2.0, 3.0}, 3, 1);
+    CHECK_THROWS_WITH_AS(qr.solve(constants), "The matrix is singular",
+                         std::runtime_error);
+  }
+}
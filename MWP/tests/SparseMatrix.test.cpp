@@ -0,0 +1,105 @@
+#include "SparseMatrix.hpp"
+#include "doctest/doctest.h"
+#include <cmath>
+#include <stdexcept>
+
+TEST_CASE("Tests the SparseMatrix class") {
+  // 0 2 0 1
+  // 0 0 0 0
+  // 3 0 4 0
+  MWP::MatrixD dense(3, 4);
+  dense(0, 1) = 2;
+  dense(0, 3) = 1;
+  dense(2, 0) = 3;
+  dense(2, 2) = 4;
+
+  SUBCASE("Should compress a dense matrix in both formats") {
+    MWP::SparseMatrixD csr(dense);
+    CHECK(csr.nonZeros() == 4);
+    CHECK(csr._offsets == std::vector<std::size_t>{0, 2, 2, 4});
+    CHECK(csr._indices == std::vector<std::size_t>{1, 3, 0, 2});
+    MWP::SparseMatrixD csc(dense, MWP::SparseFormat::CSC);
+    CHECK(csc._offsets == std::vector<std::size_t>{0, 1, 2, 3, 4});
+    CHECK(csc._indices == std::vector<std::size_t>{2, 0, 2, 0});
+    CHECK(csc._values == std::vector<double>{3, 2, 4, 1});
+    CHECK(csr.toDense()._elements == dense._elements);
+    CHECK(csc.toDense()._elements == dense._elements);
+    CHECK(csc.toCSR()._indices == csr._indices);
+    CHECK(csr.toCSC()._values == csc._values);
+  }
+  SUBCASE("Should assemble triplets summing duplicates") {
+    std::vector<MWP::Triplet<double>> triplets = {
+        {2, 2, 1}, {0, 3, 1}, {2, 0, 3}, {0, 1, 2}, {2, 2, 3}};
+    for (MWP::SparseFormat format :
+         {MWP::SparseFormat::CSR, MWP::SparseFormat::CSC}) {
+      MWP::SparseMatrixD sparse(3, 4, triplets, format);
+      CHECK(sparse.nonZeros() == 4);
+      CHECK(sparse.toDense()._elements == dense._elements);
+      CHECK(sparse(2, 2) == 4);
+      CHECK(sparse(1, 1) == 0);
+    }
+    std::vector<MWP::Triplet<double>> outside = {{3, 0, 1}};
+    CHECK_THROWS_WITH_AS(MWP::SparseMatrixD(3, 4, outside),
+                         "Index out of bounds", std::runtime_error);
+  }
+  SUBCASE("Should transpose without moving elements") {
+    MWP::SparseMatrixD transpose = MWP::SparseMatrixD(dense).transposed();
+    CHECK(transpose._format == MWP::SparseFormat::CSC);
+    CHECK(transpose._rows == 4);
+    CHECK(transpose(3, 0) == 1);
+    CHECK(transpose(0, 2) == 3);
+  }
+  SUBCASE("Should multiply by vectors and dense matrices") {
+    MWP::VectorD x({1, 2, 3, 4}, 4, 1);
+    MWP::VectorD y({1, 2, 3}, 3, 1);
+    MWP::MatrixD B({1, 0, 0, 1, 1, 1, 2, -1}, 4, 2);
+    for (MWP::SparseFormat format :
+         {MWP::SparseFormat::CSR, MWP::SparseFormat::CSC}) {
+      MWP::SparseMatrixD sparse(dense, format);
+      CHECK((sparse * x)._elements == std::vector<double>{8, 0, 15});
+      CHECK(sparse.multiplyTransposed(y)._elements ==
+            std::vector<double>{9, 2, 12, 1});
+      CHECK((sparse * B)._elements == std::vector<double>{2, 1, 0, 0, 7, 4});
+      MWP::MatrixD C({1, 0, 0, 1, 1, 1}, 3, 2);
+      CHECK(sparse.multiplyTransposed(C)._elements ==
+            std::vector<double>{3, 3, 2, 0, 4, 4, 1, 0});
+    }
+    CHECK_THROWS_WITH_AS(MWP::SparseMatrixD(dense) * y,
+                         "Invalid matrix and vector dimensions for "
+                         "multiplication operation",
+                         std::runtime_error);
+  }
+  SUBCASE("Should match the dense product on a large banded matrix") {
+    // Enough nonzeros to split the products across the thread pool.
+    const std::size_t n = 5000;
+    std::vector<MWP::Triplet<double>> triplets;
+    for (std::size_t i = 0; i < n; i++) {
+      triplets.push_back({i, i, 4.0});
+      if (i + 1 < n) {
+        triplets.push_back({i, i + 1, -1.0});
+        triplets.push_back({i + 1, i, -2.0});
+      }
+      triplets.push_back({i, (i * 7) % n, 0.5});
+    }
+    MWP::SparseMatrixD csr(n, n, triplets);
+    MWP::SparseMatrixD csc = csr.toCSC();
+    MWP::VectorD x(n, 1);
+    for (std::size_t i = 0; i < n; i++) {
+      x._elements[i] = std::sin((double)i);
+    }
+    std::vector<double> expected(n, 0.0);
+    std::vector<double> expectedTransposed(n, 0.0);
+    for (const MWP::Triplet<double> &t : triplets) {
+      expected[t._row] += t._value * x._elements[t._column];
+      expectedTransposed[t._column] += t._value * x._elements[t._row];
+    }
+    for (const MWP::SparseMatrixD *sparse : {&csr, &csc}) {
+      MWP::VectorD y = *sparse * x;
+      MWP::VectorD z = sparse->multiplyTransposed(x);
+      for (std::size_t i = 0; i < n; i++) {
+        CHECK(y._elements[i] == doctest::Approx(expected[i]));
+        CHECK(z._elements[i] == doctest::Approx(expectedTransposed[i]));
+      }
+    }
+  }
+}
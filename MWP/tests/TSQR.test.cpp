@@ -0,0 +1,82 @@
+#include "TSQR.hpp"
+#include "doctest/doctest.h"
+#include <cmath>
+#include <stdexcept>
+
+TEST_CASE("Tests the TSQR class") {
+  const unsigned int m = 500;
+  const unsigned int n = 12;
+  MWP::MatrixD matrix(m, n);
+  unsigned int seed = 12345;
+  for (unsigned int i = 0; i < m; i++) {
+    for (unsigned int j = 0; j < n; j++) {
+      seed = seed * 1103515245u + 12345u;
+      matrix(i, j) = (double)((seed >> 16) % 2001) / 1000.0 - 1.0;
+    }
+  }
+
+  SUBCASE("Should not factor a wide matrix") {
+    MWP::MatrixD wide(2, 3);
+    CHECK_THROWS_WITH_AS(MWP::TSQRD tsqr(wide),
+                         "Underdetermined linear systems are not supported",
+                         std::runtime_error);
+  }
+  SUBCASE("Should reduce the blocks to the R of a plain QR") {
+    MWP::TSQRD tsqr(matrix, 7);
+    CHECK(tsqr.blocks() == 7);
+    MWP::MatrixD upper = tsqr.upper();
+    MWP::MatrixD expected = MWP::QRD(matrix).upper();
+    // R is unique up to the sign of its rows.
+    for (unsigned int i = 0; i < n; i++) {
+      const double sign = upper(i, i) * expected(i, i) < 0 ? -1.0 : 1.0;
+      for (unsigned int j = 0; j < n; j++) {
+        CHECK(upper(i, j) * sign == doctest::Approx(expected(i, j)));
+      }
+    }
+    MWP::MatrixD orthogonal = tsqr.orthogonal();
+    CHECK(orthogonal._rows == m);
+    CHECK(orthogonal._columns == n);
+    MWP::MatrixD identity = TransposeMatrix(orthogonal) * orthogonal;
+    for (unsigned int i = 0; i < n; i++) {
+      for (unsigned int j = 0; j < n; j++) {
+        CHECK(identity(i, j) ==
+              doctest::Approx(i == j ? 1.0 : 0.0).epsilon(1e-10));
+      }
+    }
+    MWP::MatrixD product = orthogonal * upper;
+    for (unsigned int i = 0; i < m; i += 17) {
+      for (unsigned int j = 0; j < n; j++) {
+        CHECK(product(i, j) == doctest::Approx(matrix(i, j)));
+      }
+    }
+  }
+  SUBCASE("Should keep every block at least n rows high") {
+    MWP::TSQRD tsqr(matrix, 100);
+    CHECK(tsqr.blocks() == m / n);
+  }
+  SUBCASE("Should solve a least-squares problem") {
+    MWP::VectorD expected(n, 1);
+    for (unsigned int j = 0; j < n; j++) {
+      expected[j] = (double)j - 4.0;
+    }
+    MWP::VectorD constants = matrix * expected;
+    MWP::TSQRD tsqr(matrix, 4);
+    MWP::VectorD variables = tsqr.solve(constants);
+    CHECK(variables._rows == n);
+    for (unsigned int j = 0; j < n; j++) {
+      CHECK(variables[j] == doctest::Approx(expected[j]));
+    }
+    MWP::MatrixD small({1.0, 1.0, 1.0, 2.0, 1.0, 3.0, 1.0, 4.0}, 4, 2);
+    MWP::VectorD observed({6.0, 5.0, 7.0, 10.0}, 4, 1);
+    MWP::VectorD fit = MWP::TSQRD(small, 2).solve(observed);
+    CHECK(fit[0] == doctest::Approx(3.5));
+    CHECK(fit[1] == doctest::Approx(1.4));
+  }
+  SUBCASE("Should report a rank deficient matrix") {
+    MWP::MatrixD deficient({1.0, 2.0, 2.0, 4.0, 3.0, 6.0, 4.0, 8.0}, 4, 2);
+    MWP::TSQRD tsqr(deficient, 2);
+    MWP::VectorD constants({1.0, 2.0, 3.0, 4.0}, 4, 1);
+    CHECK_THROWS_WITH_AS(tsqr.solve(constants), "The matrix is singular",
+                         std::runtime_error);
+  }
+}
@@ -0,0 +1,106 @@
+#include "Matrix.hpp"
+#include "Transpose.hpp"
+#include "doctest/doctest.h"
+#include <complex>
+#include <vector>
+
+namespace {
+
+std::vector<double> numbered(std::size_t size) {
+  std::vector<double> values(size);
+  for (std::size_t i = 0; i < size; i++) {
+    values[i] = (double)i + 0.5;
+  }
+  return values;
+}
+
+bool isTransposed(std::size_t rows, std::size_t columns,
+                  const std::vector<double> &original,
+                  const std::vector<double> &transposed) {
+  for (std::size_t i = 0; i < rows; i++) {
+    for (std::size_t j = 0; j < columns; j++) {
+      if (transposed[j * rows + i] != original[i * columns + j]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+TEST_CASE("Tests the tiled transposes") {
+  // Shapes around the 2, 4 and 8 wide register blocks and the 32 wide tiles.
+  const std::size_t sizes[] = {1, 2, 3, 7, 8, 9, 31, 33, 70};
+  SUBCASE("Should transpose out of place") {
+    for (std::size_t rows : sizes) {
+      for (std::size_t columns : sizes) {
+        std::vector<double> A = numbered(rows * columns);
+        std::vector<double> B(rows * columns, -1.0);
+        MWP::transpose<double>(rows, columns, A.data(), columns, B.data(),
+                               rows);
+        CHECK(isTransposed(rows, columns, A, B));
+      }
+    }
+  }
+  SUBCASE("Should respect the leading dimensions") {
+    const std::size_t rows = 9, columns = 11, lda = 13, ldb = 12;
+    std::vector<double> A = numbered(rows * lda);
+    std::vector<double> B(columns * ldb, -1.0);
+    MWP::transpose<double>(rows, columns, A.data(), lda, B.data(), ldb);
+    for (std::size_t i = 0; i < rows; i++) {
+      for (std::size_t j = 0; j < columns; j++) {
+        CHECK(B[j * ldb + i] == A[i * lda + j]);
+      }
+    }
+    // Padding of the destination is left untouched.
+    CHECK(B[rows] == -1.0);
+  }
+  SUBCASE("Should transpose in place") {
+    for (std::size_t rows : sizes) {
+      for (std::size_t columns : sizes) {
+        std::vector<double> A = numbered(rows * columns);
+        std::vector<double> original = A;
+        MWP::transposeInPlace<double>(rows, columns, A.data());
+        CHECK(isTransposed(rows, columns, original, A));
+      }
+    }
+  }
+  SUBCASE("Should transpose other element types") {
+    std::vector<std::complex<double>> A = {{1, 1}, {2, 2}, {3, 3},
+                                           {4, 4}, {5, 5}, {6, 6}};
+    MWP::transposeInPlace<std::complex<double>>(2, 3, A.data());
+    CHECK(A[1] == std::complex<double>(4, 4));
+    CHECK(A[4] == std::complex<double>(3, 3));
+    std::vector<int> B = {1, 2, 3, 4};
+    std::vector<int> C(4);
+    MWP::transpose<int>(2, 2, B.data(), 2, C.data(), 2);
+    CHECK(C == std::vector<int>{1, 3, 2, 4});
+  }
+}
+
+TEST_CASE("Tests the matrix transposes") {
+  SUBCASE("Should transpose square and rectangular matrices") {
+    for (unsigned int rows : {5u, 64u, 67u}) {
+      for (unsigned int columns : {5u, 67u}) {
+        MWP::MatrixD matrix(numbered(rows * columns), rows, columns);
+        std::vector<double> original = matrix._elements;
+        matrix.transpose();
+        CHECK(matrix._rows == columns);
+        CHECK(matrix._columns == rows);
+        CHECK(isTransposed(rows, columns, original, matrix._elements));
+      }
+    }
+  }
+  SUBCASE("Should materialize lazy transposes of blocks") {
+    const MWP::MatrixD matrix(numbered(40 * 50), 40, 50);
+    MWP::MatrixD block = MWP::transposed(matrix.view(2, 37, 3, 40));
+    MWP::MatrixD transposed = TransposeMatrix(matrix);
+    for (unsigned int i = 0; i < 37; i++) {
+      for (unsigned int j = 0; j < 35; j++) {
+        CHECK(block(i, j) == matrix(j + 2, i + 3));
+      }
+    }
+    CHECK(isTransposed(40, 50, matrix._elements, transposed._elements));
+  }
+}
@@ -105,6 +105,28 @@ TEST_CASE("Tests the vectos class and its functionalities") {
     CHECK(vectorIRes1[1] == 9);
     CHECK(vectorIRes1[2] == 12);
   }
+  SUBCASE("Should update a vector in place with compound assignments") {
+    std::vector<double> elements = {1.0, 2.0, 3.0};
+    MWP::VectorD moved(std::move(elements), 3, 1);
+    // The buffer of a std::vector is not aligned: the elements are copied
+    // once and the source released.
+    CHECK(elements.empty());
+    CHECK(moved._elements == std::vector<double>{1.0, 2.0, 3.0});
+    MWP::AlignedVector<double> aligned = {1.0, 2.0, 3.0};
+    const double *storage = aligned.data();
+    MWP::VectorD vectorD(std::move(aligned), 3, 1);
+    CHECK(vectorD._elements.data() == storage);
+    MWP::VectorD other({1.0, 1.0, 1.0}, 3, 1);
+    vectorD += other * 3.0;
+    vectorD -= other;
+    vectorD *= 2.0;
+    CHECK(vectorD[0] == 6.0);
+    CHECK(vectorD[2] == 10.0);
+    CHECK(vectorD._elements.data() == storage);
+    CHECK_THROWS_WITH_AS(vectorD += MWP::VectorD(1, 3),
+                         "Invalid vectors dimensions for addition operation",
+                         std::runtime_error);
+  }
   SUBCASE("Should multiply a vector by another vector") {
     SUBCASE("Should not multiply a vector by another vector with incompatible "
             "dimensions for multiplication operation") {
@@ -150,6 +172,49 @@ TEST_CASE("Tests the vectos class and its functionalities") {
     double dotProduct = Dot(vectorD1, vectorD2);
     CHECK(dotProduct == 25.0f);
   }
+  SUBCASE("Should evaluate lazy vector expressions") {
+    MWP::VectorD vectorD1({1.0f, 2.0f, 3.0f}, 3, 1);
+    MWP::VectorD vectorD2({4.0f, 5.0f, 6.0f}, 3, 1);
+    MWP::VectorD fused = vectorD1 * 2.0 + vectorD2 - vectorD1;
+    CHECK(fused[0] == 5.0f);
+    CHECK(fused[1] == 7.0f);
+    CHECK(fused[2] == 9.0f);
+    vectorD1 = vectorD1 - vectorD2 * 0.5;
+    CHECK(vectorD1[0] == -1.0f);
+    CHECK(vectorD1[1] == -0.5f);
+    CHECK(vectorD1[2] == 0.0f);
+    vectorD2 = vectorD1 - vectorD2;
+    CHECK(vectorD2[0] == -5.0f);
+    CHECK(vectorD2[2] == -6.0f);
+    CHECK((vectorD1 - vectorD2).norm2() ==
+          doctest::Approx(MWP::VectorD(vectorD1 - vectorD2).norm2()));
+    CHECK((vectorD1 + vectorD2)[1] == -0.5f + -5.5f);
+    CHECK((vectorD2 * 2.0)[2] == -12.0f);
+    CHECK_THROWS_WITH_AS((vectorD1 + vectorD2)[3], "Index out of bounds",
+                         std::runtime_error);
+  }
+  SUBCASE("Should apply element-wise operations on lengths that are not a "
+          "multiple of the SIMD width") {
+    const unsigned int size = 37;
+    MWP::VectorD vectorD1(size, 1);
+    MWP::VectorD vectorD2(size, 1);
+    double expectedDot = 0.0;
+    for (unsigned int i = 0; i < size; i++) {
+      vectorD1[i] = (double)i;
+      vectorD2[i] = (double)(2 * i + 1);
+      expectedDot += vectorD1[i] * vectorD2[i];
+    }
+    MWP::VectorD sum = vectorD1 + vectorD2;
+    MWP::VectorD difference = vectorD2 - vectorD1;
+    MWP::VectorD scaled = vectorD1 * 0.5;
+    for (unsigned int i = 0; i < size; i++) {
+      CHECK(sum[i] == (double)(3 * i + 1));
+      CHECK(difference[i] == (double)(i + 1));
+      CHECK(scaled[i] == 0.5 * i);
+    }
+    CHECK(Dot(vectorD1, vectorD2) == expectedDot);
+    CHECK(vectorD1.norm2() == doctest::Approx(std::sqrt(Dot(vectorD1, vectorD1))));
+  }
   SUBCASE("Should transform a valid Vector object into a Matrix object") {
     MWP::VectorD vectorD({1.0f, 2.0f, 3.0f}, 3, 1);
     MWP::MatrixD toMatrixVectorD = toMatrix(vectorD);
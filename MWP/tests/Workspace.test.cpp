@@ -0,0 +1,109 @@
+#include "Workspace.hpp"
+#include "Cholesky.hpp"
+#include "QR.hpp"
+#include "doctest/doctest.h"
+#include <cmath>
+#include <cstdint>
+
+namespace {
+
+MWP::MatrixD randomMatrix(unsigned int rows, unsigned int columns) {
+  MWP::MatrixD matrix(rows, columns);
+  unsigned int seed = 2024;
+  for (unsigned int i = 0; i < rows * columns; i++) {
+    seed = seed * 1103515245u + 12345u;
+    matrix[i] = (double)((seed >> 16) % 2001) / 1000.0 - 1.0;
+  }
+  return matrix;
+}
+
+bool isAligned(const void *pointer) {
+  return reinterpret_cast<std::uintptr_t>(pointer) % MWP::StorageAlignment ==
+         0;
+}
+
+} // namespace
+
+TEST_CASE("Tests the Workspace class") {
+  SUBCASE("Should hand out aligned blocks released with their scope") {
+    MWP::Workspace workspace;
+    {
+      MWP::WorkspaceScope outer(workspace);
+      double *first = outer.allocate<double>(3);
+      float *second = outer.allocate<float>(100, 1.5f);
+      CHECK(isAligned(first));
+      CHECK(isAligned(second));
+      CHECK(second[99] == 1.5f);
+      const std::size_t used = workspace.used();
+      CHECK(used >= 3 * sizeof(double) + 100 * sizeof(float));
+      {
+        MWP::WorkspaceScope inner(workspace);
+        int *third = inner.allocate<int>(10);
+        CHECK(isAligned(third));
+        CHECK(workspace.used() > used);
+      }
+      CHECK(workspace.used() == used);
+      // The space of the inner scope is handed out again.
+      MWP::WorkspaceScope inner(workspace);
+      CHECK(inner.allocate<double>(1) ==
+            reinterpret_cast<double *>(reinterpret_cast<char *>(first) +
+                                       used));
+    }
+    CHECK(workspace.used() == 0);
+  }
+  SUBCASE("Should merge its chunks once every scope has ended") {
+    MWP::Workspace workspace;
+    {
+      MWP::WorkspaceScope scope(workspace);
+      for (unsigned int i = 0; i < 8; i++) {
+        scope.allocate<double>(20000);
+      }
+    }
+    const std::size_t capacity = workspace.capacity();
+    CHECK(capacity >= workspace.peak());
+    CHECK(workspace.peak() >= 8 * 20000 * sizeof(double));
+    {
+      MWP::WorkspaceScope scope(workspace);
+      for (unsigned int i = 0; i < 8; i++) {
+        scope.allocate<double>(20000);
+      }
+    }
+    CHECK(workspace.capacity() == capacity);
+    workspace.release();
+    CHECK(workspace.capacity() == 0);
+    workspace.reserve(1000);
+    CHECK(workspace.capacity() >= 1000);
+  }
+  SUBCASE("Should stop growing once the decompositions reach steady state") {
+    MWP::Workspace &workspace = MWP::Workspace::local();
+    const MWP::MatrixD matrix = randomMatrix(200, 120);
+    const MWP::QRD first(matrix);
+    const std::size_t capacity = workspace.capacity();
+    CHECK(capacity > 0);
+    CHECK(workspace.used() == 0);
+    const MWP::QRD second(matrix);
+    CHECK(workspace.capacity() == capacity);
+    CHECK(workspace.used() == 0);
+    for (unsigned int i = 0; i < first._factors._size; i++) {
+      CHECK(first._factors[i] == second._factors[i]);
+    }
+    MWP::MatrixD spd = MWP::MatrixD(matrix.view(0, 120, 0, 120)) *
+                       MWP::transposed(matrix.view(0, 120, 0, 120));
+    for (unsigned int i = 0; i < 120; i++) {
+      spd(i, i) += 120.0;
+    }
+    const MWP::CholeskyD cholesky(spd);
+    CHECK(cholesky.isPositiveDefinite());
+    CHECK(workspace.used() == 0);
+  }
+  SUBCASE("Should apply householder reflectors in place") {
+    MWP::MatrixD matrix = randomMatrix(40, 30);
+    const double norm = MWP::MatrixD(matrix.view(0, 40, 0, 1)).norm2();
+    hhInPlace(matrix.view(0, 40, 0, 30));
+    CHECK(std::abs(matrix(0, 0)) == doctest::Approx(norm));
+    for (unsigned int i = 1; i < 40; i++) {
+      CHECK(matrix(i, 0) == doctest::Approx(0.0).epsilon(1e-12));
+    }
+    CHECK(MWP::Workspace::local().used() == 0);
+  }
+}